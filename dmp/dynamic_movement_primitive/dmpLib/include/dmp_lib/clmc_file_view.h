@@ -0,0 +1,225 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks   Read-only, memory mapped view onto a binary CLMC data file.
+            The header is parsed once; data columns are only byte swapped
+            and converted to double when they are requested.
+
+ \file    clmc_file_view.h
+
+ \date    Oct 17, 2026
+
+ *********************************************************************/
+
+#ifndef CLMC_FILE_VIEW_H_
+#define CLMC_FILE_VIEW_H_
+
+// system include
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <Eigen/Core>
+
+// local include
+#include <dmp_lib/status.h>
+#include <dmp_lib/logger.h>
+
+namespace dmp_lib
+{
+
+/*! Zero-copy reader for CLMC files. The file is mmap'ed and only the header
+ * (sizes, sampling frequency, variable names and units) is parsed upon
+ * initialization. The big-endian float data is decoded lazily, column by column.
+ */
+class CLMCFileView : public Status, boost::noncopyable
+{
+
+public:
+
+  /*! Constructor
+   */
+  CLMCFileView() :
+    num_rows_(0),
+    num_cols_(0),
+    sampling_frequency_(0.0),
+    file_descriptor_(-1),
+    mapped_file_(NULL),
+    mapped_size_(0),
+    data_(NULL) {};
+
+  /*! Destructor
+   */
+  virtual ~CLMCFileView();
+
+  /*! Maps the file and parses the header
+   * @param file_name
+   * @return True on success, otherwise False
+   */
+  bool initialize(const std::string& file_name);
+
+  /*! Unmaps the file
+   */
+  void close();
+
+  /*!
+   * @return Number of samples (rows) contained in the file
+   */
+  int getNumRows() const;
+
+  /*!
+   * @return Number of variables (columns) contained in the file
+   */
+  int getNumCols() const;
+
+  /*!
+   * @return
+   */
+  double getSamplingFrequency() const;
+
+  /*!
+   * @return
+   */
+  const std::vector<std::string>& getVariableNames() const;
+
+  /*!
+   * @return
+   */
+  const std::vector<std::string>& getVariableUnits() const;
+
+  /*!
+   * @param variable_name
+   * @param column_index
+   * @return True if the variable is contained in the file, otherwise False
+   */
+  bool getColumnIndex(const std::string& variable_name,
+                      int& column_index) const;
+
+  /*! Computes the (half open) row range [start_row, start_row + num_rows) that
+   * corresponds to the time window [start_time, end_time]
+   * @param start_time
+   * @param end_time
+   * @param start_row
+   * @param num_rows
+   * @return True on success, otherwise False
+   */
+  bool getRowRange(const double start_time,
+                   const double end_time,
+                   int& start_row,
+                   int& num_rows) const;
+
+  /*! Decodes num_rows samples of a single column starting at start_row into column.
+   * @param column_index
+   * @param column Output, must provide space for num_rows values
+   * @param start_row
+   * @param num_rows
+   * @return True on success, otherwise False
+   */
+  bool readColumn(const int column_index,
+                  double* column,
+                  const int start_row,
+                  const int num_rows) const;
+
+  /*! Decodes the requested columns into the columns of matrix. The matrix is resized to num_rows x column_indices.size()
+   * @param column_indices
+   * @param matrix
+   * @param start_row
+   * @param num_rows If negative, all rows starting from start_row are read
+   * @return True on success, otherwise False
+   */
+  bool readColumns(const std::vector<int>& column_indices,
+                   Eigen::MatrixXd& matrix,
+                   const int start_row = 0,
+                   const int num_rows = -1) const;
+
+private:
+
+  /*!
+   */
+  int num_rows_;
+  int num_cols_;
+  double sampling_frequency_;
+
+  std::vector<std::string> variable_names_;
+  std::vector<std::string> variable_units_;
+
+  /*!
+   */
+  int file_descriptor_;
+  void* mapped_file_;
+  size_t mapped_size_;
+
+  /*! Points to the first (big-endian) float of the data block inside the mapped file
+   */
+  const unsigned int* data_;
+
+  /*!
+   * @param file_name
+   * @return True on success, otherwise False
+   */
+  bool parseHeader(const std::string& file_name);
+
+  /*!
+   * @param column_index
+   * @return True on success, otherwise False
+   */
+  bool isWithinColumnBoundaries(const int column_index) const;
+
+  /*!
+   * @param start_row
+   * @param num_rows
+   * @return True on success, otherwise False
+   */
+  bool isWithinRowBoundaries(const int start_row,
+                             const int num_rows) const;
+
+};
+
+/*! Abbreviation for convinience
+ */
+typedef boost::shared_ptr<CLMCFileView> CLMCFileViewPtr;
+
+// Inline functions follow
+inline int CLMCFileView::getNumRows() const
+{
+  assert(initialized_);
+  return num_rows_;
+}
+inline int CLMCFileView::getNumCols() const
+{
+  assert(initialized_);
+  return num_cols_;
+}
+inline double CLMCFileView::getSamplingFrequency() const
+{
+  assert(initialized_);
+  return sampling_frequency_;
+}
+inline const std::vector<std::string>& CLMCFileView::getVariableNames() const
+{
+  assert(initialized_);
+  return variable_names_;
+}
+inline const std::vector<std::string>& CLMCFileView::getVariableUnits() const
+{
+  assert(initialized_);
+  return variable_units_;
+}
+
+inline bool CLMCFileView::isWithinRowBoundaries(const int start_row,
+                                                const int num_rows) const
+{
+  if ((start_row < 0) || (num_rows < 0) || (start_row + num_rows > num_rows_))
+  {
+    Logger::logPrintf("Requested rows [%i, %i) are out of bound. File contains >%i< rows.", Logger::ERROR, start_row, start_row + num_rows, num_rows_);
+    return false;
+  }
+  return true;
+}
+
+}
+
+#endif /* CLMC_FILE_VIEW_H_ */
@@ -392,6 +392,37 @@ public:
   bool propagateFull(Trajectory& trajectory,
                      const double sampling_duration);
 
+  /*! Propagates all DMPs and generates one rollout of size num_samples for each of them. All DMPs need
+   *  to be setup, their canonical systems need to be equal, and their transformation systems need to be of
+   *  the same type. The canonical system is integrated only once, the nonlinearities of all dimensions are
+   *  computed with one matrix-matrix product (per set of basis functions), and the transformation systems are
+   *  integrated together as structure-of-arrays. DMPs that cannot be batched (e.g. because they contain
+   *  quaternion transformation systems) are propagated one after the other.
+   * @param dmps
+   * @param trajectories Will contain one rollout for each DMP
+   * @param sampling_duration
+   * @param num_samples
+   * @return True on success, otherwise False
+   */
+  static bool propagateFull(std::vector<boost::shared_ptr<DynamicMovementPrimitive> >& dmps,
+                            std::vector<Trajectory>& trajectories,
+                            const double sampling_duration,
+                            const int num_samples);
+
+  /*! Propagates the DMP once for each set of thetas (e.g. the noisy parameters of policy improvement rollouts)
+   *  in one batch, see above. The thetas of the DMP are not changed, its transformation systems are left in
+   *  the state of the last rollout.
+   * @param thetas For each rollout, one theta vector for each dimension (see getThetas)
+   * @param trajectories Will contain one rollout for each set of thetas
+   * @param sampling_duration
+   * @param num_samples
+   * @return True on success, otherwise False
+   */
+  bool propagateFull(const std::vector<std::vector<Eigen::VectorXd> >& thetas,
+                     std::vector<Trajectory>& trajectories,
+                     const double sampling_duration,
+                     const int num_samples);
+
   /*!
    * @param desired_positions
    * @param desired_velocities
@@ -715,6 +746,12 @@ protected:
    */
   bool setupIndices();
 
+  /*! Preallocates the feedback vectors used while propagating such that
+   * propagateStep does not need to allocate any memory.
+   * Needs to be called whenever the transformation systems change.
+   */
+  void setupFeedbackWorkspace();
+
   /*! Contains the mapping from dimension index to transformation system index and dimension index
    */
   std::vector<std::pair<int, int> > indices_;
@@ -745,6 +782,38 @@ private:
    */
   bool integrate(const int num_iteration, const Eigen::VectorXd& feedback);
 
+  /*! Integrates the canonical system (and does the book keeping) exactly as num_samples calls to propagateStep would
+   * @param sampling_duration
+   * @param num_samples
+   * @param state_x Phase variable used by the transformation systems in each step
+   * @param can_x Canonical system value used by the transformation systems in each step
+   * @return True on success, otherwise False
+   */
+  bool integrateCanonicalSystem(const double sampling_duration,
+                                const int num_samples,
+                                Eigen::VectorXd& state_x,
+                                Eigen::VectorXd& can_x);
+
+  /*!
+   * @param dmps
+   * @return True if all transformation systems can be integrated as one batch, otherwise False
+   */
+  static bool isBatchable(const std::vector<DynamicMovementPrimitive*>& dmps);
+
+  /*! Propagates one rollout for each entry in dmps. The same DMP may appear multiple times.
+   * @param dmps
+   * @param thetas If not empty, the thetas of each rollout, otherwise the thetas of the DMPs are used
+   * @param trajectories
+   * @param sampling_duration
+   * @param num_samples
+   * @return True on success, otherwise False
+   */
+  static bool propagateBatch(const std::vector<DynamicMovementPrimitive*>& dmps,
+                             const std::vector<std::vector<Eigen::VectorXd> >& thetas,
+                             std::vector<Trajectory>& trajectories,
+                             const double sampling_duration,
+                             const int num_samples);
+
   /*!
    * @param debug_trajectory
    * @return
@@ -755,6 +824,10 @@ private:
 
   Eigen::VectorXd zero_feedback_;
 
+  /*! Preallocated feedback vector of each transformation system
+   */
+  std::vector<Eigen::VectorXd> transformation_system_feedbacks_;
+
 };
 
 /*! Abbreviation for convinience
@@ -0,0 +1,618 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks    Dynamic movement primitive with a dimensionality that is known
+              at compile time. All states are stored in fixed size Eigen
+              vectors and the ICRA2009/NC2010 specific parts are resolved
+              statically (CRTP) instead of through virtual calls.
+
+  \file   fixed_dynamic_movement_primitive.h
+
+  \date   Oct 17, 2026
+
+ *********************************************************************/
+
+#ifndef FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+#define FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+
+// system includes
+#include <math.h>
+#include <vector>
+#include <string>
+#include <cassert>
+#include <Eigen/Core>
+
+// local includes
+#include <dmp_lib/status.h>
+#include <dmp_lib/logger.h>
+#include <dmp_lib/trajectory.h>
+#include <dmp_lib/dynamic_movement_primitive.h>
+
+namespace dmp_lib
+{
+
+/*! Base class of the fixed size DMPs. The parameters are always obtained from a
+ * (learned) DynamicMovementPrimitive, which therefore remains the one to be
+ * stored to file or sent over the wire. The Derived class needs to implement
+ *
+ *   static std::string getVersionString();
+ *   void resetCanonicalSystem();
+ *   void integrateCanonicalSystem(const double delta_t, const double tau);
+ *   void finishCanonicalSystem();
+ *   bool integrateTransformationSystem(const Vector& feedback, const double delta_t, const double tau);
+ *
+ * where the transformation system may use predict() to evaluate the nonlinearity.
+ */
+template<int N, typename Derived>
+class FixedDynamicMovementPrimitive : public Status
+{
+
+public:
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Eigen::Matrix<double, N, 1> Vector;
+
+  /*! Basis function parameters, one column per dimension
+   */
+  typedef Eigen::Matrix<double, Eigen::Dynamic, N> BasisFunctionMatrix;
+
+  /*! Constructor
+   */
+  FixedDynamicMovementPrimitive() :
+    alpha_x_(0.0), cutoff_(0.0), initial_duration_(0.0), state_x_(1.0), can_x_(0.0), time_(0.0),
+    has_shared_basis_functions_(false), sum_of_basis_functions_(0.0), tau_(0.0), delta_t_(0.0), num_generated_samples_(0), is_setup_(false) {};
+
+  /*! Destructor
+   */
+  virtual ~FixedDynamicMovementPrimitive() {};
+
+  /*! Copies gains, basis functions, thetas, initial start/goal/duration and the
+   * canonical system state from a learned DMP of the same version and dimensionality.
+   * @param dmp
+   * @return True on success, otherwise False
+   */
+  bool initialize(const DynamicMovementPrimitive& dmp);
+
+  /*!
+   * @param start
+   * @param goal
+   * @param movement_duration
+   * @param sampling_frequency
+   * @return True on success, otherwise False
+   */
+  bool setup(const Vector& start,
+             const Vector& goal,
+             const double movement_duration,
+             const double sampling_frequency);
+
+  /*! Setup using the initial start, goal, and duration
+   * @param sampling_frequency
+   * @return True on success, otherwise False
+   */
+  bool setup(const double sampling_frequency);
+
+  /*!
+   * @return True if setup, otherwise False
+   */
+  bool isSetup() const;
+
+  /*! Same semantic as DynamicMovementPrimitive::propagateStep
+   * @param desired_positions
+   * @param desired_velocities
+   * @param desired_accelerations
+   * @param movement_finished
+   * @param feedback
+   * @param sampling_duration
+   * @param num_samples
+   * @return True on success, otherwise False
+   * REAL-TIME REQUIREMENTS
+   */
+  bool propagateStep(Vector& desired_positions,
+                     Vector& desired_velocities,
+                     Vector& desired_accelerations,
+                     bool& movement_finished,
+                     const Vector& feedback,
+                     const double sampling_duration,
+                     const int num_samples);
+
+  /*!
+   * @param desired_positions
+   * @param desired_velocities
+   * @param desired_accelerations
+   * @param movement_finished
+   * @param sampling_duration
+   * @param num_samples
+   * @return True on success, otherwise False
+   * REAL-TIME REQUIREMENTS
+   */
+  bool propagateStep(Vector& desired_positions,
+                     Vector& desired_velocities,
+                     Vector& desired_accelerations,
+                     bool& movement_finished,
+                     const double sampling_duration,
+                     const int num_samples);
+
+  /*! Uses the movement duration and sampling frequency provided during setup
+   * @param desired_positions
+   * @param desired_velocities
+   * @param desired_accelerations
+   * @param movement_finished
+   * @return True on success, otherwise False
+   * REAL-TIME REQUIREMENTS
+   */
+  bool propagateStep(Vector& desired_positions,
+                     Vector& desired_velocities,
+                     Vector& desired_accelerations,
+                     bool& movement_finished);
+
+  /*!
+   * @param trajectory
+   * @param sampling_duration
+   * @param num_samples
+   * @return True on success, otherwise False
+   */
+  bool propagateFull(Trajectory& trajectory,
+                     const double sampling_duration,
+                     const int num_samples);
+
+  /*!
+   * @param thetas
+   * @return True on success, otherwise False
+   */
+  bool getThetas(std::vector<Eigen::VectorXd>& thetas) const;
+
+  /*!
+   * @param thetas
+   * @return True on success, otherwise False
+   */
+  bool setThetas(const std::vector<Eigen::VectorXd>& thetas);
+
+  /*!
+   * @return
+   */
+  int getNumDimensions() const
+  {
+    return N;
+  }
+
+  /*!
+   * @return
+   */
+  int getNumRFS() const;
+
+  /*!
+   * @return
+   */
+  const std::vector<std::string>& getVariableNames() const;
+
+protected:
+
+  /*! Evaluates the normalized basis functions of all dimensions
+   * @param x
+   * @param predictions
+   * @return False if the basis functions are not activated, otherwise True
+   * REAL-TIME REQUIREMENTS
+   */
+  bool predict(const double x, Vector& predictions) const;
+
+  /*! Parameters
+   */
+  Vector k_gains_;
+  Vector d_gains_;
+  BasisFunctionMatrix centers_;
+  BasisFunctionMatrix inverse_widths_;
+  BasisFunctionMatrix thetas_;
+  double alpha_x_;
+  double cutoff_;
+
+  Vector initial_start_;
+  Vector initial_goal_;
+  double initial_duration_;
+
+  std::vector<std::string> variable_names_;
+
+  /*! Canonical system state
+   */
+  double state_x_;
+  double can_x_;
+  double time_;
+
+  /*! Transformation system state
+   */
+  Vector start_;
+  Vector goal_;
+  Vector internal_xd_;
+  Vector internal_xdd_;
+  Vector current_x_;
+  Vector current_xd_;
+  Vector current_xdd_;
+  Vector f_;
+  Vector predictions_;
+
+  /*! True if all dimensions use the same widths and centers
+   */
+  bool has_shared_basis_functions_;
+
+  /*! Preallocated workspace for predict()
+   */
+  mutable Eigen::VectorXd basis_functions_;
+  mutable double sum_of_basis_functions_;
+
+  /*! Time and book keeping
+   */
+  double tau_;
+  double delta_t_;
+  int num_generated_samples_;
+  bool is_setup_;
+
+private:
+
+  Derived& derived()
+  {
+    return *static_cast<Derived*> (this);
+  }
+
+};
+
+// Inline functions follow
+template<int N, typename Derived>
+bool FixedDynamicMovementPrimitive<N, Derived>::initialize(const DynamicMovementPrimitive& dmp)
+{
+  initialized_ = false;
+  if (!dmp.isInitialized())
+  {
+    Logger::logPrintf("DMP is not initialized. Cannot initialize fixed size DMP.", Logger::ERROR);
+    return false;
+  }
+  if (dmp.getNumDimensions() != N)
+  {
+    Logger::logPrintf("Number of dimensions >%i< of the DMP does not match >%i<. Cannot initialize fixed size DMP.", Logger::ERROR,
+                      dmp.getNumDimensions(), N);
+    return false;
+  }
+  if (dmp.getVersionString().compare(Derived::getVersionString()) != 0)
+  {
+    Logger::logPrintf("DMP version >%s< does not match >%s<. Cannot initialize fixed size DMP.", Logger::ERROR,
+                      dmp.getVersionString().c_str(), Derived::getVersionString().c_str());
+    return false;
+  }
+
+  const std::vector<std::pair<int, int> >& indices = dmp.getIndices();
+  for (int i = 0; i < N; ++i)
+  {
+    TSPtr transformation_system = dmp.getTransformationSystem(indices[i].first);
+    if (transformation_system->getIntegrationMethod() != TransformationSystem::NORMAL)
+    {
+      Logger::logPrintf("Transformation system >%i< is not integrated normally (quaternion?). Cannot initialize fixed size DMP.", Logger::ERROR,
+                        indices[i].first);
+      return false;
+    }
+    if (!transformation_system->getGains(indices[i].second, k_gains_(i), d_gains_(i)))
+    {
+      return false;
+    }
+    lwr_lib::LWRPtr lwr_model = transformation_system->getParameters(indices[i].second)->getLWRModel();
+    const int num_rfs = lwr_model->getNumRFS();
+    if (i == 0)
+    {
+      centers_.resize(num_rfs, N);
+      inverse_widths_.resize(num_rfs, N);
+      thetas_.resize(num_rfs, N);
+    }
+    else if (num_rfs != centers_.rows())
+    {
+      Logger::logPrintf("Number of receptive fields >%i< of dimension >%i< differs from >%i<. Cannot initialize fixed size DMP.", Logger::ERROR,
+                        num_rfs, i, (int)centers_.rows());
+      return false;
+    }
+    Eigen::VectorXd widths = Eigen::VectorXd::Zero(num_rfs);
+    Eigen::VectorXd centers = Eigen::VectorXd::Zero(num_rfs);
+    Eigen::VectorXd thetas = Eigen::VectorXd::Zero(num_rfs);
+    if (!lwr_model->getWidthsAndCenters(widths, centers) || !lwr_model->getThetas(thetas))
+    {
+      Logger::logPrintf("Could not get basis function parameters of dimension >%i<. Cannot initialize fixed size DMP.", Logger::ERROR, i);
+      return false;
+    }
+    centers_.col(i) = centers;
+    inverse_widths_.col(i) = widths.cwiseInverse();
+    thetas_.col(i) = thetas;
+  }
+  has_shared_basis_functions_ = true;
+  for (int i = 1; i < N; ++i)
+  {
+    has_shared_basis_functions_ = has_shared_basis_functions_ && (centers_.col(i) == centers_.col(0))
+        && (inverse_widths_.col(i) == inverse_widths_.col(0));
+  }
+  basis_functions_ = Eigen::VectorXd::Zero(centers_.rows());
+  sum_of_basis_functions_ = 0.0;
+
+  Eigen::VectorXd initial_start = Eigen::VectorXd::Zero(N);
+  Eigen::VectorXd initial_goal = Eigen::VectorXd::Zero(N);
+  if (!dmp.getInitialStart(initial_start) || !dmp.getInitialGoal(initial_goal) || !dmp.getInitialDuration(initial_duration_))
+  {
+    Logger::logPrintf("Could not get initial start, goal, or duration. Cannot initialize fixed size DMP.", Logger::ERROR);
+    return false;
+  }
+  initial_start_ = initial_start;
+  initial_goal_ = initial_goal;
+
+  alpha_x_ = dmp.getCanonicalSystem()->getParameters()->getAlphaX();
+  // the canonical system parameters store alpha_x = -log(cutoff)
+  cutoff_ = exp(-alpha_x_);
+  state_x_ = dmp.getCanonicalSystem()->getState()->getStateX();
+  can_x_ = dmp.getCanonicalSystem()->getState()->getCanX();
+  time_ = dmp.getCanonicalSystem()->getState()->getTime();
+
+  variable_names_ = dmp.getVariableNames();
+
+  start_.setZero();
+  goal_.setZero();
+  internal_xd_.setZero();
+  internal_xdd_.setZero();
+  current_x_.setZero();
+  current_xd_.setZero();
+  current_xdd_.setZero();
+  f_.setZero();
+  predictions_.setZero();
+  is_setup_ = false;
+  return (initialized_ = true);
+}
+
+template<int N, typename Derived>
+bool FixedDynamicMovementPrimitive<N, Derived>::setup(const Vector& start,
+                                                      const Vector& goal,
+                                                      const double movement_duration,
+                                                      const double sampling_frequency)
+{
+  assert(initialized_);
+  if (movement_duration <= 0)
+  {
+    Logger::logPrintf("Movement duration >%f< is invalid.", Logger::ERROR, movement_duration);
+    return (is_setup_ = false);
+  }
+  if (sampling_frequency <= 0)
+  {
+    Logger::logPrintf("Sampling frequency >%f< [Hz] is invalid.", Logger::ERROR, sampling_frequency);
+    return (is_setup_ = false);
+  }
+  derived().resetCanonicalSystem();
+  tau_ = movement_duration;
+  delta_t_ = static_cast<double> (1.0) / sampling_frequency;
+
+  start_ = start;
+  goal_ = goal;
+  internal_xd_.setZero();
+  internal_xdd_.setZero();
+  current_x_ = start;
+  current_xd_.setZero();
+  current_xdd_.setZero();
+  f_.setZero();
+
+  num_generated_samples_ = 0;
+  return (is_setup_ = true);
+}
+
+template<int N, typename Derived>
+bool FixedDynamicMovementPrimitive<N, Derived>::setup(const double sampling_frequency)
+{
+  return setup(initial_start_, initial_goal_, initial_duration_, sampling_frequency);
+}
+
+template<int N, typename Derived>
+inline bool FixedDynamicMovementPrimitive<N, Derived>::isSetup() const
+{
+  return is_setup_;
+}
+
+// REAL-TIME REQUIREMENTS
+template<int N, typename Derived>
+inline bool FixedDynamicMovementPrimitive<N, Derived>::predict(const double x, Vector& predictions) const
+{
+  // same as LWR::predict, however, the basis functions are only evaluated once if they are shared among all dimensions
+  for (int i = 0; i < N; ++i)
+  {
+    if (i == 0 || !has_shared_basis_functions_)
+    {
+      for (int j = 0; j < basis_functions_.size(); ++j)
+      {
+        const double diff = x - centers_(j, i);
+        basis_functions_(j) = exp(-inverse_widths_(j, i) * diff * diff);
+      }
+      sum_of_basis_functions_ = basis_functions_.sum();
+      if (sum_of_basis_functions_ < 0.000000001 && sum_of_basis_functions_ > -0.000000001)
+      {
+        Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
+        return false;
+      }
+    }
+    predictions(i) = thetas_.col(i).dot(basis_functions_) * x / sum_of_basis_functions_;
+  }
+  return true;
+}
+
+// REAL-TIME REQUIREMENTS
+template<int N, typename Derived>
+bool FixedDynamicMovementPrimitive<N, Derived>::propagateStep(Vector& desired_positions,
+                                                              Vector& desired_velocities,
+                                                              Vector& desired_accelerations,
+                                                              bool& movement_finished,
+                                                              const Vector& feedback,
+                                                              const double sampling_duration,
+                                                              const int num_samples)
+{
+  assert(initialized_);
+  movement_finished = false;
+  if (num_samples <= 0 || sampling_duration <= 0)
+  {
+    Logger::logPrintf("Number of samples >%i< or sampling duration >%f< is invalid. (Real-time violation).", Logger::ERROR,
+                      num_samples, sampling_duration);
+    movement_finished = true;
+    return false;
+  }
+  if ((can_x_ > (cutoff_ / 2.0)) && !is_setup_)
+  {
+    Logger::logPrintf("DMP is not setup. Need to be setup first using on of the setup() functions.", Logger::ERROR);
+    movement_finished = true;
+    return false;
+  }
+  delta_t_ = sampling_duration / static_cast<double> (num_samples);
+  tau_ = sampling_duration;
+
+  if (!derived().integrateTransformationSystem(feedback, delta_t_, tau_))
+  {
+    Logger::logPrintf("Problem while integrating the transformation system. (Real-time violation).", Logger::ERROR);
+    movement_finished = true;
+    return false;
+  }
+  desired_positions = current_x_;
+  desired_velocities = current_xd_;
+  desired_accelerations = current_xdd_;
+
+  // only integrate the canonical system when movement hasn't finished yet...
+  if (num_generated_samples_ + 1 < num_samples)
+  {
+    num_generated_samples_++;
+    derived().integrateCanonicalSystem(delta_t_, tau_);
+  }
+  else
+  {
+    derived().finishCanonicalSystem();
+    is_setup_ = false;
+    movement_finished = true;
+  }
+  return true;
+}
+
+// REAL-TIME REQUIREMENTS
+template<int N, typename Derived>
+inline bool FixedDynamicMovementPrimitive<N, Derived>::propagateStep(Vector& desired_positions,
+                                                                     Vector& desired_velocities,
+                                                                     Vector& desired_accelerations,
+                                                                     bool& movement_finished,
+                                                                     const double sampling_duration,
+                                                                     const int num_samples)
+{
+  return propagateStep(desired_positions, desired_velocities, desired_accelerations, movement_finished,
+                       Vector::Zero(), sampling_duration, num_samples);
+}
+
+// REAL-TIME REQUIREMENTS
+template<int N, typename Derived>
+inline bool FixedDynamicMovementPrimitive<N, Derived>::propagateStep(Vector& desired_positions,
+                                                                     Vector& desired_velocities,
+                                                                     Vector& desired_accelerations,
+                                                                     bool& movement_finished)
+{
+  assert(initialized_);
+  if (delta_t_ <= 0)
+  {
+    Logger::logPrintf("DeltaT >%f< is not set or is invalid (Real-time violation).", Logger::ERROR, delta_t_);
+    movement_finished = true;
+    return false;
+  }
+  const int num_samples = static_cast<int> (floor(tau_ / delta_t_));
+  return propagateStep(desired_positions, desired_velocities, desired_accelerations, movement_finished,
+                       Vector::Zero(), tau_, num_samples);
+}
+
+template<int N, typename Derived>
+bool FixedDynamicMovementPrimitive<N, Derived>::propagateFull(Trajectory& trajectory,
+                                                              const double sampling_duration,
+                                                              const int num_samples)
+{
+  assert(initialized_);
+  if ((sampling_duration < 1e-10) || num_samples < 1)
+  {
+    return false;
+  }
+
+  const double special_sampling_frequency = static_cast<double> (num_samples) / (sampling_duration);
+  if (!trajectory.initialize(variable_names_, special_sampling_frequency, false, num_samples))
+  {
+    Logger::logPrintf("Could not initialize trajectory to store rollout.", Logger::ERROR);
+    return false;
+  }
+
+  Eigen::MatrixXd positions(num_samples, N);
+  Eigen::MatrixXd velocities(num_samples, N);
+  Eigen::MatrixXd accelerations(num_samples, N);
+  Vector desired_positions, desired_velocities, desired_accelerations;
+  bool movement_finished = false;
+  int num_generated_samples = 0;
+  while (!movement_finished)
+  {
+    if (!propagateStep(desired_positions, desired_velocities, desired_accelerations, movement_finished, sampling_duration, num_samples))
+    {
+      Logger::logPrintf("Could not propagate dmp.", Logger::ERROR);
+      return false;
+    }
+    positions.row(num_generated_samples) = desired_positions.transpose();
+    velocities.row(num_generated_samples) = desired_velocities.transpose();
+    accelerations.row(num_generated_samples) = desired_accelerations.transpose();
+    num_generated_samples++;
+  }
+
+  if (!trajectory.add(Eigen::MatrixXd(positions.topRows(num_generated_samples)),
+                      Eigen::MatrixXd(velocities.topRows(num_generated_samples)),
+                      Eigen::MatrixXd(accelerations.topRows(num_generated_samples))))
+  {
+    Logger::logPrintf("Could not add positions, velocities, and accelerations to trajectory.", Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+template<int N, typename Derived>
+bool FixedDynamicMovementPrimitive<N, Derived>::getThetas(std::vector<Eigen::VectorXd>& thetas) const
+{
+  assert(initialized_);
+  thetas.resize(N);
+  for (int i = 0; i < N; ++i)
+  {
+    thetas[i] = thetas_.col(i);
+  }
+  return true;
+}
+
+template<int N, typename Derived>
+bool FixedDynamicMovementPrimitive<N, Derived>::setThetas(const std::vector<Eigen::VectorXd>& thetas)
+{
+  assert(initialized_);
+  if ((int)thetas.size() != N)
+  {
+    Logger::logPrintf("Number of theta vectors >%i< does not match number of dimensions >%i<.", Logger::ERROR, (int)thetas.size(), N);
+    return false;
+  }
+  for (int i = 0; i < N; ++i)
+  {
+    if (thetas[i].size() != thetas_.rows())
+    {
+      Logger::logPrintf("Number of thetas >%i< does not match number of receptive fields >%i<.", Logger::ERROR,
+                        (int)thetas[i].size(), (int)thetas_.rows());
+      return false;
+    }
+    thetas_.col(i) = thetas[i];
+  }
+  return true;
+}
+
+template<int N, typename Derived>
+inline int FixedDynamicMovementPrimitive<N, Derived>::getNumRFS() const
+{
+  assert(initialized_);
+  return static_cast<int> (thetas_.rows());
+}
+
+template<int N, typename Derived>
+inline const std::vector<std::string>& FixedDynamicMovementPrimitive<N, Derived>::getVariableNames() const
+{
+  assert(initialized_);
+  return variable_names_;
+}
+
+}
+
+#endif /* FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_ */
@@ -0,0 +1,116 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks    Fixed size version of the ICRA2009 dynamic movement primitive.
+
+  \file   icra2009_fixed_dynamic_movement_primitive.h
+
+  \date   Oct 17, 2026
+
+ *********************************************************************/
+
+#ifndef ICRA2009_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+#define ICRA2009_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+
+// system includes
+#include <math.h>
+#include <string>
+
+// local includes
+#include <dmp_lib/fixed_dynamic_movement_primitive.h>
+
+namespace dmp_lib
+{
+
+/*! Implements the same integration as ICRA2009CanonicalSystem and
+ * ICRA2009TransformationSystem (NORMAL integration method only)
+ */
+template<int N>
+class ICRA2009FixedDynamicMovementPrimitive : public FixedDynamicMovementPrimitive<N, ICRA2009FixedDynamicMovementPrimitive<N> >
+{
+
+  /*! Allow the base class to call the integration functions
+   */
+  friend class FixedDynamicMovementPrimitive<N, ICRA2009FixedDynamicMovementPrimitive<N> >;
+
+public:
+
+  typedef FixedDynamicMovementPrimitive<N, ICRA2009FixedDynamicMovementPrimitive<N> > Base;
+  typedef typename Base::Vector Vector;
+
+  /*! Constructor
+   */
+  ICRA2009FixedDynamicMovementPrimitive() {};
+
+  /*! Destructor
+   */
+  virtual ~ICRA2009FixedDynamicMovementPrimitive() {};
+
+  /*! Returns the version string
+   * @return version string
+   */
+  static std::string getVersionString()
+  {
+    return "ICRA2009";
+  }
+
+private:
+
+  /*! Same as ICRA2009CanonicalSystem::reset(), the canonical value is not reset
+   */
+  void resetCanonicalSystem()
+  {
+    this->state_x_ = 1.0;
+    this->time_ = 0.0;
+  }
+
+  /*! REAL-TIME REQUIREMENTS
+   */
+  void integrateCanonicalSystem(const double delta_t, const double tau)
+  {
+    this->state_x_ = exp(-(this->alpha_x_ / tau) * this->time_);
+    this->time_ += delta_t;
+    this->can_x_ = this->state_x_;
+  }
+
+  /*! REAL-TIME REQUIREMENTS
+   */
+  void finishCanonicalSystem()
+  {
+    this->can_x_ = 0.0;
+  }
+
+  /*! REAL-TIME REQUIREMENTS
+   */
+  bool integrateTransformationSystem(const Vector& feedback, const double delta_t, const double tau)
+  {
+    if (!this->predict(this->state_x_, this->predictions_))
+    {
+      return false;
+    }
+    this->f_ = this->predictions_ * this->can_x_;
+    this->internal_xdd_ = (this->k_gains_.cwiseProduct(this->goal_ - this->current_x_)
+        - this->d_gains_.cwiseProduct(this->internal_xd_)
+        - this->k_gains_.cwiseProduct(this->goal_ - this->start_) * this->can_x_
+        + this->k_gains_.cwiseProduct(this->f_)) / tau + feedback;
+
+    this->current_xd_ = this->internal_xd_ / tau;
+    this->current_xdd_ = this->internal_xdd_;
+
+    // integrate the system twice
+    this->internal_xd_ += this->current_xdd_ * delta_t;
+    this->current_x_ += this->current_xd_ * delta_t;
+    return true;
+  }
+
+};
+
+/*! Abbreviation for convinience
+ */
+typedef ICRA2009FixedDynamicMovementPrimitive<7> ICRA2009DMP7;
+
+}
+
+#endif /* ICRA2009_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_ */
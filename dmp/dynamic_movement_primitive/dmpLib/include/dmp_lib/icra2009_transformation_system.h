@@ -108,6 +108,27 @@ public:
                  const Eigen::VectorXd& feedback,
                  const int num_iterations = 1);
 
+  /*! Implementes derived function
+   * @param batch
+   * @param state_x
+   * @param can_x
+   * @param dmp_time
+   */
+  void integrateBatch(TransformationSystemBatch& batch,
+                      const double state_x,
+                      const double can_x,
+                      const Time& dmp_time) const;
+
+  /*! Implementes derived function
+   * @param index
+   * @param k_gain
+   * @param d_gain
+   * @return True if success, otherwise False
+   */
+  bool getGains(const int index,
+                double& k_gain,
+                double& d_gain) const;
+
   /*! Returns the version string
    * @return version string
    */
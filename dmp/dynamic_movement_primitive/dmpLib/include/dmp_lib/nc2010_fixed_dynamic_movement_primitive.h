@@ -0,0 +1,116 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks    Fixed size version of the NC2010 dynamic movement primitive.
+
+  \file   nc2010_fixed_dynamic_movement_primitive.h
+
+  \date   Oct 17, 2026
+
+ *********************************************************************/
+
+#ifndef NC2010_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+#define NC2010_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+
+// system includes
+#include <math.h>
+#include <string>
+
+// local includes
+#include <dmp_lib/fixed_dynamic_movement_primitive.h>
+
+namespace dmp_lib
+{
+
+/*! Implements the same integration as NC2010CanonicalSystem and
+ * NC2010TransformationSystem (NORMAL integration method only)
+ */
+template<int N>
+class NC2010FixedDynamicMovementPrimitive : public FixedDynamicMovementPrimitive<N, NC2010FixedDynamicMovementPrimitive<N> >
+{
+
+  /*! Allow the base class to call the integration functions
+   */
+  friend class FixedDynamicMovementPrimitive<N, NC2010FixedDynamicMovementPrimitive<N> >;
+
+public:
+
+  typedef FixedDynamicMovementPrimitive<N, NC2010FixedDynamicMovementPrimitive<N> > Base;
+  typedef typename Base::Vector Vector;
+
+  /*! Constructor
+   */
+  NC2010FixedDynamicMovementPrimitive() {};
+
+  /*! Destructor
+   */
+  virtual ~NC2010FixedDynamicMovementPrimitive() {};
+
+  /*! Returns the version string
+   * @return version string
+   */
+  static std::string getVersionString()
+  {
+    return "NC2010";
+  }
+
+private:
+
+  /*! Same as NC2010CanonicalSystem::reset()
+   */
+  void resetCanonicalSystem()
+  {
+    this->state_x_ = 1.0;
+    this->time_ = 0.0;
+  }
+
+  /*! REAL-TIME REQUIREMENTS
+   */
+  void integrateCanonicalSystem(const double delta_t, const double tau)
+  {
+    this->state_x_ = exp(-(this->alpha_x_ / tau) * this->time_);
+    this->time_ += delta_t;
+  }
+
+  /*! REAL-TIME REQUIREMENTS
+   */
+  void finishCanonicalSystem()
+  {
+    this->can_x_ = 0.0;
+  }
+
+  /*! The NC2010 transformation system ignores the feedback (as NC2010TransformationSystem does)
+   * REAL-TIME REQUIREMENTS
+   */
+  bool integrateTransformationSystem(const Vector& /*feedback*/, const double delta_t, const double tau)
+  {
+    if (!this->predict(this->state_x_, this->predictions_))
+    {
+      return false;
+    }
+    this->f_ = this->predictions_ * this->state_x_;
+    this->internal_xdd_ = (this->k_gains_.cwiseProduct(this->goal_ - this->current_x_)
+        - this->d_gains_.cwiseProduct(this->internal_xd_)
+        - this->k_gains_.cwiseProduct(this->goal_ - this->start_) * this->state_x_
+        + this->k_gains_.cwiseProduct(this->f_)) / tau;
+
+    this->current_xd_ = this->internal_xd_ / tau;
+    this->current_xdd_ = this->internal_xdd_ / tau;
+
+    // integrate the system twice
+    this->internal_xd_ += this->internal_xdd_ * delta_t;
+    this->current_x_ += this->current_xd_ * delta_t;
+    return true;
+  }
+
+};
+
+/*! Abbreviation for convinience
+ */
+typedef NC2010FixedDynamicMovementPrimitive<7> NC2010DMP7;
+
+}
+
+#endif /* NC2010_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_ */
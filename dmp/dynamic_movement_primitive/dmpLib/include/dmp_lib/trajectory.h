@@ -216,6 +216,23 @@ public:
                         const bool positions_only = false,
                         const bool use_variable_names = true);
 
+  /*! Initializes the trajectory from the time window [start_time, end_time] of the File pointed to by the provided file_name.
+   * The file is memory mapped and only the requested rows and columns are decoded.
+   * @param file_name
+   * @param variable_names
+   * @param start_time (in seconds)
+   * @param end_time (in seconds) If negative, the whole file is read
+   * @param positions_only
+   * @param use_variable_names If this is set to false, variable names parameter is ignored and ALL variable names are read from file
+   * @return True on success, otherwise False
+   */
+  bool readFromCLMCFile(const std::string& file_name,
+                        const std::vector<std::string>& variable_names,
+                        const double start_time,
+                        const double end_time,
+                        const bool positions_only = false,
+                        const bool use_variable_names = true);
+
   /*!
    * @param file_name
    * @return True on success, otherwise False
@@ -426,6 +443,17 @@ public:
            const Eigen::VectorXd& trajectory_accelerations,
            const bool positions_only = false);
 
+  /*! Adds multiple samples of positions, velocities, and accelerations to the end of the Trajectory.
+   * Each row contains one sample.
+   * @param trajectory_positions
+   * @param trajectory_velocities
+   * @param trajectory_accelerations
+   * @return True on success, otherwise False
+   */
+  bool add(const Eigen::MatrixXd& trajectory_positions,
+           const Eigen::MatrixXd& trajectory_velocities,
+           const Eigen::MatrixXd& trajectory_accelerations);
+
   /*! Adds positions to the end of the Trajectory.
    * @param trajectory_positons
    * @param positions_only
@@ -19,6 +19,7 @@
 #include <vector>
 #include <string>
 #include <boost/shared_ptr.hpp>
+#include <Eigen/Core>
 
 // local include
 #include <dmp_lib/transformation_system_parameters.h>
@@ -32,6 +33,38 @@
 namespace dmp_lib
 {
 
+/*! Structure-of-arrays representation of the dimensions of many transformation systems. Used to
+ * integrate a whole batch of DMPs at once (see DynamicMovementPrimitive::propagateFull).
+ */
+struct TransformationSystemBatch
+{
+  /*!
+   * @param num_dimensions
+   */
+  void resize(const int num_dimensions);
+
+  /*!
+   */
+  Eigen::ArrayXd k_gains;
+  Eigen::ArrayXd d_gains;
+  Eigen::ArrayXd starts;
+  Eigen::ArrayXd goals;
+
+  /*!
+   */
+  Eigen::ArrayXd internal_x;
+  Eigen::ArrayXd internal_xd;
+  Eigen::ArrayXd internal_xdd;
+  Eigen::ArrayXd current_x;
+  Eigen::ArrayXd current_xd;
+  Eigen::ArrayXd current_xdd;
+  Eigen::ArrayXd f;
+
+  /*! Prediction of the LWR model of each dimension for the current time step
+   */
+  Eigen::ArrayXd predictions;
+};
+
 /*!
  */
 class TransformationSystem : public Status
@@ -140,6 +173,44 @@ public:
                          const Eigen::VectorXd& feedback,
                          const int num_iterations = 1) = 0;
 
+  /*! Integrates all dimensions contained in batch for one time step. This is the structure-of-arrays
+   * version of integrate(...) for the NORMAL integration method and zero feedback.
+   * @param batch The predictions need to be set for the current time step
+   * @param state_x Phase variable of the canonical system (used to predict the nonlinearity)
+   * @param can_x Canonical system value that scales the nonlinearity
+   * @param dmp_time
+   */
+  virtual void integrateBatch(TransformationSystemBatch& batch,
+                              const double state_x,
+                              const double can_x,
+                              const Time& dmp_time) const = 0;
+
+  /*! Copies gains, start, goal, and states of all dimensions into the batch
+   * @param batch
+   * @param offset Index of the first dimension of this transformation system within the batch
+   * @return True if success, otherwise False
+   */
+  bool getBatch(TransformationSystemBatch& batch,
+                const int offset) const;
+
+  /*! Copies the states of all dimensions back from the batch
+   * @param batch
+   * @param offset Index of the first dimension of this transformation system within the batch
+   * @return True if success, otherwise False
+   */
+  bool setBatch(const TransformationSystemBatch& batch,
+                const int offset);
+
+  /*!
+   * @param index
+   * @param k_gain
+   * @param d_gain
+   * @return True if success, otherwise False
+   */
+  virtual bool getGains(const int index,
+                        double& k_gain,
+                        double& d_gain) const = 0;
+
   /*!
    * @param index
    * @param current_state
@@ -0,0 +1,342 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		...
+
+ \file		clmc_file_view.cpp
+
+ \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <math.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <errno.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+// local include
+#include <dmp_lib/clmc_file_view.h>
+#include <dmp_lib/trajectory.h>
+
+using namespace Eigen;
+using namespace std;
+
+namespace dmp_lib
+{
+
+static const int MAX_HEADER_LINE_LENGTH = 256;
+static const size_t CACHE_BLOCK_SIZE = 16384;
+
+/*! Skips white spaces and returns the next token in [begin, end)
+ * @param position Is advanced past the token
+ * @param end
+ * @param token
+ * @return True if a token was found, otherwise False
+ */
+static bool nextToken(const char*& position, const char* end, string& token)
+{
+  while (position < end && isspace(*position))
+  {
+    position++;
+  }
+  const char* start = position;
+  while (position < end && !isspace(*position))
+  {
+    position++;
+  }
+  token.assign(start, position - start);
+  return !token.empty();
+}
+
+/*! Converts a single big-endian float into a double
+ */
+static inline double decode(const unsigned int word)
+{
+  const unsigned int swapped = __builtin_bswap32(word);
+  float value;
+  memcpy(&value, &swapped, sizeof(float));
+  return static_cast<double> (value);
+}
+
+CLMCFileView::~CLMCFileView()
+{
+  close();
+}
+
+void CLMCFileView::close()
+{
+  if (mapped_file_ != NULL)
+  {
+    munmap(mapped_file_, mapped_size_);
+    mapped_file_ = NULL;
+    mapped_size_ = 0;
+  }
+  if (file_descriptor_ >= 0)
+  {
+    ::close(file_descriptor_);
+    file_descriptor_ = -1;
+  }
+  data_ = NULL;
+  num_rows_ = 0;
+  num_cols_ = 0;
+  variable_names_.clear();
+  variable_units_.clear();
+  initialized_ = false;
+}
+
+bool CLMCFileView::initialize(const string& file_name)
+{
+  close();
+
+  if ((file_descriptor_ = open(file_name.c_str(), O_RDONLY)) < 0)
+  {
+    Logger::logPrintf("Cannot open file >%s< : %s.", Logger::ERROR, file_name.c_str(), strerror(errno));
+    return (initialized_ = false);
+  }
+
+  struct stat file_status;
+  if (fstat(file_descriptor_, &file_status) != 0 || file_status.st_size <= 0)
+  {
+    Logger::logPrintf("Cannot stat file >%s< or file is empty.", Logger::ERROR, file_name.c_str());
+    close();
+    return (initialized_ = false);
+  }
+  mapped_size_ = static_cast<size_t> (file_status.st_size);
+
+  mapped_file_ = mmap(NULL, mapped_size_, PROT_READ, MAP_PRIVATE, file_descriptor_, 0);
+  if (mapped_file_ == MAP_FAILED)
+  {
+    Logger::logPrintf("Cannot mmap file >%s< : %s.", Logger::ERROR, file_name.c_str(), strerror(errno));
+    mapped_file_ = NULL;
+    close();
+    return (initialized_ = false);
+  }
+
+  if (!parseHeader(file_name))
+  {
+    close();
+    return (initialized_ = false);
+  }
+
+  Logger::logPrintf("Mapped >%i< rows and >%i< cols (%.2f MBytes) of file >%s<.", Logger::DEBUG, num_rows_, num_cols_,
+                    (double)(4 * (double)num_rows_ * num_cols_) / (double)1000000, file_name.c_str());
+  return (initialized_ = true);
+}
+
+bool CLMCFileView::parseHeader(const string& file_name)
+{
+  const char* position = static_cast<const char*> (mapped_file_);
+  const char* end = position + mapped_size_;
+
+  // the header numbers are not necessarily separated by white spaces (e.g. "300R_HAND_x"),
+  // they are therefore parsed from a null terminated copy just like fscanf would
+  const string header_line(position, std::min(mapped_size_, static_cast<size_t> (MAX_HEADER_LINE_LENGTH)));
+  int num_entries = 0;
+  int num_parsed_characters = 0;
+  if (sscanf(header_line.c_str(), "%d %d %d %lf%n", &num_entries, &num_cols_, &num_rows_, &sampling_frequency_, &num_parsed_characters) != 4)
+  {
+    Logger::logPrintf("Could not read/parse header of file >%s<.", Logger::ERROR, file_name.c_str());
+    return false;
+  }
+  position += num_parsed_characters;
+
+  // checking whether values make sense
+  if ((num_cols_ <= 0) || (num_rows_ <= 0))
+  {
+    Logger::logPrintf("Values for number of columns >%i< and rows >%i< are negative.", Logger::ERROR, num_cols_, num_rows_);
+    return false;
+  }
+  if ((num_cols_ > ABSOLUTE_MAX_TRAJECTORY_DIMENSION) || (num_rows_ > ABSOLUTE_MAX_TRAJECTORY_LENGTH))
+  {
+    Logger::logPrintf("Values for number of columns >%i< and rows >%i< are out of bound (%i x %i).", Logger::ERROR, num_cols_, num_rows_,
+                      ABSOLUTE_MAX_TRAJECTORY_DIMENSION, ABSOLUTE_MAX_TRAJECTORY_LENGTH);
+    return false;
+  }
+  if (sampling_frequency_ <= 0)
+  {
+    Logger::logPrintf("Read implausible sampling frequency >%.1f<.", Logger::ERROR, sampling_frequency_);
+    return false;
+  }
+
+  variable_names_.reserve(num_cols_);
+  variable_units_.reserve(num_cols_);
+  string name, unit;
+  for (int j = 0; j < num_cols_; ++j)
+  {
+    if (!nextToken(position, end, name) || !nextToken(position, end, unit))
+    {
+      Logger::logPrintf("Cannot read variable names and units.", Logger::ERROR);
+      return false;
+    }
+    variable_names_.push_back(name);
+    variable_units_.push_back(unit);
+  }
+
+  // there are two extra blank chars at the end of the block and a line return which we must account for
+  const size_t data_offset = static_cast<size_t> (position - static_cast<const char*> (mapped_file_)) + 3;
+  const size_t data_size = sizeof(float) * static_cast<size_t> (num_rows_) * static_cast<size_t> (num_cols_);
+  if (data_offset + data_size > mapped_size_)
+  {
+    Logger::logPrintf("File >%s< is truncated. Expected >%i< x >%i< data block.", Logger::ERROR, file_name.c_str(), num_rows_, num_cols_);
+    return false;
+  }
+  // the data block is not necessarily aligned, words are therefore always read with memcpy or unaligned loads
+  data_ = reinterpret_cast<const unsigned int*> (static_cast<const char*> (mapped_file_) + data_offset);
+  madvise(mapped_file_, mapped_size_, MADV_SEQUENTIAL);
+  return true;
+}
+
+bool CLMCFileView::getColumnIndex(const string& variable_name,
+                                  int& column_index) const
+{
+  assert(initialized_);
+  for (int j = 0; j < num_cols_; ++j)
+  {
+    if (variable_names_[j].compare(variable_name) == 0)
+    {
+      column_index = j;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CLMCFileView::getRowRange(const double start_time,
+                               const double end_time,
+                               int& start_row,
+                               int& num_rows) const
+{
+  assert(initialized_);
+  if (start_time < 0.0 || end_time < start_time)
+  {
+    Logger::logPrintf("Invalid time window [%f, %f].", Logger::ERROR, start_time, end_time);
+    return false;
+  }
+  start_row = static_cast<int> (ceil(start_time * sampling_frequency_ - 1e-9));
+  int end_row = static_cast<int> (floor(end_time * sampling_frequency_ + 1e-9)) + 1;
+  if (end_row > num_rows_)
+  {
+    end_row = num_rows_;
+  }
+  if (start_row >= end_row)
+  {
+    Logger::logPrintf("Time window [%f, %f] does not contain any samples (file duration is >%f< seconds).", Logger::ERROR,
+                      start_time, end_time, static_cast<double> (num_rows_) / sampling_frequency_);
+    return false;
+  }
+  num_rows = end_row - start_row;
+  return true;
+}
+
+/*! Decodes num_rows big-endian floats that are stride bytes apart into consecutive doubles
+ */
+static void decodeColumn(const char* source,
+                         const size_t stride,
+                         double* column,
+                         const int num_rows)
+{
+  int i = 0;
+
+#ifdef __SSSE3__
+  // gather 4 rows, swap the bytes of all 4 words at once and convert them to double
+  const __m128i swap_mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  for (; i + 4 <= num_rows; i += 4)
+  {
+    int words[4];
+    memcpy(&words[0], source, sizeof(int));
+    memcpy(&words[1], source + stride, sizeof(int));
+    memcpy(&words[2], source + 2 * stride, sizeof(int));
+    memcpy(&words[3], source + 3 * stride, sizeof(int));
+    source += 4 * stride;
+    const __m128 values = _mm_castsi128_ps(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*> (words)), swap_mask));
+    _mm_storeu_pd(column + i, _mm_cvtps_pd(values));
+    _mm_storeu_pd(column + i + 2, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+  }
+#endif
+
+  for (; i < num_rows; ++i)
+  {
+    unsigned int word;
+    memcpy(&word, source, sizeof(unsigned int));
+    column[i] = decode(word);
+    source += stride;
+  }
+}
+
+bool CLMCFileView::isWithinColumnBoundaries(const int column_index) const
+{
+  if ((column_index < 0) || (column_index >= num_cols_))
+  {
+    Logger::logPrintf("Requested column >%i< is out of bound. File contains >%i< columns.", Logger::ERROR, column_index, num_cols_);
+    return false;
+  }
+  return true;
+}
+
+bool CLMCFileView::readColumn(const int column_index,
+                              double* column,
+                              const int start_row,
+                              const int num_rows) const
+{
+  assert(initialized_);
+  if (!isWithinColumnBoundaries(column_index) || !isWithinRowBoundaries(start_row, num_rows))
+  {
+    return false;
+  }
+  const char* source = reinterpret_cast<const char*> (data_ + static_cast<size_t> (start_row) * num_cols_ + column_index);
+  decodeColumn(source, sizeof(unsigned int) * static_cast<size_t> (num_cols_), column, num_rows);
+  return true;
+}
+
+bool CLMCFileView::readColumns(const vector<int>& column_indices,
+                               MatrixXd& matrix,
+                               const int start_row,
+                               const int num_rows) const
+{
+  assert(initialized_);
+  const int rows = (num_rows < 0) ? (num_rows_ - start_row) : num_rows;
+  if (!isWithinRowBoundaries(start_row, rows))
+  {
+    return false;
+  }
+  for (int j = 0; j < (int)column_indices.size(); ++j)
+  {
+    if (!isWithinColumnBoundaries(column_indices[j]))
+    {
+      return false;
+    }
+  }
+  matrix.resize(rows, static_cast<int> (column_indices.size()));
+
+  // decode block of rows that fit into the L1 cache such that each row of the file is only fetched once
+  const size_t stride = sizeof(unsigned int) * static_cast<size_t> (num_cols_);
+  const int block_size = std::max(16, static_cast<int> (CACHE_BLOCK_SIZE / stride)) & ~3;
+  for (int block_start = 0; block_start < rows; block_start += block_size)
+  {
+    const int block_rows = std::min(block_size, rows - block_start);
+    const unsigned int* block = data_ + static_cast<size_t> (start_row + block_start) * num_cols_;
+    // Eigen matrices are column major, each column is therefore written contiguously
+    for (int j = 0; j < (int)column_indices.size(); ++j)
+    {
+      decodeColumn(reinterpret_cast<const char*> (block + column_indices[j]), stride, matrix.col(j).data() + block_start, block_rows);
+    }
+  }
+  return true;
+}
+
+}
@@ -15,6 +15,8 @@
 // system include
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <typeinfo>
 #include <stdio.h>
 
 // local include
@@ -33,6 +35,11 @@ namespace dmp_lib
  */
 static const int MIN_NUM_DATA_POINTS = 70;
 
+/*! Activations below this threshold are ignored when propagating DMPs in a batch. They do not change the
+ * predictions but would turn into (very slow) denormal numbers during the matrix-matrix product.
+ */
+static const double BATCH_ACTIVATION_THRESHOLD = 1e-200;
+
 bool DynamicMovementPrimitive::initialize(DMPParamPtr parameters,
                                           DMPStatePtr state,
                                           std::vector<TSPtr>& transformation_systems,
@@ -47,7 +54,6 @@ bool DynamicMovementPrimitive::initialize(DMPParamPtr parameters,
   {
     return (initialized_ = false);
   }
-  zero_feedback_ = Eigen::VectorXd::Zero(indices_.size());
   return (initialized_ = true);
 }
 
@@ -79,9 +85,20 @@ bool DynamicMovementPrimitive::setupIndices()
       indices_.push_back(index_pair);
     }
   }
+  setupFeedbackWorkspace();
   return true;
 }
 
+void DynamicMovementPrimitive::setupFeedbackWorkspace()
+{
+  zero_feedback_ = Eigen::VectorXd::Zero(indices_.size());
+  transformation_system_feedbacks_.resize(transformation_systems_.size());
+  for (int i = 0; i < static_cast<int> (transformation_systems_.size()); ++i)
+  {
+    transformation_system_feedbacks_[i] = Eigen::VectorXd::Zero(transformation_systems_[i]->getNumDimensions());
+  }
+}
+
 bool DynamicMovementPrimitive::isCompatible(const DynamicMovementPrimitive& other_dmp) const
 {
   if (!initialized_)
@@ -978,6 +995,328 @@ bool DynamicMovementPrimitive::propagateFull(Trajectory& trajectory,
   return propagateFull(trajectory, sampling_duration, num_samples);
 }
 
+bool DynamicMovementPrimitive::propagateFull(vector<DMPPtr>& dmps,
+                                             vector<Trajectory>& trajectories,
+                                             const double sampling_duration,
+                                             const int num_samples)
+{
+  vector<DynamicMovementPrimitive*> rollout_dmps;
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    if (!dmps[i])
+    {
+      Logger::logPrintf("DMP >%i< is not allocated. Cannot propagate DMPs.", Logger::ERROR, i);
+      return false;
+    }
+    rollout_dmps.push_back(dmps[i].get());
+  }
+  return propagateBatch(rollout_dmps, vector<vector<VectorXd> > (), trajectories, sampling_duration, num_samples);
+}
+
+bool DynamicMovementPrimitive::propagateFull(const vector<vector<VectorXd> >& thetas,
+                                             vector<Trajectory>& trajectories,
+                                             const double sampling_duration,
+                                             const int num_samples)
+{
+  assert(initialized_);
+  if (thetas.empty())
+  {
+    Logger::logPrintf("No thetas provided. Cannot propagate DMP.", Logger::ERROR);
+    return false;
+  }
+  vector<DynamicMovementPrimitive*> rollout_dmps(thetas.size(), this);
+  return propagateBatch(rollout_dmps, thetas, trajectories, sampling_duration, num_samples);
+}
+
+bool DynamicMovementPrimitive::integrateCanonicalSystem(const double sampling_duration,
+                                                        const int num_samples,
+                                                        VectorXd& state_x,
+                                                        VectorXd& can_x)
+{
+  if (!state_->current_time_.setDeltaT(sampling_duration / static_cast<double> (num_samples))
+      || !state_->current_time_.setTau(sampling_duration))
+  {
+    return false;
+  }
+
+  // same book keeping as in propagateStep
+  state_x.resize(num_samples);
+  can_x.resize(num_samples);
+  int num_steps = 0;
+  bool movement_finished = false;
+  while (!movement_finished)
+  {
+    state_x(num_steps) = canonical_system_->getState()->getStateX();
+    can_x(num_steps) = canonical_system_->getState()->getCanX();
+    num_steps++;
+
+    if (state_->num_generated_samples_ + 1 < num_samples)
+    {
+      state_->num_generated_samples_++;
+      if (!canonical_system_->integrate(state_->current_time_))
+      {
+        Logger::logPrintf("Problem while integrating the canonical system.", Logger::ERROR);
+        return false;
+      }
+    }
+    else
+    {
+      canonical_system_->getState()->setCanX(0.0);
+      state_->is_start_set_ = false;
+      state_->is_setup_ = false;
+      movement_finished = true;
+    }
+    canonical_system_->integrateProgress(state_->current_time_);
+  }
+  state_x.conservativeResize(num_steps);
+  can_x.conservativeResize(num_steps);
+  return true;
+}
+
+bool DynamicMovementPrimitive::isBatchable(const vector<DynamicMovementPrimitive*>& dmps)
+{
+  const TransformationSystem& first_transformation_system = *(dmps[0]->transformation_systems_[0]);
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    if (*(dmps[i]->canonical_system_) != *(dmps[0]->canonical_system_))
+    {
+      return false;
+    }
+    for (int j = 0; j < dmps[i]->getNumTransformationSystems(); ++j)
+    {
+      if ((dmps[i]->transformation_systems_[j]->integration_method_ != TransformationSystem::NORMAL)
+          || (typeid(*(dmps[i]->transformation_systems_[j])) != typeid(first_transformation_system)))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool DynamicMovementPrimitive::propagateBatch(const vector<DynamicMovementPrimitive*>& dmps,
+                                              const vector<vector<VectorXd> >& thetas,
+                                              vector<Trajectory>& trajectories,
+                                              const double sampling_duration,
+                                              const int num_samples)
+{
+  if (dmps.empty() || (sampling_duration < 1e-10) || (num_samples < 1))
+  {
+    Logger::logPrintf("Invalid number of DMPs >%i<, sampling duration >%f<, or number of samples >%i<. Cannot propagate DMPs.", Logger::ERROR,
+                      (int)dmps.size(), sampling_duration, num_samples);
+    return false;
+  }
+
+  // the same DMP is contained multiple times when propagating multiple parameter sets
+  vector<DynamicMovementPrimitive*> unique_dmps;
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    if (find(unique_dmps.begin(), unique_dmps.end(), dmps[i]) == unique_dmps.end())
+    {
+      if (!dmps[i]->isInitialized())
+      {
+        Logger::logPrintf("DMP >%i< is not initialized. Cannot propagate DMPs.", Logger::ERROR, i);
+        return false;
+      }
+      if (!dmps[i]->isReadyToPropagate())
+      {
+        return false;
+      }
+      unique_dmps.push_back(dmps[i]);
+    }
+  }
+
+  if (!isBatchable(dmps))
+  {
+    if (!thetas.empty())
+    {
+      Logger::logPrintf("DMP cannot be propagated in a batch. Cannot propagate multiple sets of thetas.", Logger::ERROR);
+      return false;
+    }
+    Logger::logPrintf("DMPs cannot be propagated in a batch, propagating them one by one.", Logger::DEBUG);
+    trajectories.resize(dmps.size());
+    for (int i = 0; i < (int)dmps.size(); ++i)
+    {
+      if (!dmps[i]->propagateFull(trajectories[i], sampling_duration, num_samples))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // each dimension of each rollout is one entry in the batch
+  vector<int> offsets(dmps.size(), 0);
+  int num_dimensions = 0;
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    if (!thetas.empty() && (static_cast<int> (thetas[i].size()) != dmps[i]->getNumDimensions()))
+    {
+      Logger::logPrintf("Number of theta vectors >%i< of rollout >%i< does not match number of DMP dimensions >%i<. Cannot propagate DMPs.",
+                        Logger::ERROR, (int)thetas[i].size(), i, dmps[i]->getNumDimensions());
+      return false;
+    }
+    offsets[i] = num_dimensions;
+    num_dimensions += dmps[i]->getNumDimensions();
+  }
+  TransformationSystemBatch batch;
+  batch.resize(num_dimensions);
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    int offset = offsets[i];
+    for (int j = 0; j < dmps[i]->getNumTransformationSystems(); ++j)
+    {
+      if (!dmps[i]->transformation_systems_[j]->getBatch(batch, offset))
+      {
+        return false;
+      }
+      offset += dmps[i]->transformation_systems_[j]->getNumDimensions();
+    }
+  }
+
+  // all canonical systems are equal, only the values of the first one are kept
+  VectorXd state_x, can_x, unused_state_x, unused_can_x;
+  for (int i = 0; i < (int)unique_dmps.size(); ++i)
+  {
+    if (!unique_dmps[i]->integrateCanonicalSystem(sampling_duration, num_samples, (i == 0) ? state_x : unused_state_x, (i == 0) ? can_x : unused_can_x))
+    {
+      return false;
+    }
+    if ((i > 0) && (unused_state_x.size() != state_x.size()))
+    {
+      Logger::logPrintf("DMP >%i< has already generated a different number of samples. Cannot propagate DMPs.", Logger::ERROR, i);
+      return false;
+    }
+  }
+  const int num_steps = static_cast<int> (state_x.size());
+
+  // group all dimensions that share the same basis functions
+  vector<lwr_lib::LWRPtr> lwr_models;
+  vector<VectorXd> group_widths, group_centers;
+  vector<vector<int> > group_dimensions;
+  vector<vector<VectorXd> > group_thetas;
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    for (int j = 0; j < dmps[i]->getNumDimensions(); ++j)
+    {
+      const lwr_lib::LWRPtr lwr_model
+          = dmps[i]->transformation_systems_[dmps[i]->indices_[j].first]->parameters_[dmps[i]->indices_[j].second]->lwr_model_;
+      const int num_rfs = lwr_model->getNumRFS();
+      VectorXd widths = VectorXd::Zero(num_rfs);
+      VectorXd centers = VectorXd::Zero(num_rfs);
+      VectorXd theta = VectorXd::Zero(num_rfs);
+      if (!lwr_model->getWidthsAndCenters(widths, centers) || !lwr_model->getThetas(theta))
+      {
+        Logger::logPrintf("Could not get parameters of the LWR model of dimension >%i<. Cannot propagate DMPs.", Logger::ERROR, j);
+        return false;
+      }
+      if (!thetas.empty())
+      {
+        if (thetas[i][j].size() != num_rfs)
+        {
+          Logger::logPrintf("Number of thetas >%i< of dimension >%i< of rollout >%i< does not match number of receptive fields >%i<. Cannot propagate DMPs.",
+                            Logger::ERROR, (int)thetas[i][j].size(), j, i, num_rfs);
+          return false;
+        }
+        theta = thetas[i][j];
+      }
+      int group = 0;
+      while ((group < (int)lwr_models.size()) && !((group_widths[group].size() == num_rfs)
+          && (group_widths[group] == widths) && (group_centers[group] == centers)))
+      {
+        group++;
+      }
+      if (group == (int)lwr_models.size())
+      {
+        lwr_models.push_back(lwr_model);
+        group_widths.push_back(widths);
+        group_centers.push_back(centers);
+        group_dimensions.push_back(vector<int> ());
+        group_thetas.push_back(vector<VectorXd> ());
+      }
+      group_dimensions[group].push_back(offsets[i] + j);
+      group_thetas[group].push_back(theta);
+    }
+  }
+
+  // compute the nonlinearities of all dimensions at all time steps
+  MatrixXd predictions = MatrixXd::Zero(num_dimensions, num_steps);
+  for (int g = 0; g < (int)lwr_models.size(); ++g)
+  {
+    MatrixXd basis_functions = MatrixXd::Zero(num_steps, lwr_models[g]->getNumRFS());
+    if (!lwr_models[g]->generateBasisFunctionMatrix(state_x, basis_functions, BATCH_ACTIVATION_THRESHOLD))
+    {
+      Logger::logPrintf("Could not generate basis function matrix. Cannot propagate DMPs.", Logger::ERROR);
+      return false;
+    }
+    const VectorXd sum_basis_functions = basis_functions.rowwise().sum();
+    if (sum_basis_functions.minCoeff() < 0.000000001)
+    {
+      Logger::logPrintf("Could not predict output, basis functions are not active.", Logger::ERROR);
+      return false;
+    }
+    // normalized basis functions times phase variable, see LWR::predict
+    basis_functions = (basis_functions.array().colwise() * (state_x.array() / sum_basis_functions.array())).matrix();
+
+    MatrixXd theta_matrix(lwr_models[g]->getNumRFS(), group_dimensions[g].size());
+    for (int j = 0; j < (int)group_dimensions[g].size(); ++j)
+    {
+      theta_matrix.col(j) = group_thetas[g][j];
+    }
+    const MatrixXd group_predictions = basis_functions * theta_matrix;
+    for (int j = 0; j < (int)group_dimensions[g].size(); ++j)
+    {
+      predictions.row(group_dimensions[g][j]) = group_predictions.col(j).transpose();
+    }
+  }
+
+  // integrate all transformation systems at once
+  MatrixXd positions(num_dimensions, num_steps);
+  MatrixXd velocities(num_dimensions, num_steps);
+  MatrixXd accelerations(num_dimensions, num_steps);
+  const TransformationSystem& transformation_system = *(dmps[0]->transformation_systems_[0]);
+  const Time& dmp_time = unique_dmps[0]->state_->current_time_;
+  for (int n = 0; n < num_steps; ++n)
+  {
+    batch.predictions = predictions.col(n).array();
+    transformation_system.integrateBatch(batch, state_x(n), can_x(n), dmp_time);
+    positions.col(n) = batch.current_x.matrix();
+    velocities.col(n) = batch.current_xd.matrix();
+    accelerations.col(n) = batch.current_xdd.matrix();
+  }
+
+  trajectories.resize(dmps.size());
+  const double special_sampling_frequency = static_cast<double> (num_samples) / (sampling_duration);
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    const int num_rollout_dimensions = dmps[i]->getNumDimensions();
+    const MatrixXd rollout_positions = positions.block(offsets[i], 0, num_rollout_dimensions, num_steps).transpose();
+    const MatrixXd rollout_velocities = velocities.block(offsets[i], 0, num_rollout_dimensions, num_steps).transpose();
+    const MatrixXd rollout_accelerations = accelerations.block(offsets[i], 0, num_rollout_dimensions, num_steps).transpose();
+    if (!trajectories[i].initialize(dmps[i]->getVariableNames(), special_sampling_frequency, false, num_samples)
+        || !trajectories[i].add(rollout_positions, rollout_velocities, rollout_accelerations))
+    {
+      Logger::logPrintf("Could not store rollout >%i< in trajectory.", Logger::ERROR, i);
+      return false;
+    }
+  }
+
+  // write back the final states
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    int offset = offsets[i];
+    for (int j = 0; j < dmps[i]->getNumTransformationSystems(); ++j)
+    {
+      if (!dmps[i]->transformation_systems_[j]->setBatch(batch, offset))
+      {
+        return false;
+      }
+      offset += dmps[i]->transformation_systems_[j]->getNumDimensions();
+    }
+  }
+  return true;
+}
+
 // REAL-TIME REQUIREMENTS
 bool DynamicMovementPrimitive::integrate(const int num_iteration, const VectorXd& feedback)
 {
@@ -986,7 +1325,9 @@ bool DynamicMovementPrimitive::integrate(const int num_iteration, const VectorXd
   for (int i = 0; i < getNumTransformationSystems(); ++i)
   {
     int num_dimesions = transformation_systems_[i]->getNumDimensions();
-    if (!transformation_systems_[i]->integrate(canonical_system_->state_, state_->current_time_, feedback.segment(index, num_dimesions), num_iteration))
+    // copy into the preallocated vector, passing the segment itself would create a (heap allocated) temporary
+    transformation_system_feedbacks_[i] = feedback.segment(index, num_dimesions);
+    if (!transformation_systems_[i]->integrate(canonical_system_->state_, state_->current_time_, transformation_system_feedbacks_[i], num_iteration))
     {
       return false;
     }
@@ -48,6 +48,7 @@ ICRA2009DynamicMovementPrimitive& ICRA2009DynamicMovementPrimitive::operator=(co
   DynamicMovementPrimitive::canonical_system_ = canonical_system_;
 
   indices_ = icra2009dmp.indices_;
+  setupFeedbackWorkspace();
   initialized_ = icra2009dmp.initialized_;
   return *this;
 }
@@ -474,4 +474,48 @@ bool ICRA2009TransformationSystem::integrate(const CSStatePtr canonical_system_s
   return true;
 }
 
+// REAL-TIME REQUIREMENTS
+void ICRA2009TransformationSystem::integrateBatch(TransformationSystemBatch& batch,
+                                                  const double /*state_x*/,
+                                                  const double can_x,
+                                                  const Time& dmp_time) const
+{
+  // same as the NORMAL integration in integrate(...), but for all dimensions of the batch at once
+  const double dt = dmp_time.getDeltaT();
+  const double tau = dmp_time.getTau();
+
+  // for debugging only (zero feedback)
+  batch.internal_x.setZero();
+
+  batch.f = batch.predictions * can_x;
+
+  // compute transformation system
+  batch.internal_xdd = (batch.k_gains * (batch.goals - batch.current_x)
+      - batch.d_gains * batch.internal_xd
+      - batch.k_gains * (batch.goals - batch.starts) * can_x
+      + batch.k_gains * batch.f) / tau;
+
+  batch.current_xd = batch.internal_xd / tau;
+  batch.current_xdd = batch.internal_xdd;
+
+  // integrate the system twice
+  batch.internal_xd += batch.current_xdd * dt;
+  batch.current_x += batch.current_xd * dt;
+}
+
+bool ICRA2009TransformationSystem::getGains(const int index,
+                                            double& k_gain,
+                                            double& d_gain) const
+{
+  assert(initialized_);
+  if ((index < 0) || (index >= getNumDimensions()))
+  {
+    Logger::logPrintf("Cannot get gains of dimension >%i<, transformation system has >%i< dimensions.", Logger::ERROR, index, getNumDimensions());
+    return false;
+  }
+  k_gain = parameters_[index]->k_gain_;
+  d_gain = parameters_[index]->d_gain_;
+  return true;
+}
+
 }
@@ -48,6 +48,7 @@ NC2010DynamicMovementPrimitive& NC2010DynamicMovementPrimitive::operator=(const
   DynamicMovementPrimitive::canonical_system_ = canonical_system_;
 
   indices_ = nc2010dmp.indices_;
+  setupFeedbackWorkspace();
   initialized_ = nc2010dmp.initialized_;
   return *this;
 }
@@ -439,4 +439,45 @@ bool NC2010TransformationSystem::integrate(const CSStatePtr canonical_system_sta
   return true;
 }
 
+// REAL-TIME REQUIREMENTS
+void NC2010TransformationSystem::integrateBatch(TransformationSystemBatch& batch,
+                                                const double state_x,
+                                                const double /*can_x*/,
+                                                const Time& dmp_time) const
+{
+  // same as the NORMAL integration in integrate(...), but for all dimensions of the batch at once
+  const double dt = dmp_time.getDeltaT();
+  const double tau = dmp_time.getTau();
+
+  batch.f = batch.predictions * state_x;
+
+  // compute transformation system
+  batch.internal_xdd = (batch.k_gains * (batch.goals - batch.current_x)
+      - batch.d_gains * batch.internal_xd
+      - batch.k_gains * (batch.goals - batch.starts) * state_x
+      + batch.k_gains * batch.f) / tau;
+
+  batch.current_xd = batch.internal_xd / tau;
+  batch.current_xdd = batch.internal_xdd / tau;
+
+  // integrate the system twice
+  batch.internal_xd += batch.internal_xdd * dt;
+  batch.current_x += batch.current_xd * dt;
+}
+
+bool NC2010TransformationSystem::getGains(const int index,
+                                          double& k_gain,
+                                          double& d_gain) const
+{
+  assert(initialized_);
+  if ((index < 0) || (index >= getNumDimensions()))
+  {
+    Logger::logPrintf("Cannot get gains of dimension >%i<, transformation system has >%i< dimensions.", Logger::ERROR, index, getNumDimensions());
+    return false;
+  }
+  k_gain = parameters_[index]->k_gain_;
+  d_gain = parameters_[index]->d_gain_;
+  return true;
+}
+
 }
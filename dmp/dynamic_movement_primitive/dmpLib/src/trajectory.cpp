@@ -23,6 +23,7 @@
 // local include
 #include <dmp_lib/trajectory.h>
 #include <dmp_lib/logger.h>
+#include <dmp_lib/clmc_file_view.h>
 
 // 32 bit word byte/word swap macros
 #define LLSB(x) ((x) & 0xff)
@@ -386,43 +387,31 @@ bool Trajectory::readFromCLMCFile(const string& file_name,
                                   const bool positions_only,
                                   const bool use_variable_names)
 {
+  return readFromCLMCFile(file_name, variable_names, 0.0, -1.0, positions_only, use_variable_names);
+}
 
-  FILE *fp;
-  // open the file, and parse the parameters
-  if ((fp = fopen(file_name.c_str(), "r")) == NULL)
-  {
-    Logger::logPrintf("Cannot fopen file >%s<.", Logger::ERROR, file_name.c_str());
-    return false;
-  }
-
-  int tmp_trajectory_type, tmp_num_rows, tmp_num_cols;
-  double tmp_sampling_frequency;
-  if (fscanf(fp, "%d %d %d %lf", &tmp_trajectory_type, &tmp_num_cols, &tmp_num_rows, &tmp_sampling_frequency) != 4)
+bool Trajectory::readFromCLMCFile(const string& file_name,
+                                  const vector<string>& variable_names,
+                                  const double start_time,
+                                  const double end_time,
+                                  const bool positions_only,
+                                  const bool use_variable_names)
+{
+  CLMCFileView clmc_file;
+  if (!clmc_file.initialize(file_name))
   {
-    Logger::logPrintf("Could not read/parse header.", Logger::ERROR);
-    fclose(fp);
     return false;
   }
 
-  // checking whether values make sense
-  if ((tmp_num_cols <= 0) || (tmp_num_rows <= 0))
+  int start_row = 0;
+  int num_rows = clmc_file.getNumRows();
+  if (end_time >= 0.0)
   {
-    Logger::logPrintf("Values for number of columns >%i< and rows >%i< are negative.", Logger::ERROR, tmp_num_cols, tmp_num_rows);
-    fclose(fp);
-    return false;
-  }
-  if ((tmp_num_cols > ABSOLUTE_MAX_TRAJECTORY_DIMENSION) || (tmp_num_rows > ABSOLUTE_MAX_TRAJECTORY_LENGTH))
-  {
-    Logger::logPrintf("Values for number of columns >%i< and rows >%i< are out of bound (%i x %i).", Logger::ERROR, tmp_num_cols, tmp_num_rows,
-           ABSOLUTE_MAX_TRAJECTORY_DIMENSION, ABSOLUTE_MAX_TRAJECTORY_LENGTH);
-    fclose(fp);
-    return false;
-  }
-  if (tmp_sampling_frequency <= 0)
-  {
-    Logger::logPrintf("Read implausible sampling frequency >%.1f<.", Logger::ERROR, tmp_sampling_frequency);
-    fclose(fp);
-    return false;
+    if (!clmc_file.getRowRange(start_time, end_time, start_row, num_rows))
+    {
+      Logger::logPrintf("Could not read time window of file >%s<.", Logger::ERROR, file_name.c_str());
+      return false;
+    }
   }
 
   vector<int> position_variable_indices;
@@ -432,21 +421,8 @@ bool Trajectory::readFromCLMCFile(const string& file_name,
   variable_names_.clear();
   variable_units_.clear();
 
-  vector<string> file_variable_names;
-  vector<string> file_variable_units;
-  for (int j = 0; j < tmp_num_cols; ++j)
-  {
-    char tmp_name[MAX_VARNAME_LENGTH];
-    char tmp_unit[MAX_VARNAME_LENGTH];
-    if (fscanf(fp, "%s %s", tmp_name, tmp_unit) != 2)
-    {
-      Logger::logPrintf("Cannot read variable names and units.", Logger::ERROR);
-      fclose(fp);
-      return false;
-    }
-    file_variable_names.push_back(tmp_name);
-    file_variable_units.push_back(tmp_unit);
-  }
+  const vector<string>& file_variable_names = clmc_file.getVariableNames();
+  const vector<string>& file_variable_units = clmc_file.getVariableUnits();
 
   vector<string> variable_names_list = variable_names;
   if(!use_variable_names)
@@ -457,141 +433,62 @@ bool Trajectory::readFromCLMCFile(const string& file_name,
 
   for (int i = 0; i < (int)variable_names_list.size(); ++i)
   {
-    bool variable_name_found = false;
-    for (int j = 0; j < (int)file_variable_names.size(); ++j)
-    {
-      if (variable_names_list[i].compare(file_variable_names[j]) == 0)
-      {
-        variable_name_found = true;
-        position_variable_indices.push_back(j);
-        variable_names_.push_back(file_variable_names[j]);
-        variable_units_.push_back(file_variable_units[j]);
-        Logger::logPrintf("Read %s [%s].", Logger::DEBUG, variable_names_.back().c_str(), variable_units_.back().c_str());
-
-        if (!positions_only)
-        {
-          string velocity_variable_name = variable_names_list[i] + "d";
-          bool velocity_variable_name_found = false;
-          for (int s = 0; s < (int)file_variable_names.size(); ++s)
-          {
-            if (velocity_variable_name.compare(file_variable_names[s]) == 0)
-            {
-              velocity_variable_name_found = true;
-            }
-          }
-          if(!velocity_variable_name_found)
-          {
-            Logger::logPrintf("Could not find variable >%s<. Maybe use position only option.", Logger::ERROR, velocity_variable_name.c_str());
-            return false;
-          }
-
-          string acceleration_variable_name = variable_names_list[i] + "dd";
-          bool acceleration_variable_name_found = false;
-          for (int s = 0; s < (int)file_variable_names.size(); ++s)
-          {
-            if (acceleration_variable_name.compare(file_variable_names[s]) == 0)
-            {
-              acceleration_variable_name_found = true;
-            }
-          }
-          if(!acceleration_variable_name_found)
-          {
-            Logger::logPrintf("Could not find variable >%s<. Maybe use position only option.", Logger::ERROR, acceleration_variable_name.c_str());
-            return false;
-          }
-
-          for (int m = 0; m < (int)file_variable_names.size(); ++m)
-          {
-            if (velocity_variable_name.compare(file_variable_names[m]) == 0)
-            {
-              velocity_variable_indices.push_back(m);
-            }
-            if (acceleration_variable_name.compare(file_variable_names[m]) == 0)
-            {
-              acceleration_variable_indices.push_back(m);
-            }
-          }
-        }
-        if (variable_name_found)
-        {
-          break;
-        }
-      }
-    }
-    if (!variable_name_found)
+    int position_index;
+    if (!clmc_file.getColumnIndex(variable_names_list[i], position_index))
     {
       Logger::logPrintf("Could not find variable named >%s< in trajectory file >%s<.", Logger::ERROR, variable_names_list[i].c_str(), file_name.c_str());
-      fclose(fp);
       return false;
     }
-  }
-
-  // there are two extra blank chars at the end of the block and a line return which we must account for
-  fgetc(fp);
-  fgetc(fp);
-  fgetc(fp);
-
-  // read file into a buffer
-  //  float trajectory_data[tmp_num_rows][tmp_num_cols];
-  //  if (fread(&(trajectory_data[0][0]), sizeof(float), tmp_num_rows * tmp_num_cols, fp) != (unsigned)(tmp_num_rows * tmp_num_cols))
-  //  {
-  //    Logger::logPrintf("Cannot read trajectory data.", Logger::ERROR);
-  //    fclose(fp);
-  //    return false;
-  //  }
-
-  // Allocate memory on the heap to hold really biiiig data
-  Logger::logPrintf("Reading >%i< rows and >%i< cols (%.2f MBytes).", Logger::INFO, tmp_num_rows, tmp_num_cols, (double)(4 * tmp_num_rows * tmp_num_cols)/(double)1000000);
-  float** buffer;
-  buffer = (float**) calloc((size_t)tmp_num_rows, sizeof(float*));
-  float* chunk;
-  chunk = (float *) calloc((size_t) tmp_num_rows * tmp_num_cols, sizeof(float));
-  for (int i = 0; i < tmp_num_rows; ++i)
-  {
-    buffer[i] = (float*) &(chunk[i*tmp_num_cols]);
-  }
-  if (fread(buffer[0], sizeof(float), tmp_num_rows * tmp_num_cols, fp) != (unsigned)(tmp_num_rows * tmp_num_cols))
-  {
-    Logger::logPrintf("Cannot read trajectory data of size >%i< x >%i<.", Logger::ERROR, tmp_num_rows, tmp_num_cols);
-    fclose(fp);
-    return false;
-  }
-  fclose(fp);
+    position_variable_indices.push_back(position_index);
+    variable_names_.push_back(file_variable_names[position_index]);
+    variable_units_.push_back(file_variable_units[position_index]);
+    Logger::logPrintf("Read %s [%s].", Logger::DEBUG, variable_names_.back().c_str(), variable_units_.back().c_str());
 
-  // convert little-endian to big-endian
-  // TODO: check this on different platforms
-  int aux;
-  for (int i = 0; i < tmp_num_rows; i++)
-  {
-    for (int j = 0; j < tmp_num_cols; j++)
+    if (!positions_only)
     {
-      // aux = LONGSWAP(*((int *)&(trajectory_data->at(i)[j])));
-      aux = LONGSWAP(*((int *)&(buffer[i][j])));
-      // trajectory_data[i][j] = *((float *)&aux);
-      buffer[i][j] = *((float *)&aux);
+      string velocity_variable_name = variable_names_list[i] + "d";
+      int velocity_index;
+      if (!clmc_file.getColumnIndex(velocity_variable_name, velocity_index))
+      {
+        Logger::logPrintf("Could not find variable >%s<. Maybe use position only option.", Logger::ERROR, velocity_variable_name.c_str());
+        return false;
+      }
+      velocity_variable_indices.push_back(velocity_index);
+
+      string acceleration_variable_name = variable_names_list[i] + "dd";
+      int acceleration_index;
+      if (!clmc_file.getColumnIndex(acceleration_variable_name, acceleration_index))
+      {
+        Logger::logPrintf("Could not find variable >%s<. Maybe use position only option.", Logger::ERROR, acceleration_variable_name.c_str());
+        return false;
+      }
+      acceleration_variable_indices.push_back(acceleration_index);
     }
   }
 
+  Logger::logPrintf("Reading >%i< rows and >%i< of >%i< cols (%.2f MBytes).", Logger::INFO, num_rows, (int)variable_names_list.size(), clmc_file.getNumCols(),
+                    (double)(4 * num_rows * (int)variable_names_list.size()) / (double)1000000);
+
   // initialize trajectory and allocate memory to hold the trajectory
-  if (!initialize(variable_names_list, tmp_sampling_frequency, positions_only, tmp_num_rows))
+  if (!initialize(variable_names_list, clmc_file.getSamplingFrequency(), positions_only, num_rows))
   {
     Logger::logPrintf("Could not initialize trajectory. Reading from file failed.", Logger::ERROR);
     return false;
   }
 
-  for (int i = 0; i < trajectory_length_; i++)
+  // only the requested columns are byte swapped and converted
+  if (!clmc_file.readColumns(position_variable_indices, trajectory_positions_, start_row, num_rows))
   {
-    for (int j = 0; j < trajectory_dimension_; j++)
+    Logger::logPrintf("Cannot read trajectory data of size >%i< x >%i<.", Logger::ERROR, num_rows, clmc_file.getNumCols());
+    return false;
+  }
+  if (!positions_only)
+  {
+    if (!clmc_file.readColumns(velocity_variable_indices, trajectory_velocities_, start_row, num_rows)
+        || !clmc_file.readColumns(acceleration_variable_indices, trajectory_accelerations_, start_row, num_rows))
     {
-      // trajectory_positions_(i, j) = static_cast<double> (trajectory_data[i][position_variable_indices[j]]);
-      trajectory_positions_(i, j) = static_cast<double> (buffer[i][position_variable_indices[j]]);
-      if (!positions_only)
-      {
-        // trajectory_velocities_(i, j) = static_cast<double> (trajectory_data[i][velocity_variable_indices[j]]);
-        // trajectory_accelerations_(i, j) = static_cast<double> (trajectory_data[i][acceleration_variable_indices[j]]);
-        trajectory_velocities_(i, j) = static_cast<double> (buffer[i][velocity_variable_indices[j]]);
-        trajectory_accelerations_(i, j) = static_cast<double> (buffer[i][acceleration_variable_indices[j]]);
-      }
+      Logger::logPrintf("Cannot read trajectory data of size >%i< x >%i<.", Logger::ERROR, num_rows, clmc_file.getNumCols());
+      return false;
     }
   }
   index_to_last_trajectory_point_ = trajectory_length_;
@@ -614,10 +511,6 @@ bool Trajectory::readFromCLMCFile(const string& file_name,
                     Logger::INFO, (int)variable_names_list.size(), trajectory_length_);
   Logger::logPrintf("Variable names are >%s<.", Logger::DEBUG, all_variable_names.c_str());
 
-  // deallocate
-  free(buffer[0]);
-  free(buffer);
-
   return true;
 }
 
@@ -1299,6 +1192,38 @@ bool Trajectory::add(const VectorXd& trajectory_positons,
   return true;
 }
 
+bool Trajectory::add(const MatrixXd& trajectory_positions,
+                     const MatrixXd& trajectory_velocities,
+                     const MatrixXd& trajectory_accelerations)
+{
+  assert(initialized_);
+  if ((trajectory_positions.cols() != trajectory_dimension_)
+      || (trajectory_velocities.rows() != trajectory_positions.rows()) || (trajectory_velocities.cols() != trajectory_dimension_)
+      || (trajectory_accelerations.rows() != trajectory_positions.rows()) || (trajectory_accelerations.cols() != trajectory_dimension_))
+  {
+    Logger::logPrintf("Size of provided matrices does not match trajectory dimension >%i<. Cannot add samples to trajectory.",
+                      Logger::ERROR, trajectory_dimension_);
+    return false;
+  }
+  if (sampling_frequency_ <= 0.0)
+  {
+    Logger::logPrintf("Sampling frequency >%.1f< is invalid. Cannot add samples to trajectory.", Logger::ERROR, sampling_frequency_);
+    return false;
+  }
+  const int num_samples = static_cast<int> (trajectory_positions.rows());
+  if (!canHold(index_to_last_trajectory_point_ + num_samples, trajectory_dimension_, false))
+  {
+    return false;
+  }
+
+  trajectory_positions_.block(index_to_last_trajectory_point_, 0, num_samples, trajectory_dimension_) = trajectory_positions;
+  trajectory_velocities_.block(index_to_last_trajectory_point_, 0, num_samples, trajectory_dimension_) = trajectory_velocities;
+  trajectory_accelerations_.block(index_to_last_trajectory_point_, 0, num_samples, trajectory_dimension_) = trajectory_accelerations;
+  index_to_last_trajectory_point_ += num_samples;
+  trajectory_duration_ = static_cast<double> (index_to_last_trajectory_point_) / sampling_frequency_;
+  return true;
+}
+
 // REAL-TIME REQUIREMENTS
 bool Trajectory::add(const VectorXd& trajectory_positons,
                      const bool positions_only)
@@ -390,6 +390,68 @@ void TransformationSystem::getNames(vector<string>& names) const
   }
 }
 
+void TransformationSystemBatch::resize(const int num_dimensions)
+{
+  k_gains = Eigen::ArrayXd::Zero(num_dimensions);
+  d_gains = Eigen::ArrayXd::Zero(num_dimensions);
+  starts = Eigen::ArrayXd::Zero(num_dimensions);
+  goals = Eigen::ArrayXd::Zero(num_dimensions);
+  internal_x = Eigen::ArrayXd::Zero(num_dimensions);
+  internal_xd = Eigen::ArrayXd::Zero(num_dimensions);
+  internal_xdd = Eigen::ArrayXd::Zero(num_dimensions);
+  current_x = Eigen::ArrayXd::Zero(num_dimensions);
+  current_xd = Eigen::ArrayXd::Zero(num_dimensions);
+  current_xdd = Eigen::ArrayXd::Zero(num_dimensions);
+  f = Eigen::ArrayXd::Zero(num_dimensions);
+  predictions = Eigen::ArrayXd::Zero(num_dimensions);
+}
+
+bool TransformationSystem::getBatch(TransformationSystemBatch& batch,
+                                    const int offset) const
+{
+  assert(initialized_);
+  if ((offset < 0) || (offset + getNumDimensions() > batch.current_x.size()))
+  {
+    Logger::logPrintf("Batch of size >%i< cannot hold >%i< dimensions at offset >%i<.", Logger::ERROR, (int)batch.current_x.size(), getNumDimensions(), offset);
+    return false;
+  }
+  for (int i = 0; i < getNumDimensions(); ++i)
+  {
+    if (!getGains(i, batch.k_gains(offset + i), batch.d_gains(offset + i)))
+    {
+      return false;
+    }
+    batch.starts(offset + i) = states_[i]->start_;
+    batch.goals(offset + i) = states_[i]->goal_;
+    batch.internal_x(offset + i) = states_[i]->internal_.getX();
+    batch.internal_xd(offset + i) = states_[i]->internal_.getXd();
+    batch.internal_xdd(offset + i) = states_[i]->internal_.getXdd();
+    batch.current_x(offset + i) = states_[i]->current_.getX();
+    batch.current_xd(offset + i) = states_[i]->current_.getXd();
+    batch.current_xdd(offset + i) = states_[i]->current_.getXdd();
+    batch.f(offset + i) = states_[i]->f_;
+  }
+  return true;
+}
+
+bool TransformationSystem::setBatch(const TransformationSystemBatch& batch,
+                                    const int offset)
+{
+  assert(initialized_);
+  if ((offset < 0) || (offset + getNumDimensions() > batch.current_x.size()))
+  {
+    Logger::logPrintf("Batch of size >%i< does not contain >%i< dimensions at offset >%i<.", Logger::ERROR, (int)batch.current_x.size(), getNumDimensions(), offset);
+    return false;
+  }
+  for (int i = 0; i < getNumDimensions(); ++i)
+  {
+    states_[i]->internal_.set(batch.internal_x(offset + i), batch.internal_xd(offset + i), batch.internal_xdd(offset + i));
+    states_[i]->current_.set(batch.current_x(offset + i), batch.current_xd(offset + i), batch.current_xdd(offset + i));
+    states_[i]->f_ = batch.f(offset + i);
+  }
+  return true;
+}
+
 bool TransformationSystem::setIntegrationMethod(IntegrationMethod integration_method)
 {
   if((integration_method == QUATERNION) && (getNumDimensions() != 4))
@@ -0,0 +1,195 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Compares the memory mapped CLMC reader with the former
+            fscanf/fread based implementation.
+
+ \file		clmc_file_benchmark.cpp
+
+ \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <Eigen/Core>
+
+#include <dmp_lib/logger.h>
+#include <dmp_lib/trajectory.h>
+#include <dmp_lib/clmc_file_view.h>
+
+using namespace std;
+using namespace dmp_lib;
+using namespace Eigen;
+
+// 32 bit word byte/word swap macros
+#define LLSB(x) ((x) & 0xff)
+#define LNLSB(x) (((x) >> 8) & 0xff)
+#define LNMSB(x) (((x) >> 16) & 0xff)
+#define LMSB(x) (((x) >> 24) & 0xff)
+#define LONGSWAP(x) ((LLSB(x) << 24) | (LNLSB(x) << 16)| (LNMSB(x) << 8) | (LMSB(x)))
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+/*! Reference implementation: fscanf the header, fread all data, byte swap every element and copy all columns
+ */
+static bool readLegacy(const string& file_name, MatrixXd& values)
+{
+  FILE *fp;
+  if ((fp = fopen(file_name.c_str(), "r")) == NULL)
+  {
+    return false;
+  }
+  int type, num_rows, num_cols;
+  double frequency;
+  if (fscanf(fp, "%d %d %d %lf", &type, &num_cols, &num_rows, &frequency) != 4)
+  {
+    fclose(fp);
+    return false;
+  }
+  char name[200], unit[200];
+  for (int j = 0; j < num_cols; ++j)
+  {
+    if (fscanf(fp, "%s %s", name, unit) != 2)
+    {
+      fclose(fp);
+      return false;
+    }
+  }
+  fgetc(fp);
+  fgetc(fp);
+  fgetc(fp);
+  float* buffer = (float*)calloc((size_t)num_rows * num_cols, sizeof(float));
+  if (fread(buffer, sizeof(float), num_rows * num_cols, fp) != (unsigned)(num_rows * num_cols))
+  {
+    free(buffer);
+    fclose(fp);
+    return false;
+  }
+  fclose(fp);
+  int aux;
+  for (int i = 0; i < num_rows * num_cols; ++i)
+  {
+    aux = LONGSWAP(*((int *)&(buffer[i])));
+    buffer[i] = *((float *)&aux);
+  }
+  values = MatrixXd::Zero(num_rows, num_cols);
+  for (int i = 0; i < num_rows; ++i)
+  {
+    for (int j = 0; j < num_cols; ++j)
+    {
+      values(i, j) = static_cast<double> (buffer[i * num_cols + j]);
+    }
+  }
+  free(buffer);
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  const int num_variables = (argc > 1) ? atoi(argv[1]) : 50;
+  const int num_samples = (argc > 2) ? atoi(argv[2]) : 100000;
+  const int num_repetitions = 5;
+  const string file_name = "/tmp/clmc_file_benchmark.clmc";
+
+  Logger::setLogLevel(Logger::WARN);
+
+  vector<string> variable_names;
+  for (int i = 0; i < num_variables; ++i)
+  {
+    char tmp[32];
+    sprintf(tmp, "var_%i", i);
+    variable_names.push_back(tmp);
+  }
+
+  Trajectory trajectory;
+  if (!trajectory.initialize(variable_names, 1000.0, false, num_samples))
+  {
+    return -1;
+  }
+  VectorXd point = VectorXd::Zero(num_variables);
+  for (int i = 0; i < num_samples; ++i)
+  {
+    for (int j = 0; j < num_variables; ++j)
+    {
+      point(j) = sin(0.001 * i + j);
+    }
+    trajectory.add(point, point, point);
+  }
+  if (!trajectory.writeToCLMCFile(file_name))
+  {
+    return -1;
+  }
+  printf("File contains %i columns and %i rows (%.1f MBytes).\n", 3 * num_variables, num_samples,
+         4.0 * 3 * num_variables * num_samples / 1e6);
+
+  vector<string> single_variable(1, variable_names[num_variables / 2]);
+  const int column = 3 * (num_variables / 2);
+
+  MatrixXd legacy_values;
+  double start = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    readLegacy(file_name, legacy_values);
+  }
+  const double legacy_time = (now() - start) / num_repetitions;
+
+  Trajectory full_trajectory;
+  start = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    full_trajectory.readFromCLMCFile(file_name, variable_names);
+  }
+  const double full_time = (now() - start) / num_repetitions;
+
+  Trajectory single_trajectory;
+  start = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    single_trajectory.readFromCLMCFile(file_name, single_variable, true);
+  }
+  const double single_time = (now() - start) / num_repetitions;
+
+  Trajectory window_trajectory;
+  const double duration = num_samples / 1000.0;
+  start = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    window_trajectory.readFromCLMCFile(file_name, single_variable, 0.25 * duration, 0.5 * duration, true);
+  }
+  const double window_time = (now() - start) / num_repetitions;
+
+  double error = 0.0;
+  for (int i = 0; i < num_samples; ++i)
+  {
+    double position = 0.0;
+    if (!single_trajectory.getTrajectoryPosition(i, 0, position))
+    {
+      remove(file_name.c_str());
+      return -1;
+    }
+    error += fabs(position - legacy_values(i, column));
+  }
+
+  printf("legacy read of all columns           : %8.2f ms\n", 1e3 * legacy_time);
+  printf("mmap read of all pos/vel/acc columns : %8.2f ms\n", 1e3 * full_time);
+  printf("mmap read of a single column         : %8.2f ms\n", 1e3 * single_time);
+  printf("mmap read of a single column window  : %8.2f ms\n", 1e3 * window_time);
+  printf("accumulated difference to legacy     : %g\n", error);
+
+  remove(file_name.c_str());
+  return (error == 0.0) ? 0 : -1;
+}
@@ -0,0 +1,165 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Compares propagating a 7 dimensional ICRA2009 DMP with its
+            fixed size counterpart.
+
+ \file		fixed_dmp_benchmark.cpp
+
+ \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <Eigen/Core>
+
+#include <dmp_lib/logger.h>
+#include <dmp_lib/trajectory.h>
+#include <dmp_lib/icra2009_dynamic_movement_primitive.h>
+#include <dmp_lib/icra2009_fixed_dynamic_movement_primitive.h>
+
+using namespace std;
+using namespace dmp_lib;
+using namespace Eigen;
+
+static const int NUM_DIMENSIONS = 7;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+/*! Creates a DMP with a single transformation system and one LWR model per dimension
+ */
+static bool initialize(ICRA2009DMP& dmp, const int num_rfs)
+{
+  const double k_gain = 60.0;
+  const double d_gain = 2.0 * sqrt(k_gain);
+
+  vector<ICRA2009TSParamPtr> parameters;
+  vector<ICRA2009TSStatePtr> states;
+  for (int i = 0; i < NUM_DIMENSIONS; ++i)
+  {
+    lwr_lib::LWRParamPtr lwr_parameters(new lwr_lib::LWRParameters());
+    lwr_lib::LWRPtr lwr_model(new lwr_lib::LWR());
+    if (!lwr_parameters->initialize(num_rfs, 0.1) || !lwr_model->initialize(lwr_parameters))
+    {
+      return false;
+    }
+    char name[32];
+    sprintf(name, "joint_%i", i);
+    ICRA2009TSParamPtr transformation_system_parameters(new ICRA2009TransformationSystemParameters());
+    if (!transformation_system_parameters->initialize(lwr_model, name, k_gain, d_gain))
+    {
+      return false;
+    }
+    parameters.push_back(transformation_system_parameters);
+    states.push_back(ICRA2009TSStatePtr(new ICRA2009TransformationSystemState()));
+  }
+  vector<ICRA2009TSPtr> transformation_systems(1, ICRA2009TSPtr(new ICRA2009TransformationSystem()));
+  if (!transformation_systems[0]->initialize(parameters, states, TransformationSystem::NORMAL))
+  {
+    return false;
+  }
+
+  ICRA2009CSPtr canonical_system(new ICRA2009CanonicalSystem());
+  if (!canonical_system->initialize(ICRA2009CSParamPtr(new ICRA2009CanonicalSystemParameters()),
+                                    ICRA2009CSStatePtr(new ICRA2009CanonicalSystemState())))
+  {
+    return false;
+  }
+  ICRA2009DMPParamPtr dmp_parameters(new ICRA2009DynamicMovementPrimitiveParameters());
+  if (!dmp_parameters->setCutoff(0.001))
+  {
+    return false;
+  }
+  ICRA2009DMPStatePtr dmp_state(new ICRA2009DynamicMovementPrimitiveState());
+  return dmp.initialize(dmp_parameters, dmp_state, transformation_systems, canonical_system);
+}
+
+int main(int argc, char** argv)
+{
+  const int num_rfs = (argc > 1) ? atoi(argv[1]) : 30;
+  const int num_samples = (argc > 2) ? atoi(argv[2]) : 1000;
+  const int num_repetitions = 100;
+  const double duration = 1.0;
+  const double sampling_frequency = num_samples / duration;
+
+  Logger::setLogLevel(Logger::WARN);
+
+  ICRA2009DMP dmp;
+  if (!initialize(dmp, num_rfs))
+  {
+    printf("Could not initialize DMP.\n");
+    return -1;
+  }
+  ICRA2009DMP7::Vector start, goal;
+  for (int j = 0; j < NUM_DIMENSIONS; ++j)
+  {
+    start(j) = 0.1 * j;
+    goal(j) = 1.0 - 0.2 * j;
+  }
+  VectorXd dynamic_start = start;
+  VectorXd dynamic_goal = goal;
+  if (!dmp.learnFromMinimumJerk(dynamic_start, dynamic_goal, sampling_frequency, duration))
+  {
+    printf("Could not learn DMP.\n");
+    return -1;
+  }
+  ICRA2009DMP7 fixed_dmp;
+  if (!fixed_dmp.initialize(dmp))
+  {
+    printf("Could not initialize fixed size DMP.\n");
+    return -1;
+  }
+
+  VectorXd dynamic_positions = VectorXd::Zero(NUM_DIMENSIONS);
+  VectorXd dynamic_velocities = VectorXd::Zero(NUM_DIMENSIONS);
+  VectorXd dynamic_accelerations = VectorXd::Zero(NUM_DIMENSIONS);
+  bool movement_finished = false;
+  double dynamic_checksum = 0.0;
+  double start_time = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    dmp.setup(dynamic_start, dynamic_goal, duration, sampling_frequency);
+    movement_finished = false;
+    while (!movement_finished)
+    {
+      dmp.propagateStep(dynamic_positions, dynamic_velocities, dynamic_accelerations, movement_finished);
+    }
+    dynamic_checksum += dynamic_positions.sum();
+  }
+  const double dynamic_time = (now() - start_time) / (num_repetitions * num_samples);
+
+  ICRA2009DMP7::Vector fixed_positions, fixed_velocities, fixed_accelerations;
+  double fixed_checksum = 0.0;
+  start_time = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    fixed_dmp.setup(start, goal, duration, sampling_frequency);
+    movement_finished = false;
+    while (!movement_finished)
+    {
+      fixed_dmp.propagateStep(fixed_positions, fixed_velocities, fixed_accelerations, movement_finished);
+    }
+    fixed_checksum += fixed_positions.sum();
+  }
+  const double fixed_time = (now() - start_time) / (num_repetitions * num_samples);
+
+  printf("%i dimensions, %i receptive fields, %i samples\n", NUM_DIMENSIONS, num_rfs, num_samples);
+  printf("dynamic propagateStep    : %8.3f us\n", 1e6 * dynamic_time);
+  printf("fixed size propagateStep : %8.3f us\n", 1e6 * fixed_time);
+  printf("difference of final positions : %g\n", fabs(dynamic_checksum - fixed_checksum) / num_repetitions);
+  return 0;
+}
@@ -16,12 +16,15 @@
 #include <string>
 #include <vector>
 #include <stdio.h>
+#include <math.h>
 
 #include <dmp_lib/icra2009_dynamic_movement_primitive.h>
+#include <dmp_lib/icra2009_fixed_dynamic_movement_primitive.h>
 #include <dmp_lib/logger.h>
 
 // local includes
 #include "icra2009_test.h"
+#include "malloc_hook.h"
 
 using namespace dmp_lib;
 using namespace std;
@@ -140,4 +143,215 @@ bool ICRA2009Test::initialize(ICRA2009DMP& dmp, const TestData& testdata)
   return true;
 }
 
+bool ICRA2009Test::testBatchPropagation(const TestData& testdata)
+{
+  const int num_dmps = 3;
+  const double sampling_frequency = 300.0;
+  const double duration = 1.0;
+  const int num_samples = static_cast<int> (duration * sampling_frequency);
+  const double error_threshold = 1e-6;
+
+  vector<DMPPtr> dmps;
+  vector<Trajectory> expected_trajectories(num_dmps);
+  for (int i = 0; i < num_dmps; ++i)
+  {
+    ICRA2009DMPPtr dmp(new ICRA2009DMP());
+    if (!initialize(*dmp, testdata))
+    {
+      Logger::logPrintf("Could not initialize ICRA2009 DMP.", Logger::ERROR);
+      return false;
+    }
+    vector<double> start;
+    vector<double> goal;
+    for (int j = 0; j < dmp->getNumDimensions(); ++j)
+    {
+      start.push_back(0.1 * i);
+      goal.push_back(1.0 + i + j);
+    }
+    if (!dmp->learnFromMinimumJerk(start, goal, sampling_frequency, duration))
+    {
+      Logger::logPrintf("Could not learn DMP from minimum jerk trajectory.", Logger::ERROR);
+      return false;
+    }
+    // the canonical system value is not reset by setup, the first rollout after learning therefore starts from a different state
+    if (!dmp->setup() || !dmp->propagateFull(expected_trajectories[i], duration, num_samples)
+        || !dmp->setup() || !dmp->propagateFull(expected_trajectories[i], duration, num_samples) || !dmp->setup())
+    {
+      Logger::logPrintf("Could not propagate DMP.", Logger::ERROR);
+      return false;
+    }
+    dmps.push_back(dmp);
+  }
+
+  vector<Trajectory> trajectories;
+  if (!DynamicMovementPrimitive::propagateFull(dmps, trajectories, duration, num_samples))
+  {
+    Logger::logPrintf("Could not propagate DMPs in a batch.", Logger::ERROR);
+    return false;
+  }
+  if (!isEqual(trajectories, expected_trajectories, error_threshold))
+  {
+    Logger::logPrintf("Batch propagation of multiple DMPs failed.", Logger::ERROR);
+    return false;
+  }
+
+  // propagate multiple sets of thetas of the same DMP
+  vector<VectorXd> thetas;
+  if (!dmps[0]->getThetas(thetas))
+  {
+    Logger::logPrintf("Could not get thetas from DMP.", Logger::ERROR);
+    return false;
+  }
+  vector<vector<VectorXd> > rollout_thetas(num_dmps, thetas);
+  for (int i = 0; i < num_dmps; ++i)
+  {
+    for (int j = 0; j < (int)thetas.size(); ++j)
+    {
+      rollout_thetas[i][j] = (1.0 + 0.1 * i) * thetas[j] + VectorXd::Constant(thetas[j].size(), 0.2 * i);
+    }
+    if (!dmps[0]->setThetas(rollout_thetas[i]) || !dmps[0]->setup() || !dmps[0]->propagateFull(expected_trajectories[i], duration, num_samples))
+    {
+      Logger::logPrintf("Could not propagate DMP.", Logger::ERROR);
+      return false;
+    }
+  }
+  if (!dmps[0]->setThetas(thetas) || !dmps[0]->setup())
+  {
+    Logger::logPrintf("Could not setup DMP.", Logger::ERROR);
+    return false;
+  }
+  if (!dmps[0]->propagateFull(rollout_thetas, trajectories, duration, num_samples))
+  {
+    Logger::logPrintf("Could not propagate multiple sets of thetas in a batch.", Logger::ERROR);
+    return false;
+  }
+  if (!isEqual(trajectories, expected_trajectories, error_threshold))
+  {
+    Logger::logPrintf("Batch propagation of multiple sets of thetas failed.", Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+bool ICRA2009Test::testFixedSizePropagation(const TestData& testdata)
+{
+  const int num_dimensions = 2;
+  const double sampling_frequency = 300.0;
+  const double duration = 1.0;
+  const int num_samples = static_cast<int> (duration * sampling_frequency);
+  const double error_threshold = 1e-6;
+
+  ICRA2009DMP dmp;
+  if (!initialize(dmp, testdata) || dmp.getNumDimensions() != num_dimensions)
+  {
+    Logger::logPrintf("Could not initialize >%i< dimensional ICRA2009 DMP.", Logger::ERROR, num_dimensions);
+    return false;
+  }
+  ICRA2009FixedDynamicMovementPrimitive<num_dimensions>::Vector start, goal;
+  for (int j = 0; j < num_dimensions; ++j)
+  {
+    start(j) = 0.1 * j;
+    goal(j) = 1.0 + j;
+  }
+  VectorXd dynamic_start = start;
+  VectorXd dynamic_goal = goal;
+  if (!dmp.learnFromMinimumJerk(dynamic_start, dynamic_goal, sampling_frequency, duration))
+  {
+    Logger::logPrintf("Could not learn DMP from minimum jerk trajectory.", Logger::ERROR);
+    return false;
+  }
+
+  ICRA2009FixedDynamicMovementPrimitive<num_dimensions> fixed_dmp;
+  if (!fixed_dmp.initialize(dmp))
+  {
+    Logger::logPrintf("Could not initialize fixed size ICRA2009 DMP.", Logger::ERROR);
+    return false;
+  }
+
+  // propagate twice since the first rollout after learning starts from a different canonical system state
+  vector<Trajectory> expected_trajectories(1);
+  vector<Trajectory> trajectories(1);
+  for (int i = 0; i < 2; ++i)
+  {
+    goal(0) += 0.5;
+    dynamic_goal = goal;
+    if (!dmp.setup(dynamic_start, dynamic_goal, duration, sampling_frequency) || !dmp.propagateFull(expected_trajectories[0], duration, num_samples)
+        || !fixed_dmp.setup(start, goal, duration, sampling_frequency) || !fixed_dmp.propagateFull(trajectories[0], duration, num_samples))
+    {
+      Logger::logPrintf("Could not propagate DMPs.", Logger::ERROR);
+      return false;
+    }
+    if (!isEqual(trajectories, expected_trajectories, error_threshold))
+    {
+      Logger::logPrintf("Rollout >%i< of the fixed size DMP differs from the dynamic DMP.", Logger::ERROR, i);
+      return false;
+    }
+  }
+
+  if (!fixed_dmp.setup(start, goal, duration, sampling_frequency))
+  {
+    Logger::logPrintf("Could not setup fixed size ICRA2009 DMP.", Logger::ERROR);
+    return false;
+  }
+  ICRA2009FixedDynamicMovementPrimitive<num_dimensions>::Vector desired_positions, desired_velocities, desired_accelerations;
+  bool movement_finished = false;
+  while (!movement_finished)
+  {
+    resetThreadAllocInfo();
+    if (!fixed_dmp.propagateStep(desired_positions, desired_velocities, desired_accelerations, movement_finished))
+    {
+      Logger::logPrintf("Could not propagate fixed size DMP.", Logger::ERROR);
+      return false;
+    }
+    if (getThreadAllocInfo().total_ops != 0)
+    {
+      Logger::logPrintf("Propagating the fixed size DMP performed >%i< heap operations (Real-time violation).", Logger::ERROR,
+                        (int)getThreadAllocInfo().total_ops);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ICRA2009Test::isEqual(const vector<Trajectory>& trajectories,
+                           const vector<Trajectory>& expected_trajectories,
+                           const double error_threshold)
+{
+  if (trajectories.size() != expected_trajectories.size())
+  {
+    Logger::logPrintf("Number of trajectories >%i< does not match expected number >%i<.", Logger::ERROR,
+                      (int)trajectories.size(), (int)expected_trajectories.size());
+    return false;
+  }
+  for (int i = 0; i < (int)trajectories.size(); ++i)
+  {
+    if ((trajectories[i].getNumContainedSamples() != expected_trajectories[i].getNumContainedSamples())
+        || (trajectories[i].getDimension() != expected_trajectories[i].getDimension()))
+    {
+      Logger::logPrintf("Size of trajectory >%i< does not match.", Logger::ERROR, i);
+      return false;
+    }
+    for (int n = 0; n < trajectories[i].getNumContainedSamples(); ++n)
+    {
+      for (int j = 0; j < trajectories[i].getDimension(); ++j)
+      {
+        double x, xd, xdd, expected_x, expected_xd, expected_xdd;
+        if (!trajectories[i].getTrajectoryPosition(n, j, x) || !trajectories[i].getTrajectoryVelocity(n, j, xd)
+            || !trajectories[i].getTrajectoryAcceleration(n, j, xdd) || !expected_trajectories[i].getTrajectoryPosition(n, j, expected_x)
+            || !expected_trajectories[i].getTrajectoryVelocity(n, j, expected_xd)
+            || !expected_trajectories[i].getTrajectoryAcceleration(n, j, expected_xdd))
+        {
+          return false;
+        }
+        if ((fabs(x - expected_x) > error_threshold) || (fabs(xd - expected_xd) > error_threshold) || (fabs(xdd - expected_xdd) > error_threshold))
+        {
+          Logger::logPrintf("Sample >%i< of dimension >%i< of trajectory >%i< differs by more than >%f<.", Logger::ERROR, n, j, i, error_threshold);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 }
@@ -16,7 +16,9 @@
 #define ICRA2009_TEST_H_
 
 // system includes
+#include <vector>
 #include <dmp_lib/icra2009_dynamic_movement_primitive.h>
+#include <dmp_lib/trajectory.h>
 
 // local includes
 #include "test_data.h"
@@ -31,8 +33,22 @@ public:
 
   static bool initialize(dmp_lib::ICRA2009DMP& dmp, const TestData& testdata);
 
+  /*! Checks that propagating multiple DMPs (and multiple sets of thetas) in one batch yields the
+   * same rollouts as propagating them one after the other
+   */
+  static bool testBatchPropagation(const TestData& testdata);
+
+  /*! Checks that the fixed size DMP yields the same rollout as the DMP it has been initialized from
+   * and that propagating it does not allocate memory
+   */
+  static bool testFixedSizePropagation(const TestData& testdata);
+
 private:
 
+  static bool isEqual(const std::vector<dmp_lib::Trajectory>& trajectories,
+                      const std::vector<dmp_lib::Trajectory>& expected_trajectories,
+                      const double error_threshold);
+
   ICRA2009Test() {};
   virtual ~ICRA2009Test() {};
 
@@ -0,0 +1,120 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		...
+
+ \file		malloc_hook.cpp
+
+ \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+// local includes
+#include "malloc_hook.h"
+
+// glibc provides its internal allocator under these names, which avoids the dlsym bootstrapping problem
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t nmemb, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t boundary, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace test_dmp
+{
+namespace detail
+{
+
+__thread uint64_t g_mallocs = 0;
+__thread uint64_t g_callocs = 0;
+__thread uint64_t g_reallocs = 0;
+__thread uint64_t g_memaligns = 0;
+__thread uint64_t g_frees = 0;
+__thread uint64_t g_total_ops = 0;
+
+}
+
+AllocInfo getThreadAllocInfo()
+{
+  AllocInfo info;
+  info.mallocs = detail::g_mallocs;
+  info.callocs = detail::g_callocs;
+  info.reallocs = detail::g_reallocs;
+  info.memaligns = detail::g_memaligns;
+  info.frees = detail::g_frees;
+  info.total_ops = detail::g_total_ops;
+  return info;
+}
+
+void resetThreadAllocInfo()
+{
+  detail::g_mallocs = 0;
+  detail::g_callocs = 0;
+  detail::g_reallocs = 0;
+  detail::g_memaligns = 0;
+  detail::g_frees = 0;
+  detail::g_total_ops = 0;
+}
+
+}
+
+extern "C"
+{
+
+void* malloc(size_t size)
+{
+  ++test_dmp::detail::g_mallocs;
+  ++test_dmp::detail::g_total_ops;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size)
+{
+  ++test_dmp::detail::g_callocs;
+  ++test_dmp::detail::g_total_ops;
+  return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+  ++test_dmp::detail::g_reallocs;
+  ++test_dmp::detail::g_total_ops;
+  return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t boundary, size_t size)
+{
+  ++test_dmp::detail::g_memaligns;
+  ++test_dmp::detail::g_total_ops;
+  return __libc_memalign(boundary, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+  ++test_dmp::detail::g_memaligns;
+  ++test_dmp::detail::g_total_ops;
+  *ptr = __libc_memalign(alignment, size);
+  if (*ptr == NULL)
+  {
+    return ENOMEM;
+  }
+  return 0;
+}
+
+void free(void* ptr)
+{
+  ++test_dmp::detail::g_frees;
+  ++test_dmp::detail::g_total_ops;
+  __libc_free(ptr);
+}
+
+}
@@ -0,0 +1,50 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Counts heap allocations of the calling thread by wrapping
+            malloc, calloc, realloc, memalign, posix_memalign and free
+            (similar to the rosrt malloc wrappers).
+
+ \file		malloc_hook.h
+
+ \date		Oct 17, 2026
+
+ *********************************************************************/
+
+#ifndef MALLOC_HOOK_H_
+#define MALLOC_HOOK_H_
+
+// system includes
+#include <stdint.h>
+
+namespace test_dmp
+{
+
+/*! Allocation statistics of a single thread
+ */
+struct AllocInfo
+{
+  AllocInfo() :
+    mallocs(0), callocs(0), reallocs(0), memaligns(0), frees(0), total_ops(0) {};
+  uint64_t mallocs;
+  uint64_t callocs;
+  uint64_t reallocs;
+  uint64_t memaligns;
+  uint64_t frees;
+  uint64_t total_ops;
+};
+
+/*!
+ * @return Allocation statistics of the calling thread since the last reset
+ */
+AllocInfo getThreadAllocInfo();
+
+/*! Resets the allocation statistics of the calling thread
+ */
+void resetThreadAllocInfo();
+
+}
+
+#endif /* MALLOC_HOOK_H_ */
@@ -106,6 +106,18 @@ inline bool Test::test(const std::string base_directory, const bool regenerate_r
     return false;
   }
 
+  if (!test_dmp::ICRA2009Test::testBatchPropagation(testdata))
+  {
+    dmp_lib::Logger::logPrintf("ICRA2009 batch propagation test failed.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  if (!test_dmp::ICRA2009Test::testFixedSizePropagation(testdata))
+  {
+    dmp_lib::Logger::logPrintf("ICRA2009 fixed size propagation test failed.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
   dmp_lib::Logger::logPrintf("Test finished successful.", dmp_lib::Logger::INFO);
   return true;
 }
@@ -29,6 +29,9 @@
 #include <dmp_lib/trajectory.h>
 #include <dmp_lib/logger.h>
 
+// local includes
+#include "malloc_hook.h"
+
 namespace test_dmp
 {
 
@@ -185,11 +188,20 @@ template<class DMPType>
     bool movement_finished = false;
     while (!movement_finished)
     {
+      resetThreadAllocInfo();
       if (!dmp.propagateStep(desired_positions, desired_velocities, desired_accelerations, movement_finished, duration, num_samples))
       {
         dmp_lib::Logger::logPrintf("Could not propagate the DMP.", dmp_lib::Logger::ERROR);
         return false;
       }
+      // propagating the DMP must not touch the heap since it is called from within real-time loops
+      AllocInfo alloc_info = getThreadAllocInfo();
+      if (alloc_info.total_ops != 0)
+      {
+        dmp_lib::Logger::logPrintf("Propagating the DMP one step performed >%i< heap operations (>%i< mallocs, >%i< frees). (Real-time violation).",
+                                   dmp_lib::Logger::ERROR, (int)alloc_info.total_ops, (int)alloc_info.mallocs, (int)alloc_info.frees);
+        return false;
+      }
 
       // log debug variables
       int log_index = 0;
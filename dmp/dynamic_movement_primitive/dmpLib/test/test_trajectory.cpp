@@ -87,6 +87,31 @@ bool TestTrajectory::test(const string& filename, const TestData& testdata, cons
     return false;
   }
 
+  Trajectory pos_window_trajectory;
+  const double window_start_time = 0.5 * pos_trajectory.getDuration();
+  const double window_end_time = pos_trajectory.getDuration();
+  fname.assign(data_directory_name + filename + prefix);
+  if (!pos_window_trajectory.readFromCLMCFile(fname, variable_names, window_start_time, window_end_time, true))
+  {
+    dmp_lib::Logger::logPrintf("Could not read time window of clmc file >%s<.", Logger::ERROR, fname.c_str());
+    return false;
+  }
+  const int window_offset = pos_trajectory.getNumContainedSamples() - pos_window_trajectory.getNumContainedSamples();
+  for (int i = 0; i < pos_window_trajectory.getNumContainedSamples(); ++i)
+  {
+    for (int j = 0; j < pos_window_trajectory.getDimension(); ++j)
+    {
+      double window_position, position;
+      if (!pos_window_trajectory.getTrajectoryPosition(i, j, window_position)
+          || !pos_trajectory.getTrajectoryPosition(i + window_offset, j, position)
+          || window_position != position)
+      {
+        dmp_lib::Logger::logPrintf("Time window of clmc file >%s< does not match the full trajectory.", Logger::ERROR, fname.c_str());
+        return false;
+      }
+    }
+  }
+
   Trajectory pos_trajectory_copy;
   pos_trajectory_copy = pos_trajectory;
   fname.assign(result_directory_name + filename + string("_pos_vel_acc_copy") + prefix);
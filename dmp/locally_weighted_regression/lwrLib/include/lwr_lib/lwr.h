@@ -199,6 +199,18 @@ public:
      */
     bool generateBasisFunctionMatrix(const Eigen::VectorXd& x_input_vector, Eigen::MatrixXd& basis_function_matrix) const;
 
+    /*! Generates the basis function matrix, kernels whose activation is below activation_threshold are set to zero
+     * without being evaluated. If the inputs are sorted (like the phase variable of a canonical system) the
+     * support of each kernel is found by bisection.
+     * @param x_input_vector
+     * @param basis_function_matrix
+     * @param activation_threshold
+     * @return True on success, false on failure
+     */
+    bool generateBasisFunctionMatrix(const Eigen::VectorXd& x_input_vector,
+                                     Eigen::MatrixXd& basis_function_matrix,
+                                     const double activation_threshold) const;
+
     /*!
      * @param x_input
      * @param basis_functions
@@ -230,6 +242,16 @@ private:
      */
     double evaluateKernel(const double x_input, const int center_index) const;
 
+    /*! Fills the basis function matrix in blocks of samples, one kernel (column) at a time, such that the
+     * exponentials are evaluated vectorized over contiguous memory
+     * @param x_input_vector
+     * @param basis_function_matrix Must be of size x_input_vector.size() x num_rfs
+     * @param activation_threshold
+     */
+    void fillBasisFunctionMatrix(const Eigen::VectorXd& x_input_vector,
+                                 Eigen::MatrixXd& basis_function_matrix,
+                                 const double activation_threshold) const;
+
 };
 
 /*! Abbreviation for convinience
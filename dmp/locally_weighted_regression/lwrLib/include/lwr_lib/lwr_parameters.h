@@ -227,6 +227,11 @@ private:
      */
     Eigen::VectorXd widths_;
 
+    /*! Inverse of the bandwidths (1.0 / widths_), kept in sync with widths_ such that
+     * evaluating a kernel does not require a division
+     */
+    Eigen::VectorXd inverse_widths_;
+
     /*! Slopes of the local linear approximations
      */
     Eigen::VectorXd slopes_;
@@ -235,6 +240,10 @@ private:
      */
     Eigen::VectorXd offsets_;
 
+    /*! Needs to be called whenever widths_ changes
+     */
+    void updateInverseWidths();
+
 };
 
 
@@ -14,7 +14,10 @@
 
 // system include
 #include <stdio.h>
+#include <math.h>
 #include <cassert>
+#include <algorithm>
+#include <functional>
 
 // local include
 #include <lwr_lib/lwr.h>
@@ -27,6 +30,15 @@ using namespace std;
 namespace lwr_lib
 {
 
+/*! Number of samples that are processed at once when filling the basis function matrix
+ */
+static const int BASIS_FUNCTION_BLOCK_SIZE = 256;
+
+/*! Kernel exponents are clamped to this value such that the vectorized exp does not produce denormals,
+ * the resulting activations (< 1e-307) are numerically zero
+ */
+static const double MIN_KERNEL_EXPONENT = -708.0;
+
 LWR& LWR::operator=(const LWR& lwr_model)
 {
   Logger::logPrintf("LWR assignment.", Logger::DEBUG);
@@ -55,11 +67,88 @@ double LWR::evaluateKernel(const double x_input,
                            const int center_index) const
 {
   assert(parameters_->initialized_);
-  return exp(-(static_cast<double> (1.0) / parameters_->widths_(center_index)) * pow(x_input - parameters_->centers_(center_index), 2));
+  const double diff = x_input - parameters_->centers_(center_index);
+  return exp(-parameters_->inverse_widths_(center_index) * diff * diff);
+}
+
+void LWR::fillBasisFunctionMatrix(const VectorXd& x_input_vector,
+                                  MatrixXd& basis_function_matrix,
+                                  const double activation_threshold) const
+{
+  const int num_samples = x_input_vector.size();
+  const int num_rfs = parameters_->centers_.size();
+
+  if (activation_threshold <= 0.0)
+  {
+    for (int block_start = 0; block_start < num_samples; block_start += BASIS_FUNCTION_BLOCK_SIZE)
+    {
+      const int block_size = std::min(BASIS_FUNCTION_BLOCK_SIZE, num_samples - block_start);
+      const VectorXd::ConstSegmentReturnType x_block = x_input_vector.segment(block_start, block_size);
+      for (int j = 0; j < num_rfs; ++j)
+      {
+        basis_function_matrix.col(j).segment(block_start, block_size).array()
+            = (-parameters_->inverse_widths_(j) * (x_block.array() - parameters_->centers_(j)).square()).max(MIN_KERNEL_EXPONENT).exp();
+      }
+    }
+    return;
+  }
+
+  // kernels are truncated where exp(-inverse_width * (x - center)^2) < activation_threshold
+  const double max_exponent = -log(activation_threshold);
+  const double* x_begin = x_input_vector.data();
+  const double* x_end = x_begin + num_samples;
+  const bool ascending = (num_samples < 2) || (std::adjacent_find(x_begin, x_end, std::greater<double>()) == x_end);
+  const bool descending = !ascending && (std::adjacent_find(x_begin, x_end, std::less<double>()) == x_end);
+
+  basis_function_matrix.setZero();
+  for (int j = 0; j < num_rfs; ++j)
+  {
+    const double center = parameters_->centers_(j);
+    const double inverse_width = parameters_->inverse_widths_(j);
+    if (ascending || descending)
+    {
+      const double radius = sqrt(max_exponent / inverse_width);
+      int start, end;
+      if (ascending)
+      {
+        start = std::lower_bound(x_begin, x_end, center - radius) - x_begin;
+        end = std::upper_bound(x_begin, x_end, center + radius) - x_begin;
+      }
+      else
+      {
+        start = std::lower_bound(x_begin, x_end, center + radius, std::greater<double>()) - x_begin;
+        end = std::upper_bound(x_begin, x_end, center - radius, std::greater<double>()) - x_begin;
+      }
+      if (end > start)
+      {
+        basis_function_matrix.col(j).segment(start, end - start).array()
+            = (-inverse_width * (x_input_vector.segment(start, end - start).array() - center).square()).exp();
+      }
+    }
+    else
+    {
+      for (int i = 0; i < num_samples; ++i)
+      {
+        const double diff = x_begin[i] - center;
+        const double exponent = inverse_width * diff * diff;
+        if (exponent < max_exponent)
+        {
+          basis_function_matrix(i, j) = exp(-exponent);
+        }
+      }
+    }
+  }
 }
 
 bool LWR::generateBasisFunctionMatrix(const VectorXd& x_input_vector,
                                       MatrixXd& basis_function_matrix) const
+{
+  return generateBasisFunctionMatrix(x_input_vector, basis_function_matrix, 0.0);
+}
+
+bool LWR::generateBasisFunctionMatrix(const VectorXd& x_input_vector,
+                                      MatrixXd& basis_function_matrix,
+                                      const double activation_threshold) const
 {
   if(x_input_vector.size() == 0)
   {
@@ -73,14 +162,12 @@ bool LWR::generateBasisFunctionMatrix(const VectorXd& x_input_vector,
                       Logger::ERROR, basis_function_matrix.rows(), basis_function_matrix.cols(), x_input_vector.size(), parameters_->centers_.size());
     return false;
   }
-  for (int i = 0; i < x_input_vector.size(); ++i)
+  if (activation_threshold < 0.0 || activation_threshold >= 1.0)
   {
-    // TODO: think about using the generateBasisFunction function
-    for (int j = 0; j < parameters_->centers_.size(); ++j)
-    {
-      basis_function_matrix(i, j) = evaluateKernel(x_input_vector[i], j);
-    }
+    Logger::logPrintf("Activation threshold >%f< is invalid, it must be within [0, 1).", Logger::ERROR, activation_threshold);
+    return false;
   }
+  fillBasisFunctionMatrix(x_input_vector, basis_function_matrix, activation_threshold);
   return true;
 }
 
@@ -59,6 +59,7 @@ bool LWRParameters::initialize(const VectorXd& centers,
   widths_ = widths;
   slopes_ = slopes;
   offsets_ = offsets;
+  updateInverseWidths();
   return (initialized_ = true);
 }
 
@@ -148,6 +149,7 @@ bool LWRParameters::initialize(const int num_rfs,
       widths_(i) = width;
     }
   }
+  updateInverseWidths();
 
   return (initialized_ = true);
 }
@@ -206,6 +208,11 @@ bool LWRParameters::setNumRFS(const int num_rfs)
   return true;
 }
 
+void LWRParameters::updateInverseWidths()
+{
+  inverse_widths_ = widths_.array().inverse().matrix();
+}
+
 int LWRParameters::getNumRFS() const
 {
   return num_rfs_;
@@ -218,6 +225,7 @@ bool LWRParameters::setWidthsAndCenters(const VectorXd& widths,
   assert((centers.cols() == centers_.cols()) && (centers.rows() == centers_.rows()));
   widths_ = widths;
   centers_ = centers;
+  updateInverseWidths();
   return true;
 }
 
@@ -231,6 +239,7 @@ bool LWRParameters::setWidthsAndCenters(const vector<double>& widths,
     widths_(i) = widths[i];
     centers_(i) = centers[i];
   }
+  updateInverseWidths();
   return true;
 }
 
@@ -0,0 +1,119 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Micro benchmark of the basis function evaluation.
+
+ \file		lwr_benchmark.cpp
+
+ \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <Eigen/Core>
+
+// local includes
+#include <lwr_lib/lwr.h>
+#include <lwr_lib/logger.h>
+
+using namespace Eigen;
+using namespace lwr_lib;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+/*! Reference implementation: one exp/pow and one division per (sample, center) pair
+ */
+static void generateBasisFunctionMatrixReference(const VectorXd& x, const VectorXd& widths, const VectorXd& centers, MatrixXd& basis_functions)
+{
+  for (int i = 0; i < x.size(); ++i)
+  {
+    for (int j = 0; j < centers.size(); ++j)
+    {
+      basis_functions(i, j) = exp(-(static_cast<double> (1.0) / widths(j)) * pow(x(i) - centers(j), 2));
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const int num_samples = (argc > 1) ? atoi(argv[1]) : 10000;
+  const int num_rfs = (argc > 2) ? atoi(argv[2]) : 100;
+  const int num_repetitions = 20;
+
+  LWRParamPtr parameters(new LWRParameters());
+  if (!parameters->initialize(num_rfs, 0.5, true, 0.001))
+  {
+    return -1;
+  }
+  LWR lwr;
+  if (!lwr.initialize(parameters))
+  {
+    return -1;
+  }
+
+  // phase variable of a canonical system, decaying from 1 to 0.001
+  VectorXd x = VectorXd::Zero(num_samples);
+  for (int i = 0; i < num_samples; ++i)
+  {
+    x(i) = exp(log(0.001) * static_cast<double> (i) / (num_samples - 1));
+  }
+  VectorXd widths = VectorXd::Zero(num_rfs);
+  VectorXd centers = VectorXd::Zero(num_rfs);
+  lwr.getWidthsAndCenters(widths, centers);
+  lwr.setThetas(VectorXd::Ones(num_rfs));
+
+  MatrixXd reference = MatrixXd::Zero(num_samples, num_rfs);
+  double start = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    generateBasisFunctionMatrixReference(x, widths, centers, reference);
+  }
+  const double reference_time = (now() - start) / num_repetitions;
+
+  MatrixXd dense = MatrixXd::Zero(num_samples, num_rfs);
+  start = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    lwr.generateBasisFunctionMatrix(x, dense);
+  }
+  const double dense_time = (now() - start) / num_repetitions;
+
+  MatrixXd truncated = MatrixXd::Zero(num_samples, num_rfs);
+  const double activation_threshold = 1e-8;
+  start = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    lwr.generateBasisFunctionMatrix(x, truncated, activation_threshold);
+  }
+  const double truncated_time = (now() - start) / num_repetitions;
+
+  VectorXd scalar_predictions = VectorXd::Zero(num_samples);
+  start = now();
+  for (int r = 0; r < num_repetitions; ++r)
+  {
+    for (int i = 0; i < num_samples; ++i)
+    {
+      lwr.predict(x(i), scalar_predictions(i));
+    }
+  }
+  const double scalar_predict_time = (now() - start) / num_repetitions;
+
+  printf("%i samples, %i receptive fields\n", num_samples, num_rfs);
+  printf("reference basis function matrix : %8.3f ms\n", 1e3 * reference_time);
+  printf("blocked/vectorized              : %8.3f ms (max error %g)\n", 1e3 * dense_time, (dense - reference).cwiseAbs().maxCoeff());
+  printf("truncated (threshold %g)     : %8.3f ms (max error %g)\n", activation_threshold, 1e3 * truncated_time, (truncated - reference).cwiseAbs().maxCoeff());
+  printf("scalar predict                  : %8.3f ms\n", 1e3 * scalar_predict_time);
+  return 0;
+}
@@ -133,6 +133,26 @@ bool LWRTest::testLearning()
     }
   }
 
+  // truncated kernels must only drop activations below the threshold
+  double activation_threshold = 1e-6;
+  MatrixXd basis_functions = MatrixXd::Zero(test_xq.size(), lwr_->getNumRFS());
+  MatrixXd truncated_basis_functions = MatrixXd::Zero(test_xq.size(), lwr_->getNumRFS());
+  MatrixXd reversed_basis_functions = MatrixXd::Zero(test_xq.size(), lwr_->getNumRFS());
+  VectorXd reversed_test_xq = test_xq.reverse();
+  if (!lwr_->generateBasisFunctionMatrix(test_xq, basis_functions)
+      || !lwr_->generateBasisFunctionMatrix(test_xq, truncated_basis_functions, activation_threshold)
+      || !lwr_->generateBasisFunctionMatrix(reversed_test_xq, reversed_basis_functions, activation_threshold))
+  {
+    Logger::logPrintf("Could not generate basis function matrix.", Logger::ERROR);
+    return false;
+  }
+  if (((basis_functions - truncated_basis_functions).cwiseAbs().maxCoeff() > activation_threshold)
+      || ((basis_functions - reversed_basis_functions.colwise().reverse()).cwiseAbs().maxCoeff() > activation_threshold))
+  {
+    Logger::logPrintf("Truncated basis functions differ by more than >%f<.", Logger::ERROR, activation_threshold);
+    return false;
+  }
+
   // log data
   std::ofstream outfile;
   outfile.open(std::string(std::string("test_x.txt")).c_str());
@@ -0,0 +1,369 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks   Writes messages to a bag file while they are recorded. Messages
+            are collected in chunks which are handed to a dedicated I/O
+            thread through a bounded queue, so at most
+            (queue_capacity + 2) * chunk_size messages are kept in memory.
+
+ \file    streaming_bag_writer.h
+
+ \date    Oct 17, 2026
+
+ *********************************************************************/
+
+#ifndef STREAMING_BAG_WRITER_H_
+#define STREAMING_BAG_WRITER_H_
+
+// system includes
+#include <deque>
+#include <vector>
+#include <string>
+
+// ros includes
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <usc_utilities/assert.h>
+
+// local includes
+
+namespace task_recorder2
+{
+
+/*! Backpressure metrics of a StreamingBagWriter
+ */
+struct StreamingBagWriterStatistics
+{
+  StreamingBagWriterStatistics() :
+    num_added(0), num_written(0), num_dropped(0), num_blocked(0), max_queue_length(0),
+    blocked_duration(0.0), max_blocked_duration(0.0), write_duration(0.0) {};
+
+  int num_added;                /*!< messages passed to add() */
+  int num_written;              /*!< messages written to the bag file */
+  int num_dropped;              /*!< messages dropped because the queue was full (if not blocking) */
+  int num_blocked;              /*!< times add() had to wait for the I/O thread */
+  int max_queue_length;         /*!< maximum number of chunks waiting to be written */
+  double blocked_duration;      /*!< total time add() waited for the I/O thread */
+  double max_blocked_duration;  /*!< longest time add() waited for the I/O thread */
+  double write_duration;        /*!< time the I/O thread spent writing */
+};
+
+template<class MessageType>
+  class StreamingBagWriter
+  {
+
+  public:
+
+    static const int DEFAULT_CHUNK_SIZE = 100;
+    static const int DEFAULT_QUEUE_CAPACITY = 20;
+
+    /*! Constructor
+     * @param chunk_size Number of messages that are handed to the I/O thread at once
+     * @param queue_capacity Maximum number of chunks waiting to be written
+     * @param block_when_full If true, add() waits for the I/O thread when the queue is full,
+     * otherwise the messages of the chunk are dropped
+     */
+    StreamingBagWriter(const int chunk_size = DEFAULT_CHUNK_SIZE,
+                       const int queue_capacity = DEFAULT_QUEUE_CAPACITY,
+                       const bool block_when_full = true) :
+      chunk_size_(chunk_size), queue_capacity_(queue_capacity), block_when_full_(block_when_full),
+      running_(false), stopping_(false), failed_(false)
+    {
+      ROS_ASSERT(chunk_size_ > 0);
+      ROS_ASSERT(queue_capacity_ > 0);
+    };
+
+    /*! Destructor
+     */
+    virtual ~StreamingBagWriter()
+    {
+      if (running_)
+      {
+        stop();
+      }
+    };
+
+    /*! Opens the bag file and starts the I/O thread
+     * @param abs_bag_file_name
+     * @param topic_name
+     * @return True on success, otherwise False
+     */
+    bool start(const std::string& abs_bag_file_name,
+               const std::string& topic_name);
+
+    /*! Must only be called from one thread at a time
+     * @param message
+     * @return True on success, False if the message has been dropped or writing failed
+     */
+    bool add(const MessageType& message);
+
+    /*! Writes the remaining messages, stops the I/O thread and closes the bag file
+     * @return True if all messages have been written, otherwise False
+     */
+    bool stop();
+
+    /*!
+     * @return True if the writer has been started and not stopped yet
+     */
+    bool isRunning() const
+    {
+      return running_;
+    }
+
+    /*!
+     * @param statistics of the current (or last) bag file
+     */
+    void getStatistics(StreamingBagWriterStatistics& statistics);
+
+  private:
+
+    typedef std::vector<MessageType> Chunk;
+    typedef boost::shared_ptr<Chunk> ChunkPtr;
+
+    int chunk_size_;
+    int queue_capacity_;
+    bool block_when_full_;
+
+    std::string topic_name_;
+    std::string abs_bag_file_name_;
+    rosbag::Bag bag_;
+    boost::shared_ptr<boost::thread> io_thread_;
+    bool running_;
+
+    /*! Only accessed by the thread calling add()
+     */
+    ChunkPtr current_chunk_;
+    int current_chunk_size_;
+
+    /*! Protected by mutex_
+     */
+    boost::mutex mutex_;
+    boost::condition_variable queue_condition_;
+    boost::condition_variable space_condition_;
+    std::deque<std::pair<ChunkPtr, int> > queue_;
+    std::vector<ChunkPtr> free_chunks_;
+    bool stopping_;
+    bool failed_;
+    StreamingBagWriterStatistics statistics_;
+
+    /*!
+     * @return A chunk of chunk_size_ messages
+     */
+    ChunkPtr getFreeChunk();
+
+    /*! Hands the current chunk to the I/O thread
+     * @return True on success, otherwise False
+     */
+    bool flush();
+
+    /*!
+     */
+    void run();
+
+  };
+
+template<class MessageType>
+  bool StreamingBagWriter<MessageType>::start(const std::string& abs_bag_file_name,
+                                              const std::string& topic_name)
+  {
+    if (running_)
+    {
+      ROS_ERROR("Streaming bag writer is already writing to >%s<.", abs_bag_file_name_.c_str());
+      return false;
+    }
+    abs_bag_file_name_ = abs_bag_file_name;
+    topic_name_ = topic_name;
+    try
+    {
+      bag_.open(abs_bag_file_name_, rosbag::bagmode::Write);
+    }
+    catch (rosbag::BagIOException& ex)
+    {
+      ROS_ERROR("Problem when opening bag file named >%s< : %s.", abs_bag_file_name_.c_str(), ex.what());
+      return false;
+    }
+
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      statistics_ = StreamingBagWriterStatistics();
+      stopping_ = false;
+      failed_ = false;
+    }
+    current_chunk_ = getFreeChunk();
+    current_chunk_size_ = 0;
+    io_thread_.reset(new boost::thread(boost::bind(&StreamingBagWriter<MessageType>::run, this)));
+    return (running_ = true);
+  }
+
+template<class MessageType>
+  bool StreamingBagWriter<MessageType>::add(const MessageType& message)
+  {
+    ROS_ASSERT_MSG(running_, "Streaming bag writer is not running.");
+    // assigning to a recycled message reuses its memory
+    (*current_chunk_)[current_chunk_size_] = message;
+    current_chunk_size_++;
+    if (current_chunk_size_ < chunk_size_)
+    {
+      return true;
+    }
+    return flush();
+  }
+
+template<class MessageType>
+  bool StreamingBagWriter<MessageType>::flush()
+  {
+    if (current_chunk_size_ == 0)
+    {
+      return true;
+    }
+    boost::mutex::scoped_lock lock(mutex_);
+    statistics_.num_added += current_chunk_size_;
+    if (failed_)
+    {
+      statistics_.num_dropped += current_chunk_size_;
+      current_chunk_size_ = 0;
+      return false;
+    }
+
+    if (static_cast<int>(queue_.size()) >= queue_capacity_)
+    {
+      if (!block_when_full_)
+      {
+        statistics_.num_dropped += current_chunk_size_;
+        current_chunk_size_ = 0;
+        return false;
+      }
+      ros::WallTime start_time = ros::WallTime::now();
+      while (static_cast<int>(queue_.size()) >= queue_capacity_)
+      {
+        space_condition_.wait(lock);
+      }
+      const double blocked_duration = (ros::WallTime::now() - start_time).toSec();
+      statistics_.num_blocked++;
+      statistics_.blocked_duration += blocked_duration;
+      statistics_.max_blocked_duration = std::max(statistics_.max_blocked_duration, blocked_duration);
+    }
+
+    queue_.push_back(std::make_pair(current_chunk_, current_chunk_size_));
+    statistics_.max_queue_length = std::max(statistics_.max_queue_length, static_cast<int>(queue_.size()));
+    queue_condition_.notify_one();
+    lock.unlock();
+
+    current_chunk_ = getFreeChunk();
+    current_chunk_size_ = 0;
+    return true;
+  }
+
+template<class MessageType>
+  typename StreamingBagWriter<MessageType>::ChunkPtr StreamingBagWriter<MessageType>::getFreeChunk()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (free_chunks_.empty())
+    {
+      return ChunkPtr(new Chunk(chunk_size_));
+    }
+    ChunkPtr chunk = free_chunks_.back();
+    free_chunks_.pop_back();
+    return chunk;
+  }
+
+template<class MessageType>
+  void StreamingBagWriter<MessageType>::run()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    while (true)
+    {
+      while (queue_.empty() && !stopping_)
+      {
+        queue_condition_.wait(lock);
+      }
+      if (queue_.empty())
+      {
+        return;
+      }
+      std::pair<ChunkPtr, int> chunk = queue_.front();
+      const bool failed = failed_;
+      lock.unlock();
+
+      ros::WallTime start_time = ros::WallTime::now();
+      bool written = false;
+      if (!failed)
+      {
+        try
+        {
+          for (int i = 0; i < chunk.second; ++i)
+          {
+            bag_.write(topic_name_, (*chunk.first)[i].header.stamp, (*chunk.first)[i]);
+          }
+          written = true;
+        }
+        catch (rosbag::BagException& ex)
+        {
+          ROS_ERROR("Problem when writing to bag file named >%s< : %s.", abs_bag_file_name_.c_str(), ex.what());
+        }
+      }
+      const double write_duration = (ros::WallTime::now() - start_time).toSec();
+
+      lock.lock();
+      queue_.pop_front();
+      free_chunks_.push_back(chunk.first);
+      statistics_.write_duration += write_duration;
+      if (written)
+      {
+        statistics_.num_written += chunk.second;
+      }
+      else
+      {
+        statistics_.num_dropped += chunk.second;
+        failed_ = true;
+      }
+      space_condition_.notify_one();
+    }
+  }
+
+template<class MessageType>
+  bool StreamingBagWriter<MessageType>::stop()
+  {
+    if (!running_)
+    {
+      ROS_ERROR("Streaming bag writer is not running.");
+      return false;
+    }
+    flush();
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      stopping_ = true;
+      queue_condition_.notify_one();
+    }
+    io_thread_->join();
+    io_thread_.reset();
+    running_ = false;
+
+    bool failed = failed_;
+    try
+    {
+      bag_.close();
+    }
+    catch (rosbag::BagException& ex)
+    {
+      ROS_ERROR("Problem when closing bag file named >%s< : %s.", abs_bag_file_name_.c_str(), ex.what());
+      failed = true;
+    }
+    return !failed;
+  }
+
+template<class MessageType>
+  void StreamingBagWriter<MessageType>::getStatistics(StreamingBagWriterStatistics& statistics)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    statistics = statistics_;
+  }
+
+}
+
+#endif /* STREAMING_BAG_WRITER_H_ */
@@ -32,6 +32,7 @@
 // #include <task_recorder2_utilities/accumulator.h>
 #include <task_recorder2_utilities/message_buffer.h>
 #include <task_recorder2_utilities/message_ring_buffer.h>
+#include <task_recorder2_utilities/data_sample_store.h>
 
 #include <task_recorder2_utilities/data_sample_utilities.h>
 #include <task_recorder2_utilities/task_description_utilities.h>
@@ -259,6 +260,7 @@ template<class MessageType>
     /*!
      */
     static const int MESSAGE_SUBSCRIBER_BUFFER_SIZE = 10000;
+    static const int NUMBER_OF_INITIALLY_RESERVED_SAMPLES = 20 * 300;
 
     /*!
      */
@@ -276,6 +278,11 @@ template<class MessageType>
     bool logging_;
     bool streaming_;
 
+    /*! Protects the raw data writer of recorder_io_. Writing raw data may block until the I/O thread
+     * catches up, it is therefore done without holding mutex_. Always locked after mutex_.
+     */
+    boost::mutex raw_data_mutex_;
+
     /*!
      */
     // task_recorder2_utilities::Accumulator accumulator_;
@@ -283,6 +290,11 @@ template<class MessageType>
     // boost::shared_ptr<task_recorder2_utilities::MessageBuffer> message_buffer_;
     task_recorder2_msgs::DataSample data_sample_;
 
+    /*! Recorded data samples, protected by mutex_. DataSample messages are only
+     * created for the filtered and cropped data, the raw data is streamed to disc while recording.
+     */
+    task_recorder2_utilities::DataSampleStore data_sample_store_;
+
     /*!
      */
     int num_signals_;
@@ -311,19 +323,23 @@ template<class MessageType>
     void recordMessagesCallback(const MessageTypeConstPtr message);
 
     /*!
-     * @param messages
+     * @param input_vector Time stamps of the recorded data samples
+     * @param variables Recorded values of each variable
+     * @param names of the variables
+     * @param first_time_stamp Time stamp of the first recorded data sample
      * @param start_time
      * @param end_time
      * @param num_samples
-     * @param message_names
      * @param resampled_messages
      * @return True on success, otherwise False
      */
-    bool resample(std::vector<task_recorder2_msgs::DataSample>& messages,
+    bool resample(const std::vector<double>& input_vector,
+                  const std::vector<std::vector<double> >& variables,
+                  const std::vector<std::string>& names,
+                  const ros::Time& first_time_stamp,
                   const ros::Time& start_time,
                   const ros::Time& end_time,
                   const int num_samples,
-                  const std::vector<std::string>& message_names,
                   std::vector<task_recorder2_msgs::DataSample>& resampled_messages);
 
     /*!
@@ -436,6 +452,8 @@ template<class MessageType>
     ROS_VERIFY(usc_utilities::write(private_node_handle, "variable_names", default_data_sample.names));
     default_data_sample.data.resize(default_data_sample.names.size(), 0.0);
     message_buffer_.reset(new task_recorder2_utilities::MessageRingBuffer(default_data_sample));
+    ROS_VERIFY(data_sample_store_.initialize(default_data_sample.names));
+    data_sample_store_.reserve(NUMBER_OF_INITIALLY_RESERVED_SAMPLES);
     return (initialized_ = true);
   }
 
@@ -462,8 +480,7 @@ template<class MessageType>
   void TaskRecorder<MessageType>::recordMessagesCallback(const MessageTypeConstPtr message)
   {
     // ROS_INFO("Callback for topic >%s<.", recorder_io_.topic_name_.c_str());
-    MessageType msg = *message;
-    if(!transformMsg(msg, data_sample_))
+    if(!transformMsg(*message, data_sample_))
     {
       return;
     }
@@ -475,12 +492,13 @@ template<class MessageType>
     }
     ROS_VERIFY(filter(data_sample_));
     mutex_.lock();
+    const bool logging = logging_;
     if (logging_)
     {
       // double delay = (ros::Time::now() - data_sample_.header.stamp).toSec();
       // ROS_INFO("Delay = %f", delay);
       // ROS_INFO("Logging >%s<.", recorder_io_.topic_name_.c_str());
-      recorder_io_.messages_.push_back(data_sample_);
+      ROS_VERIFY(data_sample_store_.add(data_sample_));
     }
     if (streaming_)
     {
@@ -488,6 +506,16 @@ template<class MessageType>
       ROS_VERIFY(message_buffer_->add(data_sample_));
     }
     mutex_.unlock();
+
+    // data_sample_ is only accessed by this callback
+    if (logging)
+    {
+      boost::mutex::scoped_lock raw_data_lock(raw_data_mutex_);
+      if (recorder_io_.isStreamingRawData() && !recorder_io_.streamRawData(data_sample_))
+      {
+        ROS_WARN_THROTTLE(1.0, "Could not write raw data sample of topic >%s<.", recorder_io_.topic_name_.c_str());
+      }
+    }
   }
 
 template<class MessageType>
@@ -500,10 +528,10 @@ template<class MessageType>
     {
       ros::spinOnce();
       mutex_.lock();
-      no_message = recorder_io_.messages_.empty();
+      no_message = data_sample_store_.empty();
       if (!no_message)
       {
-        abs_start_time_ = recorder_io_.messages_[0].header.stamp;
+        abs_start_time_ = data_sample_store_.getStamp(0);
       }
       mutex_.unlock();
       ros::Duration(0.01).sleep();
@@ -522,8 +550,14 @@ template<class MessageType>
     // message_subscriber_ = recorder_io_.node_handle_.subscribe(recorder_io_.topic_name_, MESSAGE_SUBSCRIBER_BUFFER_SIZE, &TaskRecorder<MessageType>::recordMessagesCallback, this);
     // }
     mutex_.lock();
+    raw_data_mutex_.lock();
+    if (recorder_io_.write_out_raw_data_ && !recorder_io_.startStreamingRawData())
+    {
+      ROS_ERROR("Could not start writing raw data of topic >%s<.", recorder_io_.topic_name_.c_str());
+    }
+    raw_data_mutex_.unlock();
     logging_ = true;
-    recorder_io_.messages_.clear();
+    data_sample_store_.clear();
     mutex_.unlock();
     ROS_VERIFY(startRecording());
     waitForMessages();
@@ -560,9 +594,9 @@ template<class MessageType>
     }
     first = abs_start_time_;
     mutex_.lock();
-    if (logging_)
+    if (logging_ && !data_sample_store_.empty())
     {
-      last = recorder_io_.messages_.back().header.stamp;
+      last = data_sample_store_.getStamp(data_sample_store_.size() - 1);
     }
     mutex_.unlock();
     return true;
@@ -638,6 +672,14 @@ template<class MessageType>
                                                      task_recorder2::InterruptRecording::Response& response)
   {
     setLogging(false);
+    mutex_.lock();
+    raw_data_mutex_.lock();
+    if (!recorder_io_.stopStreamingRawData())
+    {
+      ROS_ERROR("Could not write raw data of topic >%s<.", recorder_io_.topic_name_.c_str());
+    }
+    raw_data_mutex_.unlock();
+    mutex_.unlock();
     ROS_DEBUG("Interrupted recording topic >%s<.", recorder_io_.topic_name_.c_str());
     response.info = std::string("Stopped recording >" + recorder_io_.topic_name_ + "<. ");
     response.return_code = task_recorder2::InterruptRecording::Response::SERVICE_CALL_SUCCESSFUL;
@@ -661,7 +703,17 @@ template<class MessageType>
                                                 const std::vector<std::string>& message_names,
                                                 std::vector<task_recorder2_msgs::DataSample>& filter_and_cropped_messages)
   {
-    int num_messages = (int)recorder_io_.messages_.size();
+    // recordMessagesCallback keeps adding data samples unless recording has been stopped
+    boost::mutex::scoped_lock lock(mutex_);
+    if (!logging_)
+    {
+      boost::mutex::scoped_lock raw_data_lock(raw_data_mutex_);
+      if (!recorder_io_.stopStreamingRawData())
+      {
+        ROS_ERROR("Could not write raw data of topic >%s<.", recorder_io_.topic_name_.c_str());
+      }
+    }
+    int num_messages = data_sample_store_.size();
     if (num_messages == 0)
     {
       ROS_ERROR("Zero messages have been logged.");
@@ -675,17 +727,13 @@ template<class MessageType>
       ROS_VERIFY(message_buffer_->get(start_time, data_sample));
       data_sample.header.stamp = ros::TIME_MIN;
       filter_and_cropped_messages.push_back(data_sample);
-      if(recorder_io_.write_out_raw_data_)
-      {
-        boost::thread(boost::bind(&TaskRecorderIO<task_recorder2_msgs::DataSample>::writeRawData, recorder_io_));
-      }
       recorder_io_.messages_ = filter_and_cropped_messages;
       return true;
     }
 
     // figure out when our data starts and ends
-    ros::Time our_start_time = recorder_io_.messages_[0].header.stamp;
-    ros::Time our_end_time = recorder_io_.messages_[num_messages - 1].header.stamp;
+    ros::Time our_start_time = data_sample_store_.getStamp(0);
+    ros::Time our_end_time = data_sample_store_.getStamp(num_messages - 1);
 
     int index = 0;
     while (our_end_time.toSec() < 1e-6)
@@ -696,7 +744,7 @@ template<class MessageType>
         ROS_ERROR("Time stamps of recorded messages seem to be invalid.");
         return false;
       }
-      our_end_time = recorder_io_.messages_[num_messages - (1 + index)].header.stamp;
+      our_end_time = data_sample_store_.getStamp(num_messages - (1 + index));
     }
 
     if (our_start_time > start_time || our_end_time < end_time)
@@ -708,19 +756,40 @@ template<class MessageType>
     }
 
     // first crop
-    ROS_VERIFY(task_recorder2_utilities::crop<task_recorder2_msgs::DataSample>(recorder_io_.messages_, start_time, end_time));
+    int begin = 0;
+    int end = 0;
+    ROS_VERIFY(data_sample_store_.crop(start_time, end_time, begin, end));
+
     // then remove duplicates
-    ROS_VERIFY(task_recorder2_utilities::removeDuplicates<task_recorder2_msgs::DataSample>(recorder_io_.messages_));
+    std::vector<int> indices;
+    ROS_VERIFY(data_sample_store_.removeDuplicates(begin, end, indices));
+    ROS_ASSERT(!indices.empty());
 
-    if(recorder_io_.write_out_raw_data_)
+    // extract the time stamps and the selected variables
+    const std::vector<std::string>& recorded_names = data_sample_store_.getNames();
+    std::vector<int> variable_indices;
+    ROS_VERIFY(task_recorder2_utilities::getIndices(recorded_names, message_names.empty() ? recorded_names : message_names, variable_indices));
+    std::vector<std::string> names(variable_indices.size());
+    std::vector<std::vector<double> > variables(variable_indices.size());
+    for (int i = 0; i < static_cast<int>(variable_indices.size()); ++i)
     {
-      boost::thread(boost::bind(&TaskRecorderIO<task_recorder2_msgs::DataSample>::writeRawData, recorder_io_));
+      names[i] = recorded_names[variable_indices[i]];
+      data_sample_store_.getColumn(variable_indices[i], indices, variables[i]);
     }
+    std::vector<double> input_vector;
+    data_sample_store_.getStamps(indices, input_vector);
+    ros::Time first_time_stamp = data_sample_store_.getStamp(indices[0]);
+    std::string frame_id = data_sample_store_.getFrameId();
+    lock.unlock();
 
-    ROS_DEBUG("Resampling >%i< messages to >%i< messages for topic >%s<.", (int)recorder_io_.messages_.size(), num_samples, recorder_io_.topic_name_.c_str());
+    ROS_DEBUG("Resampling >%i< messages to >%i< messages for topic >%s<.", (int)indices.size(), num_samples, recorder_io_.topic_name_.c_str());
 
     // then resample
-    ROS_VERIFY(resample(recorder_io_.messages_, start_time, end_time, num_samples, message_names, filter_and_cropped_messages));
+    ROS_VERIFY(resample(input_vector, variables, names, first_time_stamp, start_time, end_time, num_samples, filter_and_cropped_messages));
+    for (int j = 0; j < num_samples; ++j)
+    {
+      filter_and_cropped_messages[j].header.frame_id = frame_id;
+    }
     ROS_ASSERT(static_cast<int>(filter_and_cropped_messages.size()) == num_samples);
 
     recorder_io_.messages_ = filter_and_cropped_messages;
@@ -728,108 +797,63 @@ template<class MessageType>
   }
 
 template<class MessageType>
-  bool TaskRecorder<MessageType>::resample(std::vector<task_recorder2_msgs::DataSample>& messages,
+  bool TaskRecorder<MessageType>::resample(const std::vector<double>& input_vector,
+                                           const std::vector<std::vector<double> >& variables,
+                                           const std::vector<std::string>& names,
+                                           const ros::Time& first_time_stamp,
                                            const ros::Time& start_time,
                                            const ros::Time& end_time,
                                            const int num_samples,
-                                           const std::vector<std::string>& message_names,
                                            std::vector<task_recorder2_msgs::DataSample>& resampled_messages)
   {
     // error checking
-    ROS_ASSERT(!messages.empty());
-    for (int i = 0; i < (int)messages.size(); ++i)
-    {
-      ROS_ASSERT(!messages[i].names.empty());
-      ROS_ASSERT(messages[i].names.size() == messages[i].data.size());
-    }
+    ROS_ASSERT(!input_vector.empty());
+    ROS_ASSERT(variables.size() == names.size());
     ROS_ASSERT(num_samples > 1);
 
-    // extract indices
-    std::vector<std::string> selected_names = message_names;
-    if(selected_names.empty())
-    {
-      selected_names = messages[0].names;
-    }
-
-    std::vector<int> indices;
-    ROS_VERIFY(task_recorder2_utilities::getIndices(messages[0].names, selected_names, indices));
-
-    const int num_messages = static_cast<int> (messages.size());
-    const int num_vars = static_cast<int>(indices.size());
-
-    // compute mean dt of the provided time stamps
-    double dts[num_messages - 1];
-    double mean_dt = 0.0;
-
-    std::vector<double> input_vector(num_messages);
-    ros::Time first_time_stamp = messages[0].header.stamp;
-    input_vector[0] = messages[0].header.stamp.toSec();
-    for (int i = 0; i < num_messages - 1; i++)
-    {
-      dts[i] = messages[i + 1].header.stamp.toSec() - messages[i].header.stamp.toSec();
-      mean_dt += dts[i];
-      input_vector[i + 1] = input_vector[i] + dts[i];
-    }
-    mean_dt /= static_cast<double> (num_messages - 1);
+    const int num_vars = static_cast<int>(variables.size());
 
     ros::Duration interval = static_cast<ros::Duration> (end_time - start_time) * (1.0 / double(num_samples - 1));
     double wave_length = interval.toSec() * static_cast<double> (2.0);
 
-    resampled_messages.clear();
     std::vector<double> input_querry(num_samples);
     for (int i = 0; i < num_samples; i++)
     {
-      task_recorder2_msgs::DataSample msg;
-      msg.header.seq = i;
-      msg.header.stamp = static_cast<ros::Time> (start_time.toSec() + i * interval.toSec());
-      msg.header.frame_id = messages[0].header.frame_id;
-      input_querry[i] = msg.header.stamp.toSec();
-      resampled_messages.push_back(msg);
+      input_querry[i] = static_cast<ros::Time> (start_time.toSec() + i * interval.toSec()).toSec();
     }
 
-    std::vector<std::vector<double> > variables;
-    variables.resize(num_vars);
-    for (int j = 0; j < num_messages; ++j)
+    std::vector<std::vector<double> > variables_resampled;
+    switch(splining_method_)
     {
-      for (int i = 0; i < num_vars; ++i)
+      case BSpline:
       {
-        variables[i].push_back(messages[j].data[indices[i]]);
+        // all variables share the time stamps, and therefore the b-spline nodes and its factorization
+        ROS_VERIFY(usc_utilities::resample(input_vector, variables, wave_length, input_querry, variables_resampled, false));
+        // for (int i = 0; i < num_vars; ++i)
+        //   log(task_recorder2_utilities::getDataFileName(recorder_io_.prefixed_topic_name_, i), i, input_vector, variables[i], input_querry, variables_resampled[i]);
+        break;
       }
-    }
-
-    std::vector<std::vector<double> > variables_resampled;
-    variables_resampled.resize(num_vars);
-    for (int i = 0; i < num_vars; ++i)
-    {
-      switch(splining_method_)
+      case Linear:
       {
-        case BSpline:
-        {
-          ROS_VERIFY(usc_utilities::resample(input_vector, variables[i], wave_length, input_querry, variables_resampled[i], false));
-          // log(task_recorder2_utilities::getDataFileName(recorder_io_.prefixed_topic_name_, i), i, input_vector, variables[i], input_querry, variables_resampled[i]);
-          break;
-        }
-        case Linear:
+        variables_resampled.resize(num_vars);
+        for (int i = 0; i < num_vars; ++i)
         {
           ROS_VERIFY(usc_utilities::resampleLinearNoBounds(input_vector, variables[i], input_querry, variables_resampled[i]));
           // log(task_recorder2_utilities::getDataFileName(recorder_io_.prefixed_topic_name_, i), i, input_vector, variables[i], input_querry, variables_resampled[i]);
-          break;
-        }
-        default:
-        {
-          ROS_ASSERT_MSG(false, "Unknown sampling method for task recorder with topic >%s<. This should never happen.", recorder_io_.topic_name_.c_str());
-          break;
         }
+        break;
+      }
+      default:
+      {
+        ROS_ASSERT_MSG(false, "Unknown sampling method for task recorder with topic >%s<. This should never happen.", recorder_io_.topic_name_.c_str());
+        break;
       }
     }
 
-    std::vector<std::string> names;
-    for (int i = 0; i < num_vars; ++i)
-    {
-      names.push_back(messages[0].names[indices[i]]);
-    }
+    resampled_messages.resize(num_samples);
     for (int j = 0; j < num_samples; ++j)
     {
+      resampled_messages[j].header.seq = j;
       resampled_messages[j].data.resize(num_vars, 0.0);
       for (int i = 0; i < num_vars; ++i)
       {
@@ -39,6 +39,7 @@
 #include <dmp_lib/trajectory.h>
 
 // local includes
+#include <task_recorder2/streaming_bag_writer.h>
 
 namespace task_recorder2
 {
@@ -117,6 +118,31 @@ template<class MessageType>
     bool writeRawData(const std::string raw_directory_name);
     bool writeRawData();
 
+    /*! Opens the raw data bag file of the current trial and starts writing messages to it in the background
+     * @param raw_directory_name
+     * @return True on success, otherwise False
+     */
+    bool startStreamingRawData(const std::string raw_directory_name = std::string("raw"));
+
+    /*! Queues the message to be written to the raw data bag file. Messages without valid time stamp are skipped.
+     * @param message
+     * @return True on success, otherwise False
+     */
+    bool streamRawData(const MessageType& message);
+
+    /*! Writes the remaining messages and closes the raw data bag file
+     * @return True on success, otherwise False
+     */
+    bool stopStreamingRawData();
+
+    /*!
+     * @return True if raw data is currently written to a bag file
+     */
+    bool isStreamingRawData() const
+    {
+      return (raw_data_writer_ && raw_data_writer_->isRunning());
+    }
+
     /*!
      * @return True on success, otherwise False
      */
@@ -162,6 +188,8 @@ template<class MessageType>
   private:
 
     static const int NUMBER_OF_INITIALLY_RESERVED_MESSAGES = 20 * 300;
+    static const int DEFAULT_RAW_DATA_CHUNK_SIZE = 100;
+    static const int DEFAULT_RAW_DATA_QUEUE_CAPACITY = 50;
 
     /*!
      */
@@ -178,6 +206,20 @@ template<class MessageType>
     boost::filesystem::path absolute_data_directory_path_;
     bool create_directories_;
 
+    /*! Shared by copies, such that the raw data of a trial is only written once
+     */
+    boost::shared_ptr<StreamingBagWriter<MessageType> > raw_data_writer_;
+
+    /*!
+     * @param directory_name
+     * @param abs_file_name of the data file of the current trial
+     * @param path of the directory that contains the trial counter file
+     * @return True on success, otherwise False
+     */
+    bool getDataFileName(const std::string& directory_name,
+                         std::string& abs_file_name,
+                         boost::filesystem::path& path);
+
   };
 
 template<class MessageType>
@@ -198,6 +240,14 @@ template<class MessageType>
     ROS_VERIFY(usc_utilities::read(node_handle_, "write_out_clmc_data", write_out_clmc_data_));
     ROS_VERIFY(usc_utilities::read(node_handle_, "write_out_statistics", write_out_statistics_));
 
+    int raw_data_chunk_size;
+    int raw_data_queue_capacity;
+    node_handle_.param("raw_data_chunk_size", raw_data_chunk_size, static_cast<int>(DEFAULT_RAW_DATA_CHUNK_SIZE));
+    node_handle_.param("raw_data_queue_capacity", raw_data_queue_capacity, static_cast<int>(DEFAULT_RAW_DATA_QUEUE_CAPACITY));
+    ROS_ASSERT_MSG(raw_data_chunk_size > 0 && raw_data_queue_capacity > 0, "Invalid raw data chunk size >%i< or queue capacity >%i<.",
+                   raw_data_chunk_size, raw_data_queue_capacity);
+    raw_data_writer_.reset(new StreamingBagWriter<MessageType>(raw_data_chunk_size, raw_data_queue_capacity));
+
     std::string recorder_package_name;
     ROS_VERIFY(usc_utilities::read(node_handle_, "recorder_package_name", recorder_package_name));
     std::string recorder_data_directory_name;
@@ -258,30 +308,44 @@ template<class MessageType>
   {
     ROS_ASSERT_MSG(initialized_, "Task recorder IO module is not initialized.");
 
+    std::string file_name;
+    boost::filesystem::path path;
+    ROS_VERIFY(getDataFileName(directory_name, file_name, path));
+    ROS_VERIFY(usc_utilities::FileIO<MessageType>::writeToBagFileWithTimeStamps(messages_, topic_name_, file_name, false));
+    if(create_directories_ && increment_trial_counter)
+    {
+      ROS_VERIFY(task_recorder2_utilities::incrementTrialCounterFile(path, prefixed_topic_name_));
+      ROS_VERIFY(task_recorder2_utilities::getTrialId(path, description_.trial, prefixed_topic_name_));
+      ROS_VERIFY(task_recorder2_utilities::checkForCompleteness(path, description_.trial, prefixed_topic_name_));
+    }
+    return true;
+  }
+
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::getDataFileName(const std::string& directory_name,
+                                                    std::string& abs_file_name,
+                                                    boost::filesystem::path& path)
+  {
     if(create_directories_)
     {
-      std::string file_name = task_recorder2_utilities::getPathNameIncludingTrailingSlash(absolute_data_directory_path_);
-      boost::filesystem::path path = absolute_data_directory_path_;
+      abs_file_name = task_recorder2_utilities::getPathNameIncludingTrailingSlash(absolute_data_directory_path_);
+      path = absolute_data_directory_path_;
       if (!directory_name.empty())
       {
-        file_name.append(directory_name);
+        abs_file_name.append(directory_name);
         path = boost::filesystem::path(absolute_data_directory_path_.directory_string() + std::string("/") + directory_name);
-        ROS_VERIFY(task_recorder2_utilities::checkForDirectory(file_name));
-        usc_utilities::appendTrailingSlash(file_name);
-      }
-      file_name.append(task_recorder2_utilities::getDataFileName(prefixed_topic_name_, description_.trial));
-      ROS_VERIFY(usc_utilities::FileIO<MessageType>::writeToBagFileWithTimeStamps(messages_, topic_name_, file_name, false));
-      if (increment_trial_counter)
-      {
-        ROS_VERIFY(task_recorder2_utilities::incrementTrialCounterFile(path, prefixed_topic_name_));
-        ROS_VERIFY(task_recorder2_utilities::getTrialId(path, description_.trial, prefixed_topic_name_));
-        ROS_VERIFY(task_recorder2_utilities::checkForCompleteness(path, description_.trial, prefixed_topic_name_));
+        if(!task_recorder2_utilities::checkForDirectory(abs_file_name))
+        {
+          return false;
+        }
+        usc_utilities::appendTrailingSlash(abs_file_name);
       }
+      abs_file_name.append(task_recorder2_utilities::getDataFileName(prefixed_topic_name_, description_.trial));
     }
     else
     {
-      std::string file_name = absolute_data_directory_path_.file_string();
-      ROS_VERIFY(usc_utilities::FileIO<MessageType>::writeToBagFileWithTimeStamps(messages_, topic_name_, file_name, false));
+      abs_file_name = absolute_data_directory_path_.file_string();
+      path = absolute_data_directory_path_;
     }
     return true;
   }
@@ -387,6 +451,57 @@ template<class MessageType>
     return writeRecordedData(std::string("raw"), false);
   }
 
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::startStreamingRawData(const std::string raw_directory_name)
+  {
+    ROS_ASSERT_MSG(initialized_, "Task recorder IO module is not initialized.");
+    if (raw_data_writer_->isRunning())
+    {
+      ROS_WARN("Raw data of topic >%s< is still being written. Closing previous bag file.", topic_name_.c_str());
+      stopStreamingRawData();
+    }
+    std::string file_name;
+    boost::filesystem::path path;
+    if (!getDataFileName(raw_directory_name, file_name, path))
+    {
+      ROS_ERROR("Could not create raw data directory >%s< for topic >%s<.", raw_directory_name.c_str(), topic_name_.c_str());
+      return false;
+    }
+    return raw_data_writer_->start(file_name, topic_name_);
+  }
+
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::streamRawData(const MessageType& message)
+  {
+    // rosbag refuses messages with time stamps before ros::TIME_MIN
+    if (message.header.stamp < ros::TIME_MIN)
+    {
+      return true;
+    }
+    return raw_data_writer_->add(message);
+  }
+
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::stopStreamingRawData()
+  {
+    if (!raw_data_writer_->isRunning())
+    {
+      return true;
+    }
+    const bool result = raw_data_writer_->stop();
+    StreamingBagWriterStatistics statistics;
+    raw_data_writer_->getStatistics(statistics);
+    ROS_DEBUG("Wrote >%i< of >%i< raw messages of topic >%s< in %.3f seconds. Dropped >%i<, blocked >%i< times for %.3f seconds (max %.3f), max queue length >%i<.",
+              statistics.num_written, statistics.num_added, topic_name_.c_str(), statistics.write_duration, statistics.num_dropped,
+              statistics.num_blocked, statistics.blocked_duration, statistics.max_blocked_duration, statistics.max_queue_length);
+    if (statistics.num_blocked > 0 || statistics.num_dropped > 0)
+    {
+      ROS_WARN("Writing raw data of topic >%s< could not keep up: blocked >%i< times for %.3f seconds, dropped >%i< messages.",
+               topic_name_.c_str(), statistics.num_blocked, statistics.blocked_duration, statistics.num_dropped);
+    }
+    return result;
+  }
+
 template<class MessageType>
   bool TaskRecorderIO<MessageType>::writeStatistics(std::vector<std::vector<task_recorder2_msgs::AccumulatedTrialStatistics> >& vector_of_accumulated_trial_statistics)
   {
@@ -25,6 +25,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include <task_recorder2_msgs/DataSample.h>
+#include <task_recorder2_msgs/Notification.h>
 
 #include <task_recorder2/joint_states_recorder.h>
 #include <task_recorder2/audio_recorder.h>
@@ -60,7 +61,7 @@ public:
   TaskRecorderManager(ros::NodeHandle node_handle);
   /*! Destructor
    */
-  virtual ~TaskRecorderManager() {};
+  virtual ~TaskRecorderManager();
 
   /*!
    * @return True on success, False otherwise
@@ -213,11 +214,30 @@ private:
    */
   ros::Publisher stop_recording_publisher_;
 
+  /*! If true, stopRecording returns before the recorded data has been written (see StopRecording.srv)
+   */
+  bool write_data_in_background_;
+
+  /*! Writes the recorded data of the previous trial while the next one is recorded
+   */
+  boost::shared_ptr<boost::thread> data_writer_thread_;
+
   /*!
    * @param timer_event
    */
   void timerCB(const ros::TimerEvent& timer_event);
 
+  /*! Writes the resampled (and optionally the CLMC) data file and publishes the notification
+   * @param recorder_io The recorder io module, or a copy of it at the time recording has been stopped
+   * @param notification
+   */
+  void writeRecordedData(TaskRecorderIO<task_recorder2_msgs::DataSample>& recorder_io,
+                         const task_recorder2_msgs::Notification notification);
+
+  /*! Waits until the data of the previous trial has been written and updates the trial counter
+   */
+  void waitForDataWriter();
+
   /*!
    * @param time_stamp
    * @return True if last sample is updated, otherwise False
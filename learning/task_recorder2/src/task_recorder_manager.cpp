@@ -13,7 +13,7 @@
  *********************************************************************/
 
 // system includes
-// #include <boost/thread.hpp>
+#include <boost/thread.hpp>
 #include <usc_utilities/assert.h>
 #include <usc_utilities/param_server.h>
 
@@ -27,12 +27,20 @@ namespace task_recorder2
 {
 
 TaskRecorderManager::TaskRecorderManager(ros::NodeHandle node_handle) :
-    initialized_(false), recorder_io_(node_handle), counter_(-1)
+    initialized_(false), recorder_io_(node_handle), counter_(-1), write_data_in_background_(false)
 {
   ROS_DEBUG("Creating task recorder manager in namespace >%s<.", node_handle.getNamespace().c_str());
   ROS_VERIFY(recorder_io_.initialize(recorder_io_.node_handle_.getNamespace() + std::string("/data_samples")));
 }
 
+TaskRecorderManager::~TaskRecorderManager()
+{
+  if(data_writer_thread_)
+  {
+    data_writer_thread_->join();
+  }
+}
+
 bool TaskRecorderManager::initialize()
 {
   ROS_VERIFY(read(task_recorders_));
@@ -56,6 +64,7 @@ bool TaskRecorderManager::initialize()
 
   ROS_VERIFY(usc_utilities::read(recorder_io_.node_handle_, "sampling_rate", sampling_rate_));
   ROS_ASSERT(sampling_rate_ > 0);
+  recorder_io_.node_handle_.param("write_data_in_background", write_data_in_background_, false);
   double update_timer_period = static_cast<double>(1.0) / sampling_rate_;
   timer_ = recorder_io_.node_handle_.createTimer(ros::Duration(update_timer_period), &TaskRecorderManager::timerCB, this);
 
@@ -120,6 +129,7 @@ bool TaskRecorderManager::startRecording(task_recorder2::StartRecording::Request
                                          task_recorder2::StartRecording::Response& response)
 {
   ROS_ASSERT(initialized_);
+  waitForDataWriter();
   recorder_io_.setDescription(request.description);
 
   response.start_time = ros::TIME_MAX;
@@ -144,6 +154,7 @@ bool TaskRecorderManager::stopRecording(task_recorder2::StopRecording::Request&
                                         task_recorder2::StopRecording::Response& response)
 {
   ROS_ASSERT(initialized_);
+  waitForDataWriter();
   for (int i = 0; i < (int)task_recorders_.size(); ++i)
   {
     stop_recording_requests_[i] = request;
@@ -206,24 +217,19 @@ bool TaskRecorderManager::stopRecording(task_recorder2::StopRecording::Request&
   response.description = recorder_io_.getDescription();
   response.return_code = task_recorder2::StopRecording::Response::SERVICE_CALL_SUCCESSFUL;
 
-  // write resampled data to file
-  if(recorder_io_.write_out_resampled_data_)
-  {
-    // boost::thread(boost::bind(&task_recorder2_utilities::TaskRecorderIO<task_recorder2_msgs::DataSample>::writeRecordedDataSamples, recorder_io_));
-    ROS_VERIFY(recorder_io_.writeRecordedDataSamples());
-  }
-  if(recorder_io_.write_out_clmc_data_)
-  {
-    ROS_VERIFY(recorder_io_.writeRecordedDataToCLMCFile());
-  }
-
-  // publish notification
   task_recorder2_msgs::Notification notification;
   notification.description = response.description;
   notification.start = request.crop_start_time;
   notification.end = request.crop_end_time;
-  stop_recording_publisher_.publish(notification);
+  if(!write_data_in_background_)
+  {
+    writeRecordedData(recorder_io_, notification);
+    return true;
+  }
 
+  // write resampled data to file in the background, the next call that depends on the trial counter waits for it.
+  // The thread writes a copy of the recorder io module, which is bound by value.
+  data_writer_thread_.reset(new boost::thread(boost::bind(&TaskRecorderManager::writeRecordedData, this, recorder_io_, notification)));
   return true;
 }
 
@@ -252,6 +258,7 @@ bool TaskRecorderManager::getInfo(task_recorder2::GetInfo::Request& request,
   if(!request.description.description.empty())
   {
     ROS_INFO("Getting info...");
+    waitForDataWriter();
     if(!recorder_io_.getAbsFileName(request.description, response.file_name))
     {
       response.info.assign("Could not get file name of requested description. This should never happen.");
@@ -353,6 +360,7 @@ bool TaskRecorderManager::addDataSamples(task_recorder2::AddDataSamples::Request
   }
   ROS_VERIFY_MSG(!request.data_samples.empty(), "No data samples provided to add.");
 
+  waitForDataWriter();
   recorder_io_.setDescription(request.description);
   recorder_io_.messages_ = request.data_samples;
   ROS_VERIFY(recorder_io_.writeRecordedDataSamples());
@@ -373,6 +381,7 @@ bool TaskRecorderManager::readDataSamples(task_recorder2::ReadDataSamples::Reque
                                           task_recorder2::ReadDataSamples::Response& response)
 {
   ROS_ASSERT(initialized_);
+  waitForDataWriter();
   if(!recorder_io_.readDataSamples(request.description, response.data_samples))
   {
     response.return_code = task_recorder2::ReadDataSamples::Response::SERVICE_CALL_FAILED;
@@ -385,6 +394,38 @@ bool TaskRecorderManager::readDataSamples(task_recorder2::ReadDataSamples::Reque
   return true;
 }
 
+void TaskRecorderManager::writeRecordedData(TaskRecorderIO<task_recorder2_msgs::DataSample>& recorder_io,
+                                            const task_recorder2_msgs::Notification notification)
+{
+  ros::WallTime start_time = ros::WallTime::now();
+  if(recorder_io.write_out_resampled_data_)
+  {
+    ROS_VERIFY(recorder_io.writeRecordedDataSamples());
+  }
+  if(recorder_io.write_out_clmc_data_)
+  {
+    ROS_VERIFY(recorder_io.writeRecordedDataToCLMCFile());
+  }
+  ROS_DEBUG("Wrote >%i< data samples in %.3f seconds.", (int)recorder_io.messages_.size(), (ros::WallTime::now() - start_time).toSec());
+
+  // publish notification once the data is on disc
+  stop_recording_publisher_.publish(notification);
+}
+
+void TaskRecorderManager::waitForDataWriter()
+{
+  if(!data_writer_thread_)
+  {
+    return;
+  }
+  ros::WallTime start_time = ros::WallTime::now();
+  data_writer_thread_->join();
+  data_writer_thread_.reset();
+  ROS_DEBUG("Waited %.3f seconds for data of the previous trial to be written.", (ros::WallTime::now() - start_time).toSec());
+  // the trial counter has been incremented on disc, update it
+  recorder_io_.setDescription(recorder_io_.getDescription());
+}
+
 bool TaskRecorderManager::setLastDataSample(const ros::Time& time_stamp)
 {
   for (int i = 0; i < (int)task_recorders_.size(); ++i)
@@ -60,9 +60,6 @@ template<typename T>
   class CircularMessageBuffer
   {
 
-  // TODO: change this...
-  friend class MessageRingBuffer;
-
   private:
     CircularMessageBuffer();
 
@@ -0,0 +1,209 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		Columnar storage of recorded data samples. The variable
+            names are stored once, the time stamps and each variable
+            are stored in their own column. The columns are allocated
+            in chunks which are kept across recordings.
+
+  \file		data_sample_store.h
+
+  \date		Oct 17, 2026
+
+ *********************************************************************/
+
+#ifndef DATA_SAMPLE_STORE_H_
+#define DATA_SAMPLE_STORE_H_
+
+// system includes
+#include <vector>
+#include <string>
+#include <ros/ros.h>
+#include <boost/shared_ptr.hpp>
+
+#include <task_recorder2_msgs/DataSample.h>
+
+// local includes
+
+namespace task_recorder2_utilities
+{
+
+class DataSampleStore
+{
+
+  static const int DEFAULT_CHUNK_SIZE = 1024;
+
+public:
+
+  /*! Constructor
+   */
+  DataSampleStore();
+  /*! Destructor
+   */
+  virtual ~DataSampleStore() {};
+
+  /*!
+   * @param names of the variables of each data sample
+   * @param chunk_size Number of data samples per chunk
+   * @return True on success, otherwise False
+   */
+  bool initialize(const std::vector<std::string>& names,
+                  const int chunk_size = DEFAULT_CHUNK_SIZE);
+
+  /*! Allocates enough chunks to add num_samples data samples without allocating memory
+   * @param num_samples
+   */
+  void reserve(const int num_samples);
+
+  /*! Removes all data samples. The allocated chunks are kept.
+   */
+  void clear();
+
+  /*! Appends the time stamp and the data of the data sample. Its names are not copied, they are
+   * expected to be the ones the store has been initialized with.
+   * @param data_sample
+   * @return True on success, otherwise False
+   */
+  bool add(const task_recorder2_msgs::DataSample& data_sample);
+
+  /*!
+   * @return Number of stored data samples
+   */
+  int size() const
+  {
+    return num_samples_;
+  }
+  bool empty() const
+  {
+    return (num_samples_ == 0);
+  }
+
+  /*!
+   * @return Names of the stored variables
+   */
+  const std::vector<std::string>& getNames() const
+  {
+    return names_;
+  }
+
+  /*!
+   * @return Frame id of the first stored data sample
+   */
+  const std::string& getFrameId() const
+  {
+    return frame_id_;
+  }
+
+  /*!
+   * @param index of the data sample
+   * @return Time stamp of the data sample
+   */
+  const ros::Time& getStamp(const int index) const
+  {
+    ROS_ASSERT(index >= 0 && index < num_samples_);
+    return chunks_[index / chunk_size_]->stamps[index % chunk_size_];
+  }
+
+  /*! Computes the range of data samples that covers [start_time, end_time], including the last
+   * data sample before start_time (see crop in task_recorder_utilities.h)
+   * @param start_time
+   * @param end_time
+   * @param begin Index of the first data sample of the range
+   * @param end Index past the last data sample of the range
+   * @return True on success, otherwise False
+   */
+  bool crop(const ros::Time& start_time,
+            const ros::Time& end_time,
+            int& begin,
+            int& end) const;
+
+  /*! Selects the data samples in the range [begin, end) that have a valid time stamp which is not a
+   * duplicate of the previous one (see removeDuplicates in task_recorder_utilities.h)
+   * @param begin
+   * @param end
+   * @param indices of the selected data samples
+   * @return True on success, otherwise False
+   */
+  bool removeDuplicates(const int begin,
+                        const int end,
+                        std::vector<int>& indices) const;
+
+  /*!
+   * @param indices of the data samples
+   * @param stamps of these data samples in seconds
+   */
+  void getStamps(const std::vector<int>& indices,
+                 std::vector<double>& stamps) const;
+
+  /*!
+   * @param variable_index
+   * @param indices of the data samples
+   * @param values of the variable for these data samples
+   */
+  void getColumn(const int variable_index,
+                 const std::vector<int>& indices,
+                 std::vector<double>& values) const;
+
+  /*! Creates DataSample messages for the data samples in the range [begin, end)
+   * @param begin
+   * @param end
+   * @param data_samples
+   */
+  void getDataSamples(const int begin,
+                      const int end,
+                      std::vector<task_recorder2_msgs::DataSample>& data_samples) const;
+
+  /*! Creates DataSample messages for the selected data samples
+   * @param indices of the data samples
+   * @param data_samples
+   */
+  void getDataSamples(const std::vector<int>& indices,
+                      std::vector<task_recorder2_msgs::DataSample>& data_samples) const;
+
+private:
+
+  /*! Each chunk stores chunk_size_ time stamps and chunk_size_ values of each
+   * variable. The values of variable i are stored at [i * chunk_size_, (i+1) * chunk_size_)
+   */
+  struct Chunk
+  {
+    std::vector<ros::Time> stamps;
+    std::vector<double> data;
+  };
+
+  /*!
+   */
+  std::vector<std::string> names_;
+  std::string frame_id_;
+  int num_variables_;
+  int chunk_size_;
+  int num_samples_;
+
+  /*!
+   */
+  std::vector<boost::shared_ptr<Chunk> > chunks_;
+
+  /*!
+   * @param index of the data sample
+   * @param data_sample
+   */
+  void getDataSample(const int index,
+                     task_recorder2_msgs::DataSample& data_sample) const;
+
+  /*!
+   * @param index of the data sample
+   * @param variable_index
+   * @return Value of the variable
+   */
+  double getValue(const int index, const int variable_index) const
+  {
+    return chunks_[index / chunk_size_]->data[variable_index * chunk_size_ + index % chunk_size_];
+  }
+
+};
+
+}
+
+#endif /* DATA_SAMPLE_STORE_H_ */
@@ -1,10 +1,10 @@
 /*********************************************************************
   Computational Learning and Motor Control Lab
   University of Southern California
-  Prof. Stefan Schaal 
+  Prof. Stefan Schaal
  *********************************************************************
   \remarks		...
- 
+
   \file		message_ring_buffer.h
 
   \author	Peter Pastor
@@ -18,16 +18,22 @@
 // system includes
 #include <vector>
 #include <ros/ros.h>
-#include <boost/shared_ptr.hpp>
+#include <ros/atomic.h>
+#include <boost/scoped_array.hpp>
 
 #include <task_recorder2_msgs/DataSample.h>
 
 // local includes
-#include <task_recorder2_utilities/circular_message_buffer.h>
 
 namespace task_recorder2_utilities
 {
 
+/*! Ring of the most recent data samples. The names and the frame id are stored once, and each data sample
+ * occupies a fixed width slot (time stamp, sequence id and data). One thread adds data samples, in order of their time stamps,
+ * while any number of threads look them up by binary search on the time stamps. Each slot is guarded by
+ * a sequence number (seqlock), so readers neither lock nor block the writer, they retry if the slots
+ * they read have been overwritten in the meantime.
+ */
 class MessageRingBuffer
 {
 
@@ -36,6 +42,8 @@ class MessageRingBuffer
 public:
 
   /*! Constructor
+   * @param default_data_sample Provides the names and is returned until the first data sample is added
+   * @param ring_buffer_size
    */
   MessageRingBuffer(const task_recorder2_msgs::DataSample& default_data_sample,
                     const int ring_buffer_size = DEFAULT_RING_BUFFER_SIZE);
@@ -43,18 +51,45 @@ public:
    */
   virtual ~MessageRingBuffer() {};
 
-  /*!
+  /*! Must only be called from one thread at a time. A data sample that is older than the previously
+   * added one restarts the buffer, such that time stamps remain sorted.
    * @param data_sample
    * @return True on success, otherwise False
    */
   bool add(const task_recorder2_msgs::DataSample& data_sample);
 
-  /*!
+  /*! Finds the most recent data sample with a time stamp at or before time. The names are only copied
+   * if the provided data sample does not contain them already. The frame id is always the one of the
+   * default data sample, the frame ids of added data samples are not stored.
    * @param time
    * @param data_sample
+   * @param interpolate If true, the data is linearly interpolated between that data sample and the next
+   * one (if any), and the time stamp is set to time
+   * @return True on success, otherwise False
+   */
+  bool get(const ros::Time& time,
+           task_recorder2_msgs::DataSample& data_sample,
+           const bool interpolate = false);
+
+  /*!
+   * @param time
+   * @param stamp
+   * @param data
+   * @param interpolate
    * @return True on success, otherwise False
    */
-  bool get(const ros::Time& time, task_recorder2_msgs::DataSample& data_sample);
+  bool get(const ros::Time& time,
+           ros::Time& stamp,
+           std::vector<double>& data,
+           const bool interpolate = false);
+
+  /*!
+   * @return Names of the variables of each data sample
+   */
+  const std::vector<std::string>& getNames() const
+  {
+    return names_;
+  }
 
 private:
 
@@ -64,7 +99,71 @@ private:
 
   /*!
    */
-  boost::shared_ptr<CircularMessageBuffer<task_recorder2_msgs::DataSample> > circular_buffer_;
+  std::vector<std::string> names_;
+  std::string frame_id_;
+  int num_variables_;
+  int ring_buffer_size_;
+
+  /*! Slot i holds data sample n with n % ring_buffer_size_ == i. Its sequence number is 2 * (n + 1)
+   * once the data sample has been written, and odd while it is written.
+   */
+  boost::scoped_array<ros::atomic_uint64_t> sequence_numbers_;
+  std::vector<ros::Time> stamps_;
+  std::vector<uint32_t> seqs_;
+  std::vector<double> data_;
+
+  /*! Data samples [first_, num_added_) are valid, of which the last ring_buffer_size_ are stored
+   */
+  ros::atomic_uint64_t first_;
+  ros::atomic_uint64_t num_added_;
+
+  /*! Only accessed by the writer
+   */
+  bool restart_;
+  ros::Time last_stamp_;
+
+  /*!
+   * @param index of the data sample
+   * @param stamp
+   * @return False if the data sample has been overwritten
+   */
+  bool readStamp(const uint64_t index,
+                 ros::Time& stamp) const;
+
+  /*!
+   * @param index of the data sample
+   * @param stamp
+   * @param seq
+   * @param data
+   * @return False if the data sample has been overwritten
+   */
+  bool read(const uint64_t index,
+            ros::Time& stamp,
+            uint32_t& seq,
+            double* data) const;
+
+  /*!
+   * @param stamp
+   * @param seq
+   * @param data
+   */
+  void write(const ros::Time& stamp,
+             const uint32_t seq,
+             const std::vector<double>& data);
+
+  /*! See get
+   * @param time
+   * @param stamp
+   * @param seq
+   * @param data
+   * @param interpolate
+   * @return True on success, otherwise False
+   */
+  bool lookup(const ros::Time& time,
+              ros::Time& stamp,
+              uint32_t& seq,
+              std::vector<double>& data,
+              const bool interpolate);
 
 };
 
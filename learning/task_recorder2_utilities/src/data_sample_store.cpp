@@ -0,0 +1,218 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		...
+
+  \file		data_sample_store.cpp
+
+  \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+
+// local includes
+#include <task_recorder2_utilities/data_sample_store.h>
+
+namespace task_recorder2_utilities
+{
+
+DataSampleStore::DataSampleStore() :
+  num_variables_(0), chunk_size_(DEFAULT_CHUNK_SIZE), num_samples_(0)
+{
+}
+
+bool DataSampleStore::initialize(const std::vector<std::string>& names,
+                                 const int chunk_size)
+{
+  if(names.empty())
+  {
+    ROS_ERROR("Cannot initialize data sample store without variable names.");
+    return false;
+  }
+  if(chunk_size <= 0)
+  {
+    ROS_ERROR("Invalid chunk size >%i<. Cannot initialize data sample store.", chunk_size);
+    return false;
+  }
+  names_ = names;
+  num_variables_ = static_cast<int>(names_.size());
+  chunk_size_ = chunk_size;
+  num_samples_ = 0;
+  chunks_.clear();
+  return true;
+}
+
+void DataSampleStore::reserve(const int num_samples)
+{
+  while (static_cast<int>(chunks_.size()) * chunk_size_ < num_samples)
+  {
+    boost::shared_ptr<Chunk> chunk(new Chunk());
+    chunk->stamps.resize(chunk_size_);
+    chunk->data.resize(num_variables_ * chunk_size_);
+    chunks_.push_back(chunk);
+  }
+}
+
+void DataSampleStore::clear()
+{
+  num_samples_ = 0;
+}
+
+bool DataSampleStore::add(const task_recorder2_msgs::DataSample& data_sample)
+{
+  if(static_cast<int>(data_sample.data.size()) != num_variables_)
+  {
+    ROS_ERROR("Size of data vector >%i< needs to be >%i<.", (int)data_sample.data.size(), num_variables_);
+    return false;
+  }
+  if(num_samples_ == 0)
+  {
+    frame_id_ = data_sample.header.frame_id;
+  }
+
+  reserve(num_samples_ + 1);
+  Chunk& chunk = *chunks_[num_samples_ / chunk_size_];
+  const int offset = num_samples_ % chunk_size_;
+  chunk.stamps[offset] = data_sample.header.stamp;
+  for (int i = 0; i < num_variables_; ++i)
+  {
+    chunk.data[i * chunk_size_ + offset] = data_sample.data[i];
+  }
+  num_samples_++;
+  return true;
+}
+
+bool DataSampleStore::crop(const ros::Time& start_time,
+                           const ros::Time& end_time,
+                           int& begin,
+                           int& end) const
+{
+  // skip data samples before start_time
+  begin = 0;
+  bool found_limit = false;
+  for (int i = 0; i < num_samples_ && !found_limit; i++)
+  {
+    if (getStamp(i) < start_time)
+    {
+      begin = i;
+    }
+    else
+    {
+      found_limit = true;
+    }
+  }
+  if(!found_limit)
+  {
+    ROS_ERROR("Looks like the start and end time are not contained in the data samples. Check the requested times.");
+    return false;
+  }
+
+  // skip data samples after end_time
+  end = num_samples_;
+  found_limit = false;
+  for (int i = num_samples_ - 1; i >= begin && !found_limit; --i)
+  {
+    if (getStamp(i) > end_time)
+    {
+      end = i;
+    }
+    else
+    {
+      found_limit = true;
+    }
+  }
+  if(!found_limit)
+  {
+    ROS_ERROR("Looks like the end time is not contained in the data samples. Check the requested times.");
+    return false;
+  }
+  return true;
+}
+
+bool DataSampleStore::removeDuplicates(const int begin,
+                                       const int end,
+                                       std::vector<int>& indices) const
+{
+  ROS_ASSERT(begin >= 0 && begin < end && end <= num_samples_);
+  indices.clear();
+  indices.reserve(end - begin);
+  if (getStamp(begin) < ros::TIME_MIN)
+  {
+    ROS_WARN("Found message (0) with invalid stamp.");
+  }
+  else
+  {
+    indices.push_back(begin);
+  }
+  for (int i = begin; i < end - 1; i++)
+  {
+    if ((getStamp(i + 1).toSec() - getStamp(i).toSec() >= 1e-6) && !(getStamp(i + 1) < ros::TIME_MIN))
+    {
+      indices.push_back(i + 1);
+    }
+  }
+  return true;
+}
+
+void DataSampleStore::getStamps(const std::vector<int>& indices,
+                                std::vector<double>& stamps) const
+{
+  stamps.resize(indices.size());
+  for (int j = 0; j < static_cast<int>(indices.size()); ++j)
+  {
+    stamps[j] = getStamp(indices[j]).toSec();
+  }
+}
+
+void DataSampleStore::getColumn(const int variable_index,
+                                const std::vector<int>& indices,
+                                std::vector<double>& values) const
+{
+  ROS_ASSERT(variable_index >= 0 && variable_index < num_variables_);
+  values.resize(indices.size());
+  for (int j = 0; j < static_cast<int>(indices.size()); ++j)
+  {
+    values[j] = getValue(indices[j], variable_index);
+  }
+}
+
+void DataSampleStore::getDataSamples(const int begin,
+                                     const int end,
+                                     std::vector<task_recorder2_msgs::DataSample>& data_samples) const
+{
+  ROS_ASSERT(begin >= 0 && begin <= end && end <= num_samples_);
+  data_samples.resize(end - begin);
+  for (int j = begin; j < end; ++j)
+  {
+    getDataSample(j, data_samples[j - begin]);
+  }
+}
+
+void DataSampleStore::getDataSamples(const std::vector<int>& indices,
+                                     std::vector<task_recorder2_msgs::DataSample>& data_samples) const
+{
+  data_samples.resize(indices.size());
+  for (int j = 0; j < static_cast<int>(indices.size()); ++j)
+  {
+    getDataSample(indices[j], data_samples[j]);
+  }
+}
+
+void DataSampleStore::getDataSample(const int index,
+                                    task_recorder2_msgs::DataSample& data_sample) const
+{
+  data_sample.header.seq = index;
+  data_sample.header.stamp = getStamp(index);
+  data_sample.header.frame_id = frame_id_;
+  data_sample.names = names_;
+  data_sample.data.resize(num_variables_);
+  for (int i = 0; i < num_variables_; ++i)
+  {
+    data_sample.data[i] = getValue(index, i);
+  }
+}
+
+}
@@ -1,10 +1,10 @@
 /*********************************************************************
   Computational Learning and Motor Control Lab
   University of Southern California
-  Prof. Stefan Schaal 
+  Prof. Stefan Schaal
  *********************************************************************
   \remarks		...
- 
+
   \file		message_ring_buffer.cpp
 
   \author	Peter Pastor
@@ -16,56 +16,216 @@
 
 // local includes
 #include <task_recorder2_utilities/message_ring_buffer.h>
-#include <boost/circular_buffer.hpp>
 
 namespace task_recorder2_utilities
 {
 
 MessageRingBuffer::MessageRingBuffer(const task_recorder2_msgs::DataSample& default_data_sample,
-                                     const int ring_buffer_size)
+                                     const int ring_buffer_size) :
+  names_(default_data_sample.names), frame_id_(default_data_sample.header.frame_id),
+  num_variables_(default_data_sample.data.size()), ring_buffer_size_(ring_buffer_size),
+  sequence_numbers_(new ros::atomic_uint64_t[ring_buffer_size]), stamps_(ring_buffer_size), seqs_(ring_buffer_size, 0),
+  data_(ring_buffer_size * default_data_sample.data.size(), 0.0), first_(0), num_added_(0), restart_(false)
 {
-  circular_buffer_.reset(new CircularMessageBuffer<task_recorder2_msgs::DataSample>(ring_buffer_size, default_data_sample));
+  ROS_ASSERT(ring_buffer_size_ > 0);
+  for (int i = 0; i < ring_buffer_size_; ++i)
+  {
+    sequence_numbers_[i].store(0);
+  }
+  // the default data sample is returned until the first data sample is added
+  write(default_data_sample.header.stamp, default_data_sample.header.seq, default_data_sample.data);
+  restart_ = true;
 }
 
 bool MessageRingBuffer::add(const task_recorder2_msgs::DataSample& data_sample)
 {
   // error checking
-  if(!circular_buffer_->empty())
+  if(static_cast<int>(data_sample.data.size()) != num_variables_)
   {
-    if(circular_buffer_->front().data.size() != data_sample.data.size())
-    {
-      ROS_ERROR("Size of data vector >%i< needs to be >%i<.",
-                (int)circular_buffer_->front().data.size(), (int)data_sample.data.size());
-      return false;
-    }
+    ROS_ERROR("Size of data vector >%i< needs to be >%i<.", num_variables_, (int)data_sample.data.size());
+    return false;
   }
 
-  // fill the buffer if it has been empty
-  if(circular_buffer_->size() == 0)
+  if(!restart_ && data_sample.header.stamp < last_stamp_)
   {
-    for (unsigned int i = 0; i < circular_buffer_->capacity(); ++i)
-    {
-      circular_buffer_->push_back(data_sample);
-    }
+    ROS_WARN("Time stamp of data sample went backwards, restarting the ring buffer.");
+    restart_ = true;
+  }
+  write(data_sample.header.stamp, data_sample.header.seq, data_sample.data);
+  return true;
+}
+
+void MessageRingBuffer::write(const ros::Time& stamp,
+                              const uint32_t seq,
+                              const std::vector<double>& data)
+{
+  const uint64_t index = num_added_.load(ros::memory_order_relaxed);
+  const int slot = static_cast<int>(index % ring_buffer_size_);
+
+  // a restart is published before its data sample. Readers load num_added_ before first_, hence they
+  // either see the range of the restart, which is empty until the data sample is added, or a newer one.
+  if(restart_)
+  {
+    first_.store(index, ros::memory_order_release);
+    restart_ = false;
   }
 
-  circular_buffer_->push_back(data_sample);
+  sequence_numbers_[slot].store(2 * index + 1, ros::memory_order_relaxed);
+  ros::atomic_thread_fence(ros::memory_order_release);
+  stamps_[slot] = stamp;
+  seqs_[slot] = seq;
+  std::copy(data.begin(), data.end(), data_.begin() + slot * num_variables_);
+  sequence_numbers_[slot].store(2 * (index + 1), ros::memory_order_release);
+  num_added_.store(index + 1, ros::memory_order_release);
+  last_stamp_ = stamp;
+}
+
+bool MessageRingBuffer::readStamp(const uint64_t index,
+                                  ros::Time& stamp) const
+{
+  const int slot = static_cast<int>(index % ring_buffer_size_);
+  const uint64_t sequence_number = sequence_numbers_[slot].load(ros::memory_order_acquire);
+  if(sequence_number != 2 * (index + 1))
+  {
+    return false;
+  }
+  stamp = stamps_[slot];
+  ros::atomic_thread_fence(ros::memory_order_acquire);
+  return (sequence_numbers_[slot].load(ros::memory_order_relaxed) == sequence_number);
+}
+
+bool MessageRingBuffer::read(const uint64_t index,
+                             ros::Time& stamp,
+                             uint32_t& seq,
+                             double* data) const
+{
+  const int slot = static_cast<int>(index % ring_buffer_size_);
+  const uint64_t sequence_number = sequence_numbers_[slot].load(ros::memory_order_acquire);
+  if(sequence_number != 2 * (index + 1))
+  {
+    return false;
+  }
+  stamp = stamps_[slot];
+  seq = seqs_[slot];
+  std::copy(data_.begin() + slot * num_variables_, data_.begin() + (slot + 1) * num_variables_, data);
+  ros::atomic_thread_fence(ros::memory_order_acquire);
+  return (sequence_numbers_[slot].load(ros::memory_order_relaxed) == sequence_number);
+}
+
+bool MessageRingBuffer::get(const ros::Time& time,
+                            task_recorder2_msgs::DataSample& data_sample,
+                            const bool interpolate)
+{
+  if(!lookup(time, data_sample.header.stamp, data_sample.header.seq, data_sample.data, interpolate))
+  {
+    return false;
+  }
+  if(data_sample.names != names_)
+  {
+    data_sample.names = names_;
+  }
+  if(data_sample.header.frame_id != frame_id_)
+  {
+    data_sample.header.frame_id = frame_id_;
+  }
   return true;
 }
 
-bool MessageRingBuffer::get(const ros::Time& time, task_recorder2_msgs::DataSample& data_sample)
+bool MessageRingBuffer::get(const ros::Time& time,
+                            ros::Time& stamp,
+                            std::vector<double>& data,
+                            const bool interpolate)
 {
-  bool found = false;
-  boost::circular_buffer<task_recorder2_msgs::DataSample>::const_reverse_iterator rci;
-  for(rci = circular_buffer_->cb_.rbegin(); rci!= circular_buffer_->cb_.rend() && !found; ++rci)
+  uint32_t seq;
+  return lookup(time, stamp, seq, data, interpolate);
+}
+
+bool MessageRingBuffer::lookup(const ros::Time& time,
+                               ros::Time& stamp,
+                               uint32_t& seq,
+                               std::vector<double>& data,
+                               const bool interpolate)
+{
+  data.resize(num_variables_);
+  double* values = num_variables_ > 0 ? &data[0] : NULL;
+
+  // retry until none of the data samples that have been read got overwritten
+  while (true)
   {
-    if (rci->header.stamp <= time)
+    const uint64_t end = num_added_.load(ros::memory_order_acquire);
+    uint64_t begin = first_.load(ros::memory_order_acquire);
+    if(begin > end)
+    {
+      // restarted again in the meantime
+      continue;
+    }
+    if(end - begin > static_cast<uint64_t>(ring_buffer_size_))
+    {
+      begin = end - ring_buffer_size_;
+    }
+
+    // find the first data sample that is newer than time
+    uint64_t lower = begin;
+    uint64_t upper = end;
+    bool overwritten = false;
+    while (lower < upper && !overwritten)
+    {
+      const uint64_t middle = lower + (upper - lower) / 2;
+      ros::Time middle_stamp;
+      if(!readStamp(middle, middle_stamp))
+      {
+        overwritten = true;
+      }
+      else if(middle_stamp <= time)
+      {
+        lower = middle + 1;
+      }
+      else
+      {
+        upper = middle;
+      }
+    }
+    if(overwritten)
+    {
+      continue;
+    }
+    if(lower == begin)
+    {
+      return false;
+    }
+
+    const uint64_t index = lower - 1;
+    if(!read(index, stamp, seq, values))
+    {
+      continue;
+    }
+    if(!interpolate || lower == end)
+    {
+      return true;
+    }
+
+    // blend in the next data sample
+    const int slot = static_cast<int>(lower % ring_buffer_size_);
+    const uint64_t sequence_number = sequence_numbers_[slot].load(ros::memory_order_acquire);
+    if(sequence_number != 2 * (lower + 1))
+    {
+      continue;
+    }
+    const ros::Time next_stamp = stamps_[slot];
+    const double duration = (next_stamp - stamp).toSec();
+    const double alpha = duration > 0.0 ? (time - stamp).toSec() / duration : 0.0;
+    for (int i = 0; i < num_variables_; ++i)
+    {
+      values[i] += alpha * (data_[slot * num_variables_ + i] - values[i]);
+    }
+    ros::atomic_thread_fence(ros::memory_order_acquire);
+    if(sequence_numbers_[slot].load(ros::memory_order_relaxed) != sequence_number)
     {
-      data_sample = *rci;
-      found = true;
+      continue;
     }
+    stamp = time;
+    return true;
   }
-  return found;
 }
 
 }
@@ -0,0 +1,204 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		Tests the message ring buffer, in particular lookups that run
+                concurrently to a single writer.
+
+  \file		test_message_ring_buffer.cpp
+
+  \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <ros/atomic.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+// local includes
+#include <task_recorder2_utilities/message_ring_buffer.h>
+
+using namespace task_recorder2_utilities;
+
+static const int NUM_SAMPLES = 200000;
+
+/*! Data samples contain (t, 2t, generation) at time t, the generation is increased on each restart
+ */
+static task_recorder2_msgs::DataSample getDataSample(const int t, const int generation)
+{
+  task_recorder2_msgs::DataSample data_sample;
+  data_sample.header.stamp = ros::Time(t);
+  data_sample.header.seq = t;
+  data_sample.header.frame_id = "/base";
+  data_sample.names.push_back("t");
+  data_sample.names.push_back("two_t");
+  data_sample.names.push_back("generation");
+  data_sample.data.push_back(t);
+  data_sample.data.push_back(2.0 * t);
+  data_sample.data.push_back(generation);
+  return data_sample;
+}
+
+TEST(MessageRingBuffer, retainsMostRecent)
+{
+  MessageRingBuffer ring_buffer(getDataSample(0, 0), 8);
+  task_recorder2_msgs::DataSample data_sample;
+  // the default data sample is returned until the first data sample is added
+  ASSERT_TRUE(ring_buffer.get(ros::Time(1), data_sample));
+  EXPECT_DOUBLE_EQ(0.0, data_sample.data[0]);
+  for (int t = 1; t <= 20; ++t)
+  {
+    EXPECT_TRUE(ring_buffer.add(getDataSample(t, 0)));
+  }
+  EXPECT_FALSE(ring_buffer.get(ros::Time(12.5), data_sample));
+  ASSERT_TRUE(ring_buffer.get(ros::Time(15.5), data_sample));
+  EXPECT_EQ(ros::Time(15), data_sample.header.stamp);
+  EXPECT_EQ(15u, data_sample.header.seq);
+  EXPECT_EQ(std::string("/base"), data_sample.header.frame_id);
+  ASSERT_EQ(3u, data_sample.names.size());
+  EXPECT_DOUBLE_EQ(15.0, data_sample.data[0]);
+  ASSERT_TRUE(ring_buffer.get(ros::Time(100), data_sample));
+  EXPECT_EQ(ros::Time(20), data_sample.header.stamp);
+}
+
+TEST(MessageRingBuffer, interpolates)
+{
+  MessageRingBuffer ring_buffer(getDataSample(0, 0), 8);
+  for (int t = 1; t <= 4; ++t)
+  {
+    ring_buffer.add(getDataSample(t, 0));
+  }
+  task_recorder2_msgs::DataSample data_sample;
+  ASSERT_TRUE(ring_buffer.get(ros::Time(2.25), data_sample, true));
+  EXPECT_EQ(ros::Time(2.25), data_sample.header.stamp);
+  EXPECT_EQ(2u, data_sample.header.seq);
+  EXPECT_DOUBLE_EQ(2.25, data_sample.data[0]);
+  EXPECT_DOUBLE_EQ(4.5, data_sample.data[1]);
+
+  // the most recent data sample is not extrapolated
+  ASSERT_TRUE(ring_buffer.get(ros::Time(7), data_sample, true));
+  EXPECT_EQ(ros::Time(4), data_sample.header.stamp);
+  EXPECT_DOUBLE_EQ(4.0, data_sample.data[0]);
+}
+
+TEST(MessageRingBuffer, restarts)
+{
+  MessageRingBuffer ring_buffer(getDataSample(0, 0), 8);
+  for (int t = 1; t <= 6; ++t)
+  {
+    ring_buffer.add(getDataSample(t, 0));
+  }
+  ring_buffer.add(getDataSample(3, 1));
+  task_recorder2_msgs::DataSample data_sample;
+  EXPECT_FALSE(ring_buffer.get(ros::Time(2), data_sample));
+  ASSERT_TRUE(ring_buffer.get(ros::Time(5), data_sample));
+  EXPECT_EQ(ros::Time(3), data_sample.header.stamp);
+  EXPECT_DOUBLE_EQ(1.0, data_sample.data[2]);
+}
+
+void writeDataSamples(MessageRingBuffer& ring_buffer,
+                      ros::atomic<bool>& done)
+{
+  task_recorder2_msgs::DataSample data_sample = getDataSample(0, 0);
+  for (int generation = 0; generation < 2; ++generation)
+  {
+    for (int t = 1; t <= NUM_SAMPLES; ++t)
+    {
+      data_sample.header.stamp = ros::Time(t);
+      data_sample.header.seq = t;
+      data_sample.data[0] = t;
+      data_sample.data[1] = 2.0 * t;
+      data_sample.data[2] = generation;
+      ring_buffer.add(data_sample);
+    }
+  }
+  done.store(true);
+}
+
+void readDataSamples(MessageRingBuffer& ring_buffer,
+                     ros::atomic<bool>& done,
+                     ros::atomic<bool>& failed,
+                     ros::atomic<int>& num_found,
+                     unsigned int random_seed)
+{
+  task_recorder2_msgs::DataSample latest;
+  task_recorder2_msgs::DataSample data_sample;
+  int last_generation = 0;
+  int last_t = 0;
+  while (!done.load() && !failed.load())
+  {
+    if (!ring_buffer.get(ros::Time(2 * NUM_SAMPLES), latest))
+    {
+      continue;
+    }
+    // the most recent data sample never goes back in time, unless the writer restarted
+    const int generation = static_cast<int>(latest.data[2]);
+    const int t = static_cast<int>(latest.data[0]);
+    if (generation < last_generation || (generation == last_generation && t < last_t)
+        || latest.data[0] != latest.header.stamp.toSec() || latest.header.seq != static_cast<uint32_t>(t))
+    {
+      ADD_FAILURE() << "generation " << generation << " t " << t << " after generation " << last_generation << " t " << last_t;
+      failed.store(true);
+    }
+    last_generation = generation;
+    last_t = t;
+
+    // interpolate between two of the recent data samples
+    const double time = t - (rand_r(&random_seed) % 64) - 0.5;
+    if (!ring_buffer.get(ros::Time(time), data_sample, true))
+    {
+      continue;
+    }
+    num_found.fetch_add(1);
+    // data samples are only interpolated within a generation, the most recent one is returned as is
+    const bool interpolated = (data_sample.header.stamp == ros::Time(time) && data_sample.data[0] == time);
+    const bool most_recent = (data_sample.data[2] > generation && data_sample.data[0] == data_sample.header.stamp.toSec()
+        && data_sample.header.stamp < ros::Time(time));
+    if (data_sample.data[2] < generation || data_sample.data[1] != 2.0 * data_sample.data[0]
+        || !(interpolated || most_recent))
+    {
+      ADD_FAILURE() << "interpolated (" << data_sample.data[0] << ", " << data_sample.data[1] << ", "
+          << data_sample.data[2] << ") at " << time << " in generation " << generation;
+      failed.store(true);
+    }
+  }
+}
+
+TEST(MessageRingBuffer, concurrentReaders)
+{
+  MessageRingBuffer ring_buffer(getDataSample(0, 0), 128);
+  ros::atomic<bool> done(false);
+  ros::atomic<bool> failed(false);
+  ros::atomic<int> num_found(0);
+
+  const unsigned int num_readers = std::max(2u, boost::thread::hardware_concurrency());
+  boost::thread_group readers;
+  for (unsigned int i = 0; i < num_readers; ++i)
+  {
+    readers.create_thread(boost::bind(readDataSamples, boost::ref(ring_buffer), boost::ref(done),
+                                      boost::ref(failed), boost::ref(num_found), i));
+  }
+  writeDataSamples(ring_buffer, done);
+  readers.join_all();
+
+  EXPECT_FALSE(failed.load());
+  EXPECT_GT(num_found.load(), 0);
+
+  // after the restart, only data samples of the second generation are found
+  task_recorder2_msgs::DataSample data_sample;
+  ASSERT_TRUE(ring_buffer.get(ros::Time(NUM_SAMPLES - 0.5), data_sample, true));
+  EXPECT_DOUBLE_EQ(1.0, data_sample.data[2]);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
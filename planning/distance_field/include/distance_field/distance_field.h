@@ -41,6 +41,8 @@
 #include <tf/LinearMath/Vector3.h>
 #include <tf/LinearMath/Quaternion.h>
 #include <tf/LinearMath/Transform.h>
+#include <cmath>
+#include <algorithm>
 #include <vector>
 #include <list>
 #include <ros/ros.h>
@@ -86,9 +88,11 @@ public:
    * @param origin_y Origin (y axis) of the container
    * @param origin_z Origin (z axis) of the container
    * @param default_object The object to return for an out-of-bounds query
+   * @param storage_order The order in which the voxels are stored in memory
    */
   DistanceField(double size_x, double size_y, double size_z, double resolution,
-      double origin_x, double origin_y, double origin_z, T default_object);
+      double origin_x, double origin_y, double origin_z, T default_object,
+      typename VoxelGrid<T>::StorageOrder storage_order = VoxelGrid<T>::ROW_MAJOR);
 
   virtual ~DistanceField();
 
@@ -122,6 +126,28 @@ public:
    */
   double getDistanceGradient(double x, double y, double z, double& gradient_x, double& gradient_y, double& gradient_z) const;
 
+  /**
+   * \brief Gets the trilinearly interpolated distance at a location and its gradient.
+   *
+   * Unlike getDistanceGradient(), the distance and gradient are continuous in the location.
+   * Locations outside the grid return the distance of the default object, and 0 gradient. In the outer half
+   * voxel band of the grid, the distance is clamped to the boundary voxels, and its gradient across the band is 0.
+   */
+  double getInterpolatedDistanceGradient(double x, double y, double z,
+                                         double& gradient_x, double& gradient_y, double& gradient_z) const;
+
+  /**
+   * \brief Gets the trilinearly interpolated distances and gradients at a batch of locations.
+   *
+   * Large batches are split among OpenMP threads.
+   *
+   * @param points num_points locations, stored contiguously as (x,y,z) triplets
+   * @param num_points The number of locations
+   * @param distances Output array of num_points distances
+   * @param gradients Output array of num_points (x,y,z) gradient triplets, may be NULL
+   */
+  void getInterpolatedDistanceGradients(const double* points, int num_points, double* distances, double* gradients) const;
+
   /**
    * \brief Gets the distance to the closest obstacle at the given integer cell location.
    */
@@ -162,11 +188,46 @@ public:
                        const std::string & frame_id, const ros::Time stamp,
                        visualization_msgs::Marker& marker );
 
+  /**
+   * \brief Checks whether distance queries are answered from the packed distance plane.
+   */
+  bool hasDistancePlane() const;
+
+  /**
+   * \brief Frees the voxels, such that only the packed distance plane (2 bytes per voxel) remains for queries.
+   *
+   * Obstacles can not be added or removed, and the voxels can not be accessed, until reset() is called.
+   * \return False if the field has no distance plane, it is left unchanged then.
+   */
+  virtual bool compact();
+
+  /**
+   * \brief Checks whether compact() has freed the voxels.
+   */
+  bool isCompact() const;
+
+  /**
+   * \brief Gets the number of bytes allocated for the voxels, the packed distance plane and their lookup tables.
+   */
+  virtual size_t getMemoryUsage() const;
+
 protected:
   virtual double getDistance(const T& object) const=0;
 
+  /**
+   * \brief Packed distance codes of all voxels, in the storage order of the grid.
+   *
+   * Implementations that keep it up to date also fill distance_code_table_, distance queries then
+   * only touch two bytes per voxel instead of the whole voxel. Empty if not used.
+   */
+  std::vector<unsigned short> distance_plane_;
+  std::vector<double> distance_code_table_;	/**< Distance for each code in distance_plane_ */
+
 private:
-  int inv_twice_resolution_;
+  double inv_twice_resolution_;
+  double inv_resolution_;
+
+  double getDistanceFromRef(int ref) const;
 };
 
 //////////////////////////// template function definitions follow //////////////
@@ -179,16 +240,58 @@ DistanceField<T>::~DistanceField()
 
 template <typename T>
 DistanceField<T>::DistanceField(double size_x, double size_y, double size_z, double resolution,
-    double origin_x, double origin_y, double origin_z, T default_object):
-      VoxelGrid<T>(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, default_object)
+    double origin_x, double origin_y, double origin_z, T default_object,
+    typename VoxelGrid<T>::StorageOrder storage_order):
+      VoxelGrid<T>(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, default_object, storage_order)
 {
   inv_twice_resolution_ = 1.0/(2.0*resolution);
+  inv_resolution_ = 1.0/resolution;
 }
 
 template <typename T>
 double DistanceField<T>::getDistance(double x, double y, double z) const
 {
-  return getDistance((*this)(x,y,z));
+  if (distance_plane_.empty())
+    return getDistance((*this)(x,y,z));
+
+  int gx, gy, gz;
+  if (!this->worldToGrid(x, y, z, gx, gy, gz))
+    return getDistance(this->default_object_);
+  return distance_code_table_[distance_plane_[this->ref(gx,gy,gz)]];
+}
+
+template <typename T>
+bool DistanceField<T>::hasDistancePlane() const
+{
+  return !distance_plane_.empty();
+}
+
+template <typename T>
+bool DistanceField<T>::compact()
+{
+  if (distance_plane_.empty())
+    return false;
+  this->freeData();
+  return true;
+}
+
+template <typename T>
+bool DistanceField<T>::isCompact() const
+{
+  return !this->hasData();
+}
+
+template <typename T>
+size_t DistanceField<T>::getMemoryUsage() const
+{
+  size_t bytes = 0;
+  if (this->hasData())
+    bytes += size_t(this->num_storage_cells_) * sizeof(T);
+  bytes += distance_plane_.capacity() * sizeof(unsigned short);
+  bytes += distance_code_table_.capacity() * sizeof(double);
+  for (int dim=0; dim<3; ++dim)
+    bytes += this->morton_offsets_[dim].capacity() * sizeof(int);
+  return bytes;
 }
 
 template <typename T>
@@ -216,9 +319,103 @@ double DistanceField<T>::getDistanceGradient(double x, double y, double z, doubl
 
 }
 
+template <typename T>
+inline double DistanceField<T>::getDistanceFromRef(int ref) const
+{
+  if (!distance_plane_.empty())
+    return distance_code_table_[distance_plane_[ref]];
+  return getDistance(this->data_[ref]);
+}
+
+template <typename T>
+inline double DistanceField<T>::getInterpolatedDistanceGradient(double x, double y, double z,
+    double& gradient_x, double& gradient_y, double& gradient_z) const
+{
+  // if out of bounds, return the distance of the default object, and 0 gradient
+  int gx, gy, gz;
+  if (!this->worldToGrid(x, y, z, gx, gy, gz))
+  {
+    gradient_x = 0.0;
+    gradient_y = 0.0;
+    gradient_z = 0.0;
+    return getDistance(this->default_object_);
+  }
+
+  // continuous grid coordinates, voxel centers are at integer coordinates
+  double c[3] = {(x - this->origin_[this->DIM_X])*inv_resolution_,
+                 (y - this->origin_[this->DIM_Y])*inv_resolution_,
+                 (z - this->origin_[this->DIM_Z])*inv_resolution_};
+
+  // in the outer half voxel band the distance is clamped to the first / last voxel, and does not change along that axis
+  int g[3];
+  int g1[3];
+  bool clamped[3];
+  for (int dim=0; dim<3; ++dim)
+  {
+    const int last = this->num_cells_[dim]-1;
+    clamped[dim] = (c[dim] < 0.0 || c[dim] > last);
+    c[dim] = std::max(0.0, std::min(c[dim], double(last)));
+    g[dim] = std::min(int(floor(c[dim])), last);
+    g1[dim] = std::min(g[dim]+1, last);
+  }
+
+  // gather the eight surrounding voxels, d[4*i + 2*j + k] is voxel (gx+i, gy+j, gz+k)
+  const int ox[2] = {this->getOffset(this->DIM_X, g[0]), this->getOffset(this->DIM_X, g1[0])};
+  const int oy[2] = {this->getOffset(this->DIM_Y, g[1]), this->getOffset(this->DIM_Y, g1[1])};
+  const int oz[2] = {this->getOffset(this->DIM_Z, g[2]), this->getOffset(this->DIM_Z, g1[2])};
+  double d[8];
+  for (int i=0; i<8; ++i)
+    d[i] = getDistanceFromRef(ox[i>>2] + oy[(i>>1)&1] + oz[i&1]);
+
+  double tx = c[0] - g[0];
+  double ty = c[1] - g[1];
+  double tz = c[2] - g[2];
+
+  // interpolate along z, then y, then x
+  double d00 = d[0] + tz*(d[1]-d[0]);
+  double d01 = d[2] + tz*(d[3]-d[2]);
+  double d10 = d[4] + tz*(d[5]-d[4]);
+  double d11 = d[6] + tz*(d[7]-d[6]);
+  double d0 = d00 + ty*(d01-d00);
+  double d1 = d10 + ty*(d11-d10);
+
+  gradient_x = (d1 - d0)*inv_resolution_;
+  gradient_y = ((1.0-tx)*(d01-d00) + tx*(d11-d10))*inv_resolution_;
+  gradient_z = ((1.0-tx)*((1.0-ty)*(d[1]-d[0]) + ty*(d[3]-d[2])) + tx*((1.0-ty)*(d[5]-d[4]) + ty*(d[7]-d[6])))*inv_resolution_;
+  if (clamped[this->DIM_X])
+    gradient_x = 0.0;
+  if (clamped[this->DIM_Y])
+    gradient_y = 0.0;
+  if (clamped[this->DIM_Z])
+    gradient_z = 0.0;
+  return d0 + tx*(d1-d0);
+}
+
+template <typename T>
+void DistanceField<T>::getInterpolatedDistanceGradients(const double* points, int num_points, double* distances, double* gradients) const
+{
+  // below this batch size the queries are not worth distributing to threads
+  const int min_parallel_batch_size = 1024;
+  double gradient[3];
+
+#pragma omp parallel for private(gradient) if(num_points >= min_parallel_batch_size)
+  for (int i=0; i<num_points; ++i)
+  {
+    distances[i] = getInterpolatedDistanceGradient(points[3*i], points[3*i+1], points[3*i+2], gradient[0], gradient[1], gradient[2]);
+    if (gradients)
+    {
+      gradients[3*i] = gradient[0];
+      gradients[3*i+1] = gradient[1];
+      gradients[3*i+2] = gradient[2];
+    }
+  }
+}
+
 template <typename T>
 double DistanceField<T>::getDistanceFromCell(int x, int y, int z) const
 {
+  if (!distance_plane_.empty())
+    return distance_code_table_[distance_plane_[this->ref(x,y,z)]];
   return getDistance(this->getCell(x,y,z));
 }
 
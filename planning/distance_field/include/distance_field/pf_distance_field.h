@@ -52,7 +52,7 @@ class PFDistanceField: public DistanceField<float>
 {
 public:
   PFDistanceField(double size_x, double size_y, double size_z, double resolution,
-      double origin_x, double origin_y, double origin_z);
+      double origin_x, double origin_y, double origin_z, StorageOrder storage_order = ROW_MAJOR);
 
   virtual ~PFDistanceField();
 
@@ -60,15 +60,35 @@ public:
   typedef std::vector<float> FloatArray;
   typedef std::vector<int>   IntArray;
 
-  virtual void addPointsToField(const std::vector<tf::Vector3> points);
+  virtual void addPointsToField(const std::vector<tf::Vector3>& points);
   virtual void reset();
 
+  /**
+   * \brief Restricts the updates of addPointsToField() to the bounding box of the new points, grown by the radius.
+   *
+   * The distance transform of the new points is computed within this box only, and merged into the
+   * field. Distances that are larger than the radius may hence be overestimated. A radius <= 0
+   * updates the whole grid, which is the default.
+   */
+  void setUpdateRadius(double radius);
+
   const float DT_INF;
 
 private:
+  /// \brief True if no points have been added since the last reset
+  bool empty_;
+  double update_radius_;
+
+  /// \brief Per dimension offsets of the cells into the grid, see VoxelGrid::getOffset()
+  IntArray grid_offsets_[3];
+
+  /// \brief Scratch grid for the distance transform of the new points
+  FloatArray window_;
+
   inline float sqr(float x) { return x*x; }
-  void dt(const FloatArray& f, size_t nn, FloatArray& ft, IntArray& v, FloatArray& z);
-  void computeDT();
+  void dt(const float* f, int n, float* ft, int* v, float* z, float* h);
+  void computeDT(float* data, const IntArray offsets[3], const int num_cells[3]);
+  void computeDTAlong(float* data, const IntArray offsets[3], const int num_cells[3], int dim);
   virtual double getDistance(const float& object) const;
 
 };
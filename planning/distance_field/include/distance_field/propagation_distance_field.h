@@ -85,6 +85,28 @@ struct PropDistanceFieldVoxel
   static const int UNINITIALIZED=-1;
 };
 
+/**
+ * \brief A slab (range of x indices) of the grid that is propagated by a single thread.
+ *
+ * Voxels that are queued for expansion are kept in separate bucket queues depending
+ * on whether they have been queued by the slab itself or by one of its neighboring
+ * slabs, such that every queue only has a single writer.
+ */
+struct PropagationSlab
+{
+  enum Source
+  {
+    FROM_LEFT = 0,
+    FROM_SELF = 1,
+    FROM_RIGHT = 2,
+    NUM_SOURCES = 3
+  };
+
+  int begin_x_;                 /**< First x index of the slab */
+  int end_x_;                   /**< One past the last x index of the slab */
+  std::vector<std::vector<PropDistanceFieldVoxel*> > bucket_queues_[NUM_SOURCES];
+};
+
 struct SignedPropDistanceFieldVoxel : public PropDistanceFieldVoxel
 {
     SignedPropDistanceFieldVoxel();
@@ -112,9 +134,12 @@ public:
 
   /**
    * \brief Constructor for the DistanceField.
+   *
+   * Distance queries are answered from a packed 16 bit plane of squared distances, unless the
+   * squared max distance in voxels exceeds its range. Voxels must hence not be modified through getCell().
    */
   PropagationDistanceField(double size_x, double size_y, double size_z, double resolution,
-      double origin_x, double origin_y, double origin_z, double max_distance);
+      double origin_x, double origin_y, double origin_z, double max_distance, StorageOrder storage_order = ROW_MAJOR);
 
   virtual ~PropagationDistanceField();
 
@@ -131,22 +156,81 @@ public:
   virtual void addPointsToField(const std::vector<tf::Vector3>& points);
 
   /**
-   * \brief Resets the distance field to the max_distance.
+   * \brief Resets the distance field to the max_distance and forgets all obstacle voxels.
    */
   virtual void reset();
 
+  /**
+   * \brief Frees the voxels and the per voxel obstacle flags, see DistanceField::compact().
+   */
+  virtual bool compact();
+
+  virtual size_t getMemoryUsage() const;
+
+  /**
+   * \brief Sets the number of threads used to propagate the distances.
+   *
+   * With more than one thread the grid is split into slabs along the x axis. Every other slab is
+   * propagated in parallel, such that no two threads ever update the same voxel. The result only
+   * depends on the number of threads through the order in which equidistant voxels are visited.
+   */
+  void setNumThreads(int num_threads);
+
+  /**
+   * \brief Gets the number of threads used to propagate the distances.
+   */
+  int getNumThreads() const;
+
+  /**
+   * \brief Enables dirty region tracking for iterative updates.
+   *
+   * Instead of tracing the voxels whose closest obstacle has been removed, the bounding box
+   * around all added and removed obstacle voxels (grown by the max distance) is reset and
+   * re-propagated from its boundary and the obstacles inside of it.
+   */
+  void setDirtyRegionTracking(bool dirty_region_tracking);
+
+  /**
+   * \brief Gets the (inclusive) bounds of the region that has been re-propagated by the last update.
+   * \return False if the last update did not change any obstacle voxels.
+   */
+  bool getDirtyRegion(int3& min_corner, int3& max_corner) const;
+
   using DistanceField::getDistance;
 
 private:
-  /// \brief The set of all the obstacle voxels
-  typedef std::set<int3, compareInt3> VoxelSet;
+  /// \brief The list of all the obstacle voxels
+  typedef std::vector<int3> VoxelSet;
   VoxelSet object_voxel_locations_;
 
+  /// \brief Per voxel flags, used to look up obstacle voxels in constant time
+  enum VoxelFlag
+  {
+    OBSTACLE_VOXEL = 1,
+    NEW_OBSTACLE_VOXEL = 2
+  };
+  std::vector<unsigned char> voxel_flags_;
+
   /// \brief Structure used to hold propogation frontier
   std::vector<std::vector<PropDistanceFieldVoxel*> > bucket_queue_;
   double max_distance_;
+  int max_distance_cells_;
   int max_distance_sq_;
 
+  /// \brief Slabs used by the parallel propagation, and the slab index of each x index
+  int num_threads_;
+  std::vector<PropagationSlab> slabs_;
+  std::vector<int> slab_index_;
+
+  /// \brief Dirty region tracking
+  bool dirty_region_tracking_;
+  bool has_dirty_region_;
+  int3 dirty_region_min_;
+  int3 dirty_region_max_;
+
+  /// \brief Preallocated stack used when removing obstacle voxels
+  std::vector<int3> removal_stack_;
+
   std::vector<double> sqrt_table_;
 
   // neighborhoods:
@@ -160,8 +244,18 @@ private:
 
   void addNewObstacleVoxels(const VoxelSet& points);
   void removeObstacleVoxels(const VoxelSet& points);
+  // resets the bounding box around the changed voxels and queues its boundary and obstacles for propagation
+  void resetDirtyRegion(const VoxelSet& points_added, const VoxelSet& points_removed);
+  void setObstacleVoxel(const int3& loc, int initial_update_direction);
   // starting with the voxels on the queue, propogate values to neighbors up to a certain distance.
   void propogate();
+  void propogateSlabs();
+  void propogateSlab(int slab, int distance_sq);
+  // expands a single voxel of the given bucket, queuing the updated neighbors into the bucket queue (slab<0) or the slab queues
+  void propogateVoxel(PropDistanceFieldVoxel* vptr, int distance_sq, int slab);
+  void initSlabs();
+  // sets the squared distance of the voxel, and keeps the packed distance plane in sync
+  void setDistanceSquare(PropDistanceFieldVoxel* voxel, int distance_sq);
   virtual double getDistance(const PropDistanceFieldVoxel& object) const;
   int getDirectionNumber(int dx, int dy, int dz) const;
   int3 getLocationDifference(int directionNumber) const;	// TODO- separate out neighborhoods
@@ -188,13 +282,30 @@ inline double PropagationDistanceField::getDistance(const PropDistanceFieldVoxel
   return sqrt_table_[object.distance_square_];
 }
 
+inline void PropagationDistanceField::setDistanceSquare(PropDistanceFieldVoxel* voxel, int distance_sq)
+{
+  voxel->distance_square_ = distance_sq;
+  if (!distance_plane_.empty())
+    distance_plane_[voxel - data_] = distance_sq;
+}
+
+inline int PropagationDistanceField::getNumThreads() const
+{
+  return num_threads_;
+}
+
+inline void PropagationDistanceField::setDirtyRegionTracking(bool dirty_region_tracking)
+{
+  dirty_region_tracking_ = dirty_region_tracking;
+}
+
 
 class SignedPropagationDistanceField : public DistanceField<SignedPropDistanceFieldVoxel>
 {
   public:
 
     SignedPropagationDistanceField(double size_x, double size_y, double size_z, double resolution, double origin_x,
-                                   double origin_y, double origin_z, double max_distance);
+                                   double origin_y, double origin_z, double max_distance, StorageOrder storage_order = ROW_MAJOR);
     virtual ~SignedPropagationDistanceField();
 
     virtual void addPointsToField(const std::vector<tf::Vector3> &points);
@@ -222,6 +333,8 @@ class SignedPropagationDistanceField : public DistanceField<SignedPropDistanceFi
      int getDirectionNumber(int dx, int dy, int dz) const;
      void initNeighborhoods();
      static int eucDistSq(int3 point1, int3 point2);
+     // recomputes the packed distance plane from the voxels
+     void updateDistancePlane();
 };
 
 
@@ -229,8 +342,8 @@ class SignedPropagationDistanceField : public DistanceField<SignedPropDistanceFi
 inline SignedPropDistanceFieldVoxel::SignedPropDistanceFieldVoxel(int distance_sq_positive, int distance_sq_negative):
   positive_distance_square_(distance_sq_positive),
   negative_distance_square_(distance_sq_negative),
-  closest_positive_point_(SignedPropDistanceFieldVoxel::UNINITIALIZED),
-  closest_negative_point_(SignedPropDistanceFieldVoxel::UNINITIALIZED)
+  closest_positive_point_(int3::Constant(SignedPropDistanceFieldVoxel::UNINITIALIZED)),
+  closest_negative_point_(int3::Constant(SignedPropDistanceFieldVoxel::UNINITIALIZED))
 {
 }
 
@@ -38,6 +38,7 @@
 #define DF_VOXEL_GRID_H_
 
 #include <algorithm>
+#include <vector>
 
 namespace distance_field
 {
@@ -49,6 +50,19 @@ template <typename T>
 class VoxelGrid
 {
 public:
+  /**
+   * \brief Order in which the cells are stored in memory.
+   *
+   * ROW_MAJOR stores the cells with z running fastest. MORTON groups the cells into bricks of 8x8x8
+   * cells, which are stored in Z-curve (Morton) order, such that neighboring cells are likely to
+   * share a cache line. The grid is padded to a multiple of the brick size in every dimension.
+   */
+  enum StorageOrder
+  {
+    ROW_MAJOR = 0,
+    MORTON = 1
+  };
+
   /**
    * Constructor for the VoxelGrid.
    *
@@ -60,9 +74,10 @@ public:
    * @param origin_y Origin (y axis) of the container
    * @param origin_z Origin (z axis) of the container
    * @param default_object The object to return for an out-of-bounds query
+   * @param storage_order The order in which the cells are stored in memory
    */
   VoxelGrid(double size_x, double size_y, double size_z, double resolution,
-      double origin_x, double origin_y, double origin_z, T default_object);
+      double origin_x, double origin_y, double origin_z, T default_object, StorageOrder storage_order = ROW_MAJOR);
   virtual ~VoxelGrid();
 
   /**
@@ -117,6 +132,11 @@ public:
    */
   int getNumCells(Dimension dim) const;
 
+  /**
+   * \brief Gets the order in which the cells are stored in memory.
+   */
+  StorageOrder getStorageOrder() const;
+
   /**
    * \brief Converts grid coordinates to world coordinates.
    */
@@ -127,6 +147,11 @@ public:
    */
   bool worldToGrid(double world_x, double world_y, double world_z, int& x, int& y, int& z) const;
 
+  /**
+   * \brief Checks whether the data elements are allocated, see freeData().
+   */
+  bool hasData() const;
+
 protected:
   T* data_;			/**< Storage for data elements */
   T default_object_;		/**< The default object to return in case of out-of-bounds query */
@@ -136,14 +161,31 @@ protected:
   double origin_[3];
   int num_cells_[3];
   int num_cells_total_;
+  int num_storage_cells_;	/**< Number of allocated cells, including the padding of the Morton bricks */
   int stride1_;
   int stride2_;
+  StorageOrder storage_order_;
+  std::vector<int> morton_offsets_[3];	/**< Per dimension offsets into data_ for the MORTON storage order */
+
+  static const int MORTON_BRICK_BITS = 3;
+
+  /**
+   * \brief Frees the storage of the data elements. No cell may be accessed until reset() allocates it again.
+   */
+  void freeData();
 
   /**
    * \brief Gets the reference in the data_ array for the given integer x,y,z location
    */
   int ref(int x, int y, int z) const;
 
+  /**
+   * \brief Gets the contribution of a single dimension to the reference in the data_ array
+   *
+   * The reference of a cell is the sum of the offsets of its three coordinates.
+   */
+  int getOffset(Dimension dim, int cell) const;
+
   /**
    * \brief Gets the cell number from the location
    */
@@ -169,7 +211,7 @@ protected:
 
 template<typename T>
 VoxelGrid<T>::VoxelGrid(double size_x, double size_y, double size_z, double resolution,
-    double origin_x, double origin_y, double origin_z, T default_object)
+    double origin_x, double origin_y, double origin_z, T default_object, StorageOrder storage_order)
 {
   size_[DIM_X] = size_x;
   size_[DIM_Y] = size_y;
@@ -188,9 +230,34 @@ VoxelGrid<T>::VoxelGrid(double size_x, double size_y, double size_z, double reso
 
   stride1_ = num_cells_[DIM_Y]*num_cells_[DIM_Z];
   stride2_ = num_cells_[DIM_Z];
+  storage_order_ = storage_order;
+  num_storage_cells_ = num_cells_total_;
+
+  if (storage_order_ == MORTON)
+  {
+    const int brick_size = 1 << MORTON_BRICK_BITS;
+    int num_bricks[3];
+    for (int i=DIM_X; i<=DIM_Z; ++i)
+      num_bricks[i] = (num_cells_[i] + brick_size - 1) / brick_size;
+    const int brick_strides[3] = {num_bricks[DIM_Y]*num_bricks[DIM_Z], num_bricks[DIM_Z], 1};
+    num_storage_cells_ = num_bricks[DIM_X]*num_bricks[DIM_Y]*num_bricks[DIM_Z]*brick_size*brick_size*brick_size;
+
+    // the offset of a cell is the offset of its brick plus its interleaved (x,y,z) bits within the brick
+    for (int i=DIM_X; i<=DIM_Z; ++i)
+    {
+      morton_offsets_[i].resize(num_cells_[i]);
+      for (int cell=0; cell<num_cells_[i]; ++cell)
+      {
+        int interleaved = 0;
+        for (int bit=0; bit<MORTON_BRICK_BITS; ++bit)
+          interleaved |= ((cell >> bit) & 1) << (3*bit + (DIM_Z - i));
+        morton_offsets_[i][cell] = (cell >> MORTON_BRICK_BITS) * brick_strides[i] * brick_size*brick_size*brick_size + interleaved;
+      }
+    }
+  }
 
   // initialize the data:
-  data_ = new T[num_cells_total_];
+  data_ = new T[num_storage_cells_];
 
 }
 
@@ -218,9 +285,23 @@ inline bool VoxelGrid<T>::isCellValid(Dimension dim, int cell) const
 template<typename T>
 inline int VoxelGrid<T>::ref(int x, int y, int z) const
 {
+  if (storage_order_ == MORTON)
+    return morton_offsets_[DIM_X][x] + morton_offsets_[DIM_Y][y] + morton_offsets_[DIM_Z][z];
   return x*stride1_ + y*stride2_ + z;
 }
 
+template<typename T>
+inline int VoxelGrid<T>::getOffset(Dimension dim, int cell) const
+{
+  if (storage_order_ == MORTON)
+    return morton_offsets_[dim][cell];
+  if (dim == DIM_X)
+    return cell*stride1_;
+  if (dim == DIM_Y)
+    return cell*stride2_;
+  return cell;
+}
+
 template<typename T>
 inline double VoxelGrid<T>::getSize(Dimension dim) const
 {
@@ -245,6 +326,12 @@ inline int VoxelGrid<T>::getNumCells(Dimension dim) const
   return num_cells_[dim];
 }
 
+template<typename T>
+inline typename VoxelGrid<T>::StorageOrder VoxelGrid<T>::getStorageOrder() const
+{
+  return storage_order_;
+}
+
 template<typename T>
 inline const T& VoxelGrid<T>::operator()(double x, double y, double z) const
 {
@@ -290,7 +377,22 @@ inline double VoxelGrid<T>::getLocationFromCell(Dimension dim, int cell) const
 template<typename T>
 inline void VoxelGrid<T>::reset(T initial)
 {
-  std::fill(data_, data_+num_cells_total_, initial);
+  if (data_ == NULL)
+    data_ = new T[num_storage_cells_];
+  std::fill(data_, data_+num_storage_cells_, initial);
+}
+
+template<typename T>
+inline bool VoxelGrid<T>::hasData() const
+{
+  return data_ != NULL;
+}
+
+template<typename T>
+inline void VoxelGrid<T>::freeData()
+{
+  delete[] data_;
+  data_ = NULL;
 }
 
 template<typename T>
@@ -36,101 +36,174 @@
 
 #include <distance_field/pf_distance_field.h>
 #include <limits>
+#include <algorithm>
+#include <cmath>
 
 namespace distance_field
 {
 
 PFDistanceField::PFDistanceField(double size_x, double size_y, double size_z, double resolution,
-    double origin_x, double origin_y, double origin_z):
-  DistanceField<float>(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, DT_INF),
+    double origin_x, double origin_y, double origin_z, StorageOrder storage_order):
+  DistanceField<float>(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, std::numeric_limits<float>::max(),
+                       storage_order),
   DT_INF(std::numeric_limits<float>::max())
 {
-
+  for (int dim=DIM_X; dim<=DIM_Z; ++dim)
+  {
+    grid_offsets_[dim].resize(num_cells_[dim]);
+    for (int cell=0; cell<num_cells_[dim]; ++cell)
+      grid_offsets_[dim][cell] = getOffset(Dimension(dim), cell);
+  }
+  update_radius_ = 0.0;
+  reset();
 }
 
 PFDistanceField::~PFDistanceField()
 {
 }
 
-void PFDistanceField::addPointsToField(const std::vector<tf::Vector3> points)
+void PFDistanceField::setUpdateRadius(double radius)
+{
+  update_radius_ = radius;
+}
+
+void PFDistanceField::addPointsToField(const std::vector<tf::Vector3>& points)
 {
   int x, y, z;
   float init = 0.0;
+
+  if (empty_ && update_radius_ <= 0.0)
+  {
+    // the transform of the obstacle indicator function is the distance field itself
+    for (unsigned int i=0; i<points.size(); ++i)
+    {
+      bool valid = worldToGrid(points[i].x(), points[i].y(), points[i].z(), x, y, z);
+      if (!valid)
+        continue;
+      setCell(x,y,z, init);
+    }
+    computeDT(data_, grid_offsets_, num_cells_);
+    empty_ = false;
+    return;
+  }
+
+  // otherwise the field is the minimum of the current field and the transform of the new points,
+  // which only needs to be computed around the new points
+  IntArray new_cells;
+  new_cells.reserve(3*points.size());
+  int min_cell[3] = {num_cells_[DIM_X], num_cells_[DIM_Y], num_cells_[DIM_Z]};
+  int max_cell[3] = {-1, -1, -1};
   for (unsigned int i=0; i<points.size(); ++i)
   {
     bool valid = worldToGrid(points[i].x(), points[i].y(), points[i].z(), x, y, z);
-    if (!valid)
+    if (!valid || getCell(x,y,z) == init)
       continue;
-    setCell(x,y,z, init);
+    int cell[3] = {x, y, z};
+    for (int dim=DIM_X; dim<=DIM_Z; ++dim)
+    {
+      new_cells.push_back(cell[dim]);
+      min_cell[dim] = std::min(min_cell[dim], cell[dim]);
+      max_cell[dim] = std::max(max_cell[dim], cell[dim]);
+    }
   }
-  computeDT();
-}
+  if (new_cells.empty())
+    return;
 
-void PFDistanceField::computeDT()
-{
+  int radius = std::max(num_cells_[DIM_X], std::max(num_cells_[DIM_Y], num_cells_[DIM_Z]));
+  if (update_radius_ > 0.0)
+    radius = int(ceil(update_radius_ / resolution_[DIM_X]));
 
-  size_t nx = num_cells_[DIM_X];
-  size_t ny = num_cells_[DIM_Y];
-  size_t nz = num_cells_[DIM_Z];
-
-    size_t     maxdim = std::max( nx, std::max(ny, nz) );
-    FloatArray f(maxdim), ft(maxdim), zz(maxdim+1);
-    IntArray   v(maxdim);
-
-    // along z
-    for (size_t y=0; y<ny; ++y) {
-        for (size_t x=0; x<nx; ++x) {
-            for (size_t z=0; z<nz; ++z) {
-                f[z] = getCell(x,y,z);
-            }
-            dt(f, nz, ft, v, zz);
-            for (size_t z=0; z<nz; ++z) {
-                setCell(x,y,z,ft[z]);
-            }
-        }
-    }
+  int window_cells[3];
+  IntArray window_offsets[3];
+  int window_size = 1;
+  for (int dim=DIM_X; dim<=DIM_Z; ++dim)
+  {
+    min_cell[dim] = std::max(min_cell[dim] - radius, 0);
+    max_cell[dim] = std::min(max_cell[dim] + radius, num_cells_[dim] - 1);
+    window_cells[dim] = max_cell[dim] - min_cell[dim] + 1;
+    window_size *= window_cells[dim];
+  }
+  for (int dim=DIM_X; dim<=DIM_Z; ++dim)
+  {
+    int stride = 1;
+    for (int inner=dim+1; inner<=DIM_Z; ++inner)
+      stride *= window_cells[inner];
+    window_offsets[dim].resize(window_cells[dim]);
+    for (int cell=0; cell<window_cells[dim]; ++cell)
+      window_offsets[dim][cell] = cell*stride;
+  }
 
-    // along y
-    for (size_t z=0; z<nz; ++z) {
-        for (size_t x=0; x<nx; ++x) {
-            for (size_t y=0; y<ny; ++y) {
-                f[y] = getCell(x,y,z);
-            }
-            dt(f, ny, ft, v, zz);
-            for (size_t y=0; y<ny; ++y) {
-                setCell(x,y,z,ft[y]);
-            }
-        }
-    }
+  window_.assign(window_size, DT_INF);
+  for (unsigned int i=0; i<new_cells.size(); i+=3)
+  {
+    window_[window_offsets[DIM_X][new_cells[i] - min_cell[DIM_X]] + window_offsets[DIM_Y][new_cells[i+1] - min_cell[DIM_Y]]
+            + window_offsets[DIM_Z][new_cells[i+2] - min_cell[DIM_Z]]] = init;
+  }
+  computeDT(&window_[0], window_offsets, window_cells);
 
-    // along x
-    for (size_t z=0; z<nz; ++z) {
-        for (size_t y=0; y<ny; ++y) {
-            for (size_t x=0; x<nx; ++x) {
-                f[x] = getCell(x,y,z);
-            }
-            dt(f, nx, ft, v, zz);
-            for (size_t x=0; x<nx; ++x) {
-                setCell(x,y,z,ft[x]);
-            }
-        }
+  // merge the window into the field
+#pragma omp parallel for
+  for (int wx=0; wx<window_cells[DIM_X]; ++wx)
+  {
+    for (int wy=0; wy<window_cells[DIM_Y]; ++wy)
+    {
+      const float* window_line = &window_[window_offsets[DIM_X][wx] + window_offsets[DIM_Y][wy]];
+      int grid_base = grid_offsets_[DIM_X][min_cell[DIM_X] + wx] + grid_offsets_[DIM_Y][min_cell[DIM_Y] + wy];
+      for (int wz=0; wz<window_cells[DIM_Z]; ++wz)
+      {
+        float& cell = data_[grid_base + grid_offsets_[DIM_Z][min_cell[DIM_Z] + wz]];
+        cell = std::min(cell, window_line[wz]);
+      }
     }
+  }
+  empty_ = false;
+}
+
+void PFDistanceField::computeDT(float* data, const IntArray offsets[3], const int num_cells[3])
+{
+  computeDTAlong(data, offsets, num_cells, DIM_Z);
+  computeDTAlong(data, offsets, num_cells, DIM_Y);
+  computeDTAlong(data, offsets, num_cells, DIM_X);
+}
 
+void PFDistanceField::computeDTAlong(float* data, const IntArray offsets[3], const int num_cells[3], int dim)
+{
+  // the lines along dim are independent, consecutive lines differ in the innermost of the other dimensions
+  const int outer_dim = (dim == DIM_X) ? DIM_Y : DIM_X;
+  const int inner_dim = (dim == DIM_Z) ? DIM_Y : DIM_Z;
+  const int n = num_cells[dim];
+  const int num_lines = num_cells[outer_dim] * num_cells[inner_dim];
+  const int* line_offsets = &offsets[dim][0];
+
+#pragma omp parallel
+  {
+    FloatArray f(n), ft(n), zz(n+1), h(n);
+    IntArray v(n);
+
+#pragma omp for schedule(static)
+    for (int line=0; line<num_lines; ++line)
+    {
+      const int base = offsets[outer_dim][line / num_cells[inner_dim]] + offsets[inner_dim][line % num_cells[inner_dim]];
+      for (int q=0; q<n; ++q)
+        f[q] = data[base + line_offsets[q]];
+      dt(&f[0], n, &ft[0], &v[0], &zz[0], &h[0]);
+      for (int q=0; q<n; ++q)
+        data[base + line_offsets[q]] = ft[q];
+    }
+  }
 }
 
 
-void PFDistanceField::dt(const FloatArray& f,
-        size_t nn,
-        FloatArray& ft,
-        IntArray& v,
-        FloatArray& z) {
+void PFDistanceField::dt(const float* f,
+        int n,
+        float* ft,
+        int* v,
+        float* z,
+        float* h) {
 
-/*    assert(f.size() >= nn);
-    assert(ft.size() >= nn);
-    assert(v.size() >= nn);
-    assert(z.size() >= nn+1);
-*/
-    int n = nn;
+    // heights of the parabolas at the origin, computed up front in a loop that vectorizes
+    for (int q=0; q<n; ++q)
+        h[q] = f[q] + sqr(q);
 
     int k = 0;
 
@@ -140,10 +213,10 @@ void PFDistanceField::dt(const FloatArray& f,
     z[1] =  DT_INF;
 
     for (int q=1; q<n; ++q) {
-        float s = ((f[q]+sqr(q))-(f[v[k]]+sqr(v[k])))/(2*q-2*v[k]);
+        float s = (h[q]-h[v[k]])/(2*q-2*v[k]);
         while (s <= z[k]) {
             --k;
-            s = ((f[q]+sqr(q))-(f[v[k]]+sqr(v[k])))/(2*q-2*v[k]);
+            s = (h[q]-h[v[k]])/(2*q-2*v[k]);
         }
         ++k;
         v[k] = q;
@@ -163,6 +236,7 @@ void PFDistanceField::dt(const FloatArray& f,
 void PFDistanceField::reset()
 {
   VoxelGrid<float>::reset(DT_INF);
+  empty_ = true;
 }
 
 }
@@ -36,29 +36,52 @@
 
 #include <distance_field/propagation_distance_field.h>
 #include <visualization_msgs/Marker.h>
+#include <algorithm>
+#include <limits>
 
 namespace distance_field
 {
 
+// below this number of queued voxels a bucket is not worth distributing to the threads
+static const unsigned int MIN_PARALLEL_QUEUE_SIZE = 64;
+
 PropagationDistanceField::~PropagationDistanceField()
 {
 }
 
 PropagationDistanceField::PropagationDistanceField(double size_x, double size_y, double size_z, double resolution,
-    double origin_x, double origin_y, double origin_z, double max_distance):
-      DistanceField<PropDistanceFieldVoxel>(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, PropDistanceFieldVoxel(max_distance))
+    double origin_x, double origin_y, double origin_z, double max_distance, StorageOrder storage_order):
+      DistanceField<PropDistanceFieldVoxel>(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, PropDistanceFieldVoxel(max_distance),
+                                            storage_order)
 {
   max_distance_ = max_distance;
   int max_dist_int = ceil(max_distance_/resolution);
+  max_distance_cells_ = max_dist_int;
   max_distance_sq_ = (max_dist_int*max_dist_int);
   initNeighborhoods();
 
+  // out of bounds queries are at the maximum distance
+  default_object_ = PropDistanceFieldVoxel(max_distance_sq_);
+
   bucket_queue_.resize(max_distance_sq_+1);
 
   // create a sqrt table:
   sqrt_table_.resize(max_distance_sq_+1);
   for (int i=0; i<=max_distance_sq_; ++i)
     sqrt_table_[i] = sqrt(double(i))*resolution;
+
+  // the squared distances are stored in the packed plane as they are
+  if (max_distance_sq_ <= std::numeric_limits<unsigned short>::max())
+  {
+    distance_plane_.resize(num_storage_cells_);
+    distance_code_table_ = sqrt_table_;
+  }
+
+  voxel_flags_.resize(num_storage_cells_, 0);
+  num_threads_ = 1;
+  dirty_region_tracking_ = false;
+  has_dirty_region_ = false;
+  reset();
 }
 
 int PropagationDistanceField::eucDistSq(int3 point1, int3 point2)
@@ -69,12 +92,42 @@ int PropagationDistanceField::eucDistSq(int3 point1, int3 point2)
   return dx*dx + dy*dy + dz*dz;
 }
 
+void PropagationDistanceField::setNumThreads(int num_threads)
+{
+  if (num_threads < 1)
+    num_threads = 1;
+#ifndef _OPENMP
+  if (num_threads > 1)
+    ROS_WARN("distance_field has been compiled without OpenMP, propagating with a single thread.");
+  num_threads = 1;
+#endif
+  num_threads_ = num_threads;
+  initSlabs();
+}
+
+bool PropagationDistanceField::getDirtyRegion(int3& min_corner, int3& max_corner) const
+{
+  if (!has_dirty_region_)
+    return false;
+  min_corner = dirty_region_min_;
+  max_corner = dirty_region_max_;
+  return true;
+}
+
 void PropagationDistanceField::updatePointsInField(const std::vector<tf::Vector3>& points, bool iterative)
 {
+  has_dirty_region_ = false;
+  if( iterative && isCompact() )
+  {
+    ROS_ERROR("The distance field has been compacted, it can only be updated from scratch (non iterative).");
+    return;
+  }
   if( iterative )
   {
     VoxelSet points_added;
-    VoxelSet points_removed(object_voxel_locations_);
+    VoxelSet points_removed;
+    VoxelSet new_voxel_locations;
+    new_voxel_locations.reserve(points.size());
 
     // Compare and figure out what points are new,
     // and what points are to be deleted
@@ -86,40 +139,51 @@ void PropagationDistanceField::updatePointsInField(const std::vector<tf::Vector3
                                 voxel_loc.x(), voxel_loc.y(), voxel_loc.z() );
       if( valid )
       {
-        if( iterative )
-        {
-          bool already_obstacle_voxel = ( object_voxel_locations_.find(voxel_loc) != object_voxel_locations_.end() );
-          if( !already_obstacle_voxel )
-          {
-            // Not already in set of existing obstacles, so add to voxel list
-            object_voxel_locations_.insert(voxel_loc);
+        unsigned char& flags = voxel_flags_[ref(voxel_loc.x(), voxel_loc.y(), voxel_loc.z())];
+        if( flags & NEW_OBSTACLE_VOXEL )
+          continue;
+        flags |= NEW_OBSTACLE_VOXEL;
+        new_voxel_locations.push_back(voxel_loc);
 
-            // Add point to the set or expansion
-            points_added.insert(voxel_loc);
-          }
-          else
-          {
-            // Already an existing obstacle, so take off removal list
-            points_removed.erase(voxel_loc);
-          }
-        }
-        else
-        {
-          object_voxel_locations_.insert(voxel_loc);
-          points_added.insert(voxel_loc);
-        }
+        // Not already in set of existing obstacles, so add to the expansion list
+        if( !(flags & OBSTACLE_VOXEL) )
+          points_added.push_back(voxel_loc);
       }
     }
 
-   removeObstacleVoxels( points_removed );
-   addNewObstacleVoxels( points_added );
+    // Existing obstacles that have not been seen again are to be removed
+    for( unsigned int i=0; i<object_voxel_locations_.size(); i++)
+    {
+      const int3& loc = object_voxel_locations_[i];
+      unsigned char& flags = voxel_flags_[ref(loc.x(), loc.y(), loc.z())];
+      if( !(flags & NEW_OBSTACLE_VOXEL) )
+        points_removed.push_back(loc);
+      flags = 0;
+    }
+    for( unsigned int i=0; i<new_voxel_locations.size(); i++)
+    {
+      const int3& loc = new_voxel_locations[i];
+      voxel_flags_[ref(loc.x(), loc.y(), loc.z())] = OBSTACLE_VOXEL;
+    }
+    object_voxel_locations_.swap(new_voxel_locations);
+
+    if( dirty_region_tracking_ )
+    {
+      resetDirtyRegion( points_added, points_removed );
+      propogate();
+    }
+    else
+    {
+      removeObstacleVoxels( points_removed );
+      addNewObstacleVoxels( points_added );
+    }
   }
 
   else	// !iterative
   {
-    VoxelSet points_added;
     reset();
 
+    object_voxel_locations_.reserve(points.size());
     for( unsigned int i=0; i<points.size(); i++)
     {
       // Convert to voxel coordinates
@@ -128,17 +192,27 @@ void PropagationDistanceField::updatePointsInField(const std::vector<tf::Vector3
                                 voxel_loc.x(), voxel_loc.y(), voxel_loc.z() );
       if( valid )
       {
-        object_voxel_locations_.insert(voxel_loc);
-        points_added.insert(voxel_loc);
+        unsigned char& flags = voxel_flags_[ref(voxel_loc.x(), voxel_loc.y(), voxel_loc.z())];
+        if( !(flags & OBSTACLE_VOXEL) )
+        {
+          flags = OBSTACLE_VOXEL;
+          object_voxel_locations_.push_back(voxel_loc);
+        }
       }
     }
-    addNewObstacleVoxels( points_added );
+    addNewObstacleVoxels( object_voxel_locations_ );
   }
 }
 
 void PropagationDistanceField::addPointsToField(const std::vector<tf::Vector3>& points)
 {
   VoxelSet voxel_locs;
+  has_dirty_region_ = false;
+  if (isCompact())
+  {
+    ROS_ERROR("The distance field has been compacted, reset() it before adding points.");
+    return;
+  }
 
   for( unsigned int i=0; i<points.size(); i++)
   {
@@ -150,14 +224,15 @@ void PropagationDistanceField::addPointsToField(const std::vector<tf::Vector3>&
     if( valid )
     {
       //ROS_INFO("Adding %f, %f, %f to DF", points[i].x(), points[i].y(), points[i].z());
-      bool already_obstacle_voxel = ( object_voxel_locations_.find(voxel_loc) != object_voxel_locations_.end() );
-      if( !already_obstacle_voxel )
+      unsigned char& flags = voxel_flags_[ref(voxel_loc.x(), voxel_loc.y(), voxel_loc.z())];
+      if( !(flags & OBSTACLE_VOXEL) )
       {
         // Not already in set of existing obstacles, so add to voxel list
-        object_voxel_locations_.insert(voxel_loc);
+        flags = OBSTACLE_VOXEL;
+        object_voxel_locations_.push_back(voxel_loc);
 
         // Add point to the queue for expansion
-        voxel_locs.insert(voxel_loc);
+        voxel_locs.push_back(voxel_loc);
       }
     }
   }
@@ -165,28 +240,29 @@ void PropagationDistanceField::addPointsToField(const std::vector<tf::Vector3>&
   addNewObstacleVoxels( voxel_locs );
 }
 
+void PropagationDistanceField::setObstacleVoxel(const int3& loc, int initial_update_direction)
+{
+  PropDistanceFieldVoxel& voxel = getCell(loc.x(), loc.y(), loc.z());
+  setDistanceSquare(&voxel, 0);
+  voxel.closest_point_ = loc;
+  voxel.location_ = loc;
+  voxel.update_direction_ = initial_update_direction;
+  bucket_queue_[0].push_back(&voxel);
+}
+
 void PropagationDistanceField::addNewObstacleVoxels(const VoxelSet& locations)
 {
-  int x, y, z;
   int initial_update_direction = getDirectionNumber(0,0,0);
-  bucket_queue_[0].reserve(locations.size());
+  bucket_queue_[0].reserve(bucket_queue_[0].size() + locations.size());
 
   VoxelSet::const_iterator it = locations.begin();
   for( it=locations.begin(); it!=locations.end(); ++it)
   {
-    int3 loc = *it;
-    x = loc.x();
-    y = loc.y();
-    z = loc.z();
-    bool valid = isCellValid( x, y, z);
+    const int3& loc = *it;
+    bool valid = isCellValid( loc.x(), loc.y(), loc.z());
     if (!valid)
       continue;
-    PropDistanceFieldVoxel& voxel = getCell(x,y,z);
-    voxel.distance_square_ = 0;
-    voxel.closest_point_ = loc;
-    voxel.location_ = loc;
-    voxel.update_direction_ = initial_update_direction;
-    bucket_queue_[0].push_back(&voxel);
+    setObstacleVoxel(loc, initial_update_direction);
   }
 
   propogate();
@@ -194,10 +270,10 @@ void PropagationDistanceField::addNewObstacleVoxels(const VoxelSet& locations)
 
 void PropagationDistanceField::removeObstacleVoxels(const VoxelSet& locations )
 {
-  std::vector<int3> stack;
+  std::vector<int3>& stack = removal_stack_;
   int initial_update_direction = getDirectionNumber(0,0,0);
 
-  stack.reserve( num_cells_[DIM_X] * num_cells_[DIM_Y] * num_cells_[DIM_Z] );
+  stack.clear();
   bucket_queue_[0].reserve(locations.size());
 
   // First reset the obstacle voxels,
@@ -209,7 +285,7 @@ void PropagationDistanceField::removeObstacleVoxels(const VoxelSet& locations )
     if (!valid)
       continue;
     PropDistanceFieldVoxel& voxel = getCell(loc.x(), loc.y(), loc.z());
-    voxel.distance_square_ = max_distance_sq_;
+    setDistanceSquare(&voxel, max_distance_sq_);
     voxel.closest_point_ = loc;
     voxel.location_ = loc;
     voxel.update_direction_ = initial_update_direction;
@@ -231,13 +307,14 @@ void PropagationDistanceField::removeObstacleVoxels(const VoxelSet& locations )
       {
         PropDistanceFieldVoxel& nvoxel = getCell(nloc.x(), nloc.y(), nloc.z());
         int3& close_point = nvoxel.closest_point_;
-        PropDistanceFieldVoxel& closest_point_voxel = getCell( close_point.x(), close_point.y(), close_point.z() );
 
-        if( closest_point_voxel.distance_square_ != 0 )
+        // voxels that have never been reached do not have a closest point
+        if( close_point.x() == PropDistanceFieldVoxel::UNINITIALIZED
+            || getCell( close_point.x(), close_point.y(), close_point.z() ).distance_square_ != 0 )
         {	// closest point no longer exists
           if( nvoxel.distance_square_!=max_distance_sq_)
           {
-            nvoxel.distance_square_ = max_distance_sq_;
+            setDistanceSquare(&nvoxel, max_distance_sq_);
             nvoxel.closest_point_ = nloc;
             nvoxel.location_ = nloc;
             nvoxel.update_direction_ = initial_update_direction;
@@ -255,81 +332,276 @@ void PropagationDistanceField::removeObstacleVoxels(const VoxelSet& locations )
   propogate();
 }
 
-void PropagationDistanceField::propogate()
+void PropagationDistanceField::resetDirtyRegion(const VoxelSet& points_added, const VoxelSet& points_removed)
 {
-  int x, y, z, nx, ny, nz;
-  int3 loc;
-
-  // now process the queue:
-  for (unsigned int i=0; i<bucket_queue_.size(); ++i)
+  if( points_added.empty() && points_removed.empty() )
+    return;
+
+  // bounding box of all the voxels that changed
+  int3 min_corner( num_cells_[DIM_X], num_cells_[DIM_Y], num_cells_[DIM_Z] );
+  int3 max_corner( -1, -1, -1 );
+  const VoxelSet* changed[2] = { &points_added, &points_removed };
+  for( int c=0; c<2; c++ )
   {
-    std::vector<PropDistanceFieldVoxel*>::iterator list_it = bucket_queue_[i].begin();
-    while(list_it!=bucket_queue_[i].end())
+    for( unsigned int i=0; i<changed[c]->size(); i++)
     {
-      PropDistanceFieldVoxel* vptr = *list_it;
+      min_corner = min_corner.cwiseMin( (*changed[c])[i] );
+      max_corner = max_corner.cwiseMax( (*changed[c])[i] );
+    }
+  }
 
-      x = vptr->location_.x();
-      y = vptr->location_.y();
-      z = vptr->location_.z();
+  // every voxel within the max distance of a changed voxel may change
+  for( int d=DIM_X; d<=DIM_Z; d++ )
+  {
+    min_corner(d) = std::max( min_corner(d) - max_distance_cells_, 0 );
+    max_corner(d) = std::min( max_corner(d) + max_distance_cells_, num_cells_[d] - 1 );
+  }
+  dirty_region_min_ = min_corner;
+  dirty_region_max_ = max_corner;
+  has_dirty_region_ = true;
 
-      // select the neighborhood list based on the update direction:
-      std::vector<int3 >* neighborhood;
-      int D = i;
-      if (D>1)
-        D=1;
-      // avoid a possible segfault situation:
-      if (vptr->update_direction_<0 || vptr->update_direction_>26)
+  // reset the region, and queue the obstacles inside of it
+  int initial_update_direction = getDirectionNumber(0,0,0);
+  const PropDistanceFieldVoxel empty_voxel(max_distance_sq_);
+  for( int x=min_corner.x(); x<=max_corner.x(); x++ )
+  {
+    for( int y=min_corner.y(); y<=max_corner.y(); y++ )
+    {
+      for( int z=min_corner.z(); z<=max_corner.z(); z++ )
       {
-   //     ROS_WARN("Invalid update direction detected: %d", vptr->update_direction_);
-        ++list_it;
-        continue;
+        int3 loc(x, y, z);
+        if( voxel_flags_[ref(x, y, z)] & OBSTACLE_VOXEL )
+        {
+          setObstacleVoxel(loc, initial_update_direction);
+        }
+        else
+        {
+          PropDistanceFieldVoxel& voxel = getCell(x, y, z);
+          voxel = empty_voxel;
+          setDistanceSquare(&voxel, max_distance_sq_);
+          voxel.location_ = loc;
+          voxel.update_direction_ = initial_update_direction;
+        }
       }
+    }
+  }
 
-      neighborhood = &neighborhoods_[D][vptr->update_direction_];
-
-      for (unsigned int n=0; n<neighborhood->size(); n++)
+  // the voxels just outside of the region keep their closest points, queue them so
+  // that these obstacles are propagated back into the region
+  int3 shell_min( std::max(min_corner.x() - 1, 0), std::max(min_corner.y() - 1, 0), std::max(min_corner.z() - 1, 0) );
+  int3 shell_max( std::min(max_corner.x() + 1, num_cells_[DIM_X] - 1), std::min(max_corner.y() + 1, num_cells_[DIM_Y] - 1),
+                  std::min(max_corner.z() + 1, num_cells_[DIM_Z] - 1) );
+  for( int x=shell_min.x(); x<=shell_max.x(); x++ )
+  {
+    for( int y=shell_min.y(); y<=shell_max.y(); y++ )
+    {
+      bool inside_xy = ( x >= min_corner.x() && x <= max_corner.x() && y >= min_corner.y() && y <= max_corner.y() );
+      for( int z=shell_min.z(); z<=shell_max.z(); z++ )
       {
-        int dx = (*neighborhood)[n].x();
-        int dy = (*neighborhood)[n].y();
-        int dz = (*neighborhood)[n].z();
-        nx = x + dx;
-        ny = y + dy;
-        nz = z + dz;
-        if (!isCellValid(nx,ny,nz))
+        if( inside_xy && z >= min_corner.z() && z <= max_corner.z() )
+        {
+          z = max_corner.z();
           continue;
+        }
+        PropDistanceFieldVoxel& voxel = getCell(x, y, z);
+        if( voxel.distance_square_ < max_distance_sq_ && voxel.closest_point_.x() != PropDistanceFieldVoxel::UNINITIALIZED )
+          bucket_queue_[0].push_back(&voxel);
+      }
+    }
+  }
+}
 
-        // the real update code:
-        // calculate the neighbor's new distance based on my closest filled voxel:
-        PropDistanceFieldVoxel* neighbor = &getCell(nx, ny, nz);
-        loc.x() = nx;
-        loc.y() = ny;
-        loc.z() = nz;
-        int new_distance_sq = eucDistSq(vptr->closest_point_, loc);
-        if (new_distance_sq > max_distance_sq_)
-          continue;
-        if (new_distance_sq < neighbor->distance_square_)
-        {
-          // update the neighboring voxel
-          neighbor->distance_square_ = new_distance_sq;
-          neighbor->closest_point_ = vptr->closest_point_;
-          neighbor->location_ = loc;
-          neighbor->update_direction_ = getDirectionNumber(dx, dy, dz);
+void PropagationDistanceField::propogateVoxel(PropDistanceFieldVoxel* vptr, int distance_sq, int slab)
+{
+  int x = vptr->location_.x();
+  int y = vptr->location_.y();
+  int z = vptr->location_.z();
+  int3 loc;
 
-          // and put it in the queue:
-          bucket_queue_[new_distance_sq].push_back(neighbor);
-        }
+  // select the neighborhood list based on the update direction:
+  std::vector<int3 >* neighborhood;
+  int D = distance_sq;
+  if (D>1)
+    D=1;
+  // avoid a possible segfault situation:
+  if (vptr->update_direction_<0 || vptr->update_direction_>26)
+  {
+ //     ROS_WARN("Invalid update direction detected: %d", vptr->update_direction_);
+    return;
+  }
+
+  neighborhood = &neighborhoods_[D][vptr->update_direction_];
+
+  for (unsigned int n=0; n<neighborhood->size(); n++)
+  {
+    int dx = (*neighborhood)[n].x();
+    int dy = (*neighborhood)[n].y();
+    int dz = (*neighborhood)[n].z();
+    int nx = x + dx;
+    int ny = y + dy;
+    int nz = z + dz;
+    if (!isCellValid(nx,ny,nz))
+      continue;
+
+    // the real update code:
+    // calculate the neighbor's new distance based on my closest filled voxel:
+    PropDistanceFieldVoxel* neighbor = &getCell(nx, ny, nz);
+    loc.x() = nx;
+    loc.y() = ny;
+    loc.z() = nz;
+    int new_distance_sq = eucDistSq(vptr->closest_point_, loc);
+    if (new_distance_sq > max_distance_sq_)
+      continue;
+    if (new_distance_sq < neighbor->distance_square_)
+    {
+      // update the neighboring voxel
+      setDistanceSquare(neighbor, new_distance_sq);
+      neighbor->closest_point_ = vptr->closest_point_;
+      neighbor->location_ = loc;
+      neighbor->update_direction_ = getDirectionNumber(dx, dy, dz);
+
+      // and put it in the queue, buckets that have already been processed are not visited again
+      int bucket = std::max(new_distance_sq, distance_sq);
+      if (slab < 0)
+      {
+        bucket_queue_[bucket].push_back(neighbor);
+      }
+      else
+      {
+        int owner = slab_index_[nx];
+        int source = PropagationSlab::FROM_SELF;
+        if (owner < slab)
+          source = PropagationSlab::FROM_RIGHT;
+        else if (owner > slab)
+          source = PropagationSlab::FROM_LEFT;
+        slabs_[owner].bucket_queues_[source][bucket].push_back(neighbor);
       }
+    }
+  }
+}
 
-      ++list_it;
+void PropagationDistanceField::propogate()
+{
+  if (!slabs_.empty())
+  {
+    propogateSlabs();
+    return;
+  }
+
+  // now process the queue:
+  for (unsigned int i=0; i<bucket_queue_.size(); ++i)
+  {
+    // the bucket may grow while it is being processed
+    for (unsigned int j=0; j<bucket_queue_[i].size(); ++j)
+      propogateVoxel(bucket_queue_[i][j], i, -1);
+    bucket_queue_[i].clear();
+  }
+}
+
+void PropagationDistanceField::propogateSlabs()
+{
+  const int num_slabs = slabs_.size();
+
+  // hand the queued voxels over to the slabs that contain them
+  for (unsigned int i=0; i<bucket_queue_.size(); ++i)
+  {
+    for (unsigned int j=0; j<bucket_queue_[i].size(); ++j)
+    {
+      PropDistanceFieldVoxel* vptr = bucket_queue_[i][j];
+      slabs_[slab_index_[vptr->location_.x()]].bucket_queues_[PropagationSlab::FROM_SELF][i].push_back(vptr);
     }
     bucket_queue_[i].clear();
   }
 
+  for (int i=0; i<=max_distance_sq_; ++i)
+  {
+    // neighboring slabs may hand voxels of the same bucket back and forth
+    while (true)
+    {
+      unsigned int num_queued = 0;
+      for (int s=0; s<num_slabs; ++s)
+        for (int source=0; source<PropagationSlab::NUM_SOURCES; ++source)
+          num_queued += slabs_[s].bucket_queues_[source][i].size();
+      if (num_queued == 0)
+        break;
+
+      // even slabs first, then odd slabs, such that no two threads touch the same voxel
+      for (int color=0; color<2; ++color)
+      {
+        const int num_colored_slabs = (num_slabs - color + 1) / 2;
+#pragma omp parallel for num_threads(num_threads_) schedule(dynamic) if(num_queued > MIN_PARALLEL_QUEUE_SIZE)
+        for (int k=0; k<num_colored_slabs; ++k)
+          propogateSlab(2*k + color, i);
+      }
+    }
+  }
+}
+
+void PropagationDistanceField::propogateSlab(int slab, int distance_sq)
+{
+  for (int source=0; source<PropagationSlab::NUM_SOURCES; ++source)
+  {
+    std::vector<PropDistanceFieldVoxel*>& queue = slabs_[slab].bucket_queues_[source][distance_sq];
+    for (unsigned int j=0; j<queue.size(); ++j)
+      propogateVoxel(queue[j], distance_sq, slab);
+    queue.clear();
+  }
+}
+
+void PropagationDistanceField::initSlabs()
+{
+  slabs_.clear();
+  slab_index_.assign(num_cells_[DIM_X], 0);
+
+  // two slabs per thread, each at least two voxels wide
+  int num_slabs = std::min(2 * num_threads_, num_cells_[DIM_X] / 2);
+  if (num_threads_ <= 1 || num_slabs < 2)
+    return;
+
+  slabs_.resize(num_slabs);
+  for (int s=0; s<num_slabs; ++s)
+  {
+    slabs_[s].begin_x_ = (s * num_cells_[DIM_X]) / num_slabs;
+    slabs_[s].end_x_ = ((s + 1) * num_cells_[DIM_X]) / num_slabs;
+    for (int source=0; source<PropagationSlab::NUM_SOURCES; ++source)
+      slabs_[s].bucket_queues_[source].resize(max_distance_sq_+1);
+    for (int x=slabs_[s].begin_x_; x<slabs_[s].end_x_; ++x)
+      slab_index_[x] = s;
+  }
 }
 
 void PropagationDistanceField::reset()
 {
   VoxelGrid<PropDistanceFieldVoxel>::reset(PropDistanceFieldVoxel(max_distance_sq_));
+  std::fill(distance_plane_.begin(), distance_plane_.end(), max_distance_sq_);
+  if (voxel_flags_.empty())
+  {
+    // freed by compact()
+    voxel_flags_.resize(num_storage_cells_, 0);
+  }
+  else
+  {
+    for( unsigned int i=0; i<object_voxel_locations_.size(); i++)
+    {
+      const int3& loc = object_voxel_locations_[i];
+      voxel_flags_[ref(loc.x(), loc.y(), loc.z())] = 0;
+    }
+  }
+  object_voxel_locations_.clear();
+  has_dirty_region_ = false;
+}
+
+bool PropagationDistanceField::compact()
+{
+  if (!DistanceField<PropDistanceFieldVoxel>::compact())
+    return false;
+  std::vector<unsigned char>().swap(voxel_flags_);
+  return true;
+}
+
+size_t PropagationDistanceField::getMemoryUsage() const
+{
+  return DistanceField<PropDistanceFieldVoxel>::getMemoryUsage() + voxel_flags_.capacity() * sizeof(unsigned char);
 }
 
 void PropagationDistanceField::initNeighborhoods()
@@ -405,18 +677,46 @@ SignedPropagationDistanceField::~SignedPropagationDistanceField()
 }
 
 SignedPropagationDistanceField::SignedPropagationDistanceField(double size_x, double size_y, double size_z, double resolution,
-    double origin_x, double origin_y, double origin_z, double max_distance):
-      DistanceField<SignedPropDistanceFieldVoxel>(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, SignedPropDistanceFieldVoxel(max_distance,0))
+    double origin_x, double origin_y, double origin_z, double max_distance, StorageOrder storage_order):
+      DistanceField<SignedPropDistanceFieldVoxel>(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, SignedPropDistanceFieldVoxel(max_distance,0),
+                                                  storage_order)
 {
   max_distance_ = max_distance;
   int max_dist_int = ceil(max_distance_/resolution);
   max_distance_sq_ = (max_dist_int*max_dist_int);
   initNeighborhoods();
 
+  // out of bounds queries are at the maximum distance
+  default_object_ = SignedPropDistanceFieldVoxel(max_distance_sq_, 0);
+
   // create a sqrt table:
   sqrt_table_.resize(max_distance_sq_+1);
   for (int i=0; i<=max_distance_sq_; ++i)
     sqrt_table_[i] = sqrt(double(i))*resolution;
+
+  // a voxel is either inside an obstacle (positive distance 0) or outside (negative distance 0),
+  // hence the difference of the squared distances identifies its signed distance
+  if (2*max_distance_sq_ <= std::numeric_limits<unsigned short>::max())
+  {
+    distance_plane_.resize(num_storage_cells_);
+    distance_code_table_.resize(2*max_distance_sq_+1);
+    for (int i=0; i<=2*max_distance_sq_; ++i)
+    {
+      if (i >= max_distance_sq_)
+        distance_code_table_[i] = sqrt_table_[i - max_distance_sq_];
+      else
+        distance_code_table_[i] = -sqrt_table_[max_distance_sq_ - i];
+    }
+  }
+  reset();
+}
+
+void SignedPropagationDistanceField::updateDistancePlane()
+{
+  if (distance_plane_.empty())
+    return;
+  for (int i=0; i<num_storage_cells_; ++i)
+    distance_plane_[i] = max_distance_sq_ + data_[i].positive_distance_square_ - data_[i].negative_distance_square_;
 }
 
 int SignedPropagationDistanceField::eucDistSq(int3 point1, int3 point2)
@@ -429,6 +729,12 @@ int SignedPropagationDistanceField::eucDistSq(int3 point1, int3 point2)
 
 void SignedPropagationDistanceField::addPointsToField(const std::vector<tf::Vector3>& points)
 {
+  if (isCompact())
+  {
+    ROS_ERROR("The distance field has been compacted, reset() it before adding points.");
+    return;
+  }
+
   // initialize the bucket queue
   positive_bucket_queue_.resize(max_distance_sq_+1);
   negative_bucket_queue_.resize(max_distance_sq_+1);
@@ -638,11 +944,13 @@ void SignedPropagationDistanceField::addPointsToField(const std::vector<tf::Vect
     negative_bucket_queue_[i].clear();
   }
 
+  updateDistancePlane();
 }
 
 void SignedPropagationDistanceField::reset()
 {
   VoxelGrid<SignedPropDistanceFieldVoxel>::reset(SignedPropDistanceFieldVoxel(max_distance_sq_, 0));
+  std::fill(distance_plane_.begin(), distance_plane_.end(), 2*max_distance_sq_);
 }
 
 void SignedPropagationDistanceField::initNeighborhoods()
@@ -0,0 +1,293 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2009, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Times full, iterative, dirty region and multithreaded updates of the PropagationDistanceField
+// on synthetic scenes of increasing density: static random clutter plus a small box that moves
+// by one voxel between updates. Also times distance and gradient queries along random walks, as
+// issued for the collision points of a trajectory, for the different storage layouts.
+
+#include <distance_field/propagation_distance_field.h>
+#include <distance_field/pf_distance_field.h>
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+using namespace distance_field;
+
+static const double size_x = 2.0;
+static const double size_y = 2.0;
+static const double size_z = 1.5;
+static const double resolution = 0.02;
+static const double max_dist = 0.3;
+static const int num_updates = 10;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+static void createScene(int num_clutter_points, int update, std::vector<tf::Vector3>& points)
+{
+  points.clear();
+  srand48(0);
+  for (int i=0; i<num_clutter_points; ++i)
+    points.push_back(tf::Vector3(drand48()*size_x, drand48()*size_y, drand48()*size_z));
+
+  // surface of a 10cm box that moves along the x axis
+  const double box_size = 0.1;
+  const double box_x = 0.5 + update*resolution;
+  for (double u=0.0; u<=box_size; u+=resolution)
+  {
+    for (double v=0.0; v<=box_size; v+=resolution)
+    {
+      points.push_back(tf::Vector3(box_x + u, 1.0 + v, 0.7));
+      points.push_back(tf::Vector3(box_x + u, 1.0 + v, 0.7 + box_size));
+      points.push_back(tf::Vector3(box_x + u, 1.0, 0.7 + v));
+      points.push_back(tf::Vector3(box_x + u, 1.0 + box_size, 0.7 + v));
+      points.push_back(tf::Vector3(box_x, 1.0 + u, 0.7 + v));
+      points.push_back(tf::Vector3(box_x + box_size, 1.0 + u, 0.7 + v));
+    }
+  }
+}
+
+static int countDifferences(const PropagationDistanceField& df1, const PropagationDistanceField& df2)
+{
+  int num_differences = 0;
+  for (int x=0; x<df1.getNumCells(PropagationDistanceField::DIM_X); ++x)
+    for (int y=0; y<df1.getNumCells(PropagationDistanceField::DIM_Y); ++y)
+      for (int z=0; z<df1.getNumCells(PropagationDistanceField::DIM_Z); ++z)
+        if (df1.getCell(x,y,z).distance_square_ != df2.getCell(x,y,z).distance_square_)
+          num_differences++;
+  return num_differences;
+}
+
+/**
+ * Recomputes the PFDistanceField (an exact, unbounded transform) for num_updates updates of the scene
+ * and returns the average time per update.
+ */
+static double timePFUpdates(PFDistanceField& df, int num_clutter_points)
+{
+  std::vector<tf::Vector3> points;
+  double total_time = 0.0;
+  for (int update=1; update<=num_updates; ++update)
+  {
+    createScene(num_clutter_points, update, points);
+    double start = now();
+    df.reset();
+    df.addPointsToField(points);
+    total_time += now() - start;
+  }
+  return total_time / num_updates;
+}
+
+/**
+ * Runs num_updates updates of the scene and returns the average time per update.
+ */
+static double timeUpdates(PropagationDistanceField& df, int num_clutter_points, bool iterative)
+{
+  std::vector<tf::Vector3> points;
+  createScene(num_clutter_points, 0, points);
+  df.updatePointsInField(points, false);
+
+  double total_time = 0.0;
+  for (int update=1; update<=num_updates; ++update)
+  {
+    createScene(num_clutter_points, update, points);
+    double start = now();
+    df.updatePointsInField(points, iterative);
+    total_time += now() - start;
+  }
+  return total_time / num_updates;
+}
+
+/**
+ * Queries the distance gradient along random walks of 1cm steps and returns the time per query.
+ * With use_voxels set, the distance is read from the voxels instead of the packed distance plane.
+ */
+static double timeQueries(const PropagationDistanceField& df, bool use_voxels, double& checksum)
+{
+  const int num_walks = 2000;
+  const int num_steps = 500;
+  const double step = 0.01;
+  const double res = df.getResolution(PropagationDistanceField::DIM_X);
+
+  checksum = 0.0;
+  srand48(1);
+  double start = now();
+  for (int w=0; w<num_walks; ++w)
+  {
+    double x = drand48()*size_x, y = drand48()*size_y, z = drand48()*size_z;
+    for (int s=0; s<num_steps; ++s)
+    {
+      x = std::min(std::max(x + step*(drand48() - 0.3), 0.0), size_x);
+      y = std::min(std::max(y + step*(drand48() - 0.5), 0.0), size_y);
+      z = std::min(std::max(z + step*(drand48() - 0.5), 0.0), size_z);
+      int gx, gy, gz;
+      df.worldToGrid(x, y, z, gx, gy, gz);
+      if (gx<1 || gy<1 || gz<1 || gx>=df.getNumCells(PropagationDistanceField::DIM_X)-1
+          || gy>=df.getNumCells(PropagationDistanceField::DIM_Y)-1 || gz>=df.getNumCells(PropagationDistanceField::DIM_Z)-1)
+        continue;
+      if (use_voxels)
+      {
+        checksum += sqrt(double(df.getCell(gx,gy,gz).distance_square_))*res;
+        checksum += sqrt(double(df.getCell(gx+1,gy,gz).distance_square_))*res - sqrt(double(df.getCell(gx-1,gy,gz).distance_square_))*res;
+        checksum += sqrt(double(df.getCell(gx,gy+1,gz).distance_square_))*res - sqrt(double(df.getCell(gx,gy-1,gz).distance_square_))*res;
+        checksum += sqrt(double(df.getCell(gx,gy,gz+1).distance_square_))*res - sqrt(double(df.getCell(gx,gy,gz-1).distance_square_))*res;
+      }
+      else
+      {
+        checksum += df.getDistanceFromCell(gx,gy,gz);
+        checksum += df.getDistanceFromCell(gx+1,gy,gz) - df.getDistanceFromCell(gx-1,gy,gz);
+        checksum += df.getDistanceFromCell(gx,gy+1,gz) - df.getDistanceFromCell(gx,gy-1,gz);
+        checksum += df.getDistanceFromCell(gx,gy,gz+1) - df.getDistanceFromCell(gx,gy,gz-1);
+      }
+    }
+  }
+  return (now() - start) / (num_walks*num_steps);
+}
+
+/**
+ * Queries the interpolated distances and gradients of the same random walks in a single batch, and
+ * returns the time per query.
+ */
+static double timeBatchQueries(const PropagationDistanceField& df)
+{
+  const int num_walks = 2000;
+  const int num_steps = 500;
+  const double step = 0.01;
+
+  std::vector<double> points, distances(num_walks*num_steps), gradients(3*num_walks*num_steps);
+  points.reserve(3*num_walks*num_steps);
+  srand48(1);
+  for (int w=0; w<num_walks; ++w)
+  {
+    double x = drand48()*size_x, y = drand48()*size_y, z = drand48()*size_z;
+    for (int s=0; s<num_steps; ++s)
+    {
+      x = std::min(std::max(x + step*(drand48() - 0.3), 0.0), size_x);
+      y = std::min(std::max(y + step*(drand48() - 0.5), 0.0), size_y);
+      z = std::min(std::max(z + step*(drand48() - 0.5), 0.0), size_z);
+      points.push_back(x);
+      points.push_back(y);
+      points.push_back(z);
+    }
+  }
+
+  double start = now();
+  df.getInterpolatedDistanceGradients(&points[0], num_walks*num_steps, &distances[0], &gradients[0]);
+  return (now() - start) / (num_walks*num_steps);
+}
+
+static void benchmarkQueries()
+{
+  const double query_resolution = 0.01;
+  PropagationDistanceField row_major_df(size_x, size_y, size_z, query_resolution, 0.0, 0.0, 0.0, max_dist);
+  PropagationDistanceField morton_df(size_x, size_y, size_z, query_resolution, 0.0, 0.0, 0.0, max_dist,
+                                     PropagationDistanceField::MORTON);
+  std::vector<tf::Vector3> points;
+  createScene(10000, 0, points);
+  row_major_df.updatePointsInField(points, false);
+  morton_df.updatePointsInField(points, false);
+
+  double voxel_checksum, plane_checksum, morton_voxel_checksum, morton_plane_checksum;
+  double voxel_time = timeQueries(row_major_df, true, voxel_checksum);
+  double plane_time = timeQueries(row_major_df, false, plane_checksum);
+  double morton_voxel_time = timeQueries(morton_df, true, morton_voxel_checksum);
+  double morton_plane_time = timeQueries(morton_df, false, morton_plane_checksum);
+
+  printf("gradient queries at %.2fm resolution, %d voxels of %d bytes\n", query_resolution,
+         row_major_df.getNumCells(PropagationDistanceField::DIM_X)*row_major_df.getNumCells(PropagationDistanceField::DIM_Y)
+         *row_major_df.getNumCells(PropagationDistanceField::DIM_Z), (int)sizeof(PropDistanceFieldVoxel));
+  printf("  row major, voxels      : %8.1f ns\n", 1e9*voxel_time);
+  printf("  row major, plane       : %8.1f ns (checksum difference %g)\n", 1e9*plane_time, fabs(plane_checksum - voxel_checksum));
+  printf("  morton, voxels         : %8.1f ns (checksum difference %g)\n", 1e9*morton_voxel_time, fabs(morton_voxel_checksum - voxel_checksum));
+  printf("  morton, plane          : %8.1f ns (checksum difference %g)\n", 1e9*morton_plane_time, fabs(morton_plane_checksum - voxel_checksum));
+  printf("  morton, trilinear batch: %8.1f ns\n", 1e9*timeBatchQueries(morton_df));
+
+  size_t row_major_bytes = row_major_df.getMemoryUsage();
+  size_t morton_bytes = morton_df.getMemoryUsage();
+  row_major_df.compact();
+  morton_df.compact();
+  double compact_checksum;
+  double compact_time = timeQueries(morton_df, false, compact_checksum);
+  printf("memory footprint\n");
+  printf("  row major              : %8.1f MB, %8.1f MB compacted\n", row_major_bytes/1e6, row_major_df.getMemoryUsage()/1e6);
+  printf("  morton                 : %8.1f MB, %8.1f MB compacted\n", morton_bytes/1e6, morton_df.getMemoryUsage()/1e6);
+  printf("  morton, compacted plane: %8.1f ns (checksum difference %g)\n", 1e9*compact_time, fabs(compact_checksum - voxel_checksum));
+}
+
+int main(int argc, char** argv)
+{
+  const int num_threads = (argc > 1) ? atoi(argv[1]) : 4;
+  const int densities[] = {100, 1000, 10000, 100000};
+
+  printf("%.1fx%.1fx%.1fm grid, %.2fm resolution, %.2fm max distance, %d threads\n",
+         size_x, size_y, size_z, resolution, max_dist, num_threads);
+  for (unsigned int d=0; d<sizeof(densities)/sizeof(densities[0]); ++d)
+  {
+    PropagationDistanceField full_df(size_x, size_y, size_z, resolution, 0.0, 0.0, 0.0, max_dist);
+    PropagationDistanceField parallel_df(size_x, size_y, size_z, resolution, 0.0, 0.0, 0.0, max_dist);
+    PropagationDistanceField iterative_df(size_x, size_y, size_z, resolution, 0.0, 0.0, 0.0, max_dist);
+    PropagationDistanceField dirty_region_df(size_x, size_y, size_z, resolution, 0.0, 0.0, 0.0, max_dist);
+    PropagationDistanceField parallel_dirty_region_df(size_x, size_y, size_z, resolution, 0.0, 0.0, 0.0, max_dist);
+    parallel_df.setNumThreads(num_threads);
+    dirty_region_df.setDirtyRegionTracking(true);
+    parallel_dirty_region_df.setDirtyRegionTracking(true);
+    parallel_dirty_region_df.setNumThreads(num_threads);
+
+    double full_time = timeUpdates(full_df, densities[d], false);
+    double parallel_time = timeUpdates(parallel_df, densities[d], false);
+    double iterative_time = timeUpdates(iterative_df, densities[d], true);
+    double dirty_region_time = timeUpdates(dirty_region_df, densities[d], true);
+    double parallel_dirty_region_time = timeUpdates(parallel_dirty_region_df, densities[d], true);
+
+    printf("%d clutter points\n", densities[d]);
+    printf("  full                  : %8.2f ms\n", 1e3*full_time);
+    printf("  full, threaded        : %8.2f ms (%d voxels differ)\n", 1e3*parallel_time, countDifferences(full_df, parallel_df));
+    printf("  iterative             : %8.2f ms (%d voxels differ)\n", 1e3*iterative_time, countDifferences(full_df, iterative_df));
+    printf("  dirty region          : %8.2f ms (%d voxels differ)\n", 1e3*dirty_region_time, countDifferences(full_df, dirty_region_df));
+    printf("  dirty region, threaded: %8.2f ms (%d voxels differ)\n", 1e3*parallel_dirty_region_time,
+           countDifferences(full_df, parallel_dirty_region_df));
+
+    PFDistanceField pf_df(size_x, size_y, size_z, resolution, 0.0, 0.0, 0.0);
+    printf("  PF transform          : %8.2f ms\n", 1e3*timePFUpdates(pf_df, densities[d]));
+  }
+
+  benchmarkQueries();
+  return 0;
+}
@@ -38,6 +38,7 @@
 
 #include <distance_field/voxel_grid.h>
 #include <distance_field/propagation_distance_field.h>
+#include <distance_field/pf_distance_field.h>
 #include <ros/ros.h>
 
 using namespace distance_field;
@@ -150,6 +151,307 @@ TEST(TestPropagationDistanceField, TestAddPoints)
 
 }
 
+TEST(TestPropagationDistanceField, TestParallelAndDirtyRegionUpdates)
+{
+  const double size = 1.2;
+  PropagationDistanceField sequential_df( size, size, size, resolution, origin_x, origin_y, origin_z, max_dist);
+  PropagationDistanceField parallel_df( size, size, size, resolution, origin_x, origin_y, origin_z, max_dist);
+  PropagationDistanceField dirty_region_df( size, size, size, resolution, origin_x, origin_y, origin_z, max_dist);
+  parallel_df.setNumThreads(3);
+  dirty_region_df.setDirtyRegionTracking(true);
+
+  int numX = sequential_df.getNumCells(PropagationDistanceField::DIM_X);
+  int numY = sequential_df.getNumCells(PropagationDistanceField::DIM_Y);
+  int numZ = sequential_df.getNumCells(PropagationDistanceField::DIM_Z);
+
+  std::vector<tf::Vector3> points;
+  points.push_back(tf::Vector3(0.1,0.2,0.4));
+  points.push_back(tf::Vector3(0.5,0.5,0.5));
+  points.push_back(tf::Vector3(0.9,0.1,0.8));
+  points.push_back(tf::Vector3(1.0,0.9,0.2));
+  sequential_df.updatePointsInField(points);
+  parallel_df.updatePointsInField(points);
+  dirty_region_df.updatePointsInField(points);
+  check_distance_field( sequential_df, points, numX, numY, numZ);
+  check_distance_field( parallel_df, points, numX, numY, numZ);
+  check_distance_field( dirty_region_df, points, numX, numY, numZ);
+
+  // move a single obstacle, only its neighborhood is recomputed
+  points[1] = tf::Vector3(0.4,0.5,0.4);
+  sequential_df.updatePointsInField(points,true);
+  parallel_df.updatePointsInField(points,true);
+  dirty_region_df.updatePointsInField(points,true);
+  check_distance_field( sequential_df, points, numX, numY, numZ);
+  check_distance_field( parallel_df, points, numX, numY, numZ);
+  check_distance_field( dirty_region_df, points, numX, numY, numZ);
+
+  int3 min_corner, max_corner;
+  ASSERT_TRUE( dirty_region_df.getDirtyRegion(min_corner, max_corner) );
+  EXPECT_EQ( min_corner, int3(4-max_dist_in_voxels, 5-max_dist_in_voxels, 4-max_dist_in_voxels) );
+  EXPECT_EQ( max_corner, int3(5+max_dist_in_voxels, 5+max_dist_in_voxels, 5+max_dist_in_voxels) );
+
+  // an update without changes does not touch the field
+  dirty_region_df.updatePointsInField(points,true);
+  EXPECT_FALSE( dirty_region_df.getDirtyRegion(min_corner, max_corner) );
+  check_distance_field( dirty_region_df, points, numX, numY, numZ);
+
+  // remove an obstacle
+  points.pop_back();
+  sequential_df.updatePointsInField(points,true);
+  parallel_df.updatePointsInField(points,true);
+  dirty_region_df.updatePointsInField(points,true);
+  check_distance_field( sequential_df, points, numX, numY, numZ);
+  check_distance_field( parallel_df, points, numX, numY, numZ);
+  check_distance_field( dirty_region_df, points, numX, numY, numZ);
+}
+
+TEST(TestPropagationDistanceField, TestMortonStorageAndDistancePlane)
+{
+  const double size = 1.2;
+  PropagationDistanceField row_major_df( size, size, size, resolution, origin_x, origin_y, origin_z, max_dist);
+  PropagationDistanceField morton_df( size, size, size, resolution, origin_x, origin_y, origin_z, max_dist,
+                                      PropagationDistanceField::MORTON);
+  EXPECT_TRUE( row_major_df.hasDistancePlane() );
+  EXPECT_TRUE( morton_df.hasDistancePlane() );
+
+  int numX = morton_df.getNumCells(PropagationDistanceField::DIM_X);
+  int numY = morton_df.getNumCells(PropagationDistanceField::DIM_Y);
+  int numZ = morton_df.getNumCells(PropagationDistanceField::DIM_Z);
+
+  std::vector<tf::Vector3> points;
+  points.push_back(tf::Vector3(0.1,0.2,0.4));
+  points.push_back(tf::Vector3(0.5,0.5,0.5));
+  points.push_back(tf::Vector3(0.9,0.1,0.8));
+  row_major_df.updatePointsInField(points);
+  morton_df.updatePointsInField(points);
+  check_distance_field( morton_df, points, numX, numY, numZ);
+
+  // remove a point, the plane has to follow the iterative update
+  points.pop_back();
+  row_major_df.updatePointsInField(points,true);
+  morton_df.updatePointsInField(points,true);
+  check_distance_field( morton_df, points, numX, numY, numZ);
+
+  for (int x=0; x<numX; x++) {
+    for (int y=0; y<numY; y++) {
+      for (int z=0; z<numZ; z++) {
+        double expected = sqrt(double(morton_df.getCell(x,y,z).distance_square_))*resolution;
+        ASSERT_NEAR( morton_df.getDistanceFromCell(x,y,z), expected, 1e-9 );
+        ASSERT_EQ( row_major_df.getDistanceFromCell(x,y,z), morton_df.getDistanceFromCell(x,y,z) );
+      }
+    }
+  }
+
+  double gradient[3], morton_gradient[3];
+  double distance = row_major_df.getDistanceGradient(0.4, 0.4, 0.6, gradient[0], gradient[1], gradient[2]);
+  double morton_distance = morton_df.getDistanceGradient(0.4, 0.4, 0.6, morton_gradient[0], morton_gradient[1], morton_gradient[2]);
+  EXPECT_EQ( distance, morton_distance );
+  for (int i=0; i<3; i++)
+    EXPECT_EQ( gradient[i], morton_gradient[i] );
+}
+
+TEST(TestSignedPropagationDistanceField, TestDistancePlane)
+{
+  SignedPropagationDistanceField df( width, height, depth, resolution, origin_x, origin_y, origin_z, max_dist,
+                                     SignedPropagationDistanceField::MORTON);
+  ASSERT_TRUE( df.hasDistancePlane() );
+
+  int numX = df.getNumCells(SignedPropagationDistanceField::DIM_X);
+  int numY = df.getNumCells(SignedPropagationDistanceField::DIM_Y);
+  int numZ = df.getNumCells(SignedPropagationDistanceField::DIM_Z);
+
+  // a solid block of obstacles
+  std::vector<tf::Vector3> points;
+  for (int x=1; x<4; x++)
+    for (int y=1; y<4; y++)
+      for (int z=1; z<4; z++)
+        points.push_back(tf::Vector3(x*resolution, y*resolution, z*resolution));
+  df.addPointsToField(points);
+
+  for (int x=0; x<numX; x++) {
+    for (int y=0; y<numY; y++) {
+      for (int z=0; z<numZ; z++) {
+        const SignedPropDistanceFieldVoxel& voxel = df.getCell(x,y,z);
+        double expected = (sqrt(double(voxel.positive_distance_square_)) - sqrt(double(voxel.negative_distance_square_)))*resolution;
+        ASSERT_NEAR( df.getDistanceFromCell(x,y,z), expected, 1e-9 );
+      }
+    }
+  }
+  EXPECT_LT( df.getDistanceFromCell(2,2,2), 0.0 );
+  EXPECT_GT( df.getDistanceFromCell(0,0,0), 0.0 );
+}
+
+TEST(TestPropagationDistanceField, TestInterpolatedDistanceGradients)
+{
+  const double size = 1.2;
+  PropagationDistanceField df( size, size, size, resolution, origin_x, origin_y, origin_z, max_dist,
+                               PropagationDistanceField::MORTON);
+  std::vector<tf::Vector3> points;
+  points.push_back(tf::Vector3(0.5,0.5,0.5));
+  df.updatePointsInField(points);
+
+  double gradient[3];
+
+  // at the voxel centers the interpolation reproduces the voxels
+  for (int x=1; x<6; x++)
+  {
+    double distance = df.getInterpolatedDistanceGradient(x*resolution, 0.5, 0.5, gradient[0], gradient[1], gradient[2]);
+    EXPECT_NEAR( distance, df.getDistanceFromCell(x,5,5), 1e-9 );
+  }
+
+  // between the voxel centers it is linear along an axis
+  double distance = df.getInterpolatedDistanceGradient(0.325, 0.5, 0.5, gradient[0], gradient[1], gradient[2]);
+  EXPECT_NEAR( distance, 0.175, 1e-9 );
+  EXPECT_NEAR( gradient[0], -1.0, 1e-9 );
+
+  // out of bounds the distance is the maximum distance
+  distance = df.getInterpolatedDistanceGradient(-0.2, 0.5, 0.5, gradient[0], gradient[1], gradient[2]);
+  EXPECT_NEAR( distance, max_dist, 1e-9 );
+  EXPECT_EQ( gradient[0], 0.0 );
+  EXPECT_EQ( gradient[1], 0.0 );
+  EXPECT_EQ( gradient[2], 0.0 );
+  distance = df.getInterpolatedDistanceGradient(0.5, 0.5, size + 0.2, gradient[0], gradient[1], gradient[2]);
+  EXPECT_NEAR( distance, max_dist, 1e-9 );
+  EXPECT_EQ( gradient[2], 0.0 );
+
+  // in the outer half voxel band the distance is clamped to the boundary voxels
+  const int last = df.getNumCells(PropagationDistanceField::DIM_X)-1;
+  distance = df.getInterpolatedDistanceGradient(-0.04, 0.5, 0.5, gradient[0], gradient[1], gradient[2]);
+  EXPECT_NEAR( distance, df.getDistanceFromCell(0,5,5), 1e-9 );
+  EXPECT_EQ( gradient[0], 0.0 );
+  distance = df.getInterpolatedDistanceGradient((last+0.4)*resolution, 0.5, 0.5, gradient[0], gradient[1], gradient[2]);
+  EXPECT_NEAR( distance, df.getDistanceFromCell(last,5,5), 1e-9 );
+  EXPECT_EQ( gradient[0], 0.0 );
+  distance = df.getInterpolatedDistanceGradient(last*resolution, 0.5, 0.5, gradient[0], gradient[1], gradient[2]);
+  EXPECT_NEAR( distance, df.getDistanceFromCell(last,5,5), 1e-9 );
+
+  // batches match the single queries
+  const int num_queries = 2000;
+  std::vector<double> queries(3*num_queries), distances(num_queries), gradients(3*num_queries);
+  for (int i=0; i<3*num_queries; i++)
+    queries[i] = (i*0.37)/(3*num_queries) + (i%3)*0.2;
+  df.getInterpolatedDistanceGradients(&queries[0], num_queries, &distances[0], &gradients[0]);
+  for (int i=0; i<num_queries; i++)
+  {
+    distance = df.getInterpolatedDistanceGradient(queries[3*i], queries[3*i+1], queries[3*i+2], gradient[0], gradient[1], gradient[2]);
+    ASSERT_EQ( distances[i], distance );
+    for (int j=0; j<3; j++)
+      ASSERT_EQ( gradients[3*i+j], gradient[j] );
+  }
+  df.getInterpolatedDistanceGradients(&queries[0], num_queries, &distances[0], NULL);
+  EXPECT_EQ( distances[num_queries-1], distance );
+}
+
+TEST(TestPropagationDistanceField, TestCompactMemoryFootprint)
+{
+  const double size = 1.2;
+  PropagationDistanceField df( size, size, size, resolution, origin_x, origin_y, origin_z, max_dist,
+                               PropagationDistanceField::MORTON);
+  std::vector<tf::Vector3> points;
+  points.push_back(tf::Vector3(0.1,0.2,0.4));
+  points.push_back(tf::Vector3(0.5,0.5,0.5));
+  df.updatePointsInField(points);
+
+  int numX = df.getNumCells(PropagationDistanceField::DIM_X);
+  int numY = df.getNumCells(PropagationDistanceField::DIM_Y);
+  int numZ = df.getNumCells(PropagationDistanceField::DIM_Z);
+  std::vector<double> distances;
+  for (int x=0; x<numX; x++)
+    for (int y=0; y<numY; y++)
+      for (int z=0; z<numZ; z++)
+        distances.push_back(df.getDistanceFromCell(x,y,z));
+  double gradient[3], compact_gradient[3];
+  double distance = df.getInterpolatedDistanceGradient(0.325, 0.45, 0.6, gradient[0], gradient[1], gradient[2]);
+
+  const size_t full_bytes = df.getMemoryUsage();
+  ASSERT_TRUE( df.compact() );
+  EXPECT_TRUE( df.isCompact() );
+  const size_t compact_bytes = df.getMemoryUsage();
+  std::cout << "distance field of " << numX*numY*numZ << " voxels: " << full_bytes << " bytes, "
+            << compact_bytes << " bytes compacted" << std::endl;
+  RecordProperty("full_bytes", full_bytes);
+  RecordProperty("compact_bytes", compact_bytes);
+  // each voxel takes 32 bytes and a flag, in the packed distance plane it takes 2 bytes
+  EXPECT_LT( 8*compact_bytes, full_bytes );
+
+  // the queries only read the distance plane
+  int i = 0;
+  for (int x=0; x<numX; x++)
+    for (int y=0; y<numY; y++)
+      for (int z=0; z<numZ; z++)
+        ASSERT_EQ( distances[i++], df.getDistanceFromCell(x,y,z) );
+  EXPECT_EQ( distance, df.getInterpolatedDistanceGradient(0.325, 0.45, 0.6, compact_gradient[0], compact_gradient[1], compact_gradient[2]) );
+  for (int j=0; j<3; j++)
+    EXPECT_EQ( gradient[j], compact_gradient[j] );
+
+  // obstacles can only be added again after a reset
+  df.addPointsToField(points);
+  EXPECT_TRUE( df.isCompact() );
+  df.reset();
+  EXPECT_FALSE( df.isCompact() );
+  EXPECT_EQ( full_bytes, df.getMemoryUsage() );
+  df.addPointsToField(points);
+  check_distance_field( df, points, numX, numY, numZ);
+
+  // without a distance plane the voxels are needed for the queries
+  PropagationDistanceField unpacked_df( width, height, depth, resolution, origin_x, origin_y, origin_z, 30.0);
+  ASSERT_FALSE( unpacked_df.hasDistancePlane() );
+  EXPECT_FALSE( unpacked_df.compact() );
+  EXPECT_FALSE( unpacked_df.isCompact() );
+}
+
+TEST(TestPFDistanceField, TestAddPoints)
+{
+  const double size = 1.2;
+  PFDistanceField df( size, size, size, resolution, origin_x, origin_y, origin_z);
+  PFDistanceField morton_df( size, size, size, resolution, origin_x, origin_y, origin_z, PFDistanceField::MORTON);
+  PFDistanceField radius_df( size, size, size, resolution, origin_x, origin_y, origin_z);
+  radius_df.setUpdateRadius(0.2);
+
+  int numX = df.getNumCells(PFDistanceField::DIM_X);
+  int numY = df.getNumCells(PFDistanceField::DIM_Y);
+  int numZ = df.getNumCells(PFDistanceField::DIM_Z);
+
+  std::vector<tf::Vector3> points, new_points;
+  points.push_back(tf::Vector3(0.1,0.9,0.2));
+  points.push_back(tf::Vector3(0.8,0.4,1.0));
+  df.addPointsToField(points);
+  morton_df.addPointsToField(points);
+  radius_df.addPointsToField(points);
+
+  // incremental additions are exact everywhere, and within the update radius when it is set
+  new_points.push_back(tf::Vector3(0.5,0.5,0.5));
+  new_points.push_back(tf::Vector3(0.4,0.5,0.9));
+  points.insert(points.end(), new_points.begin(), new_points.end());
+  df.addPointsToField(new_points);
+  morton_df.addPointsToField(new_points);
+  radius_df.addPointsToField(new_points);
+
+  for (int x=0; x<numX; x++) {
+    for (int y=0; y<numY; y++) {
+      for (int z=0; z<numZ; z++) {
+        int min_dist_square = std::numeric_limits<int>::max();
+        int min_new_dist_square = std::numeric_limits<int>::max();
+        for( unsigned int i=0; i<points.size(); i++) {
+          int dist_square = dist_sq(points[i].x()/resolution - x, points[i].y()/resolution - y, points[i].z()/resolution - z);
+          min_dist_square = std::min(dist_square, min_dist_square);
+          if (i >= points.size() - new_points.size())
+            min_new_dist_square = std::min(dist_square, min_new_dist_square);
+        }
+        ASSERT_EQ(df.getCell(x,y,z), min_dist_square);
+        ASSERT_EQ(morton_df.getCell(x,y,z), min_dist_square);
+        if (min_new_dist_square <= 4)
+          ASSERT_EQ(radius_df.getCell(x,y,z), min_dist_square);
+        else
+          ASSERT_GE(radius_df.getCell(x,y,z), min_dist_square);
+      }
+    }
+  }
+
+  df.reset();
+  EXPECT_EQ(df.getCell(5,5,5), df.DT_INF);
+}
+
 int main(int argc, char **argv){
   testing::InitGoogleTest(&argc, argv);
 
@@ -91,6 +91,46 @@ TEST(TestVoxelGrid, TestReadWrite)
 
 }
 
+TEST(TestVoxelGrid, TestMortonReadWrite)
+{
+  int def=-100;
+  // not a multiple of the brick size in any dimension
+  VoxelGrid<int> vg(0.13,0.09,0.21,0.01,0,0,0, def, VoxelGrid<int>::MORTON);
+  EXPECT_EQ(vg.getStorageOrder(), VoxelGrid<int>::MORTON);
+
+  int numX = vg.getNumCells(VoxelGrid<int>::DIM_X);
+  int numY = vg.getNumCells(VoxelGrid<int>::DIM_Y);
+  int numZ = vg.getNumCells(VoxelGrid<int>::DIM_Z);
+
+  vg.reset(-1);
+
+  // every cell needs its own storage
+  int i=0;
+  for (int x=0; x<numX; x++)
+    for (int y=0; y<numY; y++)
+      for (int z=0; z<numZ; z++)
+      {
+        EXPECT_EQ(-1, vg.getCell(x,y,z));
+        vg.getCell(x,y,z) = i;
+        i++;
+      }
+
+  i=0;
+  for (int x=0; x<numX; x++)
+    for (int y=0; y<numY; y++)
+      for (int z=0; z<numZ; z++)
+      {
+        EXPECT_EQ(i, vg.getCell(x,y,z));
+        i++;
+      }
+
+  // neighboring cells of a brick are stored next to each other
+  EXPECT_EQ(&vg.getCell(0,0,1) - &vg.getCell(0,0,0), 1);
+  EXPECT_EQ(&vg.getCell(0,1,0) - &vg.getCell(0,0,0), 2);
+  EXPECT_EQ(&vg.getCell(1,0,0) - &vg.getCell(0,0,0), 4);
+  EXPECT_EQ(&vg.getCell(1,1,1) - &vg.getCell(0,0,0), 7);
+}
+
 int main(int argc, char **argv){
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
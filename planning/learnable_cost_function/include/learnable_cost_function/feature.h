@@ -32,11 +32,47 @@ public:
   virtual int getNumValues() const = 0;
   virtual void computeValuesAndGradients(boost::shared_ptr<Input const> input, std::vector<double>& feature_values,
                                          bool compute_gradients, std::vector<Eigen::VectorXd>& gradients, bool& state_validity) = 0;
+
+  /**
+   * Computes the feature values of a batch of inputs at once, e.g. all time steps of a rollout.
+   * The values of inputs[i] are written to row (row + i) of feature_values, starting at column "column".
+   * state_validities[i] is set to 0 if inputs[i] is not a valid state, and left untouched otherwise.
+   *
+   * The default implementation calls computeValuesAndGradients() for each input, features can
+   * override it to share work between the inputs.
+   */
+  virtual void computeValues(const boost::shared_ptr<Input const>* inputs, int num_inputs,
+                             Eigen::MatrixXd& feature_values, int row, int column, int* state_validities);
+
+  /**
+   * Returns true if computeValues() may be called concurrently on disjoint inputs of the same batch.
+   */
+  virtual bool isThreadSafe() const { return false; }
+
   virtual std::string getName() const = 0;
   virtual boost::shared_ptr<Feature> clone() const = 0;
 
 };
 
+////////////////////////// inline functions follow ////////////////////////////////////////
+
+inline void Feature::computeValues(const boost::shared_ptr<Input const>* inputs, int num_inputs,
+                                   Eigen::MatrixXd& feature_values, int row, int column, int* state_validities)
+{
+  // scratch space is allocated once per batch, not per input
+  std::vector<double> values(getNumValues());
+  std::vector<Eigen::VectorXd> gradients;
+  for (int i=0; i<num_inputs; ++i)
+  {
+    bool validity;
+    computeValuesAndGradients(inputs[i], values, false, gradients, validity);
+    for (unsigned int j=0; j<values.size(); ++j)
+      feature_values(row+i, column+j) = values[j];
+    if (!validity)
+      state_validities[i] = 0;
+  }
+}
+
 }
 
 #endif /* LEARNABLE_COST_FUNCTION_FEATURE_H_ */
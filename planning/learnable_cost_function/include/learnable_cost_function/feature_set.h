@@ -32,9 +32,20 @@ public:
   virtual int getNumValues() const;
   virtual void computeValuesAndGradients(boost::shared_ptr<Input const> input, std::vector<double>& feature_values,
                                          bool compute_gradients, std::vector<Eigen::VectorXd>& gradients, bool& state_validity);
+  virtual void computeValues(const boost::shared_ptr<Input const>* inputs, int num_inputs,
+                             Eigen::MatrixXd& feature_values, int row, int column, int* state_validities);
+  virtual bool isThreadSafe() const;
   virtual std::string getName() const;
   virtual boost::shared_ptr<Feature> clone() const;
 
+  /**
+   * Same as computeValues() above, but the inputs of the thread safe features are split into
+   * blocks that are processed by num_threads threads.
+   */
+  void computeValues(const boost::shared_ptr<Input const>* inputs, int num_inputs,
+                     Eigen::MatrixXd& feature_values, int row, int column, int* state_validities,
+                     int num_threads);
+
   void addFeature(boost::shared_ptr<Feature> features);
   void clear();
 
@@ -6,6 +6,8 @@
  */
 
 #include <learnable_cost_function/feature_set.h>
+#include <algorithm>
+#include <omp.h>
 
 namespace learnable_cost_function
 {
@@ -67,6 +69,46 @@ void FeatureSet::computeValuesAndGradients(boost::shared_ptr<Input const> input,
 
 }
 
+void FeatureSet::computeValues(const boost::shared_ptr<Input const>* inputs, int num_inputs,
+                               Eigen::MatrixXd& feature_values, int row, int column, int* state_validities)
+{
+  computeValues(inputs, num_inputs, feature_values, row, column, state_validities, 1);
+}
+
+void FeatureSet::computeValues(const boost::shared_ptr<Input const>* inputs, int num_inputs,
+                               Eigen::MatrixXd& feature_values, int row, int column, int* state_validities,
+                               int num_threads)
+{
+  // each feature writes its values straight into its own columns
+  for (unsigned int i=0; i<features_.size(); ++i)
+  {
+    Feature* feature = features_[i].feature.get();
+    int feature_threads = feature->isThreadSafe() ? std::min(num_threads, num_inputs) : 1;
+
+    // one contiguous block of inputs per thread
+#pragma omp parallel num_threads(feature_threads) if (feature_threads > 1)
+    {
+      int num_blocks = omp_get_num_threads();
+      int block = omp_get_thread_num();
+      int start = (block * num_inputs) / num_blocks;
+      int end = ((block + 1) * num_inputs) / num_blocks;
+      feature->computeValues(inputs + start, end - start, feature_values, row + start, column,
+                             state_validities + start);
+    }
+    column += features_[i].num_values;
+  }
+}
+
+bool FeatureSet::isThreadSafe() const
+{
+  for (unsigned int i=0; i<features_.size(); ++i)
+  {
+    if (!features_[i].feature->isThreadSafe())
+      return false;
+  }
+  return true;
+}
+
 std::string FeatureSet::getName() const
 {
   return "FeatureSet";
@@ -0,0 +1,75 @@
+/*
+ * banded_quintic_spline_solver.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef BANDED_QUINTIC_SPLINE_SOLVER_H_
+#define BANDED_QUINTIC_SPLINE_SOLVER_H_
+
+#include <vector>
+
+namespace qp_spline_smoother
+{
+
+/**
+ * Quadratic cost matrix of a single quintic spline segment x = at^5 + bt^4 + ct^3 + dt^2 + et + f,
+ * over the variables [a b c d e], as used by the quadratic program in QuinticOptimizedSplineSmoother
+ *
+ * @param dt duration of the segment
+ * @param cost (output) symmetric 5x5 matrix
+ */
+void computeQuinticSegmentCost(double dt, double velocity_weight, double acceleration_weight, double jerk_weight,
+                               double cost[5][5]);
+
+/**
+ * \brief Solves the quintic spline smoothing problem of QuinticOptimizedSplineSmoother in O(length)
+ *
+ * The quadratic program only has equality constraints, which fix the positions of all points and the
+ * velocities and accelerations at both ends. Each segment is fully determined by the position, velocity
+ * and acceleration at its two end points, so the program is equivalent to an unconstrained least squares
+ * problem in the interior velocities and accelerations. Its matrix is block tridiagonal (a band matrix with
+ * half-bandwidth 3), and only depends on the segment durations, not on the positions. The factorization is
+ * therefore kept, and reused as long as the durations stay the same (e.g. across joints, and across chunks of
+ * a trajectory with constant time steps).
+ */
+class BandedQuinticSplineSolver
+{
+public:
+  BandedQuinticSplineSolver(double velocity_weight, double acceleration_weight, double jerk_weight);
+  virtual ~BandedQuinticSplineSolver();
+
+  /**
+   * Same interface as QuinticOptimizedSplineSmoother::optimize(): fills in the interior velocities and
+   * accelerations xd[1..length-2] and xdd[1..length-2]
+   *
+   * @param t times of the points, starting at 0
+   * @return false if the problem is degenerate
+   */
+  bool optimize(const double *x, double *xd, double *xdd, const double *t, int length);
+
+  /**
+   * Number of factorizations done so far, the other calls to optimize() reused the previous one
+   */
+  int getNumFactorizations() const;
+
+private:
+  static const int BANDWIDTH = 3;
+
+  double velocity_weight_;
+  double acceleration_weight_;
+  double jerk_weight_;
+
+  std::vector<double> durations_;       /**< segment durations of the current factorization */
+  std::vector<double> segment_costs_;   /**< [num_segments] 6x6 costs over [x0 v0 a0 x1 v1 a1], row major */
+  std::vector<double> cholesky_;        /**< [num_unknowns] x (BANDWIDTH+1), cholesky_[i*(BANDWIDTH+1)+k] = L(i, i-k) */
+  std::vector<double> rhs_;
+  bool factorization_valid_;
+  int num_factorizations_;
+
+  bool factorize(const double *t, int length);
+};
+
+}
+
+#endif /* BANDED_QUINTIC_SPLINE_SOLVER_H_ */
@@ -11,6 +11,7 @@
 #include <spline_smoother/spline_smoother.h>
 #include <spline_smoother/spline_smoother_utils.h>
 #include <quadprog/QuadProg++.hh>
+#include <qp_spline_smoother/banded_quintic_spline_solver.h>
 #include <rosbag/bag.h>
 #include <sstream>
 
@@ -37,9 +38,10 @@ private:
   };
 
   std::vector<double> cost_function_weights_;
-  int chunk_size_;
+  int chunk_size_;                  /**< number of points optimized at once, <= 0 for the whole trajectory */
   double min_dt_;
   bool logging_;
+  bool use_banded_solver_;          /**< use BandedQuinticSplineSolver instead of the dense quadratic program, off by default */
 
   bool optimize(const double *x, double *xd, double *xdd, double *t, int length) const;
   bool numericalDifferentiation(T& trajectory) const;
@@ -58,6 +60,7 @@ QuinticOptimizedSplineSmoother<T>::QuinticOptimizedSplineSmoother()
   cost_function_weights_[MIN_JERK]=0.0;
   chunk_size_=10;
   min_dt_ = 0.01;
+  use_banded_solver_ = false;
 }
 
 template<typename T>
@@ -83,11 +86,16 @@ bool QuinticOptimizedSplineSmoother<T>::configure()
   {
     logging_ = filters::FilterBase<T>::params_["logging"];
   }
+  if (filters::FilterBase<T>::params_.find("use_banded_solver") != filters::FilterBase<T>::params_.end())
+  {
+    use_banded_solver_ = filters::FilterBase<T>::params_["use_banded_solver"];
+  }
   ROS_DEBUG("velocity cost = %f", cost_function_weights_[MIN_VEL]);
   ROS_DEBUG("acceleration cost = %f", cost_function_weights_[MIN_ACC]);
   ROS_DEBUG("jerk cost = %f", cost_function_weights_[MIN_JERK]);
   ROS_DEBUG("chunk size = %d", chunk_size_);
   ROS_DEBUG("min_dt = %f", min_dt_);
+  ROS_DEBUG("banded solver = %d", use_banded_solver_);
   
   for (int i=0; i<NUM_WEIGHTS; ++i)
   {
@@ -189,73 +197,85 @@ bool QuinticOptimizedSplineSmoother<T>::smooth(const T& trajectory_in, T& trajec
   if (size>=3)
   {
     // optimize in chunks
-#pragma omp parallel for
-    for (int j = 0; j < num_traj; ++j)
-    {
-      double x[chunk_size_];
-      double xd[chunk_size_];
-      double xdd[chunk_size_];
-      double t[chunk_size_];
-      int last_valid = 0;
+    int chunk_size = chunk_size_;
+    if (chunk_size <= 0 || chunk_size > size)
+      chunk_size = size;
 
-      do
+#pragma omp parallel
+    {
+      // one solver per thread, which keeps its factorization for all chunks and joints with the same timing
+      BandedQuinticSplineSolver solver(cost_function_weights_[MIN_VEL], cost_function_weights_[MIN_ACC],
+                                       cost_function_weights_[MIN_JERK]);
+#pragma omp for
+      for (int j = 0; j < num_traj; ++j)
       {
-        int start_point = last_valid - chunk_size_/2;
-        if (start_point < 0)
-          start_point = 0;
-        int end_point = start_point + chunk_size_ - 1;
-        if (end_point > size-1)
-          end_point = size-1;
-
-        int num_points = end_point - start_point + 1;
-        if (num_points < 3)
+        double x[chunk_size];
+        double xd[chunk_size];
+        double xdd[chunk_size];
+        double t[chunk_size];
+        int last_valid = 0;
+
+        do
         {
-          int diff = 3 - num_points;
-          start_point -= diff;
-          num_points +=diff;
+          int start_point = last_valid - chunk_size/2;
           if (start_point < 0)
+            start_point = 0;
+          int end_point = start_point + chunk_size - 1;
+          if (end_point > size-1)
+            end_point = size-1;
+
+          int num_points = end_point - start_point + 1;
+          if (num_points < 3)
           {
-            ROS_ERROR("QuinticOptimized: Strange condition occurred that should never happen!");
-            qp_success = false;
-            break;
+            int diff = 3 - num_points;
+            start_point -= diff;
+            num_points +=diff;
+            if (start_point < 0)
+            {
+              ROS_ERROR("QuinticOptimized: Strange condition occurred that should never happen!");
+              qp_success = false;
+              break;
+            }
           }
-        }
 
-        //ROS_INFO("Chunk = %d to %d", start_point, end_point);
+          //ROS_INFO("Chunk = %d to %d", start_point, end_point);
 
-        // create input for optimize:
-        for (int i=start_point; i<=end_point; ++i)
-        {
-          x[i-start_point] = trajectory_out.request.trajectory.points[i].positions[j];
-          xd[i-start_point] = trajectory_out.request.trajectory.points[i].velocities[j];
-          xdd[i-start_point] = trajectory_out.request.trajectory.points[i].accelerations[j];
-          t[i-start_point] = trajectory_out.request.trajectory.points[i].time_from_start.toSec() -
-              trajectory_out.request.trajectory.points[start_point].time_from_start.toSec();
-        }
-        if (!optimize(x, xd, xdd, t, num_points))
-          qp_success = false;
-        else
-        {
+          // create input for optimize:
           for (int i=start_point; i<=end_point; ++i)
           {
-            double w1=0.0, w2=1.0;
-            if (i<last_valid)
+            x[i-start_point] = trajectory_out.request.trajectory.points[i].positions[j];
+            xd[i-start_point] = trajectory_out.request.trajectory.points[i].velocities[j];
+            xdd[i-start_point] = trajectory_out.request.trajectory.points[i].accelerations[j];
+            t[i-start_point] = trajectory_out.request.trajectory.points[i].time_from_start.toSec() -
+                trajectory_out.request.trajectory.points[start_point].time_from_start.toSec();
+          }
+          bool optimized = use_banded_solver_ ? solver.optimize(x, xd, xdd, t, num_points) :
+              optimize(x, xd, xdd, t, num_points);
+          if (!optimized)
+            qp_success = false;
+          else
+          {
+            for (int i=start_point; i<=end_point; ++i)
             {
-              w1 = last_valid-i;
-              w2 = (last_valid-start_point)-w1;
+              double w1=0.0, w2=1.0;
+              if (i<last_valid)
+              {
+                w1 = last_valid-i;
+                w2 = (last_valid-start_point)-w1;
+              }
+              //ROS_INFO("%i - w1=%f, w2=%f", i, w1, w2);
+              trajectory_out.request.trajectory.points[i].velocities[j] =
+                  weightedAvg(w1, trajectory_out.request.trajectory.points[i].velocities[j], w2, xd[i-start_point]);
+              trajectory_out.request.trajectory.points[i].accelerations[j] =
+                  weightedAvg(w1, trajectory_out.request.trajectory.points[i].accelerations[j], w2, xdd[i-start_point]);
             }
-            //ROS_INFO("%i - w1=%f, w2=%f", i, w1, w2);
-            trajectory_out.request.trajectory.points[i].velocities[j] =
-                weightedAvg(w1, trajectory_out.request.trajectory.points[i].velocities[j], w2, xd[i-start_point]);
-            trajectory_out.request.trajectory.points[i].accelerations[j] =
-                weightedAvg(w1, trajectory_out.request.trajectory.points[i].accelerations[j], w2, xdd[i-start_point]);
           }
-        }
 
-        last_valid = end_point;
+          last_valid = end_point;
 
+        }
+        while (last_valid < size-1);
       }
-      while (last_valid < size-1);
     }
   }
 
@@ -319,84 +339,17 @@ bool QuinticOptimizedSplineSmoother<T>::optimize(const double *x, double *xd, do
   }
 
   // construct the quadratic cost matrix:
-
-  if (cost_function_weights_[MIN_VEL] > 0.0)
-  {
-    double w = cost_function_weights_[MIN_VEL];
-    for (int i = 0; i < numSegments; i++)
-    {
-      int a = i * 5;
-      int b = i * 5 + 1;
-      int c = i * 5 + 2;
-      int d = i * 5 + 3;
-      int e = i * 5 + 4;
-      quadCost[a][a] = (25.0 / 9.0) * dt[i][9] * w;
-      quadCost[a][b] = quadCost[b][a] = (5.0 / 2.0) * dt[i][8] * w;
-      quadCost[a][c] = quadCost[c][a] = ((30.0 / 7.0) / 2.0) * dt[i][7] * w;
-      quadCost[b][b] = (16.0 / 7.0) * dt[i][7] * w;
-      quadCost[a][d] = quadCost[d][a] = ((20.0 / 6.0) / 2.0) * dt[i][6] * w;
-      quadCost[c][b] = quadCost[b][c] = ((24.0 / 6.0) / 2.0) * dt[i][6] * w;
-      quadCost[a][e] = quadCost[e][a] = ((10.0 / 5.0) / 2.0) * dt[i][5] * w;
-      quadCost[b][d] = quadCost[d][b] = ((16.0 / 5.0) / 2.0) * dt[i][5] * w;
-      quadCost[c][c] = (9.0 / 5.0) * dt[i][5] * w;
-      quadCost[b][e] = quadCost[e][b] = ((8.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[c][d] = quadCost[d][c] = ((12.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[c][e] = quadCost[e][c] = ((6.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[d][d] = (4.0 / 3.0) * dt[i][3] * w;
-      quadCost[d][e] = quadCost[e][d] = dt[i][2] * w;
-      quadCost[e][e] = dt[i][1] * w;
-    }
-  }
-  if (cost_function_weights_[MIN_ACC] > 0.0)
-  {
-    double w = cost_function_weights_[MIN_ACC];
-    for (int i = 0; i < numSegments; i++)
-    {
-      int a = i * 5;
-      int b = i * 5 + 1;
-      int c = i * 5 + 2;
-      int d = i * 5 + 3;
-      int e = i * 5 + 4;
-      quadCost[a][a] += (400.0 / 7.0) * dt[i][7] * w;
-      quadCost[a][b] += (80.0 / 2.0) * dt[i][6] * w;
-      quadCost[b][a] += (80.0 / 2.0) * dt[i][6] * w;
-      quadCost[b][b] += (144.0 / 5.0) * dt[i][5] * w;
-      quadCost[a][c] += ((240.0 / 5.0) / 2.0) * dt[i][5] * w;
-      quadCost[c][a] += ((240.0 / 5.0) / 2.0) * dt[i][5] * w;
-      quadCost[c][b] += ((144.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[b][c] += ((144.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[a][d] += ((80.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[d][a] += ((80.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[b][d] += ((48.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[d][b] += ((48.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[c][c] += (36.0 / 3.0) * dt[i][3] * w;
-      quadCost[c][d] += ((12.0) / 2.0) * dt[i][2] * w;
-      quadCost[d][c] += ((12.0) / 2.0) * dt[i][2] * w;
-      quadCost[d][d] += (4.0) * dt[i][1] * w;
-      quadCost[e][e] += 10e-10 * w;
-    }
-  }
-  if (cost_function_weights_[MIN_JERK] > 0.0)
+  for (int i = 0; i < numSegments; i++)
   {
-    double w = cost_function_weights_[MIN_JERK];
-    for (int i = 0; i < numSegments; i++)
+    double segment_cost[5][5];
+    computeQuinticSegmentCost(dt[i][1], cost_function_weights_[MIN_VEL], cost_function_weights_[MIN_ACC],
+                              cost_function_weights_[MIN_JERK], segment_cost);
+    for (int k = 0; k < 5; k++)
     {
-      int a = i * 5;
-      int b = i * 5 + 1;
-      int c = i * 5 + 2;
-      int d = i * 5 + 3;
-      int e = i * 5 + 4;
-      quadCost[a][a] += (720) * dt[i][5] * w;
-      quadCost[a][b] += (720.0 / 2.0) * dt[i][4] * w;
-      quadCost[b][a] += (720.0 / 2.0) * dt[i][4] * w;
-      quadCost[a][c] += ((720.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[c][a] += ((720.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[b][b] += (576.0 / 3.0) * dt[i][3] * w;
-      quadCost[c][b] += ((144.0) / 2.0) * dt[i][2] * w;
-      quadCost[b][c] += ((144.0) / 2.0) * dt[i][2] * w;
-      quadCost[c][c] += (36.0) * dt[i][1] * w;
-      quadCost[d][d] += 10e-10 * w;
-      quadCost[e][e] += 10e-10 * w;
+      for (int l = 0; l < 5; l++)
+      {
+        quadCost[i * 5 + k][i * 5 + l] = segment_cost[k][l];
+      }
     }
   }
 
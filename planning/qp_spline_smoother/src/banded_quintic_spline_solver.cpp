@@ -0,0 +1,260 @@
+/*
+ * banded_quintic_spline_solver.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <qp_spline_smoother/banded_quintic_spline_solver.h>
+#include <algorithm>
+#include <math.h>
+
+namespace qp_spline_smoother
+{
+
+void computeQuinticSegmentCost(double dt, double velocity_weight, double acceleration_weight, double jerk_weight,
+                               double cost[5][5])
+{
+  // powers of dt
+  double p[10];
+  p[0] = 1.0;
+  for (int j = 1; j <= 9; j++)
+    p[j] = p[j - 1] * dt;
+
+  for (int i = 0; i < 5; i++)
+    for (int j = 0; j < 5; j++)
+      cost[i][j] = 0.0;
+
+  const int a = 0, b = 1, c = 2, d = 3, e = 4;
+  if (velocity_weight > 0.0)
+  {
+    double w = velocity_weight;
+    cost[a][a] += (25.0 / 9.0) * p[9] * w;
+    cost[a][b] += (5.0 / 2.0) * p[8] * w;
+    cost[a][c] += ((30.0 / 7.0) / 2.0) * p[7] * w;
+    cost[b][b] += (16.0 / 7.0) * p[7] * w;
+    cost[a][d] += ((20.0 / 6.0) / 2.0) * p[6] * w;
+    cost[b][c] += ((24.0 / 6.0) / 2.0) * p[6] * w;
+    cost[a][e] += ((10.0 / 5.0) / 2.0) * p[5] * w;
+    cost[b][d] += ((16.0 / 5.0) / 2.0) * p[5] * w;
+    cost[c][c] += (9.0 / 5.0) * p[5] * w;
+    cost[b][e] += ((8.0 / 4.0) / 2.0) * p[4] * w;
+    cost[c][d] += ((12.0 / 4.0) / 2.0) * p[4] * w;
+    cost[c][e] += ((6.0 / 3.0) / 2.0) * p[3] * w;
+    cost[d][d] += (4.0 / 3.0) * p[3] * w;
+    cost[d][e] += p[2] * w;
+    cost[e][e] += p[1] * w;
+  }
+  if (acceleration_weight > 0.0)
+  {
+    double w = acceleration_weight;
+    cost[a][a] += (400.0 / 7.0) * p[7] * w;
+    cost[a][b] += (80.0 / 2.0) * p[6] * w;
+    cost[b][b] += (144.0 / 5.0) * p[5] * w;
+    cost[a][c] += ((240.0 / 5.0) / 2.0) * p[5] * w;
+    cost[b][c] += ((144.0 / 4.0) / 2.0) * p[4] * w;
+    cost[a][d] += ((80.0 / 4.0) / 2.0) * p[4] * w;
+    cost[b][d] += ((48.0 / 3.0) / 2.0) * p[3] * w;
+    cost[c][c] += (36.0 / 3.0) * p[3] * w;
+    cost[c][d] += ((12.0) / 2.0) * p[2] * w;
+    cost[d][d] += (4.0) * p[1] * w;
+    cost[e][e] += 10e-10 * w;
+  }
+  if (jerk_weight > 0.0)
+  {
+    double w = jerk_weight;
+    cost[a][a] += (720) * p[5] * w;
+    cost[a][b] += (720.0 / 2.0) * p[4] * w;
+    cost[a][c] += ((720.0 / 3.0) / 2.0) * p[3] * w;
+    cost[b][b] += (576.0 / 3.0) * p[3] * w;
+    cost[b][c] += ((144.0) / 2.0) * p[2] * w;
+    cost[c][c] += (36.0) * p[1] * w;
+    cost[d][d] += 10e-10 * w;
+    cost[e][e] += 10e-10 * w;
+  }
+
+  // only the upper triangle was filled in above
+  for (int i = 0; i < 5; i++)
+    for (int j = 0; j < i; j++)
+      cost[i][j] = cost[j][i];
+}
+
+BandedQuinticSplineSolver::BandedQuinticSplineSolver(double velocity_weight, double acceleration_weight, double jerk_weight):
+  velocity_weight_(velocity_weight),
+  acceleration_weight_(acceleration_weight),
+  jerk_weight_(jerk_weight),
+  factorization_valid_(false),
+  num_factorizations_(0)
+{
+}
+
+BandedQuinticSplineSolver::~BandedQuinticSplineSolver()
+{
+}
+
+int BandedQuinticSplineSolver::getNumFactorizations() const
+{
+  return num_factorizations_;
+}
+
+bool BandedQuinticSplineSolver::factorize(const double *t, int length)
+{
+  int num_segments = length - 1;
+  bool same_durations = factorization_valid_ && int(durations_.size()) == num_segments;
+  for (int i = 0; same_durations && i < num_segments; i++)
+    same_durations = (durations_[i] == t[i + 1] - t[i]);
+  if (same_durations)
+    return true;
+
+  factorization_valid_ = false;
+  durations_.resize(num_segments);
+  segment_costs_.resize(num_segments * 36);
+  int num_unknowns = 2 * (length - 2);
+  cholesky_.assign(num_unknowns * (BANDWIDTH + 1), 0.0);
+
+  for (int i = 0; i < num_segments; i++)
+  {
+    double h = t[i + 1] - t[i];
+    durations_[i] = h;
+    if (h <= 0.0)
+      return false;
+
+    // the spline coefficients [a b c d e] as a linear function of the boundary conditions
+    // s = [x0 v0 a0 x1 v1 a1]: d and e directly, a, b, c from the residuals r at the segment end
+    double r[3][6] = {{-1.0, -h, -0.5 * h * h, 1.0, 0.0, 0.0},
+                      {0.0, -1.0, -h, 0.0, 1.0, 0.0},
+                      {0.0, 0.0, -1.0, 0.0, 0.0, 1.0}};
+    double h2 = h * h, h3 = h2 * h, h4 = h3 * h, h5 = h4 * h;
+    double coeffs[5][6];
+    for (int l = 0; l < 6; l++)
+    {
+      coeffs[0][l] = (6.0 * r[0][l] - 3.0 * h * r[1][l] + 0.5 * h2 * r[2][l]) / h5;
+      coeffs[1][l] = (-15.0 * r[0][l] + 7.0 * h * r[1][l] - h2 * r[2][l]) / h4;
+      coeffs[2][l] = (10.0 * r[0][l] - 4.0 * h * r[1][l] + 0.5 * h2 * r[2][l]) / h3;
+      coeffs[3][l] = (l == 2) ? 0.5 : 0.0;
+      coeffs[4][l] = (l == 1) ? 1.0 : 0.0;
+    }
+
+    // segment cost over s = coeffs^T * cost * coeffs
+    double cost[5][5];
+    computeQuinticSegmentCost(h, velocity_weight_, acceleration_weight_, jerk_weight_, cost);
+    double cost_coeffs[5][6];
+    for (int m = 0; m < 5; m++)
+      for (int l = 0; l < 6; l++)
+      {
+        cost_coeffs[m][l] = 0.0;
+        for (int k = 0; k < 5; k++)
+          cost_coeffs[m][l] += cost[m][k] * coeffs[k][l];
+      }
+    double* segment_cost = &segment_costs_[i * 36];
+    for (int l1 = 0; l1 < 6; l1++)
+      for (int l2 = 0; l2 < 6; l2++)
+      {
+        segment_cost[l1 * 6 + l2] = 0.0;
+        for (int m = 0; m < 5; m++)
+          segment_cost[l1 * 6 + l2] += coeffs[m][l1] * cost_coeffs[m][l2];
+      }
+
+    // add the velocities and accelerations of the interior points to the band matrix
+    for (int l1 = 0; l1 < 6; l1++)
+    {
+      int point1 = i + l1 / 3;
+      if (l1 % 3 == 0 || point1 == 0 || point1 == length - 1)
+        continue;
+      int u1 = 2 * (point1 - 1) + (l1 % 3) - 1;
+      for (int l2 = 0; l2 < 6; l2++)
+      {
+        int point2 = i + l2 / 3;
+        if (l2 % 3 == 0 || point2 == 0 || point2 == length - 1)
+          continue;
+        int u2 = 2 * (point2 - 1) + (l2 % 3) - 1;
+        if (u2 > u1)
+          continue;
+        cholesky_[u1 * (BANDWIDTH + 1) + (u1 - u2)] += segment_cost[l1 * 6 + l2];
+      }
+    }
+  }
+
+  // in-place banded Cholesky factorization
+  for (int i = 0; i < num_unknowns; i++)
+  {
+    for (int j = std::max(0, i - BANDWIDTH); j <= i; j++)
+    {
+      double sum = cholesky_[i * (BANDWIDTH + 1) + (i - j)];
+      for (int m = std::max(0, i - BANDWIDTH); m < j; m++)
+        sum -= cholesky_[i * (BANDWIDTH + 1) + (i - m)] * cholesky_[j * (BANDWIDTH + 1) + (j - m)];
+      if (j == i)
+      {
+        if (sum <= 0.0)
+          return false;
+        cholesky_[i * (BANDWIDTH + 1)] = sqrt(sum);
+      }
+      else
+      {
+        cholesky_[i * (BANDWIDTH + 1) + (i - j)] = sum / cholesky_[j * (BANDWIDTH + 1)];
+      }
+    }
+  }
+
+  num_factorizations_++;
+  factorization_valid_ = true;
+  return true;
+}
+
+bool BandedQuinticSplineSolver::optimize(const double *x, double *xd, double *xdd, const double *t, int length)
+{
+  if (length < 3)
+    return true;
+  if (!factorize(t, length))
+    return false;
+
+  // linear cost term, from the fixed positions and end point velocities and accelerations
+  int num_unknowns = 2 * (length - 2);
+  rhs_.assign(num_unknowns, 0.0);
+  for (int i = 0; i < length - 1; i++)
+  {
+    const double* segment_cost = &segment_costs_[i * 36];
+    double s[6] = {x[i], xd[i], xdd[i], x[i + 1], xd[i + 1], xdd[i + 1]};
+    bool fixed[6];
+    for (int l = 0; l < 6; l++)
+    {
+      int point = i + l / 3;
+      fixed[l] = (l % 3 == 0 || point == 0 || point == length - 1);
+    }
+    for (int l1 = 0; l1 < 6; l1++)
+    {
+      if (fixed[l1])
+        continue;
+      int u1 = 2 * (i + l1 / 3 - 1) + (l1 % 3) - 1;
+      for (int l2 = 0; l2 < 6; l2++)
+      {
+        if (fixed[l2])
+          rhs_[u1] -= segment_cost[l1 * 6 + l2] * s[l2];
+      }
+    }
+  }
+
+  // forward and back substitution
+  for (int i = 0; i < num_unknowns; i++)
+  {
+    double sum = rhs_[i];
+    for (int m = std::max(0, i - BANDWIDTH); m < i; m++)
+      sum -= cholesky_[i * (BANDWIDTH + 1) + (i - m)] * rhs_[m];
+    rhs_[i] = sum / cholesky_[i * (BANDWIDTH + 1)];
+  }
+  for (int i = num_unknowns - 1; i >= 0; i--)
+  {
+    double sum = rhs_[i];
+    for (int m = i + 1; m <= std::min(num_unknowns - 1, i + BANDWIDTH); m++)
+      sum -= cholesky_[m * (BANDWIDTH + 1) + (m - i)] * rhs_[m];
+    rhs_[i] = sum / cholesky_[i * (BANDWIDTH + 1)];
+  }
+
+  for (int i = 1; i < length - 1; i++)
+  {
+    xd[i] = rhs_[2 * (i - 1)];
+    xdd[i] = rhs_[2 * (i - 1) + 1];
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ * quintic_spline_smoother_benchmark.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <ros/ros.h>
+#include <stdio.h>
+#include <math.h>
+#include <qp_spline_smoother/quintic_optimized_spline_smoother.h>
+#include <arm_navigation_msgs/FilterJointTrajectoryWithConstraints.h>
+
+typedef arm_navigation_msgs::FilterJointTrajectoryWithConstraints Trajectory;
+typedef qp_spline_smoother::QuinticOptimizedSplineSmoother<Trajectory> Smoother;
+
+static const int NUM_JOINTS = 7;
+static const int NUM_REPETITIONS = 3;
+static const double DT = 0.05;
+
+static bool configureSmoother(Smoother& smoother, bool use_banded_solver, int chunk_size)
+{
+  XmlRpc::XmlRpcValue config;
+  config["name"] = std::string("qp_optimized");
+  config["type"] = std::string("qp_spline_smoother/QuinticOptimizedSplineSmootherFilterJointTrajectoryWithConstraints");
+  config["params"]["velocity_cost"] = 0.0;
+  config["params"]["acceleration_cost"] = 1.0;
+  config["params"]["jerk_cost"] = 0.0;
+  config["params"]["chunk_size"] = chunk_size;
+  config["params"]["logging"] = false;
+  config["params"]["use_banded_solver"] = use_banded_solver;
+  return smoother.configure(config);
+}
+
+static void createTrajectory(int length, Trajectory& trajectory)
+{
+  trajectory.request.trajectory.joint_names.clear();
+  for (int j=0; j<NUM_JOINTS; ++j)
+  {
+    char name[32];
+    sprintf(name, "joint_%d", j);
+    trajectory.request.trajectory.joint_names.push_back(name);
+  }
+  trajectory.request.trajectory.points.resize(length);
+  for (int i=0; i<length; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint& point = trajectory.request.trajectory.points[i];
+    point.positions.resize(NUM_JOINTS);
+    point.velocities.resize(NUM_JOINTS, 0.0);
+    point.accelerations.resize(NUM_JOINTS, 0.0);
+    for (int j=0; j<NUM_JOINTS; ++j)
+      point.positions[j] = sin(2.0 * M_PI * (j+1) * i / (length - 1.0)) + 0.01 * cos(7.0 * i);
+    point.time_from_start = ros::Duration(i * DT);
+  }
+}
+
+static double smoothingTime(const Smoother& smoother, const Trajectory& trajectory_in, Trajectory& trajectory_out)
+{
+  ros::WallTime start = ros::WallTime::now();
+  for (int r=0; r<NUM_REPETITIONS; ++r)
+    smoother.smooth(trajectory_in, trajectory_out);
+  return (ros::WallTime::now() - start).toSec() / NUM_REPETITIONS;
+}
+
+static double maxDifference(const Trajectory& trajectory1, const Trajectory& trajectory2)
+{
+  double max_difference = 0.0;
+  for (unsigned int i=0; i<trajectory1.request.trajectory.points.size(); ++i)
+  {
+    for (int j=0; j<NUM_JOINTS; ++j)
+    {
+      max_difference = std::max(max_difference, fabs(trajectory1.request.trajectory.points[i].velocities[j] -
+                                                     trajectory2.request.trajectory.points[i].velocities[j]));
+    }
+  }
+  return max_difference;
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "quintic_spline_smoother_benchmark");
+  ros::Time::init();
+
+  // the dense quadratic program over the whole trajectory (chunk_size 0) is the slow path that the
+  // banded solver replaces; chunks of 10 points are the default setting of the filter
+  Smoother dense, dense_chunked, banded, banded_chunked;
+  if (!configureSmoother(dense, false, 0) || !configureSmoother(dense_chunked, false, 10) ||
+      !configureSmoother(banded, true, 0) || !configureSmoother(banded_chunked, true, 10))
+  {
+    ROS_ERROR("Could not configure the smoothers");
+    return -1;
+  }
+
+  printf("%d joints, acceleration cost, times per trajectory in ms\n", NUM_JOINTS);
+  printf("%8s %12s %12s %12s %12s %12s\n", "points", "dense", "banded", "max diff", "dense/10", "banded/10");
+  const int lengths[] = {25, 50, 100, 200, 500};
+  for (unsigned int l=0; l<sizeof(lengths)/sizeof(lengths[0]); ++l)
+  {
+    Trajectory trajectory_in, dense_out, banded_out, chunked_out;
+    createTrajectory(lengths[l], trajectory_in);
+    double dense_time = smoothingTime(dense, trajectory_in, dense_out);
+    double banded_time = smoothingTime(banded, trajectory_in, banded_out);
+    double dense_chunked_time = smoothingTime(dense_chunked, trajectory_in, chunked_out);
+    double banded_chunked_time = smoothingTime(banded_chunked, trajectory_in, chunked_out);
+    printf("%8d %12.3f %12.3f %12g %12.3f %12.3f\n", lengths[l], 1e3 * dense_time, 1e3 * banded_time,
+           maxDifference(dense_out, banded_out), 1e3 * dense_chunked_time, 1e3 * banded_chunked_time);
+  }
+  return 0;
+}
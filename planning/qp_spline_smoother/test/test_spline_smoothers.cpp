@@ -1,10 +1,128 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
 #include <qp_spline_smoother/quintic_optimized_spline_smoother.h>
+#include <qp_spline_smoother/banded_quintic_spline_solver.h>
 #include <arm_navigation_msgs/FilterJointTrajectoryWithConstraints.h>
 
+typedef arm_navigation_msgs::FilterJointTrajectoryWithConstraints Trajectory;
+typedef qp_spline_smoother::QuinticOptimizedSplineSmoother<Trajectory> Smoother;
+
+static const int NUM_JOINTS = 3;
+static const int NUM_POINTS = 40;
+static const double ACCELERATION_COST = 1.0;
+
+static bool configureSmoother(Smoother& smoother, bool use_banded_solver)
+{
+  XmlRpc::XmlRpcValue config;
+  config["name"] = std::string("qp_optimized");
+  config["type"] = std::string("qp_spline_smoother/QuinticOptimizedSplineSmootherFilterJointTrajectoryWithConstraints");
+  config["params"]["velocity_cost"] = 0.0;
+  config["params"]["acceleration_cost"] = ACCELERATION_COST;
+  config["params"]["jerk_cost"] = 0.0;
+  config["params"]["chunk_size"] = 0;
+  config["params"]["use_banded_solver"] = use_banded_solver;
+  return smoother.configure(config);
+}
+
+static void createTrajectory(Trajectory& trajectory)
+{
+  for (int j=0; j<NUM_JOINTS; ++j)
+  {
+    char name[32];
+    sprintf(name, "joint_%d", j);
+    trajectory.request.trajectory.joint_names.push_back(name);
+  }
+  trajectory.request.trajectory.points.resize(NUM_POINTS);
+  double time = 0.0;
+  for (int i=0; i<NUM_POINTS; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint& point = trajectory.request.trajectory.points[i];
+    point.positions.resize(NUM_JOINTS);
+    point.velocities.resize(NUM_JOINTS, 0.0);
+    point.accelerations.resize(NUM_JOINTS, 0.0);
+    for (int j=0; j<NUM_JOINTS; ++j)
+      point.positions[j] = sin(2.0 * M_PI * (j+1) * i / (NUM_POINTS - 1.0)) + 0.01 * cos(7.0 * i);
+    // non uniform time steps
+    point.time_from_start = ros::Duration(time);
+    time += 0.05 + 0.02 * (i % 3);
+  }
+}
+
+static void expectEndpointConstraints(const Trajectory& trajectory_in, const Trajectory& trajectory_out)
+{
+  ASSERT_EQ(trajectory_in.request.trajectory.points.size(), trajectory_out.request.trajectory.points.size());
+  for (int i=0; i<NUM_POINTS; ++i)
+  {
+    const trajectory_msgs::JointTrajectoryPoint& point_in = trajectory_in.request.trajectory.points[i];
+    const trajectory_msgs::JointTrajectoryPoint& point_out = trajectory_out.request.trajectory.points[i];
+    EXPECT_EQ(point_in.time_from_start, point_out.time_from_start);
+    for (int j=0; j<NUM_JOINTS; ++j)
+      EXPECT_EQ(point_in.positions[j], point_out.positions[j]);
+  }
+  const int last = NUM_POINTS - 1;
+  for (int j=0; j<NUM_JOINTS; ++j)
+  {
+    EXPECT_EQ(0.0, trajectory_out.request.trajectory.points[0].velocities[j]);
+    EXPECT_EQ(0.0, trajectory_out.request.trajectory.points[0].accelerations[j]);
+    EXPECT_EQ(0.0, trajectory_out.request.trajectory.points[last].velocities[j]);
+    EXPECT_EQ(0.0, trajectory_out.request.trajectory.points[last].accelerations[j]);
+  }
+}
+
+TEST(QuinticOptimizedSplineSmoother, bandedSolverMatchesDenseQuadraticProgram)
+{
+  Smoother dense, banded;
+  ASSERT_TRUE(configureSmoother(dense, false));
+  ASSERT_TRUE(configureSmoother(banded, true));
+
+  Trajectory trajectory_in, dense_out, banded_out;
+  createTrajectory(trajectory_in);
+  ASSERT_TRUE(dense.smooth(trajectory_in, dense_out));
+  ASSERT_TRUE(banded.smooth(trajectory_in, banded_out));
+  expectEndpointConstraints(trajectory_in, dense_out);
+  expectEndpointConstraints(trajectory_in, banded_out);
+
+  // the filter scales the cost weights by 1000
+  qp_spline_smoother::BandedQuinticSplineSolver solver(0.0, 1000.0 * ACCELERATION_COST, 0.0);
+  std::vector<double> x(NUM_POINTS), xd(NUM_POINTS), xdd(NUM_POINTS), t(NUM_POINTS);
+  for (int j=0; j<NUM_JOINTS; ++j)
+  {
+    for (int i=0; i<NUM_POINTS; ++i)
+    {
+      const trajectory_msgs::JointTrajectoryPoint& point = trajectory_in.request.trajectory.points[i];
+      x[i] = point.positions[j];
+      t[i] = point.time_from_start.toSec();
+      xd[i] = 0.0;
+      xdd[i] = 0.0;
+    }
+    // non zero boundary conditions are kept as they are
+    xd[0] = 0.3;
+    xdd[NUM_POINTS-1] = -0.2;
+    ASSERT_TRUE(solver.optimize(&x[0], &xd[0], &xdd[0], &t[0], NUM_POINTS));
+    EXPECT_EQ(0.3, xd[0]);
+    EXPECT_EQ(0.0, xdd[0]);
+    EXPECT_EQ(0.0, xd[NUM_POINTS-1]);
+    EXPECT_EQ(-0.2, xdd[NUM_POINTS-1]);
+    for (int i=0; i<NUM_POINTS; ++i)
+      EXPECT_EQ(trajectory_in.request.trajectory.points[i].positions[j], x[i]);
+
+    for (int i=1; i<NUM_POINTS-1; ++i)
+    {
+      const trajectory_msgs::JointTrajectoryPoint& dense_point = dense_out.request.trajectory.points[i];
+      const trajectory_msgs::JointTrajectoryPoint& banded_point = banded_out.request.trajectory.points[i];
+      EXPECT_NEAR(dense_point.velocities[j], banded_point.velocities[j], 1e-6 * (1.0 + fabs(dense_point.velocities[j])));
+      EXPECT_NEAR(dense_point.accelerations[j], banded_point.accelerations[j],
+                  1e-6 * (1.0 + fabs(dense_point.accelerations[j])));
+    }
+  }
+  // all joints share the timing, the factorization is reused
+  EXPECT_EQ(1, solver.getNumFactorizations());
+}
+
 int main(int argc, char** argv)
 {
-  //qp_spline_smoother::QuinticOptimizedSplineSmoother<arm_navigation_msgs::FilterJointTrajectory::Request>
-  qp_spline_smoother::QuinticOptimizedSplineSmoother<arm_navigation_msgs::FilterJointTrajectoryWithConstraints> foo;
-  //foo.configure();
-  return 0;
+  ros::Time::init();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
 }
@@ -0,0 +1,264 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2009, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef STOMP_BAND_MATRIX_H_
+#define STOMP_BAND_MATRIX_H_
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+
+namespace stomp
+{
+
+/**
+ * \brief Symmetric positive definite band matrix, with its Cholesky factorization
+ *
+ * Only the diagonal and the first "bandwidth" sub-diagonals are stored, so an n x n matrix takes
+ * O(n*b) memory, and the factorization, solves and products take O(n*b^2), O(n*b) and O(n*b) time.
+ */
+class BandMatrix
+{
+public:
+  BandMatrix();
+  BandMatrix(int size, int bandwidth);
+
+  /**
+   * Resizes the matrix and sets it to zero
+   */
+  void resize(int size, int bandwidth);
+
+  int size() const;
+  int bandwidth() const;
+
+  /**
+   * Element (i,j) of the lower triangle, 0 <= i-j <= bandwidth
+   */
+  double& coeffRef(int i, int j);
+
+  /**
+   * Element (i,j) of the symmetric matrix, zero outside of the band
+   */
+  double operator()(int i, int j) const;
+
+  /**
+   * Cholesky factorization LL^T of the matrix, needed by the solve functions below
+   * @return false if the matrix is not positive definite
+   */
+  bool factorize();
+
+  /**
+   * y = A*x
+   */
+  template <typename Derived1, typename Derived2>
+  void multiply(const Eigen::MatrixBase<Derived1>& x, Eigen::MatrixBase<Derived2>& y) const;
+
+  /**
+   * x = A^-1 * x, using the factorization
+   */
+  template <typename Derived>
+  void solve(Eigen::MatrixBase<Derived>& x) const;
+
+  /**
+   * x = L^-T * x, using the factorization. If x is standard normal, the result is normal with covariance A^-1.
+   */
+  template <typename Derived>
+  void solveCholeskyTranspose(Eigen::MatrixBase<Derived>& x) const;
+
+  /**
+   * Dense copy of the matrix
+   */
+  void toDense(Eigen::MatrixXd& dense) const;
+
+  /**
+   * Dense inverse of the matrix, one solve per column (O(n^2*b)), using the factorization
+   */
+  void inverse(Eigen::MatrixXd& inverse) const;
+
+private:
+  int size_;
+  int bandwidth_;
+  Eigen::MatrixXd band_;      /**< (bandwidth+1) x size: band_(k, j) = A(j+k, j) */
+  Eigen::MatrixXd cholesky_;  /**< same layout as band_, for the Cholesky factor L */
+
+  template <typename Derived>
+  void solveCholesky(Eigen::MatrixBase<Derived>& x) const;
+};
+
+// inline functions follow
+
+inline BandMatrix::BandMatrix():
+  size_(0),
+  bandwidth_(0)
+{
+}
+
+inline BandMatrix::BandMatrix(int size, int bandwidth)
+{
+  resize(size, bandwidth);
+}
+
+inline void BandMatrix::resize(int size, int bandwidth)
+{
+  size_ = size;
+  bandwidth_ = bandwidth;
+  band_ = Eigen::MatrixXd::Zero(bandwidth_+1, size_);
+  cholesky_ = Eigen::MatrixXd::Zero(bandwidth_+1, size_);
+}
+
+inline int BandMatrix::size() const
+{
+  return size_;
+}
+
+inline int BandMatrix::bandwidth() const
+{
+  return bandwidth_;
+}
+
+inline double& BandMatrix::coeffRef(int i, int j)
+{
+  return band_(i-j, j);
+}
+
+inline double BandMatrix::operator()(int i, int j) const
+{
+  if (i < j)
+    std::swap(i, j);
+  if (i-j > bandwidth_)
+    return 0.0;
+  return band_(i-j, j);
+}
+
+inline bool BandMatrix::factorize()
+{
+  for (int j=0; j<size_; ++j)
+  {
+    double diagonal = band_(0, j);
+    for (int k=std::max(0, j-bandwidth_); k<j; ++k)
+      diagonal -= cholesky_(j-k, k) * cholesky_(j-k, k);
+    if (diagonal <= 0.0)
+      return false;
+    double l_jj = sqrt(diagonal);
+    cholesky_(0, j) = l_jj;
+
+    int end = std::min(size_-1, j+bandwidth_);
+    for (int i=j+1; i<=end; ++i)
+    {
+      double sum = band_(i-j, j);
+      for (int k=std::max(0, i-bandwidth_); k<j; ++k)
+        sum -= cholesky_(i-k, k) * cholesky_(j-k, k);
+      cholesky_(i-j, j) = sum / l_jj;
+    }
+  }
+  return true;
+}
+
+template <typename Derived1, typename Derived2>
+void BandMatrix::multiply(const Eigen::MatrixBase<Derived1>& x, Eigen::MatrixBase<Derived2>& y) const
+{
+  y.setZero();
+  for (int j=0; j<size_; ++j)
+  {
+    y(j) += band_(0, j) * x(j);
+    int end = std::min(bandwidth_, size_-1-j);
+    for (int k=1; k<=end; ++k)
+    {
+      y(j+k) += band_(k, j) * x(j);
+      y(j) += band_(k, j) * x(j+k);
+    }
+  }
+}
+
+template <typename Derived>
+void BandMatrix::solveCholesky(Eigen::MatrixBase<Derived>& x) const
+{
+  // forward substitution with L
+  for (int i=0; i<size_; ++i)
+  {
+    double sum = x(i);
+    for (int k=std::max(0, i-bandwidth_); k<i; ++k)
+      sum -= cholesky_(i-k, k) * x(k);
+    x(i) = sum / cholesky_(0, i);
+  }
+}
+
+template <typename Derived>
+void BandMatrix::solveCholeskyTranspose(Eigen::MatrixBase<Derived>& x) const
+{
+  // back substitution with L^T
+  for (int i=size_-1; i>=0; --i)
+  {
+    double sum = x(i);
+    int end = std::min(size_-1, i+bandwidth_);
+    for (int k=i+1; k<=end; ++k)
+      sum -= cholesky_(k-i, i) * x(k);
+    x(i) = sum / cholesky_(0, i);
+  }
+}
+
+template <typename Derived>
+void BandMatrix::solve(Eigen::MatrixBase<Derived>& x) const
+{
+  solveCholesky(x);
+  solveCholeskyTranspose(x);
+}
+
+inline void BandMatrix::toDense(Eigen::MatrixXd& dense) const
+{
+  dense = Eigen::MatrixXd::Zero(size_, size_);
+  for (int j=0; j<size_; ++j)
+  {
+    int end = std::min(bandwidth_, size_-1-j);
+    for (int k=0; k<=end; ++k)
+    {
+      dense(j+k, j) = band_(k, j);
+      dense(j, j+k) = band_(k, j);
+    }
+  }
+}
+
+inline void BandMatrix::inverse(Eigen::MatrixXd& inverse) const
+{
+  inverse = Eigen::MatrixXd::Identity(size_, size_);
+  for (int j=0; j<size_; ++j)
+  {
+    Eigen::MatrixXd::ColXpr column = inverse.col(j);
+    solve(column);
+  }
+}
+
+}
+
+#endif /* STOMP_BAND_MATRIX_H_ */
@@ -40,6 +40,7 @@
 #include <ros/ros.h>
 #include <Eigen/Core>
 #include <stomp/stomp_utils.h>
+#include <stomp/band_matrix.h>
 
 namespace stomp
 {
@@ -118,7 +119,21 @@ public:
      */
     bool getControlCosts(std::vector<Eigen::MatrixXd>& control_costs);
 
+    /**
+     * Gets the dense inverse of the control cost matrix. It is computed from the banded Cholesky
+     * factorization on the first call, in O(num_params^2) memory.
+     */
     bool getInvControlCosts(std::vector<Eigen::MatrixXd>& control_costs);
+
+    /**
+     * Gets the control cost matrices in banded form, already factorized, so that
+     * products with the matrix and its inverse take O(num_params) time and memory
+     *
+     * @param control_costs (output) [num_dimensions] num_params x num_params band matrices
+     * @return true on success, false on failure
+     */
+    bool getBandedControlCosts(std::vector<BandMatrix>& control_costs);
+
     /**
      * Update the policy parameters based on the updates per timestep
      * @param updates (input) parameter updates per time-step, num_time_steps x num_parameters
@@ -194,17 +209,20 @@ private:
     std::vector<Eigen::MatrixXd> derivative_costs_;
     std::vector<Eigen::MatrixXd> derivative_costs_sqrt_;
     std::vector<Eigen::MatrixXd> basis_functions_;
-    std::vector<Eigen::MatrixXd> control_costs_;
-    std::vector<Eigen::MatrixXd> inv_control_costs_;
-    std::vector<Eigen::MatrixXd> control_costs_all_;
+    std::vector<BandMatrix> control_costs_;             /**< [num_dimensions] quadratic costs of the free variables, factorized */
+    std::vector<BandMatrix> control_costs_all_;         /**< [num_dimensions] quadratic costs of all variables */
+    std::vector<Eigen::MatrixXd> inv_control_costs_;    /**< [num_dimensions] dense, only computed on request */
 
     std::vector<Eigen::VectorXd> linear_control_costs_;
     std::vector<double> constant_control_costs_; // to make the control cost not appear negative!
 
     std::vector<Eigen::VectorXd> parameters_all_;
 
-    std::vector<Eigen::MatrixXd> differentiation_matrices_;
-    void createDifferentiationMatrices();
+    /**
+     * Applies a finite differencing rule to the trajectory of all variables; the rule is truncated at both ends
+     * @param derivative_number (0 = pos, 1 = vel, 2 = acc, 3 = jerk)
+     */
+    void differentiateAll(const Eigen::VectorXd& parameters_all, int derivative_number, Eigen::VectorXd& derivative) const;
     bool initializeVariables();
     bool initializeCosts();
     bool initializeBasisFunctions();
@@ -259,16 +277,34 @@ inline bool CovariantMovementPrimitive::getBasisFunctions(std::vector<Eigen::Mat
 
 inline bool CovariantMovementPrimitive::getControlCosts(std::vector<Eigen::MatrixXd>& control_costs)
 {
-    control_costs = control_costs_;
+    control_costs.resize(num_dimensions_);
+    for (int d=0; d<num_dimensions_; ++d)
+    {
+        control_costs_[d].toDense(control_costs[d]);
+    }
     return true;
 }
 
 inline bool CovariantMovementPrimitive::getInvControlCosts(std::vector<Eigen::MatrixXd>& inv_control_costs)
 {
+  if (int(inv_control_costs_.size()) != num_dimensions_)
+  {
+    inv_control_costs_.resize(num_dimensions_);
+    for (int d=0; d<num_dimensions_; ++d)
+    {
+      control_costs_[d].inverse(inv_control_costs_[d]);
+    }
+  }
   inv_control_costs = inv_control_costs_;
   return true;
 }
 
+inline bool CovariantMovementPrimitive::getBandedControlCosts(std::vector<BandMatrix>& control_costs)
+{
+  control_costs = control_costs_;
+  return true;
+}
+
 inline bool CovariantMovementPrimitive::getNumTimeSteps(int& num_time_steps)
 {
     num_time_steps = num_time_steps_;
@@ -44,6 +44,7 @@
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/shared_ptr.hpp>
 #include <cstdlib>
+#include <stomp/band_matrix.h>
 
 namespace stomp
 {
@@ -57,6 +58,12 @@ public:
   template <typename Derived1, typename Derived2>
   MultivariateGaussian(const Eigen::MatrixBase<Derived1>& mean, const Eigen::MatrixBase<Derived2>& covariance);
 
+  /**
+   * Gaussian given by its banded inverse covariance (precision) matrix, which must already be factorized.
+   * Sampling then takes O(size*bandwidth) time, and the dense covariance is never formed.
+   */
+  MultivariateGaussian(const Eigen::VectorXd& mean, const BandMatrix& precision);
+
   template <typename Derived>
   void sample(Eigen::MatrixBase<Derived>& output);
 
@@ -64,6 +71,8 @@ private:
   Eigen::VectorXd mean_;                /**< Mean of the gaussian distribution */
   Eigen::MatrixXd covariance_;          /**< Covariance of the gaussian distribution */
   Eigen::MatrixXd covariance_cholesky_; /**< Cholesky decomposition (LL^T) of the covariance */
+  BandMatrix precision_;                /**< Factorized inverse covariance, used instead of the above if banded_ */
+  bool banded_;
 
   int size_;
   boost::mt19937 rng_;
@@ -78,6 +87,7 @@ MultivariateGaussian::MultivariateGaussian(const Eigen::MatrixBase<Derived1>& me
   mean_(mean),
   covariance_(covariance),
   covariance_cholesky_(covariance_.llt().matrixL()),
+  banded_(false),
   normal_dist_(0.0,1.0)
 {
 
@@ -91,12 +101,32 @@ MultivariateGaussian::MultivariateGaussian(const Eigen::MatrixBase<Derived1>& me
   gaussian_.reset(new boost::variate_generator<boost::mt19937, boost::normal_distribution<> >(rng_, normal_dist_));
 }
 
+inline MultivariateGaussian::MultivariateGaussian(const Eigen::VectorXd& mean, const BandMatrix& precision):
+  mean_(mean),
+  precision_(precision),
+  banded_(true),
+  normal_dist_(0.0,1.0)
+{
+  rng_.seed(rand());
+  size_ = mean.rows();
+  gaussian_.reset(new boost::variate_generator<boost::mt19937, boost::normal_distribution<> >(rng_, normal_dist_));
+}
+
 template <typename Derived>
 void MultivariateGaussian::sample(Eigen::MatrixBase<Derived>& output)
 {
   for (int i=0; i<size_; ++i)
     output(i) = (*gaussian_)();
-  output = mean_ + covariance_cholesky_*output;
+  if (banded_)
+  {
+    // precision = LL^T, so L^-T * output has covariance L^-T L^-1 = precision^-1
+    precision_.solveCholeskyTranspose(output);
+    output += mean_;
+  }
+  else
+  {
+    output = mean_ + covariance_cholesky_*output;
+  }
 }
 
 }
@@ -196,6 +196,7 @@ private:
 
     std::vector<Eigen::MatrixXd> control_costs_;                            /**< [num_dimensions] num_parameters x num_parameters */
     std::vector<Eigen::MatrixXd> inv_control_costs_;                        /**< [num_dimensions] num_parameters x num_parameters */
+    std::vector<BandMatrix> banded_control_costs_;                          /**< [num_dimensions] factorized, for sampling the noise */
     std::vector<Eigen::MatrixXd> projection_matrix_;                        /**< [num_dimensions] num_parameters x num_parameters */
     std::vector<Eigen::MatrixXd> inv_projection_matrix_;                    /**< [num_dimensions] num_parameters x num_parameters */
     double control_cost_weight_;
@@ -217,7 +218,8 @@ private:
 
     // covariance matrix adaptation variables
     std::vector<double> adapted_stddevs_;
-    std::vector<Eigen::MatrixXd> adapted_covariances_;
+    std::vector<Eigen::MatrixXd> adapted_covariances_;                      /**< [num_dimensions] num_parameters x num_parameters, lower triangle only */
+    std::vector<double> inv_control_cost_norms_;                            /**< [num_dimensions] squared frobenius norm of inv_control_costs_ */
     //std::vector<Eigen::MatrixXd> adapted_covariance_inverse_;
     bool adapted_covariance_valid_;
     bool use_covariance_matrix_adaptation_;
@@ -67,6 +67,7 @@ public:
     bool doRollouts(int iteration_number);
     bool doUpdate(int iteration_number);
     bool doNoiselessRollout(int iteration_number);
+    bool doGradientStep(int iteration_number);
 
     void getAllRollouts(std::vector<Rollout>& rollouts);
     void getNoiselessRollout(Rollout& rollout);
@@ -92,6 +93,11 @@ private:
     bool use_noise_adaptation_;
     bool use_openmp_;
 
+    // hybrid mode: a CHOMP style covariant gradient step from the previous noiseless rollout after every sampling update
+    bool use_gradient_step_;
+    double gradient_learning_rate_;
+    double gradient_max_update_;
+
     boost::shared_ptr<Task> task_;
     boost::shared_ptr<CovariantMovementPrimitive> policy_;
 
@@ -107,6 +113,9 @@ private:
     std::vector<Eigen::MatrixXd> parameter_updates_;
     std::vector<Eigen::VectorXd> parameters_;
     std::vector<Eigen::VectorXd> time_step_weights_;
+    std::vector<BandMatrix> banded_control_costs_;
+    std::vector<Eigen::VectorXd> gradients_;
+    std::vector<Eigen::VectorXd> control_cost_gradients_;
     Eigen::MatrixXd rollout_costs_;
     std::vector<double> noise_stddev_;
     std::vector<double> noise_decay_;
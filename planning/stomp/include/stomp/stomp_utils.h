@@ -86,6 +86,30 @@ static inline void differentiate(const Eigen::VectorXd& input,
   }
 }
 
+/**
+ * Transpose of differentiate() applied at a single index: returns sum_i weights(i) * derivative(i) * d output(i) / d input(index),
+ * i.e. half the gradient of sum_i weights(i) * derivative(i)^2 w.r.t. input(index) when derivative is the output of
+ * differentiate(). The clamping of indices at the trajectory ends is ignored.
+ */
+template <typename WeightsType>
+static inline double differentiateTranspose(const Eigen::VectorXd& derivative,
+                                            const WeightsType& weights,
+                                            CostComponents order, int index,
+                                            double dt)
+{
+  double multiplier = 1.0/pow(dt,(int)order);
+  int T = derivative.rows();
+  double ret = 0.0;
+  for (int j=-DIFF_RULE_LENGTH/2; j<=DIFF_RULE_LENGTH/2; ++j)
+  {
+    int i = index-j;
+    if (i < 0 || i >= T)
+      continue;
+    ret += multiplier * DIFF_RULES[order][j+DIFF_RULE_LENGTH/2] * weights(i) * derivative(i);
+  }
+  return ret;
+}
+
 } //namespace stomp
 
 #endif /* STOMP_UTILS_H_ */
@@ -98,12 +98,16 @@ bool CovariantMovementPrimitive::computeLinearControlCosts()
   constant_control_costs_.clear();
   constant_control_costs_.resize(num_dimensions_, 0.0);
 
+  VectorXd fixed_params(num_vars_all_);
+  VectorXd fixed_costs(num_vars_all_);
   for (int d=0; d<num_dimensions_; ++d)
   {
-    linear_control_costs_[d].transpose() = parameters_all_[d].segment(0, DIFF_RULE_LENGTH-1).transpose() *
-        control_costs_all_[d].block(0, free_vars_start_index_, DIFF_RULE_LENGTH-1, num_vars_free_);
-    linear_control_costs_[d].transpose() += parameters_all_[d].segment(free_vars_end_index_+1, DIFF_RULE_LENGTH-1).transpose() *
-        control_costs_all_[d].block(free_vars_end_index_+1, free_vars_start_index_, DIFF_RULE_LENGTH-1, num_vars_free_);
+    // the start and goal variables only, multiplied by the cost matrix
+    fixed_params = parameters_all_[d];
+    fixed_params.segment(free_vars_start_index_, num_vars_free_).setZero();
+    control_costs_all_[d].multiply(fixed_params, fixed_costs);
+
+    linear_control_costs_[d] = fixed_costs.segment(free_vars_start_index_, num_vars_free_);
     linear_control_costs_[d] *= 2.0; // because the cost matrix is symmetric
 
     // the next term is from the (x - x_desired)^2 part:
@@ -112,16 +116,7 @@ bool CovariantMovementPrimitive::computeLinearControlCosts()
 
 
     // get the constant parts
-    Eigen::VectorXd const_params = Eigen::VectorXd::Zero(2*TRAJECTORY_PADDING);
-    Eigen::MatrixXd const_matrix = Eigen::MatrixXd::Zero(2*TRAJECTORY_PADDING, 2*TRAJECTORY_PADDING);
-    const_params.head(TRAJECTORY_PADDING) = parameters_all_[d].segment(0, TRAJECTORY_PADDING);
-    const_params.tail(TRAJECTORY_PADDING) = parameters_all_[d].segment(free_vars_end_index_+1, TRAJECTORY_PADDING);
-    const_matrix.topLeftCorner(TRAJECTORY_PADDING, TRAJECTORY_PADDING) = control_costs_all_[d].topLeftCorner(TRAJECTORY_PADDING, TRAJECTORY_PADDING);
-    const_matrix.bottomRightCorner(TRAJECTORY_PADDING, TRAJECTORY_PADDING) = control_costs_all_[d].bottomRightCorner(TRAJECTORY_PADDING, TRAJECTORY_PADDING);
-    const_matrix.topRightCorner(TRAJECTORY_PADDING, TRAJECTORY_PADDING) = control_costs_all_[d].topRightCorner(TRAJECTORY_PADDING, TRAJECTORY_PADDING);
-    const_matrix.bottomLeftCorner(TRAJECTORY_PADDING, TRAJECTORY_PADDING) = control_costs_all_[d].bottomLeftCorner(TRAJECTORY_PADDING, TRAJECTORY_PADDING);
-
-    constant_control_costs_[d] = movement_dt_ * const_params.transpose() * const_matrix * const_params;
+    constant_control_costs_[d] = movement_dt_ * fixed_params.dot(fixed_costs);
 
   }
 
@@ -133,8 +128,9 @@ bool CovariantMovementPrimitive::computeMinControlCostParameters()
 {
   for (int d=0; d<num_dimensions_; ++d)
   {
-    parameters_all_[d].segment(free_vars_start_index_, num_vars_free_) =
-        -0.5 * inv_control_costs_[d] * linear_control_costs_[d];
+    VectorXd parameters = -0.5 * linear_control_costs_[d];
+    control_costs_[d].solve(parameters);
+    parameters_all_[d].segment(free_vars_start_index_, num_vars_free_) = parameters;
   }
   return true;
 }
@@ -167,8 +163,6 @@ bool CovariantMovementPrimitive::initializeVariables()
 
 bool CovariantMovementPrimitive::initializeCosts()
 {
-  createDifferentiationMatrices();
-
   control_costs_all_.clear();
   control_costs_.clear();
   inv_control_costs_.clear();
@@ -178,22 +172,49 @@ bool CovariantMovementPrimitive::initializeCosts()
     // get sqrt of derivative costs
     derivative_costs_sqrt_.push_back(derivative_costs_[d].array().sqrt().matrix());
 
-    // construct the quadratic cost matrices (for all variables)
-    MatrixXd cost_all = MatrixXd::Zero(num_vars_all_, num_vars_all_);
-    //MatrixXd cost_all = MatrixXd::Identity(num_vars_all_, num_vars_all_) * cost_ridge_factor_;
+    // construct the quadratic cost matrices (for all variables): sum over the differentiation
+    // rules D of dt * D^T * diag(derivative costs) * D, which is banded since the rules are
+    BandMatrix cost_all(num_vars_all_, DIFF_RULE_LENGTH-1);
     for (int i=0; i<NUM_DIFF_RULES; ++i)
     {
-      cost_all += movement_dt_ * (differentiation_matrices_[i].transpose() *
-          derivative_costs_[d].col(i).asDiagonal() *
-          differentiation_matrices_[i]);
+      double multiplier = 1.0/pow(movement_dt_, i);
+      for (int r=0; r<num_vars_all_; ++r)
+      {
+        double weight = movement_dt_ * derivative_costs_[d](r, i) * multiplier * multiplier;
+        if (weight == 0.0)
+          continue;
+        for (int ja=-DIFF_RULE_LENGTH/2; ja<=DIFF_RULE_LENGTH/2; ++ja)
+        {
+          int a = r+ja;
+          if (a < 0 || a >= num_vars_all_ || DIFF_RULES[i][ja+DIFF_RULE_LENGTH/2] == 0.0)
+            continue;
+          for (int jb=-DIFF_RULE_LENGTH/2; jb<=ja; ++jb)
+          {
+            int b = r+jb;
+            if (b < 0)
+              continue;
+            cost_all.coeffRef(a, b) += weight * DIFF_RULES[i][ja+DIFF_RULE_LENGTH/2] * DIFF_RULES[i][jb+DIFF_RULE_LENGTH/2];
+          }
+        }
+      }
     }
     control_costs_all_.push_back(cost_all);
 
     // extract the quadratic cost just for the free variables:
-    MatrixXd cost_free = cost_all.block(DIFF_RULE_LENGTH-1, DIFF_RULE_LENGTH-1, num_vars_free_, num_vars_free_);
+    BandMatrix cost_free(num_vars_free_, DIFF_RULE_LENGTH-1);
+    for (int j=0; j<num_vars_free_; ++j)
+    {
+      for (int i=j; i<std::min(num_vars_free_, j+DIFF_RULE_LENGTH); ++i)
+      {
+        cost_free.coeffRef(i, j) = cost_all(free_vars_start_index_+i, free_vars_start_index_+j);
+      }
+    }
+    if (!cost_free.factorize())
+    {
+      ROS_ERROR("Control cost matrix for dimension %d is not positive definite.", d);
+      return false;
+    }
     control_costs_.push_back(cost_free);
-
-    inv_control_costs_.push_back(cost_free.fullPivLu().inverse());
   }
 
   computeLinearControlCosts();
@@ -211,36 +232,33 @@ bool CovariantMovementPrimitive::initializeBasisFunctions()
   return true;
 }
 
-void CovariantMovementPrimitive::createDifferentiationMatrices()
+void CovariantMovementPrimitive::differentiateAll(const Eigen::VectorXd& parameters_all, int derivative_number,
+                                                  Eigen::VectorXd& derivative) const
 {
-  double multiplier = 1.0;
-  differentiation_matrices_.clear();
-  differentiation_matrices_.resize(NUM_DIFF_RULES, MatrixXd::Zero(num_vars_all_, num_vars_all_));
-  for (int d=0; d<NUM_DIFF_RULES; ++d)
+  double multiplier = 1.0/pow(movement_dt_, derivative_number);
+  derivative = VectorXd::Zero(num_vars_all_);
+  for (int i=0; i<num_vars_all_; i++)
   {
-    for (int i=0; i<num_vars_all_; i++)
+    for (int j=-DIFF_RULE_LENGTH/2; j<=DIFF_RULE_LENGTH/2; j++)
     {
-      for (int j=-DIFF_RULE_LENGTH/2; j<=DIFF_RULE_LENGTH/2; j++)
-      {
-        int index = i+j;
-        if (index < 0)
-          continue;
-        if (index >= num_vars_all_)
-          continue;
-        differentiation_matrices_[d](i,index) = multiplier * DIFF_RULES[d][j+DIFF_RULE_LENGTH/2];
-      }
+      int index = i+j;
+      if (index < 0)
+        continue;
+      if (index >= num_vars_all_)
+        continue;
+      derivative(i) += multiplier * DIFF_RULES[derivative_number][j+DIFF_RULE_LENGTH/2] * parameters_all(index);
     }
-    multiplier /= movement_dt_;
-    //ROS_INFO_STREAM(differentiation_matrices_[d]);
   }
 }
 
 bool CovariantMovementPrimitive::getDerivatives(int derivative_number, std::vector<Eigen::VectorXd>& derivatives)
 {
   derivatives.resize(num_dimensions_);
+  VectorXd derivative_all;
   for (int dim=0; dim<num_dimensions_; ++dim)
   {
-    derivatives[dim] = (differentiation_matrices_[derivative_number] * parameters_all_[dim]).segment(free_vars_start_index_, num_vars_free_);
+    differentiateAll(parameters_all_[dim], derivative_number, derivative_all);
+    derivatives[dim] = derivative_all.segment(free_vars_start_index_, num_vars_free_);
   }
   return true;
 }
@@ -253,7 +271,9 @@ bool CovariantMovementPrimitive::computeControlCostGradient(const std::vector<Ei
 
   for (int d=0; d<num_dimensions_; ++d)
   {
-    gradient[d] = weight * (2.0 * control_costs_[d] * parameters[d] + linear_control_costs_[d]);
+    gradient[d].resize(num_vars_free_);
+    control_costs_[d].multiply(parameters[d], gradient[d]);
+    gradient[d] = weight * (2.0 * gradient[d] + linear_control_costs_[d]);
   }
 
   return true;
@@ -266,6 +286,7 @@ bool CovariantMovementPrimitive::computeControlCosts(const std::vector<Eigen::Ve
 {
   //printf("Weight = %f\n", weight);
   // this uses the already squared control cost matrix
+  VectorXd derivative_all;
   for (int d=0; d<num_dimensions_; ++d)
   {
     VectorXd params_all = parameters_all_[d];
@@ -297,8 +318,8 @@ bool CovariantMovementPrimitive::computeControlCosts(const std::vector<Eigen::Ve
     // compute them from the original diff matrices, per timestep
     for (int i=0; i<NUM_DIFF_RULES; ++i)
     {
-      Eigen::ArrayXXd Ax = (differentiation_matrices_[i] * params_all).array() *
-          derivative_costs_sqrt_[d].col(i).array();
+      differentiateAll(params_all, i, derivative_all);
+      Eigen::ArrayXXd Ax = derivative_all.array() * derivative_costs_sqrt_[d].col(i).array();
       costs_all += movement_dt_ * weight * (Ax * Ax).matrix();
     }
     control_costs[d] = costs_all.segment(free_vars_start_index_, num_vars_free_);
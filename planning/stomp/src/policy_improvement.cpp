@@ -85,16 +85,17 @@ bool PolicyImprovement::initialize(const int num_time_steps,
   ROS_VERIFY(policy_->getBasisFunctions(basis_functions_));
   ROS_VERIFY(policy_->getParameters(parameters_));
   ROS_VERIFY(policy_->getInvControlCosts(inv_control_costs_));
+  ROS_VERIFY(policy_->getBandedControlCosts(banded_control_costs_));
 
-  // invert the control costs, initialize noise generators:
+  // initialize noise generators from the banded (factorized) control costs:
   noise_generators_.clear();
   adapted_stddevs_.resize(num_dimensions_, 1.0);
   adapted_covariances_.clear();
   for (int d=0; d<num_dimensions_; ++d)
   {
-    MultivariateGaussian mvg(VectorXd::Zero(num_parameters_[d]), inv_control_costs_[d]);
+    MultivariateGaussian mvg(VectorXd::Zero(num_parameters_[d]), banded_control_costs_[d]);
     noise_generators_.push_back(mvg);
-    adapted_covariances_.push_back(inv_control_costs_[d]);
+    adapted_covariances_.push_back(MatrixXd::Zero(num_parameters_[d], num_parameters_[d]));
   }
 
   ROS_VERIFY(setNumRollouts(min_rollouts, max_rollouts, num_rollouts_per_iteration));
@@ -474,6 +475,8 @@ bool PolicyImprovement::computeRolloutCumulativeCosts(std::vector<double>& rollo
 
 bool PolicyImprovement::computeRolloutProbabilities()
 {
+    // the dimensions are independent, each one only writes its own entries of the rollouts
+#pragma omp parallel for
     for (int d=0; d<num_dimensions_; ++d)
     {
       // find min and max cost over all rollouts:
@@ -560,9 +563,11 @@ bool PolicyImprovement::computeRolloutProbabilities()
 
 bool PolicyImprovement::computeParameterUpdates()
 {
+  // the dimensions are independent and only use their own preallocated workspaces
+#pragma omp parallel for
   for (int d=0; d<num_dimensions_; ++d)
   {
-    parameter_updates_[d] = MatrixXd::Zero(num_time_steps_, num_parameters_[d]);
+    parameter_updates_[d].setZero();
 
     for (int r=0; r<num_rollouts_; ++r)
     {
@@ -600,24 +605,23 @@ bool PolicyImprovement::computeParameterUpdates()
 //      ROS_INFO("Dimension %d: new stddev = %f", d, adapted_stddevs_[d]);
 
       // true CMA method + minimization of frobenius norm
-      adapted_covariances_[d] = Eigen::MatrixXd::Zero(num_time_steps_, num_time_steps_);
+      // (symmetric rank-1 updates, only the lower triangle is computed)
+      adapted_covariances_[d].setZero();
       for (int r=0; r<num_rollouts_; ++r)
       {
-        adapted_covariances_[d] += rollouts_[r].full_probabilities_[d] *
-            rollouts_[r].noise_[d] * rollouts_[r].noise_[d].transpose();
+        adapted_covariances_[d].selfadjointView<Lower>().rankUpdate(rollouts_[r].noise_[d],
+                                                                    rollouts_[r].full_probabilities_[d]);
       }
       // minimize frobenius norm of diff between a_c and std_dev^2 * inv_control_cost
+      // both are symmetric, so the off-diagonal products of the lower triangle count twice
       double numer = 0.0;
-      double denom = 0.0;
-      for (int i=0; i<num_time_steps_; ++i)
+      for (int j=0; j<num_parameters_[d]; ++j)
       {
-        for (int j=0; j<num_time_steps_; ++j)
-        {
-          numer += adapted_covariances_[d](i,j) * inv_control_costs_[d](i,j);
-          denom += inv_control_costs_[d](i,j) * inv_control_costs_[d](i,j);
-        }
+        int length = num_parameters_[d] - j;
+        numer += 2.0 * adapted_covariances_[d].col(j).tail(length).dot(inv_control_costs_[d].col(j).tail(length))
+            - adapted_covariances_[d](j,j) * inv_control_costs_[d](j,j);
       }
-      double frob_stddev = sqrt(numer/denom);
+      double frob_stddev = sqrt(numer/inv_control_cost_norms_[d]);
 
 //      double kl_stddev = sqrt((control_costs_[d]*adapted_covariances_[d]).trace() / num_parameters_[d]);
 //      ROS_INFO("frob = %lf, kl = %lf", frob_stddev, kl_stddev);
@@ -628,8 +632,6 @@ bool PolicyImprovement::computeParameterUpdates()
         adapted_stddevs_[d] = noise_min_stddev_[d];
 //      ROS_INFO("Dimension %d: new stddev = %f", d, adapted_stddevs_[d]);
 
-      adapted_covariance_valid_ = true;
-
     }
 
     // reweighting the updates per time-step
@@ -655,10 +657,14 @@ bool PolicyImprovement::computeParameterUpdates()
     }
     parameter_updates_[d].row(0) /= divisor;
 
-    parameter_updates_[d].row(0).transpose() = projection_matrix_[d]*parameter_updates_[d].row(0).transpose();
+    tmp_parameters_[d].noalias() = projection_matrix_[d]*parameter_updates_[d].row(0).transpose();
+    parameter_updates_[d].row(0) = tmp_parameters_[d].transpose();
 
   }
 
+  if (use_covariance_matrix_adaptation_)
+    adapted_covariance_valid_ = true;
+
   return true;
 }
 
@@ -704,8 +710,10 @@ bool PolicyImprovement::preComputeProjectionMatrices()
 //  ROS_INFO("Precomputing projection matrices..");
   projection_matrix_.resize(num_dimensions_);
   inv_projection_matrix_.resize(num_dimensions_);
+  inv_control_cost_norms_.resize(num_dimensions_);
   for (int d=0; d<num_dimensions_; ++d)
   {
+    inv_control_cost_norms_[d] = inv_control_costs_[d].squaredNorm();
     projection_matrix_[d] = inv_control_costs_[d];
 
     // scale each column separately - divide by max element
@@ -731,7 +739,12 @@ bool PolicyImprovement::preComputeProjectionMatrices()
 //    projection_matrix_[d] /= max_entry*num_parameters_[d];
 
     //ROS_INFO_STREAM("Projection matrix = \n" << projection_matrix_[d]);
-    inv_projection_matrix_[d] = projection_matrix_[d].fullPivLu().inverse();
+    // projection = R^-1 * diag(1/(n*R^-1(p,p))), so its inverse is diag(n*R^-1(p,p)) * R, no need for an LU
+    inv_projection_matrix_[d] = control_costs_[d];
+    for (int p=0; p<num_parameters_[d]; ++p)
+    {
+      inv_projection_matrix_[d].row(p) *= num_parameters_[d]*inv_control_costs_[d](p,p);
+    }
   }
 //  ROS_INFO("Done precomputing projection matrices.");
   return true;
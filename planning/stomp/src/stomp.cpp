@@ -36,6 +36,7 @@
 
 // system includes
 #include <cassert>
+#include <algorithm>
 #include <omp.h>
 
 // ros includes
@@ -77,6 +78,8 @@ bool STOMP::initialize(ros::NodeHandle& node_handle, boost::shared_ptr<stomp::Ta
                                  policy_, use_noise_adaptation_, noise_min_stddev_);
 
   rollout_costs_ = Eigen::MatrixXd::Zero(max_rollouts_, num_time_steps_);
+  if (use_gradient_step_)
+    ROS_VERIFY(policy_->getBandedControlCosts(banded_control_costs_));
 
   policy_iteration_counter_ = 0;
 
@@ -109,6 +112,12 @@ bool STOMP::readParameters()
   node_handle_.param("write_to_file", write_to_file_, true); // defaults are sometimes good!
   node_handle_.param("use_noise_adaptation", use_noise_adaptation_, true);
   node_handle_.param("use_openmp", use_openmp_, false);
+  node_handle_.param("use_gradient_step", use_gradient_step_, false);
+  if (use_gradient_step_)
+  {
+    ROS_VERIFY(usc_utilities::read(node_handle_, std::string("gradient_learning_rate"), gradient_learning_rate_));
+    ROS_VERIFY(usc_utilities::read(node_handle_, std::string("gradient_max_update"), gradient_max_update_));
+  }
   return true;
 }
 
@@ -169,7 +178,9 @@ bool STOMP::doGenRollouts(int iteration_number)
 bool STOMP::doExecuteRollouts(int iteration_number)
 {
   std::vector<Eigen::VectorXd> gradients;
-#pragma omp parallel for num_threads(num_threads_)
+  // with fewer rollouts than threads, the remaining threads are left to the task (nested parallelism)
+  int num_rollout_threads = std::max(1, std::min(num_threads_, int(rollouts_.size())));
+#pragma omp parallel for num_threads(num_rollout_threads)
   for (int r=0; r<int(rollouts_.size()); ++r)
   {
     int thread_id = omp_get_thread_num();
@@ -210,12 +221,11 @@ bool STOMP::doUpdate(int iteration_number)
 
 bool STOMP::doNoiselessRollout(int iteration_number)
 {
-  // get a noise-less rollout to check the cost
-  std::vector<Eigen::VectorXd> gradients;
+  // get a noise-less rollout to check the cost, and its gradients for the hybrid mode
   ROS_VERIFY(policy_->getParameters(parameters_));
   bool validity = false;
   ROS_VERIFY(task_->execute(parameters_, parameters_, tmp_rollout_cost_[0], tmp_rollout_weighted_features_[0], iteration_number,
-                            -1, 0, false, gradients, validity));
+                            -1, 0, use_gradient_step_, gradients_, validity));
   double total_cost;
   policy_improvement_.setNoiselessRolloutCosts(tmp_rollout_cost_[0], total_cost);
 
@@ -230,6 +240,31 @@ bool STOMP::doNoiselessRollout(int iteration_number)
   return true;
 }
 
+bool STOMP::doGradientStep(int iteration_number)
+{
+  // covariant gradient step as in CHOMP, from the gradients of the previous noiseless rollout, i.e. at the
+  // parameters the rollouts of this iteration have been sampled around. There are none in the first iteration.
+  if (gradients_.empty())
+    return true;
+  ROS_VERIFY(policy_->getParameters(parameters_));
+  ROS_VERIFY(policy_->computeControlCostGradient(parameters_, control_cost_weight_, control_cost_gradients_));
+  for (int d=0; d<num_dimensions_; ++d)
+  {
+    Eigen::VectorXd update = -gradient_learning_rate_ * (gradients_[d] + control_cost_gradients_[d]);
+    banded_control_costs_[d].solve(update);
+    // scale the update
+    double max = update.array().abs().maxCoeff();
+    if (max > gradient_max_update_)
+    {
+      update *= gradient_max_update_ / max;
+    }
+    parameters_[d] += update;
+  }
+  task_->filter(parameters_, 0);
+  ROS_VERIFY(policy_->setParameters(parameters_));
+  return true;
+}
+
 bool STOMP::runSingleIteration(const int iteration_number)
 {
   ROS_ASSERT(initialized_);
@@ -243,6 +278,11 @@ bool STOMP::runSingleIteration(const int iteration_number)
 
   ROS_ASSERT(doRollouts(iteration_number));
   ROS_ASSERT(doUpdate(iteration_number));
+  if (use_gradient_step_)
+  {
+    // before the noiseless rollout, so that its cost is the one of the updated parameters
+    ROS_VERIFY(doGradientStep(iteration_number));
+  }
   ROS_ASSERT(doNoiselessRollout(iteration_number));
 
   if (write_to_file_)
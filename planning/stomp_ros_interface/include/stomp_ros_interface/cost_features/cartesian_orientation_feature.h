@@ -23,6 +23,9 @@ public:
   virtual int getNumValues() const;
   virtual void computeValuesAndGradients(boost::shared_ptr<learnable_cost_function::Input const> input, std::vector<double>& feature_values,
                                          bool compute_gradients, std::vector<Eigen::VectorXd>& gradients, bool& state_validity);
+  virtual void computeValues(const boost::shared_ptr<learnable_cost_function::Input const>* inputs, int num_inputs,
+                             Eigen::MatrixXd& feature_values, int row, int column, int* state_validities);
+  virtual bool isThreadSafe() const;
   virtual std::string getName() const;
   virtual boost::shared_ptr<learnable_cost_function::Feature> clone() const;
 
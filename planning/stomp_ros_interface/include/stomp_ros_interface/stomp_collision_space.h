@@ -78,6 +78,13 @@ public:
 
   double getDistance(double x, double y, double z) const;
 
+  /**
+   * \brief Gets the trilinearly interpolated distances and gradients of the distance field at a batch of positions.
+   *
+   * \param gradients Output array of num_positions (x,y,z) triplets, may be NULL
+   */
+  void getDistanceGradients(const KDL::Vector* positions, int num_positions, double* distances, double* gradients) const;
+
   void setPlanningScene(const arm_navigation_msgs::PlanningScene& planning_scene);
 
   const arm_navigation_msgs::PlanningScene& getPlanningScene();
@@ -136,6 +143,14 @@ inline double StompCollisionSpace::getDistance(double x, double y, double z) con
   //return distance_field_->get
 }
 
+inline void StompCollisionSpace::getDistanceGradients(const KDL::Vector* positions, int num_positions,
+                                                      double* distances, double* gradients) const
+{
+  // KDL::Vector only holds its three coordinates, so an array of them is an array of (x,y,z) triplets
+  if (num_positions > 0)
+    distance_field_->getInterpolatedDistanceGradients(positions[0].data, num_positions, distances, gradients);
+}
+
 inline bool StompCollisionSpace::getCollisionPointDistance(const StompCollisionPoint& collision_point, const KDL::Vector& collision_point_pos, double& distance) const
 {
   distance = getDistance(collision_point_pos.x(), collision_point_pos.y(), collision_point_pos.z());
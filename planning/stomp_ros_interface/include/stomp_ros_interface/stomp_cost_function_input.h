@@ -45,14 +45,44 @@ public:
   boost::shared_ptr<StompRobotModel const> robot_model_;
   const StompRobotModel::StompPlanningGroup* planning_group_;
 
-  void doFK(boost::shared_ptr<KDL::TreeFkSolverJointPosAxisPartial> fk_solver);
+  /**
+   * How doFK() obtained the kinematics of the current joint angles
+   */
+  enum FKResult
+  {
+    FK_FULL = 0,      /**< full FK of the tree */
+    FK_INCREMENTAL,   /**< only the links distal to the joints that changed since the last call were recomputed */
+    FK_CACHED         /**< the joint angles did not change since the last call */
+  };
+
+  FKResult doFK(boost::shared_ptr<KDL::TreeFkSolverJointPosAxisPartial> fk_solver);
+
+  /**
+   * Jacobian (3 x num_joints) of a collision point position w.r.t. the joints of the planning group, from the
+   * joint positions and axes of the last doFK()
+   */
+  void getCollisionPointJacobian(int collision_point, Eigen::MatrixXd& jacobian) const;
 
   void publishVizMarkers(const ros::Time& stamp, ros::Publisher& publisher);
 
+  /**
+   * Returns the rollout that the inputs belong to if they are consecutive time steps of it, NULL otherwise.
+   * Batched features can then read the differentiated trajectories of the rollout directly.
+   */
+  static const StompOptimizationTask::PerRolloutData* getRolloutData(
+      const boost::shared_ptr<learnable_cost_function::Input const>* inputs, int num_inputs);
+
+  /**
+   * Column of the first value of feature in per_rollout_data_->feature_time_weights_, -1 if the weights are not
+   * available. Features weight their gradients with them, see StompOptimizationTask::computeGradients().
+   */
+  int getFeatureTimeWeightsColumn(const learnable_cost_function::Feature* feature) const;
+
   StompOptimizationTask::PerRolloutData* per_rollout_data_;
 
 private:
   bool full_fk_done_;
+  KDL::JntArray previous_joint_angles_; // all_joint_angles_ of the last doFK()
 };
 
 } /* namespace stomp_ros_interface */
@@ -8,6 +8,7 @@
 #ifndef STOMP_OPTIMIZATION_TASK_H_
 #define STOMP_OPTIMIZATION_TASK_H_
 
+#include <map>
 #include <stomp/task.h>
 #include <stomp_ros_interface/stomp_robot_model.h>
 //#include <stomp_ros_interface/stomp_cost_function_input.h>
@@ -55,6 +56,18 @@ public:
 
   void computeCosts(const Eigen::MatrixXd& features, Eigen::VectorXd& costs, Eigen::MatrixXd& weighted_feature_values) const;
 
+  /**
+   * Gradients of the total cost of a rollout w.r.t. its joint angles, from the gradients of the features at
+   * each time step. computeFeatures() must have been called for the rollout.
+   */
+  void computeGradients(int rollout_id, std::vector<Eigen::VectorXd>& gradients);
+
+  /**
+   * Column of the first value of feature in the feature values (and in PerRolloutData::feature_time_weights_),
+   * -1 if it is not part of the feature set
+   */
+  int getFeatureColumn(const learnable_cost_function::Feature* feature) const;
+
   void setPlanningScene(const arm_navigation_msgs::PlanningScene& scene);
 
   void setMotionPlanRequest(const arm_navigation_msgs::MotionPlanRequest& request);
@@ -81,10 +94,14 @@ public:
     const StompOptimizationTask* task_;
 
     std::vector<boost::shared_ptr<StompCostFunctionInput> > cost_function_input_; // one per timestep
+    std::vector<boost::shared_ptr<learnable_cost_function::Input const> > inputs_; // cost_function_input_ as generic inputs
 
+    Eigen::MatrixXd raw_features_; // num_time x num_features, before splitting them in time
+    std::vector<int> validities_; // one per timestep
     Eigen::MatrixXd features_; // num_time x num_features
     Eigen::MatrixXd weighted_features_; // num_time x num_features
     Eigen::VectorXd costs_;
+    Eigen::MatrixXd feature_time_weights_; // num_time x num_features, weight of each feature value in the cost, set by computeGradients()
 
     // temp data structures for differentiation
     std::vector<Eigen::VectorXd> tmp_joint_angles_;     // one per dimension
@@ -93,12 +110,26 @@ public:
     std::vector<std::vector<Eigen::VectorXd> > tmp_collision_point_pos_; // [collision_point_index][x/y/z]
     std::vector<std::vector<Eigen::VectorXd> > tmp_collision_point_vel_; // [collision_point_index][x/y/z]
     std::vector<std::vector<Eigen::VectorXd> > tmp_collision_point_acc_; // [collision_point_index][x/y/z]
+    double dt_; // time step used by the last differentiate()
 
-    boost::shared_ptr<KDL::TreeFkSolverJointPosAxisPartial> fk_solver_;
+    std::vector<boost::shared_ptr<KDL::TreeFkSolverJointPosAxisPartial> > fk_solvers_; // one per thread
     void differentiate(double dt);
     void publishMarkers(ros::Publisher& viz_pub, int id, bool noiseless, const std::string& reference_frame);
   };
 
+  /**
+   * How often the forward kinematics of a time step could be skipped or done incrementally,
+   * accumulated over all rollouts since the last motion plan request
+   */
+  struct FKCacheStatistics
+  {
+    long num_time_steps_;   // time steps whose kinematics were requested
+    long num_cached_;       // time steps whose joint angles had not changed
+    long num_incremental_;  // time steps where only the links distal to the changed joints were recomputed
+  };
+
+  void getFKCacheStatistics(FKCacheStatistics& statistics) const;
+
   void findCommonCollisions(PerRolloutData* data);
 
   void getRolloutData(PerRolloutData& noiseless_rollout, std::vector<PerRolloutData>& noisy_rollouts);
@@ -119,6 +150,7 @@ private:
 
   boost::shared_ptr<stomp::CovariantMovementPrimitive> policy_;
   boost::shared_ptr<learnable_cost_function::FeatureSet> feature_set_;
+  std::map<const learnable_cost_function::Feature*, int> feature_columns_;
   double control_cost_weight_;
   //std::vector<PerThreadData> per_thread_data_;
   std::vector<PerRolloutData> per_rollout_data_;
@@ -146,6 +178,7 @@ private:
   bool publish_trajectory_markers_;
   int max_rollout_markers_published_;
   int last_executed_rollout_;
+  FKCacheStatistics fk_cache_statistics_;
 
   // variables to handle splitting features based on time
   int num_feature_basis_functions_;
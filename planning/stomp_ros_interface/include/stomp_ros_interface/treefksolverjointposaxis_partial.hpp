@@ -59,6 +59,15 @@ public:
   int JntToCartFull(const JntArray& q_in, std::vector<Vector>& joint_pos, std::vector<Vector>& joint_axis, std::vector<Frame>& segment_frames);
   int JntToCartPartial(const JntArray& q_in, std::vector<Vector>& joint_pos, std::vector<Vector>& joint_axis, std::vector<Frame>& segment_frames) const;
 
+  /**
+   * Updates the output of an earlier FK call with joint angles q_previous to the joint angles q_in.
+   * Only the segments (and joint positions / axes) distal to the joints that changed are recomputed,
+   * the frames of their parent links are reused from segment_frames.
+   * Returns the number of segments recomputed, or -1 if JntToCartFull() has not been called on this solver yet.
+   */
+  int JntToCartIncremental(const JntArray& q_in, const JntArray& q_previous, std::vector<Vector>& joint_pos,
+                           std::vector<Vector>& joint_axis, std::vector<Frame>& segment_frames);
+
   const std::vector<std::string> getSegmentNames() const;
   const std::map<std::string, int> getSegmentNameToIndex() const;
 
@@ -87,6 +96,7 @@ private:
   std::vector<const TreeElement*> joint_parent_;            /**< the parent segment for each joint */
   std::vector<bool> active_joints_;             /**< which are the joints that will change in calls to partial FK */
   std::vector<bool> joint_calc_pos_axis_;       /**< which joints should we calculate the position and axis for */
+  std::vector<char> segment_changed_;           /**< scratch space for incremental FK: which segment frames were recomputed */
 
   void assignSegmentNumber(const SegmentMap::const_iterator this_segment);
 
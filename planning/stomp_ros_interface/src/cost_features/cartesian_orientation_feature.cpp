@@ -7,10 +7,14 @@
 
 #include <stomp_ros_interface/cost_features/cartesian_orientation_feature.h>
 #include <stomp_ros_interface/stomp_cost_function_input.h>
+#include <algorithm>
 
 namespace stomp_ros_interface
 {
 
+// number of time steps whose end effector orientations are gathered at once
+static const int ORIENTATION_BATCH_SIZE = 64;
+
 CartesianOrientationFeature::CartesianOrientationFeature()
 {
 }
@@ -55,6 +59,57 @@ void CartesianOrientationFeature::computeValuesAndGradients(boost::shared_ptr<le
 
 }
 
+void CartesianOrientationFeature::computeValues(const boost::shared_ptr<learnable_cost_function::Input const>* inputs, int num_inputs,
+                                                Eigen::MatrixXd& feature_values, int row, int column, int* state_validities)
+{
+  const StompOptimizationTask::PerRolloutData* data = StompCostFunctionInput::getRolloutData(inputs, num_inputs);
+  if (data == NULL)
+  {
+    learnable_cost_function::Feature::computeValues(inputs, num_inputs, feature_values, row, column, state_validities);
+    return;
+  }
+
+  const StompCostFunctionInput* first = static_cast<const StompCostFunctionInput*>(inputs[0].get());
+  int t = first->time_index_;
+  int i = data->tmp_collision_point_vel_.size()-1;
+  int j = first->planning_group_->end_effector_segment_index_;
+  const std::vector<Eigen::VectorXd>& vel = data->tmp_collision_point_vel_[i];
+
+  double orient[3][ORIENTATION_BATCH_SIZE];
+  for (int start=0; start<num_inputs; start+=ORIENTATION_BATCH_SIZE)
+  {
+    int batch_size = std::min(ORIENTATION_BATCH_SIZE, num_inputs - start);
+
+    // gather the end effector z axes
+    for (int b=0; b<batch_size; ++b)
+    {
+      KDL::Vector orient_vector =
+          static_cast<const StompCostFunctionInput*>(inputs[start+b].get())->segment_frames_[j].M.UnitZ();
+      orient[0][b] = orient_vector.x();
+      orient[1][b] = orient_vector.y();
+      orient[2][b] = orient_vector.z();
+    }
+
+    // abs dot product with the normalized velocity, branch free so that it vectorizes.
+    // Like KDL::Vector::Normalize(), velocities below epsilon are replaced by the x axis.
+    const double* vx = &vel[0](t + start);
+    const double* vy = &vel[1](t + start);
+    const double* vz = &vel[2](t + start);
+    double* out = &feature_values(row + start, column);
+    for (int b=0; b<batch_size; ++b)
+    {
+      double norm = sqrt(vx[b]*vx[b] + vy[b]*vy[b] + vz[b]*vz[b]);
+      double dot = orient[0][b]*vx[b] + orient[1][b]*vy[b] + orient[2][b]*vz[b];
+      out[b] = (norm < KDL::epsilon) ? fabs(orient[0][b]) : fabs(dot) / norm;
+    }
+  }
+}
+
+bool CartesianOrientationFeature::isThreadSafe() const
+{
+  return true;
+}
+
 std::string CartesianOrientationFeature::getName() const
 {
   return "CartesianOrientationFeature";
@@ -7,6 +7,7 @@
 
 #include <stomp_ros_interface/cost_features/cartesian_vel_acc_feature.h>
 #include <stomp_ros_interface/stomp_cost_function_input.h>
+#include <stomp/stomp_utils.h>
 
 namespace stomp_ros_interface
 {
@@ -53,6 +54,62 @@ void CartesianVelAccFeature::computeValuesAndGradients(boost::shared_ptr<learnab
   feature_values[0]*=feature_values[0];
   feature_values[1]*=feature_values[1];
 
+  if (compute_gradients)
+  {
+    for (int v=0; v<getNumValues(); ++v)
+      gradients[v] = Eigen::VectorXd::Zero(input->getNumDimensions());
+
+    // gradients of the squared derivatives weighted and summed over the rollout w.r.t. the position of the
+    // collision point at this time step, mapped to the joints through its jacobian. The weights of the time
+    // steps are applied before the transposed differentiation.
+    const StompOptimizationTask::PerRolloutData* data = input->per_rollout_data_;
+    int column = input->getFeatureTimeWeightsColumn(this);
+    if (column >= 0)
+    {
+      int t = input->time_index_;
+      Eigen::Vector3d vel_gradient, acc_gradient;
+      for (int d=0; d<3; ++d)
+      {
+        vel_gradient(d) = 2.0 * stomp::differentiateTranspose(data->tmp_collision_point_vel_[i][d],
+            data->feature_time_weights_.col(column + 0), stomp::STOMP_VELOCITY, t, data->dt_);
+        acc_gradient(d) = 2.0 * stomp::differentiateTranspose(data->tmp_collision_point_acc_[i][d],
+            data->feature_time_weights_.col(column + 1), stomp::STOMP_ACCELERATION, t, data->dt_);
+      }
+      Eigen::MatrixXd jacobian;
+      input->getCollisionPointJacobian(i, jacobian);
+      gradients[0] = jacobian.transpose() * vel_gradient;
+      gradients[1] = jacobian.transpose() * acc_gradient;
+    }
+  }
+
+}
+
+void CartesianVelAccFeature::computeValues(const boost::shared_ptr<learnable_cost_function::Input const>* inputs, int num_inputs,
+                                           Eigen::MatrixXd& feature_values, int row, int column, int* state_validities)
+{
+  const StompOptimizationTask::PerRolloutData* data = StompCostFunctionInput::getRolloutData(inputs, num_inputs);
+  if (data == NULL)
+  {
+    learnable_cost_function::Feature::computeValues(inputs, num_inputs, feature_values, row, column, state_validities);
+    return;
+  }
+
+  // squared norms from the differentiated x/y/z trajectories of the last collision point
+  int t = static_cast<const StompCostFunctionInput*>(inputs[0].get())->time_index_;
+  int i = data->tmp_collision_point_vel_.size()-1;
+  const std::vector<Eigen::VectorXd>& vel = data->tmp_collision_point_vel_[i];
+  const std::vector<Eigen::VectorXd>& acc = data->tmp_collision_point_acc_[i];
+  feature_values.col(column + 0).segment(row, num_inputs) =
+      (vel[0].segment(t, num_inputs).array().square() + vel[1].segment(t, num_inputs).array().square()
+          + vel[2].segment(t, num_inputs).array().square()).matrix();
+  feature_values.col(column + 1).segment(row, num_inputs) =
+      (acc[0].segment(t, num_inputs).array().square() + acc[1].segment(t, num_inputs).array().square()
+          + acc[2].segment(t, num_inputs).array().square()).matrix();
+}
+
+bool CartesianVelAccFeature::isThreadSafe() const
+{
+  return true;
 }
 
 std::string CartesianVelAccFeature::getName() const
@@ -8,10 +8,14 @@
 #include <stomp_ros_interface/cost_features/collision_feature.h>
 #include <stomp_ros_interface/stomp_cost_function_input.h>
 #include <stomp_ros_interface/sigmoid.h>
+#include <algorithm>
 
 namespace stomp_ros_interface
 {
 
+// number of collision points whose distances are queried from the distance field at once
+static const int DISTANCE_QUERY_BATCH_SIZE = 64;
+
 CollisionFeature::CollisionFeature()
 {
   sigmoid_centers_.push_back(-0.025);
@@ -61,13 +65,18 @@ void CollisionFeature::computeValuesAndGradients(boost::shared_ptr<learnable_cos
   feature_values.resize(getNumValues(), 0.0);
   if (compute_gradients)
   {
-    gradients.resize(getNumValues(), Eigen::VectorXd::Zero(input->getNumDimensions()));
+    gradients.resize(getNumValues());
+    for (int i=0; i<getNumValues(); ++i)
+      gradients[i] = Eigen::VectorXd::Zero(input->getNumDimensions());
   }
 
   state_validity = true;
 
   // for each collision point, add up the distance field costs...
   double total_cost = 0.0;
+  double distances[DISTANCE_QUERY_BATCH_SIZE];
+  double distance_gradients[3*DISTANCE_QUERY_BATCH_SIZE];
+  Eigen::MatrixXd jacobian;
   for (unsigned int i=0; i<input->collision_point_pos_.size(); ++i)
   {
 
@@ -75,18 +84,33 @@ void CollisionFeature::computeValuesAndGradients(boost::shared_ptr<learnable_cos
 //    bool in_collision = input->collision_space_->getCollisionPointPotential(
 //        input->planning_group_->collision_points_[i], input->collision_point_pos_[i], potential);
 
-    double distance = 0.0;
-    bool in_collision = input->collision_space_->getCollisionPointDistance(
-        input->planning_group_->collision_points_[i], input->collision_point_pos_[i], distance);
+    // interpolated distances of the next batch of collision points
+    int batch_index = i % DISTANCE_QUERY_BATCH_SIZE;
+    if (batch_index == 0)
+    {
+      int batch_size = std::min<int>(DISTANCE_QUERY_BATCH_SIZE, input->collision_point_pos_.size() - i);
+      input->collision_space_->getDistanceGradients(&input->collision_point_pos_[i], batch_size, distances,
+                                                    compute_gradients ? distance_gradients : NULL);
+    }
+    double distance = distances[batch_index] - input->planning_group_->collision_points_[i].getRadius();
 
     double potential = 0.0;
+    double potential_derivative = 0.0;
     double clearance = input->planning_group_->collision_points_[i].getClearance();
     if (distance >= clearance)
+    {
       potential = 0.0;
+    }
     else if (distance >= 0.0)
+    {
       potential = 0.5 * (distance - clearance) * (distance - clearance) / clearance;
+      potential_derivative = (distance - clearance) / clearance;
+    }
     else // distance < 0.0
+    {
       potential = -distance + 0.5 * clearance;
+      potential_derivative = -1.0;
+    }
 
     double vel_mag = input->collision_point_vel_[i].Norm();
     total_cost += potential * vel_mag;
@@ -96,15 +120,109 @@ void CollisionFeature::computeValuesAndGradients(boost::shared_ptr<learnable_cos
     for (int i=0; i<num_sigmoids_; ++i)
     {
       double val = (1.0 - sigmoid(distance, sigmoid_centers_[i], sigmoid_slopes_[i]));
-      feature_values[i+2] += val * vel_mag;
+      feature_values[i+1] += val * vel_mag;
       //printf("distance = %f, sigmoid %d = %f\n", distance, i, val);
     }
 
+    // the costs are integrated over arc length, so their gradients are the CHOMP functional gradients
+    //   |v| * ((I - v_hat v_hat^T) * grad(cost) - cost * kappa),  kappa = (I - v_hat v_hat^T) * a / |v|^2
+    // w.r.t. the collision point position, mapped to the joints through its jacobian
+    if (!compute_gradients || vel_mag < KDL::epsilon || (potential_derivative == 0.0 && num_sigmoids_ == 0))
+      continue;
+
+    const KDL::Vector& vel = input->collision_point_vel_[i];
+    const KDL::Vector& acc = input->collision_point_acc_[i];
+    Eigen::Vector3d vel_hat(vel.x() / vel_mag, vel.y() / vel_mag, vel.z() / vel_mag);
+    Eigen::Matrix3d projection = Eigen::Matrix3d::Identity() - vel_hat * vel_hat.transpose();
+    Eigen::Vector3d curvature = projection * Eigen::Vector3d(acc.x(), acc.y(), acc.z()) / (vel_mag * vel_mag);
+    Eigen::Vector3d field_gradient = projection * Eigen::Map<const Eigen::Vector3d>(&distance_gradients[3*batch_index]);
+
+    input->getCollisionPointJacobian(i, jacobian);
+    gradients[0] += jacobian.transpose() * (vel_mag * (potential_derivative * field_gradient - potential * curvature));
+    for (int s=0; s<num_sigmoids_; ++s)
+    {
+      double sig = sigmoid(distance, sigmoid_centers_[s], sigmoid_slopes_[s]);
+      double cost = 1.0 - sig;
+      double cost_derivative = -sigmoid_slopes_[s] * sig * (1.0 - sig);
+      gradients[s+1] += jacobian.transpose() * (vel_mag * (cost_derivative * field_gradient - cost * curvature));
+    }
   }
   feature_values[0] = total_cost;
   //feature_values[1] = state_validity?0.0:1.0;
 
-  // TODO gradients not computed yet!!!
+  // the values only depend on this time step, so their gradients are weighted with its weights
+  if (compute_gradients)
+  {
+    int column = input->getFeatureTimeWeightsColumn(this);
+    for (int v=0; column >= 0 && v<getNumValues(); ++v)
+      gradients[v] *= input->per_rollout_data_->feature_time_weights_(input->time_index_, column + v);
+  }
+}
+
+void CollisionFeature::computeValues(const boost::shared_ptr<learnable_cost_function::Input const>* inputs, int num_inputs,
+                                     Eigen::MatrixXd& feature_values, int row, int column, int* state_validities)
+{
+  if (num_inputs <= 0)
+    return;
+
+  // the collision point radii and clearances are the same for all inputs
+  const std::vector<StompCollisionPoint>& collision_points =
+      static_cast<const StompCostFunctionInput*>(inputs[0].get())->planning_group_->collision_points_;
+  int num_points = collision_points.size();
+  std::vector<double> radii(num_points);
+  std::vector<double> clearances(num_points);
+  for (int i=0; i<num_points; ++i)
+  {
+    radii[i] = collision_points[i].getRadius();
+    clearances[i] = collision_points[i].getClearance();
+  }
+
+  double distances[DISTANCE_QUERY_BATCH_SIZE];
+  double vel_mags[DISTANCE_QUERY_BATCH_SIZE];
+  for (int n=0; n<num_inputs; ++n)
+  {
+    const StompCostFunctionInput* input = static_cast<const StompCostFunctionInput*>(inputs[n].get());
+    for (int s=0; s<num_sigmoids_; ++s)
+      feature_values(row+n, column+1+s) = 0.0;
+
+    double total_cost = 0.0;
+    for (int start=0; start<num_points; start+=DISTANCE_QUERY_BATCH_SIZE)
+    {
+      int batch_size = std::min(DISTANCE_QUERY_BATCH_SIZE, num_points - start);
+      input->collision_space_->getDistanceGradients(&input->collision_point_pos_[start], batch_size, distances, NULL);
+      for (int b=0; b<batch_size; ++b)
+      {
+        distances[b] -= radii[start+b];
+        vel_mags[b] = input->collision_point_vel_[start+b].Norm();
+      }
+
+      // the potential of computeValuesAndGradients(), branch free so that it vectorizes
+      for (int b=0; b<batch_size; ++b)
+      {
+        double distance = distances[b];
+        double clearance = clearances[start+b];
+        double potential = (distance >= clearance) ? 0.0 :
+            ((distance >= 0.0) ? 0.5 * (distance - clearance) * (distance - clearance) / clearance :
+                -distance + 0.5 * clearance);
+        total_cost += potential * vel_mags[b];
+      }
+
+      for (int s=0; s<num_sigmoids_; ++s)
+      {
+        for (int b=0; b<batch_size; ++b)
+        {
+          feature_values(row+n, column+1+s) +=
+              (1.0 - sigmoid(distances[b], sigmoid_centers_[s], sigmoid_slopes_[s])) * vel_mags[b];
+        }
+      }
+    }
+    feature_values(row+n, column) = total_cost;
+  }
+}
+
+bool CollisionFeature::isThreadSafe() const
+{
+  return true;
 }
 
 std::string CollisionFeature::getName() const
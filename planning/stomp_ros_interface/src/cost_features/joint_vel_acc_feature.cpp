@@ -7,6 +7,7 @@
 
 #include <stomp_ros_interface/cost_features/joint_vel_acc_feature.h>
 #include <stomp_ros_interface/stomp_cost_function_input.h>
+#include <stomp/stomp_utils.h>
 
 namespace stomp_ros_interface
 {
@@ -52,6 +53,54 @@ void JointVelAccFeature::computeValuesAndGradients(boost::shared_ptr<learnable_c
     feature_values[j*2 + 1] = input->joint_angles_acc_(j)*input->joint_angles_acc_(j);
   }
 
+  if (compute_gradients)
+  {
+    for (int i=0; i<getNumValues(); ++i)
+      gradients[i] = Eigen::VectorXd::Zero(input->getNumDimensions());
+
+    // gradients of the squared derivatives weighted and summed over the rollout, w.r.t. the joint angles at
+    // this time step. The weights of the time steps are applied before the transposed differentiation.
+    const StompOptimizationTask::PerRolloutData* data = input->per_rollout_data_;
+    int column = input->getFeatureTimeWeightsColumn(this);
+    if (column >= 0)
+    {
+      int t = input->time_index_;
+      for (int j=0; j<num_joints_; ++j)
+      {
+        gradients[j*2 + 0](j) = 2.0 * stomp::differentiateTranspose(data->tmp_joint_angles_vel_[j],
+            data->feature_time_weights_.col(column + j*2 + 0), stomp::STOMP_VELOCITY, t, data->dt_);
+        gradients[j*2 + 1](j) = 2.0 * stomp::differentiateTranspose(data->tmp_joint_angles_acc_[j],
+            data->feature_time_weights_.col(column + j*2 + 1), stomp::STOMP_ACCELERATION, t, data->dt_);
+      }
+    }
+  }
+
+}
+
+void JointVelAccFeature::computeValues(const boost::shared_ptr<learnable_cost_function::Input const>* inputs, int num_inputs,
+                                       Eigen::MatrixXd& feature_values, int row, int column, int* state_validities)
+{
+  const StompOptimizationTask::PerRolloutData* data = StompCostFunctionInput::getRolloutData(inputs, num_inputs);
+  if (data == NULL)
+  {
+    learnable_cost_function::Feature::computeValues(inputs, num_inputs, feature_values, row, column, state_validities);
+    return;
+  }
+
+  // square the differentiated joint trajectories of the rollout, one column at a time
+  int t = static_cast<const StompCostFunctionInput*>(inputs[0].get())->time_index_;
+  for (int j=0; j<num_joints_; ++j)
+  {
+    feature_values.col(column + j*2 + 0).segment(row, num_inputs) =
+        data->tmp_joint_angles_vel_[j].segment(t, num_inputs).array().square().matrix();
+    feature_values.col(column + j*2 + 1).segment(row, num_inputs) =
+        data->tmp_joint_angles_acc_[j].segment(t, num_inputs).array().square().matrix();
+  }
+}
+
+bool JointVelAccFeature::isThreadSafe() const
+{
+  return true;
 }
 
 std::string JointVelAccFeature::getName() const
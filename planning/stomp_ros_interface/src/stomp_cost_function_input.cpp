@@ -28,12 +28,16 @@ StompCostFunctionInput::StompCostFunctionInput(boost::shared_ptr<StompCollisionS
   all_joint_angles_ = KDL::JntArray(nj);
   for (int i=0; i<nj; ++i)
     all_joint_angles_(i) = 0.0;
+  previous_joint_angles_ = all_joint_angles_;
   joint_axis_.resize(nj);
   joint_pos_.resize(nj);
   segment_frames_.resize(nl);
   collision_point_pos_.resize(nc);
   collision_point_vel_.resize(nc);
   collision_point_acc_.resize(nc);
+  time_ = 0.0;
+  time_index_ = 0;
+  per_rollout_data_ = NULL;
   full_fk_done_ = false;
 }
 
@@ -46,29 +50,87 @@ int StompCostFunctionInput::getNumDimensions() const
   return planning_group_->num_joints_;
 }
 
-void StompCostFunctionInput::doFK(boost::shared_ptr<KDL::TreeFkSolverJointPosAxisPartial> fk_solver)
+StompCostFunctionInput::FKResult StompCostFunctionInput::doFK(boost::shared_ptr<KDL::TreeFkSolverJointPosAxisPartial> fk_solver)
 {
+  // nothing to do if none of the group joints moved since the last call
+  bool changed = false;
+  for (int i=0; i<planning_group_->num_joints_; ++i)
+  {
+    int kdl_index = planning_group_->stomp_joints_[i].kdl_joint_index_;
+    if (all_joint_angles_(kdl_index) != joint_angles_(i))
+    {
+      changed = true;
+      break;
+    }
+  }
+  if (full_fk_done_ && !changed)
+    return FK_CACHED;
+
   // first copy the group joints into all_joints:
+  previous_joint_angles_ = all_joint_angles_;
   for (int i=0; i<planning_group_->num_joints_; ++i)
   {
     int kdl_index = planning_group_->stomp_joints_[i].kdl_joint_index_;
     all_joint_angles_(kdl_index) = joint_angles_(i);
   }
 
-  //  if (!full_fk_done_)
+  // reuse the frames of the links proximal to the joints that changed
+  FKResult result = FK_INCREMENTAL;
+  if (!full_fk_done_ ||
+      fk_solver->JntToCartIncremental(all_joint_angles_, previous_joint_angles_, joint_pos_, joint_axis_, segment_frames_) < 0)
   {
     fk_solver->JntToCartFull(all_joint_angles_, joint_pos_, joint_axis_, segment_frames_);
     full_fk_done_ = true;
+    result = FK_FULL;
   }
-//  else
-//  {
-//    fk_solver->JntToCartPartial(joint_angles_, joint_pos_, joint_axis_, segment_frames_);
-//  }
 
   for (unsigned int i=0; i<planning_group_->collision_points_.size(); ++i)
   {
     planning_group_->collision_points_[i].getTransformedPosition(segment_frames_, collision_point_pos_[i]);
   }
+  return result;
+}
+
+void StompCostFunctionInput::getCollisionPointJacobian(int collision_point, Eigen::MatrixXd& jacobian) const
+{
+  const StompCollisionPoint& point = planning_group_->collision_points_[collision_point];
+  const KDL::Vector& pos = collision_point_pos_[collision_point];
+  jacobian.resize(3, planning_group_->num_joints_);
+  for (int j=0; j<planning_group_->num_joints_; ++j)
+  {
+    int kdl_index = planning_group_->stomp_joints_[j].kdl_joint_index_;
+    if (!point.isParentJoint(kdl_index))
+    {
+      jacobian.col(j).setZero();
+      continue;
+    }
+    KDL::Vector column = joint_axis_[kdl_index] * (pos - joint_pos_[kdl_index]);
+    jacobian(0, j) = column.x();
+    jacobian(1, j) = column.y();
+    jacobian(2, j) = column.z();
+  }
+}
+
+const StompOptimizationTask::PerRolloutData* StompCostFunctionInput::getRolloutData(
+    const boost::shared_ptr<learnable_cost_function::Input const>* inputs, int num_inputs)
+{
+  if (num_inputs <= 0)
+    return NULL;
+  const StompCostFunctionInput* first = static_cast<const StompCostFunctionInput*>(inputs[0].get());
+  const StompCostFunctionInput* last = static_cast<const StompCostFunctionInput*>(inputs[num_inputs-1].get());
+  const StompOptimizationTask::PerRolloutData* data = first->per_rollout_data_;
+  if (data == NULL || last->per_rollout_data_ != data || last->time_index_ - first->time_index_ != num_inputs - 1
+      || data->cost_function_input_[first->time_index_].get() != first)
+    return NULL;
+  return data;
+}
+
+int StompCostFunctionInput::getFeatureTimeWeightsColumn(const learnable_cost_function::Feature* feature) const
+{
+  if (per_rollout_data_ == NULL
+      || per_rollout_data_->feature_time_weights_.rows() != (int)per_rollout_data_->cost_function_input_.size())
+    return -1;
+  return per_rollout_data_->task_->getFeatureColumn(feature);
 }
 
 void StompCostFunctionInput::publishVizMarkers(const ros::Time& stamp, ros::Publisher& publisher)
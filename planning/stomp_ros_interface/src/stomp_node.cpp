@@ -100,6 +100,16 @@ bool StompNode::plan(arm_navigation_msgs::GetMotionPlan::Request& request,
   // TODO: read these params from server
   bool success = stomp_->runUntilValid(200, 10);
 
+  StompOptimizationTask::FKCacheStatistics fk_statistics;
+  task->getFKCacheStatistics(fk_statistics);
+  if (fk_statistics.num_time_steps_ > 0)
+  {
+    ROS_INFO("STOMP: forward kinematics of %ld time steps, %.1f%% cached, %.1f%% incremental",
+             fk_statistics.num_time_steps_,
+             100.0 * fk_statistics.num_cached_ / fk_statistics.num_time_steps_,
+             100.0 * fk_statistics.num_incremental_ / fk_statistics.num_time_steps_);
+  }
+
   std::vector<Eigen::VectorXd> best_params;
   double best_cost;
   stomp_->getBestNoiselessParameters(best_params, best_cost);
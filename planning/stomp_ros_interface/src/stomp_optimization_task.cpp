@@ -17,6 +17,7 @@
 #include <iostream>
 #include <set>
 #include <algorithm>
+#include <omp.h>
 
 namespace stomp_ros_interface
 {
@@ -28,6 +29,9 @@ StompOptimizationTask::StompOptimizationTask(ros::NodeHandle node_handle,
 {
   viz_pub_ = node_handle_.advertise<visualization_msgs::MarkerArray>("robot_model_array", 10, true);
   max_rollout_markers_published_ = 0;
+  fk_cache_statistics_.num_time_steps_ = 0;
+  fk_cache_statistics_.num_cached_ = 0;
+  fk_cache_statistics_.num_incremental_ = 0;
 }
 
 StompOptimizationTask::~StompOptimizationTask()
@@ -81,8 +85,10 @@ void StompOptimizationTask::setFeatures(std::vector<boost::shared_ptr<learnable_
   // create the feature set
   feature_set_.reset(new learnable_cost_function::FeatureSet());
 
+  feature_columns_.clear();
   for (unsigned int i=0; i<features.size(); ++i)
   {
+    feature_columns_[features[i].get()] = feature_set_->getNumValues();
     feature_set_->addFeature(features[i]);
   }
 
@@ -161,6 +167,8 @@ bool StompOptimizationTask::execute(std::vector<Eigen::VectorXd>& parameters,
   }
   computeFeatures(parameters, per_rollout_data_[rollout_id].features_, rollout_id, validity);
   computeCosts(per_rollout_data_[rollout_id].features_, costs, weighted_feature_values);
+  if (compute_gradients)
+    computeGradients(rollout_id, gradients);
 
 //  // copying it to per_rollout_data
 //  PerThreadData* rdata = &noiseless_rollout_data_;
@@ -190,6 +198,7 @@ void StompOptimizationTask::PerRolloutData::differentiate(double dt)
   int num_time_steps = cost_function_input_.size();
   int num_joint_angles = task_->planning_group_->num_joints_;
   int num_collision_points = task_->planning_group_->collision_points_.size();
+  dt_ = dt;
 
   // copy to temp structures
   for (int t=0; t<num_time_steps; ++t)
@@ -313,45 +322,63 @@ void StompOptimizationTask::computeFeatures(std::vector<Eigen::VectorXd>& parame
 {
   PerRolloutData *data = &per_rollout_data_[rollout_id];
 
-  // prepare the cost function input
-  std::vector<double> temp_features(feature_set_->getNumValues());
-  std::vector<Eigen::VectorXd> temp_gradients(feature_set_->getNumValues());
-  std::vector<double> joint_angles(num_dimensions_);
-
-  // do all forward kinematics
-  validity = true;
-  bool state_validity;
+  // split the time steps across threads, unless the rollouts themselves are already being
+  // executed in parallel. In that case the time steps use the remaining threads, if nested
+  // parallelism is enabled.
+  int num_time_step_threads = num_threads_;
+  if (omp_in_parallel())
+    num_time_step_threads = std::max(1, num_threads_ / omp_get_num_threads());
+
+  // do all forward kinematics, reusing whatever is unchanged since this rollout was last executed
+  long num_cached = 0;
+  long num_incremental = 0;
+#pragma omp parallel for num_threads(num_time_step_threads) if (num_time_step_threads > 1) reduction(+:num_cached,num_incremental)
   for (int t=0; t<num_time_steps_; ++t)
   {
+    StompCostFunctionInput* input = data->cost_function_input_[t].get();
     for (int d=0; d<num_dimensions_; ++d)
     {
-      data->cost_function_input_[t]->joint_angles_(d) = parameters[d](t);
-      joint_angles[d] = parameters[d](t);
+      input->joint_angles_(d) = parameters[d](t);
     }
-    data->cost_function_input_[t]->doFK(data->fk_solver_);
-    data->cost_function_input_[t]->per_rollout_data_ = data;
-    data->cost_function_input_[t]->time_ = t*dt_;
-    data->cost_function_input_[t]->time_index_ = t;
+    StompCostFunctionInput::FKResult fk_result = input->doFK(data->fk_solvers_[omp_get_thread_num()]);
+    if (fk_result == StompCostFunctionInput::FK_CACHED)
+      ++num_cached;
+    else if (fk_result == StompCostFunctionInput::FK_INCREMENTAL)
+      ++num_incremental;
+    input->per_rollout_data_ = data;
+    input->time_ = t*dt_;
+    input->time_index_ = t;
+    data->validities_[t] = 1;
+  }
+
+
+  // rollouts may be executed in parallel
+#pragma omp critical (fk_cache_statistics)
+  {
+    fk_cache_statistics_.num_time_steps_ += num_time_steps_;
+    fk_cache_statistics_.num_cached_ += num_cached;
+    fk_cache_statistics_.num_incremental_ += num_incremental;
   }
 
   data->differentiate(dt_);
 
-  // actually compute features
-  bool validities[num_time_steps_];
-  for (int t=0; t<num_time_steps_; ++t)
+  // actually compute features, for all time steps at once
+  feature_set_->computeValues(&data->inputs_[0], num_time_steps_, data->raw_features_, 0, 0,
+                              &data->validities_[0], num_time_step_threads);
+
+  // split the features in time
+  for (int f=0; f<num_features_; ++f)
   {
-    feature_set_->computeValuesAndGradients(data->cost_function_input_[t],
-                                            temp_features, false, temp_gradients, state_validity);
-    validities[t] = state_validity;
-    for (unsigned int f=0; f<temp_features.size(); ++f)
+    for (int b=0; b<num_feature_basis_functions_; ++b)
     {
-      features.block(t, f*num_feature_basis_functions_, 1, num_feature_basis_functions_) =
-          temp_features[f] * feature_basis_functions_.row(t);
-//      features(t,f) = temp_features[f];
+      features.col(f*num_feature_basis_functions_ + b) =
+          (data->raw_features_.col(f).array() * feature_basis_functions_.col(b).array()).matrix();
     }
-
   }
 
+  validity = true;
+  const std::vector<int>& validities = data->validities_;
+
   // print validities
   if (rollout_id == num_rollouts_)
   {
@@ -412,6 +439,42 @@ void StompOptimizationTask::computeCosts(const Eigen::MatrixXd& features, Eigen:
   costs = weighted_feature_values.rowwise().sum();
 }
 
+void StompOptimizationTask::computeGradients(int rollout_id, std::vector<Eigen::VectorXd>& gradients)
+{
+  PerRolloutData *data = &per_rollout_data_[rollout_id];
+
+  gradients.resize(num_dimensions_);
+  for (int d=0; d<num_dimensions_; ++d)
+    gradients[d] = Eigen::VectorXd::Zero(num_time_steps_);
+
+  // weight of each raw feature in the cost at each time step, see computeFeatures() and computeCosts().
+  // The features apply it themselves, since the values of some of them depend on several time steps.
+  Eigen::VectorXd split_weights = (feature_weights_.array() / feature_variances_.array()).matrix();
+  data->feature_time_weights_ = feature_basis_functions_ *
+      Eigen::Map<const Eigen::MatrixXd>(split_weights.data(), num_feature_basis_functions_, num_features_);
+
+  // the feature set keeps scratch space per call, so the time steps are done serially
+  std::vector<double> values;
+  std::vector<Eigen::VectorXd> feature_gradients;
+  for (int t=0; t<num_time_steps_; ++t)
+  {
+    bool state_validity;
+    feature_set_->computeValuesAndGradients(data->inputs_[t], values, true, feature_gradients, state_validity);
+    for (int f=0; f<num_features_; ++f)
+    {
+      for (int d=0; d<num_dimensions_; ++d)
+        gradients[d](t) += feature_gradients[f](d);
+    }
+  }
+}
+
+int StompOptimizationTask::getFeatureColumn(const learnable_cost_function::Feature* feature) const
+{
+  std::map<const learnable_cost_function::Feature*, int>::const_iterator it = feature_columns_.find(feature);
+  if (it == feature_columns_.end())
+    return -1;
+  return it->second;
+}
 
 bool StompOptimizationTask::getPolicy(boost::shared_ptr<stomp::CovariantMovementPrimitive>& policy)
 {
@@ -480,11 +543,15 @@ void StompOptimizationTask::setMotionPlanRequest(const arm_navigation_msgs::Moti
   {
     per_rollout_data_[i].task_ = this;
     per_rollout_data_[i].cost_function_input_.resize(num_time_steps_);
+    per_rollout_data_[i].inputs_.resize(num_time_steps_);
     for (int t=0; t<num_time_steps_; ++t)
     {
       per_rollout_data_[i].cost_function_input_[t].reset(new StompCostFunctionInput(
           collision_space_, robot_model_, planning_group_));
+      per_rollout_data_[i].inputs_[t] = per_rollout_data_[i].cost_function_input_[t];
     }
+    per_rollout_data_[i].raw_features_ = Eigen::MatrixXd(num_time_steps_, num_features_);
+    per_rollout_data_[i].validities_.resize(num_time_steps_);
     per_rollout_data_[i].features_ = Eigen::MatrixXd(num_time_steps_, num_split_features_);
 
     per_rollout_data_[i].tmp_joint_angles_.resize(num_dimensions_, Eigen::VectorXd(num_time_steps_));
@@ -495,9 +562,15 @@ void StompOptimizationTask::setMotionPlanRequest(const arm_navigation_msgs::Moti
     per_rollout_data_[i].tmp_collision_point_pos_.resize(nc, v);
     per_rollout_data_[i].tmp_collision_point_vel_.resize(nc, v);
     per_rollout_data_[i].tmp_collision_point_acc_.resize(nc, v);
-    per_rollout_data_[i].fk_solver_ = planning_group_->getNewFKSolver();
+    per_rollout_data_[i].fk_solvers_.resize(num_threads_);
+    for (int j=0; j<num_threads_; ++j)
+      per_rollout_data_[i].fk_solvers_[j] = planning_group_->getNewFKSolver();
   }
 
+  fk_cache_statistics_.num_time_steps_ = 0;
+  fk_cache_statistics_.num_cached_ = 0;
+  fk_cache_statistics_.num_incremental_ = 0;
+
   // create the derivative costs
   std::vector<Eigen::MatrixXd> derivative_costs(num_dimensions_,
                                                 Eigen::MatrixXd::Zero(num_time_steps_ + 2*stomp::TRAJECTORY_PADDING, stomp::NUM_DIFF_RULES));
@@ -629,6 +702,11 @@ void StompOptimizationTask::setInitialTrajectory(const std::vector<sensor_msgs::
   policy_->setParameters(params);
 }
 
+void StompOptimizationTask::getFKCacheStatistics(FKCacheStatistics& statistics) const
+{
+  statistics = fk_cache_statistics_;
+}
+
 void StompOptimizationTask::getRolloutData(PerRolloutData& noiseless_rollout, std::vector<PerRolloutData>& noisy_rollouts)
 {
   noisy_rollouts.resize(num_rollouts_);
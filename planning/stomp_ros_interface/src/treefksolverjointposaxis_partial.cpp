@@ -120,6 +120,7 @@ int TreeFkSolverJointPosAxisPartial::JntToCartFull(const JntArray& q_in, std::ve
   }
 
   segment_frames_ = segment_frames;
+  full_fk_done_ = true;
 
   return 0;
 }
@@ -158,6 +159,53 @@ int TreeFkSolverJointPosAxisPartial::JntToCartPartial(const JntArray& q_in, std:
   return 0;
 }
 
+int TreeFkSolverJointPosAxisPartial::JntToCartIncremental(const JntArray& q_in, const JntArray& q_previous, std::vector<Vector>& joint_pos,
+                                                          std::vector<Vector>& joint_axis, std::vector<Frame>& segment_frames)
+{
+  // the evaluation order is only known after a full FK
+  if (!full_fk_done_)
+    return -1;
+
+  segment_changed_.assign(num_segments_, 0);
+
+  // the evaluation order lists parents before their children, so a segment is recomputed if its own joint
+  // changed or its parent frame was recomputed
+  int num_computed = 0;
+  for (size_t i=0; i<segment_evaluation_order_.size(); ++i)
+  {
+    int segment_nr = segment_evaluation_order_[i];
+    int parent_frame_nr = segment_parent_frame_nr_[segment_nr];
+    const TreeElement* parent_segment = segment_parent_[segment_nr];
+    double jnt_p = 0;
+    bool changed = (parent_frame_nr >= 0 && segment_changed_[parent_frame_nr]);
+    if (parent_segment->segment.getJoint().getType() != Joint::None)
+    {
+      jnt_p = q_in(parent_segment->q_nr);
+      if (jnt_p != q_previous(parent_segment->q_nr))
+        changed = true;
+    }
+    if (!changed)
+      continue;
+
+    segment_frames[segment_nr] = segment_frames[parent_frame_nr] * parent_segment->segment.pose(jnt_p);
+    segment_changed_[segment_nr] = 1;
+    ++num_computed;
+  }
+
+  // joint positions and axes of the joints whose parent frames moved:
+  for (int i=0; i<num_joints_; ++i)
+  {
+    if (joint_calc_pos_axis_[i] && segment_changed_[joint_parent_frame_nr_[i]])
+    {
+      Frame& frame = segment_frames[joint_parent_frame_nr_[i]];
+      const TreeElement* parent_segment = joint_parent_[i];
+      joint_pos[i] = frame * parent_segment->segment.getJoint().JointOrigin();
+      joint_axis[i] = frame.M * parent_segment->segment.getJoint().JointAxis();
+    }
+  }
+  return num_computed;
+}
+
 int TreeFkSolverJointPosAxisPartial::treeRecursiveFK(const JntArray& q_in, std::vector<Vector>& joint_pos, std::vector<Vector>& joint_axis, std::vector<Frame>& segment_frames,
     const Frame& previous_frame, const SegmentMap::const_iterator this_segment, int segment_nr, int parent_segment_nr, bool active)
 {
@@ -0,0 +1,148 @@
+/*
+ * feature_benchmark.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <ros/ros.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <learnable_cost_function/feature_set.h>
+#include <stomp_ros_interface/stomp_optimization_task.h>
+#include <stomp_ros_interface/cost_features/collision_feature.h>
+#include <stomp_ros_interface/cost_features/joint_vel_acc_feature.h>
+#include <stomp_ros_interface/cost_features/cartesian_vel_acc_feature.h>
+#include <stomp_ros_interface/cost_features/cartesian_orientation_feature.h>
+
+using namespace stomp_ros_interface;
+
+static const int NUM_TIME_STEPS = 100;
+static const int NUM_ROLLOUTS = 20;
+static const int NUM_ITERATIONS = 20;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "feature_benchmark");
+  ros::NodeHandle node_handle("~");
+  ros::NodeHandle task_node_handle(node_handle, "task");
+
+  std::string group_name;
+  int num_threads;
+  node_handle.param("group_name", group_name, std::string("R_ARM"));
+  node_handle.param("num_threads", num_threads, 4);
+
+  // no planning scene is set: the distance field stays empty, which does not change the
+  // amount of work done per collision point
+  StompOptimizationTask task(task_node_handle, group_name);
+  task.initialize(num_threads, NUM_ROLLOUTS);
+
+  boost::shared_ptr<stomp::CovariantMovementPrimitive> policy;
+  std::vector<boost::shared_ptr<learnable_cost_function::Feature> > features;
+  features.push_back(boost::shared_ptr<learnable_cost_function::Feature>(new CollisionFeature()));
+  features.push_back(boost::shared_ptr<learnable_cost_function::Feature>(new JointVelAccFeature(7)));
+  features.push_back(boost::shared_ptr<learnable_cost_function::Feature>(new CartesianVelAccFeature()));
+  features.push_back(boost::shared_ptr<learnable_cost_function::Feature>(new CartesianOrientationFeature()));
+  task.setFeatures(features);
+
+  arm_navigation_msgs::MotionPlanRequest request;
+  request.group_name = group_name;
+  request.expected_path_dt = ros::Duration(0.05);
+  request.expected_path_duration = ros::Duration(0.05 * (NUM_TIME_STEPS - 1));
+  task.setMotionPlanRequest(request);
+  int num_dimensions = 0;
+  task.getPolicy(policy);
+  policy->getNumDimensions(num_dimensions);
+  if (num_dimensions != 7)
+  {
+    ROS_ERROR("Planning group %s has %d joints, the benchmark needs a 7-DOF arm", group_name.c_str(), num_dimensions);
+    return -1;
+  }
+
+  // smooth random rollouts
+  srand48(0);
+  std::vector<std::vector<Eigen::VectorXd> > rollouts(NUM_ROLLOUTS,
+                                                      std::vector<Eigen::VectorXd>(num_dimensions, Eigen::VectorXd(NUM_TIME_STEPS)));
+  for (int r=0; r<NUM_ROLLOUTS; ++r)
+  {
+    for (int d=0; d<num_dimensions; ++d)
+    {
+      double amplitude = drand48() - 0.5;
+      double frequency = 1.0 + 2.0 * drand48();
+      for (int t=0; t<NUM_TIME_STEPS; ++t)
+        rollouts[r][d](t) = amplitude * sin(M_PI * frequency * t / (NUM_TIME_STEPS - 1.0));
+    }
+  }
+
+  // full rollout evaluation: forward kinematics, differentiation and batched features
+  Eigen::VectorXd costs;
+  Eigen::MatrixXd weighted_feature_values;
+  std::vector<Eigen::VectorXd> gradients;
+  bool validity;
+  double start = now();
+  for (int i=0; i<NUM_ITERATIONS; ++i)
+    for (int r=0; r<NUM_ROLLOUTS; ++r)
+      task.execute(rollouts[r], rollouts[r], costs, weighted_feature_values, i, r, 0, false, gradients, validity);
+  const double execute_time = (now() - start) / NUM_ITERATIONS;
+
+  // the features alone, on the inputs prepared by the last iteration
+  StompOptimizationTask::PerRolloutData noiseless_rollout;
+  std::vector<StompOptimizationTask::PerRolloutData> noisy_rollouts;
+  task.getRolloutData(noiseless_rollout, noisy_rollouts);
+
+  learnable_cost_function::FeatureSet feature_set;
+  for (unsigned int f=0; f<features.size(); ++f)
+    feature_set.addFeature(features[f]);
+  int num_values = feature_set.getNumValues();
+
+  Eigen::MatrixXd per_step_values(NUM_TIME_STEPS, num_values);
+  std::vector<double> values;
+  std::vector<Eigen::VectorXd> value_gradients;
+  bool state_validity;
+  start = now();
+  for (int i=0; i<NUM_ITERATIONS; ++i)
+  {
+    for (int r=0; r<NUM_ROLLOUTS; ++r)
+    {
+      for (int t=0; t<NUM_TIME_STEPS; ++t)
+      {
+        feature_set.computeValuesAndGradients(noisy_rollouts[r].inputs_[t], values, false, value_gradients, state_validity);
+        for (int v=0; v<num_values; ++v)
+          per_step_values(t, v) = values[v];
+      }
+    }
+  }
+  const double per_step_time = (now() - start) / NUM_ITERATIONS;
+
+  Eigen::MatrixXd batch_values(NUM_TIME_STEPS, num_values);
+  std::vector<int> validities(NUM_TIME_STEPS);
+  start = now();
+  for (int i=0; i<NUM_ITERATIONS; ++i)
+    for (int r=0; r<NUM_ROLLOUTS; ++r)
+      feature_set.computeValues(&noisy_rollouts[r].inputs_[0], NUM_TIME_STEPS, batch_values, 0, 0, &validities[0]);
+  const double batch_time = (now() - start) / NUM_ITERATIONS;
+
+  Eigen::MatrixXd threaded_values(NUM_TIME_STEPS, num_values);
+  start = now();
+  for (int i=0; i<NUM_ITERATIONS; ++i)
+    for (int r=0; r<NUM_ROLLOUTS; ++r)
+      feature_set.computeValues(&noisy_rollouts[r].inputs_[0], NUM_TIME_STEPS, threaded_values, 0, 0, &validities[0], num_threads);
+  const double threaded_time = (now() - start) / NUM_ITERATIONS;
+
+  printf("%d joints, %d time steps, %d rollouts, %d feature values\n", num_dimensions, NUM_TIME_STEPS, NUM_ROLLOUTS, num_values);
+  printf("execute (fk + features)  : %8.3f ms\n", 1e3 * execute_time);
+  printf("per time step features   : %8.3f ms\n", 1e3 * per_step_time);
+  printf("batched features         : %8.3f ms (max error %g)\n", 1e3 * batch_time,
+         (batch_values - per_step_values).cwiseAbs().maxCoeff());
+  printf("batched, %2d threads      : %8.3f ms (max error %g)\n", num_threads, 1e3 * threaded_time,
+         (threaded_values - per_step_values).cwiseAbs().maxCoeff());
+  return 0;
+}
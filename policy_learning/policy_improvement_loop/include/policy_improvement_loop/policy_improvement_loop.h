@@ -40,6 +40,7 @@
 #include <ros/ros.h>
 #include <rosbag/bag.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 
 #include <task_manager/task_manager.h>
 #include <task_manager/task.h>
@@ -73,6 +74,7 @@ private:
     int num_reused_rollouts_;
     int num_time_steps_;
     int num_dimensions_;
+    int num_threads_;
 
     bool write_to_file_;
     bool use_cumulative_costs_;
@@ -99,14 +101,32 @@ private:
 
     // temporary variables
     Eigen::VectorXd tmp_rollout_cost_;
+    std::vector<Eigen::VectorXd> tmp_rollout_costs_; /**< [num_rollouts] num_time_steps */
+    std::vector<Eigen::VectorXd> tmp_parameters_;
+
+    /** appends the statistics of the previous iteration to the statistics bag file */
+    boost::shared_ptr<boost::thread> statistics_writer_thread_;
+    /** result of the last statistics writer, only accessed after joining it */
+    bool statistics_written_;
 
     bool readParameters();
 
     int policy_iteration_counter_;
     bool readPolicy(const int iteration_number);
     bool writePolicy(const int iteration_number, bool is_rollout = false, int rollout_id = 0);
+    bool writeRolloutPolicies(const int iteration_number);
+
+    bool executeRollouts(const int iteration_number);
 
     bool writePolicyImprovementStatistics(const policy_improvement_loop::PolicyImprovementStatistics& stats_msg);
+    /** runs writePolicyImprovementStatistics in the statistics writer thread and stores its result,
+     * stats_msg is the copy held by the thread's boost::bind */
+    void writeStatistics(const policy_improvement_loop::PolicyImprovementStatistics& stats_msg);
+    /**
+     * joins the statistics writer thread
+     * @return false if the statistics could not be written
+     */
+    bool waitForStatisticsWriter();
 
     std::string getFileName(int iteration_number);
 };
@@ -36,6 +36,7 @@
 
 // system includes
 #include <cassert>
+#include <omp.h>
 
 // ros includes
 #include <ros/package.h>
@@ -55,13 +56,17 @@ namespace policy_improvement_loop
 const std::string PI_STATISTICS_TOPIC_NAME = std::string("policy_improvement_statistics");
 
 PolicyImprovementLoop::PolicyImprovementLoop()
-    : initialized_(false), policy_iteration_counter_(0)
+    : initialized_(false), num_threads_(1), statistics_written_(true), policy_iteration_counter_(0)
 {
   ROS_VERIFY(task_manager_.initialize());
 }
 
 PolicyImprovementLoop::~PolicyImprovementLoop()
 {
+  if (!waitForStatisticsWriter())
+  {
+    ROS_ERROR("Could not write policy improvement statistics of the last iteration.");
+  }
   task_.reset(); // make sure that the task is deleted before the task_manager_
 }
 
@@ -96,6 +101,13 @@ bool PolicyImprovementLoop::initialize(ros::NodeHandle& node_handle, boost::shar
 
     task_ = task;
     ROS_VERIFY(task_->initialize(node_handle_));
+    if (!task_->setNumThreads(num_threads_))
+    {
+        ROS_WARN("Task cannot be executed from %i threads, executing rollouts sequentially.", num_threads_);
+        num_threads_ = 1;
+        ROS_VERIFY(task_->setNumThreads(num_threads_));
+    }
+    ROS_INFO("Executing rollouts with %i threads.", num_threads_);
     ROS_VERIFY(task_->getPolicy(policy_));
     ROS_VERIFY(policy_->getNumTimeSteps(num_time_steps_));
     ROS_VERIFY(task_->getControlCostWeight(control_cost_weight_));
@@ -131,6 +143,11 @@ bool PolicyImprovementLoop::readParameters()
     node_handle_.param("filename_prefix", filename_prefix_, std::string("/tmp/pi"));
     node_handle_.param("use_cumulative_costs", use_cumulative_costs_, true);
     node_handle_.param("reevaluate_reused_rollouts", reevaluate_reused_rollouts_, false);
+    node_handle_.param("num_threads", num_threads_, 1); // 0 uses all available threads
+    if (num_threads_ <= 0)
+    {
+        num_threads_ = omp_get_max_threads();
+    }
     return true;
 }
 
@@ -213,10 +230,50 @@ bool PolicyImprovementLoop::writePolicy(const int iteration_number, bool is_roll
     return true;
 }
 
+bool PolicyImprovementLoop::writeRolloutPolicies(const int iteration_number)
+{
+    // the policy holds the parameters of one rollout at a time, the current ones are restored afterwards
+    ROS_VERIFY(policy_->getParameters(tmp_parameters_));
+    for (int r=0; r<int(rollouts_.size()); ++r)
+    {
+        ROS_VERIFY(policy_->setParameters(rollouts_[r]));
+        ROS_VERIFY(writePolicy(iteration_number, true, r));
+    }
+    ROS_VERIFY(policy_->setParameters(tmp_parameters_));
+    return true;
+}
+
+bool PolicyImprovementLoop::executeRollouts(const int iteration_number)
+{
+    const int num_rollouts = int(rollouts_.size());
+    tmp_rollout_costs_.resize(num_rollouts, Eigen::VectorXd::Zero(num_time_steps_));
+    std::vector<int> succeeded(num_rollouts, 0);
+
+    const int num_rollout_threads = std::max(1, std::min(num_threads_, num_rollouts));
+#pragma omp parallel for num_threads(num_rollout_threads) schedule(dynamic)
+    for (int r=0; r<num_rollouts; ++r)
+    {
+        succeeded[r] = task_->execute(rollouts_[r], tmp_rollout_costs_[r], rollout_terminal_costs_[r], iteration_number, omp_get_thread_num());
+    }
+
+    for (int r=0; r<num_rollouts; ++r)
+    {
+        if (!succeeded[r])
+        {
+            ROS_ERROR("Could not execute rollout %d.", r+1);
+            return false;
+        }
+        rollout_costs_.row(r) = tmp_rollout_costs_[r].transpose();
+        ROS_INFO("Rollout %d, cost = %lf", r+1, tmp_rollout_costs_[r].sum() + rollout_terminal_costs_[r]);
+    }
+    return true;
+}
+
 bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
 {
     ROS_ASSERT(initialized_);
     policy_iteration_counter_++;
+    ros::WallTime start_time = ros::WallTime::now();
 
     if (write_to_file_)
     {
@@ -237,18 +294,18 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     // get rollouts and execute them
     ROS_VERIFY(policy_improvement_.getRollouts(rollouts_, noise));
 
-    for (int r=0; r<int(rollouts_.size()); ++r)
-    {
-        ROS_VERIFY(task_->execute(rollouts_[r], tmp_rollout_cost_, rollout_terminal_costs_[r], iteration_number));
-        rollout_costs_.row(r) = tmp_rollout_cost_.transpose();
-        ROS_INFO("Rollout %d, cost = %lf", r+1, tmp_rollout_cost_.sum() + rollout_terminal_costs_[r]);
+    ros::WallTime rollout_start_time = ros::WallTime::now();
+    ROS_VERIFY(executeRollouts(iteration_number));
+    ros::WallTime write_rollouts_start_time = ros::WallTime::now();
+    stats_msg.rollout_duration = (write_rollouts_start_time - rollout_start_time).toSec();
 
-        if (write_to_file_)
-        {
-            // store updated policy to disc
-            ROS_VERIFY(writePolicy(iteration_number, true, r));
-        }
+    if (write_to_file_)
+    {
+        // store rollout policies to disc once all rollouts are done
+        ROS_VERIFY(writeRolloutPolicies(iteration_number));
     }
+    ros::WallTime update_start_time = ros::WallTime::now();
+    stats_msg.write_rollouts_duration = (update_start_time - write_rollouts_start_time).toSec();
 
     // TODO: fix this std::vector<>
     std::vector<double> all_costs;
@@ -264,11 +321,14 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     ROS_VERIFY(policy_improvement_.improvePolicy(parameter_updates_));
     ROS_VERIFY(policy_improvement_.getTimeStepWeights(time_step_weights_));
     ROS_VERIFY(policy_->updateParameters(parameter_updates_, time_step_weights_));
+    ros::WallTime noiseless_start_time = ros::WallTime::now();
+    stats_msg.update_duration = (noiseless_start_time - update_start_time).toSec();
 
     // get a noise-less rollout to check the cost
     ROS_VERIFY(policy_->getParameters(parameters_));
     double terminal_cost=0.0;
-    ROS_VERIFY(task_->execute(parameters_, tmp_rollout_cost_, terminal_cost, iteration_number));
+    ROS_VERIFY(task_->execute(parameters_, tmp_rollout_cost_, terminal_cost, iteration_number, 0));
+    stats_msg.noiseless_rollout_duration = (ros::WallTime::now() - noiseless_start_time).toSec();
     stats_msg.noiseless_cost = tmp_rollout_cost_.sum() + terminal_cost;
     ROS_INFO("Noiseless cost = %lf", stats_msg.noiseless_cost);
     stats_msg.iteration = iteration_number;
@@ -288,7 +348,17 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     {
         // store updated policy to disc
         ROS_VERIFY(writePolicy(iteration_number));
-        ROS_VERIFY(writePolicyImprovementStatistics(stats_msg));
+    }
+    stats_msg.total_duration = (ros::WallTime::now() - start_time).toSec();
+    ROS_INFO("Iteration %i took %.3f s: rollouts %.3f s, writing rollouts %.3f s, update %.3f s, noiseless rollout %.3f s.",
+             iteration_number, stats_msg.total_duration, stats_msg.rollout_duration, stats_msg.write_rollouts_duration,
+             stats_msg.update_duration, stats_msg.noiseless_rollout_duration);
+
+    if (write_to_file_)
+    {
+        // the statistics are appended to the bag file while the next iteration runs, boost::bind copies stats_msg once
+        ROS_VERIFY(waitForStatisticsWriter());
+        statistics_writer_thread_.reset(new boost::thread(boost::bind(&PolicyImprovementLoop::writeStatistics, this, stats_msg)));
     }
 
     ROS_INFO_STREAM(stats_msg);
@@ -297,6 +367,23 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     return true;
 }
 
+bool PolicyImprovementLoop::waitForStatisticsWriter()
+{
+    if (statistics_writer_thread_)
+    {
+        statistics_writer_thread_->join();
+        statistics_writer_thread_.reset();
+    }
+    const bool statistics_written = statistics_written_;
+    statistics_written_ = true;
+    return statistics_written;
+}
+
+void PolicyImprovementLoop::writeStatistics(const policy_improvement_loop::PolicyImprovementStatistics& stats_msg)
+{
+    statistics_written_ = writePolicyImprovementStatistics(stats_msg);
+}
+
 bool PolicyImprovementLoop::writePolicyImprovementStatistics(const policy_improvement_loop::PolicyImprovementStatistics& stats_msg)
 {
 
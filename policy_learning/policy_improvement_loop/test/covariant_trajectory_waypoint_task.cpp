@@ -60,7 +60,7 @@ bool CovariantTrajectoryWaypointTask::initialize(ros::NodeHandle& node_handle)
     node_handle_ = node_handle;
     //num_time_steps_ = 50;
 
-    evaluation_count_ = 0;
+    evaluation_counts_.assign(1, 0);
 
     readParameters();
 
@@ -72,7 +72,19 @@ bool CovariantTrajectoryWaypointTask::initialize(ros::NodeHandle& node_handle)
     return true;
 }
 
+bool CovariantTrajectoryWaypointTask::setNumThreads(const int num_threads)
+{
+    evaluation_counts_.assign(num_threads, 0);
+    return true;
+}
+
 bool CovariantTrajectoryWaypointTask::execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, double& terminal_cost, const int iteration_number)
+{
+    return execute(parameters, costs, terminal_cost, iteration_number, 0);
+}
+
+bool CovariantTrajectoryWaypointTask::execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, double& terminal_cost, const int iteration_number,
+                                              const int thread_id)
 {
     terminal_cost = 0.0;
     int waypoint_time_index = int(double(num_time_steps_) * (waypoint_time_ / movement_time_));
@@ -84,8 +96,8 @@ bool CovariantTrajectoryWaypointTask::execute(std::vector<Eigen::VectorXd>& para
         terminal_cost += waypoint_cost_weight_ * dist;
         //costs[waypoint_time_index] += waypoint_cost_weight_ * dist;
     }
-    ++evaluation_count_;
-    //printf("Evaluations: %d\n", evaluation_count_);
+    ++evaluation_counts_[thread_id];
+    //printf("Evaluations: %d\n", evaluation_counts_[thread_id]);
     return true;
 }
 
@@ -64,6 +64,25 @@ public:
      */
     bool execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, double& terminal_cost, const int iteration_number = 0);
 
+    /**
+     * The task only reads its parameters during execution, so it can be executed from any number of threads
+     * @param num_threads
+     * @return
+     */
+    bool setNumThreads(const int num_threads);
+
+    /**
+     * Thread-aware version of execute
+     * @param parameters [num_dimensions] num_parameters - policy parameters to execute
+     * @param costs Vector of num_time_steps, state space cost per timestep (do not include control costs)
+     * @param terminal_cost
+     * @param iteration_number
+     * @param thread_id
+     * @return
+     */
+    bool execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, double& terminal_cost, const int iteration_number,
+                 const int thread_id);
+
     /**
      * Get the Policy object of this Task
      * @param policy
@@ -100,7 +119,7 @@ private:
     double waypoint_cost_weight_;
     double control_cost_weight_;
 
-    int evaluation_count_;
+    std::vector<int> evaluation_counts_; /**< [num_threads] */
 
     void readParameters();
 };
@@ -68,6 +68,32 @@ public:
      */
     virtual bool execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, double& terminal_cost, const int iteration_number) = 0;
 
+    /**
+     * Prepares the task to be executed from several threads at once, e.g. by creating a copy of its simulation for each thread.
+     * Tasks that can only be executed sequentially keep this default implementation.
+     * @param num_threads Number of threads that will call execute concurrently
+     * @return False if the task cannot be executed from num_threads threads
+     */
+    virtual bool setNumThreads(const int num_threads)
+    {
+        return (num_threads == 1);
+    }
+
+    /**
+     * Thread-aware version of execute. Concurrent calls always have different thread ids.
+     * @param parameters [num_dimensions] num_parameters - policy parameters to execute
+     * @param costs Vector of num_time_steps, state space cost per timestep (do not include control costs)
+     * @param terminal_cost
+     * @param iteration_number
+     * @param thread_id in [0, num_threads) as set with setNumThreads
+     * @return
+     */
+    virtual bool execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, double& terminal_cost, const int iteration_number,
+                         const int thread_id)
+    {
+        return execute(parameters, costs, terminal_cost, iteration_number);
+    }
+
     /**
      * Get the Policy object of this Task
      * @param policy
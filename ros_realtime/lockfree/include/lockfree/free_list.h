@@ -40,7 +40,12 @@
 #include <ros/atomic.h>
 
 #if FREE_LIST_DEBUG
+#include <ros/time.h>
 #include <boost/thread.hpp>
+#include <boost/scoped_array.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
 #endif
 
 #define ROSRT_CACHELINE_SIZE 64 // TODO: actually determine this.
@@ -63,6 +68,14 @@ namespace lockfree
  *
  * Indices are stored as 32-bits with a 64-bit head index whose upper 32-bits are tagged
  * to avoid ABA problems
+ *
+ * Optionally, each CPU gets a "magazine" of free blocks in front of the shared list, in the style of
+ * a per-CPU slab cache.  allocate() and free() then only touch the cache line of their own CPU's magazine,
+ * and the shared head is only updated to refill or drain half a magazine at a time, with a single CAS.
+ * A magazine is used under a try-lock, so a thread that is preempted while using it makes the others fall
+ * back to the shared list, rather than wait.  The blocks cached in such a magazine are unavailable until
+ * that thread runs again, so a pool that must never fail to allocate needs magazine_size blocks of slack
+ * per CPU.
  */
 class FreeList
 {
@@ -75,16 +88,18 @@ public:
    * \brief Constructor with initialization
    * \param block_size The size of each block allocate() will return
    * \param block_count The number of blocks to allocate
+   * \param magazine_size The number of free blocks cached per CPU, 0 to disable the magazines
    */
-  FreeList(uint32_t block_size, uint32_t block_count);
+  FreeList(uint32_t block_size, uint32_t block_count, uint32_t magazine_size = 0);
   ~FreeList();
 
   /**
    * \brief Initialize this FreeList.  Only use if you used to default constructor
    * \param block_size The size of each block allocate() will return
    * \param block_count The number of blocks to allocate
+   * \param magazine_size The number of free blocks cached per CPU, 0 to disable the magazines
    */
-  void initialize(uint32_t block_size, uint32_t block_count);
+  void initialize(uint32_t block_size, uint32_t block_count, uint32_t magazine_size = 0);
 
   /**
    * \brief Allocate a single block from this FreeList
@@ -105,6 +120,8 @@ public:
 
   /**
    * \brief Returns whether or not this FreeList currently has any outstanding allocations
+   *
+   * Free blocks cached in the per-CPU magazines do not count as outstanding.
    */
   bool hasOutstandingAllocations();
 
@@ -188,15 +205,54 @@ private:
     val = ((uint64_t)getTag(val) << 32) | v;
   }
 
+  struct Magazine
+  {
+    ros::atomic_uint32_t locked;
+    ros::atomic_uint32_t count;
+  };
+
+  inline Magazine* getMagazine(uint32_t i)
+  {
+    return reinterpret_cast<Magazine*>(magazines_ + (i * magazine_stride_));
+  }
+
+  // the block indices of a magazine follow it
+  inline uint32_t* getMagazineBlocks(Magazine* magazine)
+  {
+    return reinterpret_cast<uint32_t*>(magazine + 1);
+  }
+
+  inline uint32_t getIndex(void const* mem)
+  {
+    return (static_cast<uint8_t const*>(mem) - blocks_) / block_size_;
+  }
+
+  void* allocateFromList();
+  void freeToList(void const* mem);
+  uint32_t allocateBatchFromList(uint32_t* indices, uint32_t count);
+  void freeBatchToList(uint32_t const* indices, uint32_t count);
+
+  Magazine* lockMagazine(uint32_t i);
+  void unlockMagazine(Magazine* magazine);
+  void* allocateFromMagazine();
+  bool freeToMagazine(void const* mem);
+  void* stealFromMagazines();
+
   uint8_t* blocks_;
   ros::atomic_uint32_t* next_;
   ros::atomic_uint64_t head_;
-  ros::atomic_uint32_t alloc_count_;
+  ros::atomic_uint32_t alloc_count_;   /**< blocks not in the shared list, including the ones in magazines */
 
   uint32_t block_size_;
   uint32_t block_count_;
 
+  uint8_t* magazines_;
+  uint32_t magazine_size_;
+  uint32_t magazine_stride_;
+  uint32_t magazine_count_;
+
 #if FREE_LIST_DEBUG
+public:
   struct Debug
   {
     enum
@@ -226,6 +282,8 @@ private:
     std::string thread;
   };
 
+private:
+
   void initDebug()
   {
     if (!debug_.get())
@@ -238,6 +296,9 @@ private:
   }
 
   boost::thread_specific_ptr<Debug> debug_;
+
+  /**< 1 for the blocks handed out by allocate(), catches double frees that would otherwise end up in a magazine */
+  boost::scoped_array<ros::atomic_uint32_t> allocated_;
 #endif
 };
 
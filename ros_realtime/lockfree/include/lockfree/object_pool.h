@@ -234,11 +234,12 @@ public:
    * \brief Constructor with initialization.
    * \param count The number of objects in the pool
    * \param tmpl The object template to use to construct the objects
+   * \param magazine_size The number of free objects cached per CPU, 0 to disable the cache.  See FreeList.
    */
-  ObjectPool(uint32_t count, const T& tmpl)
+  ObjectPool(uint32_t count, const T& tmpl, uint32_t magazine_size = 0)
   : initialized_(false)
   {
-    initialize(count, tmpl);
+    initialize(count, tmpl, magazine_size);
   }
 
   ~ObjectPool()
@@ -259,13 +260,14 @@ public:
    * \brief initialize the pool.  Only use with the default constructor
    * \param count The number of objects in the pool
    * \param tmpl The object template to use to construct the objects
+   * \param magazine_size The number of free objects cached per CPU, 0 to disable the cache.  See FreeList.
    */
-  void initialize(uint32_t count, const T& tmpl)
+  void initialize(uint32_t count, const T& tmpl, uint32_t magazine_size = 0)
   {
     ROS_ASSERT(!initialized_);
-    freelist_.initialize(sizeof(T), count);
+    freelist_.initialize(sizeof(T), count, magazine_size);
     freelist_.template constructAll<T>(tmpl);
-    sp_storage_freelist_.initialize(sizeof(detail::SPStorage), count);
+    sp_storage_freelist_.initialize(sizeof(detail::SPStorage), count, magazine_size);
     sp_storage_freelist_.template constructAll<detail::SPStorage>();
     initialized_ = true;
   }
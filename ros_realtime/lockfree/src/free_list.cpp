@@ -36,6 +36,9 @@
 #include <lockfree/free_list.h>
 #include <allocators/aligned.h>
 
+#include <unistd.h>
+#include <sched.h>
+
 using namespace ros;
 
 namespace lockfree
@@ -46,16 +49,24 @@ FreeList::FreeList()
 , next_(0)
 , block_size_(0)
 , block_count_(0)
+, magazines_(0)
+, magazine_size_(0)
+, magazine_stride_(0)
+, magazine_count_(0)
 {
 }
 
-FreeList::FreeList(uint32_t block_size, uint32_t block_count)
+FreeList::FreeList(uint32_t block_size, uint32_t block_count, uint32_t magazine_size)
 : blocks_(0)
 , next_(0)
 , block_size_(0)
 , block_count_(0)
+, magazines_(0)
+, magazine_size_(0)
+, magazine_stride_(0)
+, magazine_count_(0)
 {
-  initialize(block_size, block_count);
+  initialize(block_size, block_count, magazine_size);
 }
 
 FreeList::~FreeList()
@@ -65,11 +76,17 @@ FreeList::~FreeList()
     next_[i].~atomic_uint32_t();
   }
 
+  for (uint32_t i = 0; i < magazine_count_; ++i)
+  {
+    getMagazine(i)->~Magazine();
+  }
+
   allocators::alignedFree(blocks_);
   allocators::alignedFree(next_);
+  allocators::alignedFree(magazines_);
 }
 
-void FreeList::initialize(uint32_t block_size, uint32_t block_count)
+void FreeList::initialize(uint32_t block_size, uint32_t block_count, uint32_t magazine_size)
 {
   ROS_ASSERT(!blocks_);
   ROS_ASSERT(!next_);
@@ -85,6 +102,14 @@ void FreeList::initialize(uint32_t block_size, uint32_t block_count)
 
   memset(blocks_, 0xCD, block_size * block_count);
 
+#if FREE_LIST_DEBUG
+  allocated_.reset(new atomic_uint32_t[block_count]);
+  for (uint32_t i = 0; i < block_count; ++i)
+  {
+    allocated_[i].store(0);
+  }
+#endif
+
   for (uint32_t i = 0; i < block_count_; ++i)
   {
     new (next_ + i) atomic_uint32_t();
@@ -98,14 +123,349 @@ void FreeList::initialize(uint32_t block_size, uint32_t block_count)
       next_[i].store(i + 1);
     }
   }
+
+  if (magazine_size > 0)
+  {
+    // one magazine per CPU, each on its own cache lines
+    long cpu_count = sysconf(_SC_NPROCESSORS_CONF);
+    magazine_count_ = cpu_count > 0 ? cpu_count : 1;
+    magazine_size_ = magazine_size;
+    magazine_stride_ = sizeof(Magazine) + (sizeof(uint32_t) * magazine_size);
+    magazine_stride_ = ((magazine_stride_ + ROSRT_CACHELINE_SIZE - 1) / ROSRT_CACHELINE_SIZE) * ROSRT_CACHELINE_SIZE;
+    magazines_ = (uint8_t*)allocators::alignedMalloc(magazine_stride_ * magazine_count_, ROSRT_CACHELINE_SIZE);
+
+    for (uint32_t i = 0; i < magazine_count_; ++i)
+    {
+      Magazine* magazine = new (getMagazine(i)) Magazine();
+      magazine->locked.store(0);
+      magazine->count.store(0);
+    }
+  }
 }
 
 bool FreeList::hasOutstandingAllocations()
 {
-  return alloc_count_.load() == 0;
+  // alloc_count_ has to be read first: freeToMagazine() takes drained blocks out of the count of a magazine
+  // before it returns them to the list, so blocks in transit are seen as outstanding, never as free twice
+  uint32_t outstanding = alloc_count_.load();
+  for (uint32_t i = 0; i < magazine_count_; ++i)
+  {
+    outstanding -= getMagazine(i)->count.load();
+  }
+
+  return outstanding == 0;
 }
 
 void* FreeList::allocate()
+{
+  void* mem = 0;
+  if (magazine_size_ > 0)
+  {
+    mem = allocateFromMagazine();
+    if (!mem)
+    {
+      mem = allocateFromList();
+    }
+
+    if (!mem)
+    {
+      // The list is empty, but the other CPUs' magazines may still have free blocks
+      mem = stealFromMagazines();
+    }
+  }
+  else
+  {
+    mem = allocateFromList();
+  }
+
+#if FREE_LIST_DEBUG
+  if (mem)
+  {
+    uint32_t was_allocated = allocated_[getIndex(mem)].exchange(1);
+    ROS_ASSERT_MSG(was_allocated == 0, "Block %p handed out twice", mem);
+  }
+#endif
+
+  return mem;
+}
+
+void FreeList::free(void const* mem)
+{
+  if (!mem)
+  {
+    return;
+  }
+
+  ROS_ASSERT(((static_cast<uint8_t const*>(mem) - blocks_) % block_size_) == 0);
+  ROS_ASSERT(owns(mem));
+
+#if FREE_LIST_DEBUG
+  uint32_t was_allocated = allocated_[getIndex(mem)].exchange(0);
+  ROS_ASSERT_MSG(was_allocated == 1, "Block %p freed twice", mem);
+#endif
+
+  if (magazine_size_ > 0 && freeToMagazine(mem))
+  {
+    return;
+  }
+
+  freeToList(mem);
+}
+
+FreeList::Magazine* FreeList::lockMagazine(uint32_t i)
+{
+  Magazine* magazine = getMagazine(i);
+  if (magazine->locked.exchange(1, memory_order_acquire) != 0)
+  {
+    return 0;
+  }
+
+  return magazine;
+}
+
+void FreeList::unlockMagazine(Magazine* magazine)
+{
+  magazine->locked.store(0, memory_order_release);
+}
+
+static uint32_t getCurrentCPU()
+{
+#if defined(__linux__)
+  int cpu = sched_getcpu();
+  return cpu >= 0 ? cpu : 0;
+#else
+  return 0;
+#endif
+}
+
+void* FreeList::allocateFromMagazine()
+{
+  Magazine* magazine = lockMagazine(getCurrentCPU() % magazine_count_);
+  if (!magazine)
+  {
+    return 0;
+  }
+
+  uint32_t* blocks = getMagazineBlocks(magazine);
+  uint32_t count = magazine->count.load(memory_order_relaxed);
+  if (count == 0)
+  {
+    // refill half of the magazine, leaving room for frees
+    count = allocateBatchFromList(blocks, (magazine_size_ + 1) / 2);
+    magazine->count.store(count);
+  }
+
+  void* mem = 0;
+  if (count > 0)
+  {
+    --count;
+    magazine->count.store(count);
+    mem = static_cast<void*>(blocks_ + (block_size_ * blocks[count]));
+  }
+
+  unlockMagazine(magazine);
+  return mem;
+}
+
+bool FreeList::freeToMagazine(void const* mem)
+{
+  Magazine* magazine = lockMagazine(getCurrentCPU() % magazine_count_);
+  if (!magazine)
+  {
+    return false;
+  }
+
+  uint32_t* blocks = getMagazineBlocks(magazine);
+  uint32_t count = magazine->count.load(memory_order_relaxed);
+  if (count == magazine_size_)
+  {
+    // drain the older half of the magazine, the recently freed blocks are more likely to be in cache.
+    // The count has to be lowered before the blocks go back to the list, see hasOutstandingAllocations()
+    uint32_t drain_count = (magazine_size_ + 1) / 2;
+    count -= drain_count;
+    magazine->count.store(count);
+    freeBatchToList(blocks, drain_count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      blocks[i] = blocks[i + drain_count];
+    }
+  }
+
+  blocks[count] = getIndex(mem);
+  magazine->count.store(count + 1);
+
+  unlockMagazine(magazine);
+  return true;
+}
+
+void* FreeList::stealFromMagazines()
+{
+  for (uint32_t i = 0; i < magazine_count_; ++i)
+  {
+    Magazine* magazine = lockMagazine(i);
+    if (!magazine)
+    {
+      continue;
+    }
+
+    void* mem = 0;
+    uint32_t count = magazine->count.load(memory_order_relaxed);
+    if (count > 0)
+    {
+      --count;
+      magazine->count.store(count);
+      mem = static_cast<void*>(blocks_ + (block_size_ * getMagazineBlocks(magazine)[count]));
+    }
+
+    unlockMagazine(magazine);
+    if (mem)
+    {
+      return mem;
+    }
+  }
+
+  return 0;
+}
+
+uint32_t FreeList::allocateBatchFromList(uint32_t* indices, uint32_t count)
+{
+#if FREE_LIST_DEBUG
+  initDebug();
+#endif
+
+  ROS_ASSERT(blocks_);
+
+  while (true)
+  {
+    uint64_t head = head_.load(memory_order_consume);
+
+#if FREE_LIST_DEBUG
+    typename Debug::Item i;
+    i.head = head;
+    i.time = ros::WallTime::now();
+    i.op = Debug::Alloc;
+#endif
+
+    if (getVal(head) == 0xffffffffULL)
+    {
+#if FREE_LIST_DEBUG
+      debug_->items.push_back(i);
+#endif
+      return 0;
+    }
+
+    FREELIST_DEBUG_YIELD();
+
+    // Walk up to count blocks from the head.  If another thread changes the list meanwhile, the indices
+    // read here may be stale, but then the tag of the head has changed as well and the CAS below fails.
+    uint32_t n = 0;
+    uint32_t index = getVal(head);
+    while (n < count && index != 0xffffffffUL)
+    {
+      indices[n++] = index;
+      index = next_[index].load();
+    }
+
+    uint64_t new_head = index;
+    // Increment the tag to avoid ABA
+    setTag(new_head, getTag(head) + 1);
+
+#if FREE_LIST_DEBUG
+    i.new_head = new_head;
+#endif
+
+    FREELIST_DEBUG_YIELD();
+
+    if (head_.compare_exchange_strong(head, new_head))
+    {
+#if FREE_LIST_DEBUG
+      // one item per block, the first one carries the head change
+      for (uint32_t j = 0; j < n; ++j)
+      {
+        i.addr = blocks_ + (block_size_ * indices[j]);
+        i.success = 1;
+        debug_->items.push_back(i);
+        i.head = i.new_head;
+      }
+#endif
+      alloc_count_.fetch_add(n);
+      return n;
+    }
+
+#if FREE_LIST_DEBUG
+      i.success = 0;
+      debug_->items.push_back(i);
+#endif
+  }
+}
+
+void FreeList::freeBatchToList(uint32_t const* indices, uint32_t count)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+#if FREE_LIST_DEBUG
+  initDebug();
+#endif
+
+  // Link the blocks together first, so they can be pushed with a single CAS
+  for (uint32_t i = 0; i + 1 < count; ++i)
+  {
+    next_[indices[i]].store(indices[i + 1]);
+  }
+
+  while (true)
+  {
+    uint64_t head = head_.load(memory_order_consume);
+
+#if FREE_LIST_DEBUG
+    typename Debug::Item i;
+    i.head = head;
+    i.time = ros::WallTime::now();
+    i.op = Debug::Free;
+#endif
+
+    FREELIST_DEBUG_YIELD();
+
+    uint64_t new_head = head;
+    setVal(new_head, indices[0]);
+    // Increment the tag to avoid ABA
+    setTag(new_head, getTag(new_head) + 1);
+
+    next_[indices[count - 1]].store(getVal(head));
+
+#if FREE_LIST_DEBUG
+    i.new_head = new_head;
+#endif
+
+    FREELIST_DEBUG_YIELD();
+
+    if (head_.compare_exchange_strong(head, new_head))
+    {
+#if FREE_LIST_DEBUG
+      // one item per block, the first one carries the head change
+      for (uint32_t j = 0; j < count; ++j)
+      {
+        i.addr = blocks_ + (block_size_ * indices[j]);
+        i.success = 1;
+        debug_->items.push_back(i);
+        i.head = i.new_head;
+      }
+#endif
+      alloc_count_.fetch_sub(count);
+      return;
+    }
+
+#if FREE_LIST_DEBUG
+      i.success = 0;
+      debug_->items.push_back(i);
+#endif
+  }
+}
+
+void* FreeList::allocateFromList()
 {
 #if FREE_LIST_DEBUG
   initDebug();
@@ -167,21 +527,13 @@ void* FreeList::allocate()
   }
 }
 
-void FreeList::free(void const* mem)
+void FreeList::freeToList(void const* mem)
 {
-  if (!mem)
-  {
-    return;
-  }
-
 #if FREE_LIST_DEBUG
   initDebug();
 #endif
 
-  uint32_t index = (static_cast<uint8_t const*>(mem) - blocks_) / block_size_;
-
-  ROS_ASSERT(((static_cast<uint8_t const*>(mem) - blocks_) % block_size_) == 0);
-  ROS_ASSERT(owns(mem));
+  uint32_t index = getIndex(mem);
 
   while (true)
   {
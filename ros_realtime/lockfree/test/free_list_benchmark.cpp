@@ -0,0 +1,114 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#include "lockfree/free_list.h"
+
+#include <boost/thread.hpp>
+
+#include <stdio.h>
+#include "ros/time.h"
+
+using namespace lockfree;
+
+struct PerfCounter
+{
+  PerfCounter()
+  : start(ros::WallTime::now())
+  {}
+
+  double elapsed() { return (ros::WallTime::now() - start).toSec(); }
+
+  ros::WallTime start;
+};
+
+void benchmarkThreadFunc(FreeList& pool, ros::atomic<bool>& done, ros::atomic<uint64_t>& op_count, boost::barrier& b)
+{
+  b.wait();
+
+  void* vals[10];
+  uint64_t count = 0;
+  while (!done.load(ros::memory_order_relaxed))
+  {
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+      vals[i] = pool.allocate();
+    }
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+      pool.free(vals[i]);
+    }
+
+    count += 10;
+  }
+
+  op_count.fetch_add(count);
+}
+
+double benchmarkThroughput(uint32_t thread_count, uint32_t magazine_size, double duration)
+{
+  FreeList pool(64, (thread_count * 10) + (boost::thread::hardware_concurrency() * magazine_size), magazine_size);
+  ros::atomic<bool> done(false);
+  ros::atomic<uint64_t> op_count(0);
+  boost::thread_group tg;
+  boost::barrier bar(thread_count + 1);
+  for (uint32_t i = 0; i < thread_count; ++i)
+  {
+    tg.create_thread(boost::bind(benchmarkThreadFunc, boost::ref(pool), boost::ref(done), boost::ref(op_count), boost::ref(bar)));
+  }
+
+  bar.wait();
+  PerfCounter pc;
+  ros::WallDuration(duration).sleep();
+  done.store(true);
+  tg.join_all();
+
+  return op_count.load() / pc.elapsed();
+}
+
+int main(int argc, char** argv)
+{
+  // allocate/free pairs per second, from one thread up to twice the number of CPUs
+  const uint32_t max_thread_count = std::max(boost::thread::hardware_concurrency() * 2, 4U);
+  printf("%8s %16s %16s %8s\n", "threads", "list ops/s", "magazine ops/s", "ratio");
+  for (uint32_t thread_count = 1; thread_count <= max_thread_count; thread_count *= 2)
+  {
+    double list_throughput = benchmarkThroughput(thread_count, 0, 0.5);
+    double magazine_throughput = benchmarkThroughput(thread_count, 16, 0.5);
+    printf("%8u %16.0f %16.0f %8.2f\n", thread_count, list_throughput, magazine_throughput,
+           magazine_throughput / list_throughput);
+  }
+
+  return 0;
+}
@@ -264,6 +264,117 @@ TEST(FreeList, hasOutstandingAllocations)
   ASSERT_TRUE(pool.hasOutstandingAllocations());
 }
 
+TEST(FreeList, magazinesMultipleElements)
+{
+  // more blocks than fit in a single magazine, less than fit in all of them
+  const uint32_t count = 20;
+  FreeList pool(4, count, 16);
+  pool.constructAll<uint32_t>(5);
+
+  std::vector<uint32_t*> items;
+  items.reserve(count);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    items.push_back(static_cast<uint32_t*>(pool.allocate()));
+    ASSERT_TRUE(items[i]);
+    EXPECT_EQ(*items[i], 5UL);
+    *items[i] = i;
+  }
+
+  ASSERT_FALSE(pool.allocate());
+
+  std::set<uint32_t*> set;
+  set.insert(items.begin(), items.end());
+  EXPECT_EQ(set.size(), count);
+
+  // fill the magazine until it drains, then allocate everything again
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    pool.free(items[i]);
+  }
+
+  set.clear();
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    uint32_t* item = static_cast<uint32_t*>(pool.allocate());
+    ASSERT_TRUE(item);
+    set.insert(item);
+  }
+
+  ASSERT_FALSE(pool.allocate());
+  EXPECT_EQ(set.size(), count);
+}
+
+TEST(FreeList, magazinesHasOutstandingAllocations)
+{
+  const uint32_t count = 20;
+  FreeList pool(4, count, 4);
+
+  std::vector<uint32_t*> items;
+  items.reserve(count);
+
+  ASSERT_TRUE(pool.hasOutstandingAllocations());
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    items.push_back(static_cast<uint32_t*>(pool.allocate()));
+    ASSERT_FALSE(pool.hasOutstandingAllocations());
+  }
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ASSERT_FALSE(pool.hasOutstandingAllocations());
+    pool.free(items[i]);
+  }
+
+  // the blocks cached in the magazines are free
+  ASSERT_TRUE(pool.hasOutstandingAllocations());
+}
+
+#if FREE_LIST_DEBUG
+TEST(FreeList, magazinesDoubleFree)
+{
+  FreeList pool(4, 20, 4);
+  void* item = pool.allocate();
+  ASSERT_TRUE(item);
+  pool.free(item);
+  // the block sits in a magazine now, it must not be handed out twice
+  EXPECT_DEATH(pool.free(item), "");
+}
+#endif
+
+TEST(FreeList, magazinesMultipleThreads)
+{
+  const uint32_t thread_count = boost::thread::hardware_concurrency() * 2;
+  // with slack for the blocks in magazines locked by preempted threads
+  FreeList pool(4, (thread_count * 10) + (boost::thread::hardware_concurrency() * 16), 16);
+  ros::atomic<bool> done(false);
+  ros::atomic<bool> failed(false);
+  boost::thread_group tg;
+  boost::barrier bar(thread_count);
+  for (uint32_t i = 0; i < thread_count; ++i)
+  {
+    tg.create_thread(boost::bind(threadFunc, boost::ref(pool), boost::ref(done), boost::ref(failed), boost::ref(bar)));
+  }
+
+  ros::WallTime start = ros::WallTime::now();
+  while (ros::WallTime::now() - start < ros::WallDuration(5.0))
+  {
+    ros::WallDuration(0.01).sleep();
+
+    if (failed.load())
+    {
+      break;
+    }
+  }
+  done.store(true);
+  tg.join_all();
+
+  ASSERT_TRUE(!failed.load());
+  ASSERT_TRUE(pool.hasOutstandingAllocations());
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -82,6 +82,43 @@ TEST(ObjectPool, multipleElements)
   EXPECT_EQ(set.size(), count);
 }
 
+TEST(ObjectPool, magazines)
+{
+  const uint32_t count = 20;
+  ObjectPool<uint32_t> pool(count, 5, 8);
+
+  std::vector<boost::shared_ptr<uint32_t> > items;
+  items.reserve(count);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    items.push_back(pool.allocateShared());
+    ASSERT_TRUE(items[i]);
+    EXPECT_EQ(*items[i], 5UL);
+    *items[i] = i;
+  }
+
+  ASSERT_FALSE(pool.allocateShared());
+
+  std::set<boost::shared_ptr<uint32_t> > set;
+  set.insert(items.begin(), items.end());
+  EXPECT_EQ(set.size(), count);
+
+  // the objects come back out of the magazines in a different order
+  set.clear();
+  items.clear();
+  std::set<uint32_t> values;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    items.push_back(pool.allocateShared());
+    ASSERT_TRUE(items[i]);
+    values.insert(*items[i]);
+  }
+
+  ASSERT_FALSE(pool.allocateShared());
+  EXPECT_EQ(values.size(), count);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,144 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef ROSRT_ALLOCATION_PROFILER_H
+#define ROSRT_ALLOCATION_PROFILER_H
+
+#include <ros/types.h>
+#include <ros/node_handle.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rosrt
+{
+
+struct AllocationProfilerOptions
+{
+  AllocationProfilerOptions()
+  : sample_period(512 * 1024)
+  , sample_realtime_sections(true)
+  , print_on_exit(true)
+  {}
+
+  uint64_t sample_period;         /**< Average number of bytes allocated between two samples, 0 to sample every allocation */
+  bool sample_realtime_sections;  /**< Sample every allocation made inside a RealtimeSection, regardless of sample_period */
+  bool print_on_exit;             /**< Print the profile to stderr when the process exits */
+};
+
+/**
+ * \brief The sampled allocations made from one call stack, inside one RealtimeSection
+ */
+struct AllocationSite
+{
+  AllocationSite()
+  : section(0)
+  , samples(0)
+  , sampled_bytes(0)
+  , estimated_bytes(0)
+  {}
+
+  const char* section;              /**< Name of the innermost RealtimeSection, 0 if outside of any */
+  std::vector<void*> stack;         /**< Return addresses, innermost first, starting at the caller of malloc() */
+  uint64_t samples;
+  uint64_t sampled_bytes;
+  uint64_t estimated_bytes;         /**< Estimate of all the bytes allocated from this site, sampled or not */
+};
+
+/**
+ * \brief Starts sampling the allocations made through the rosrt malloc wrappers, in all threads
+ *
+ * A sampled allocation records the call stack with backtrace(), which is not realtime safe.  Allocations
+ * outside of realtime sections are therefore only sampled about once every sample_period bytes, which keeps the
+ * overhead low.  Allocations inside a realtime section are already a bug, and are all sampled by default.
+ * \return false if the profiler is not supported on this platform
+ */
+bool startAllocationProfiler(const AllocationProfilerOptions& ops = AllocationProfilerOptions());
+void stopAllocationProfiler();
+bool isAllocationProfilerRunning();
+
+/**
+ * \brief Clears all the samples.  Samples taken concurrently may be partially lost.
+ */
+void resetAllocationProfile();
+
+/**
+ * \brief Returns the allocation sites sampled so far, the ones with the most estimated bytes first
+ */
+void getAllocationProfile(std::vector<AllocationSite>& sites);
+
+/**
+ * \brief Prints the allocation sites with the most estimated bytes, with symbolized call stacks
+ */
+void printAllocationProfile(std::ostream& out, uint32_t max_sites = 20);
+
+/**
+ * \brief Advertises a std_srvs/Empty service that prints the allocation profile to the ROS log
+ */
+ros::ServiceServer advertiseAllocationProfileService(ros::NodeHandle& nh, const std::string& service = "print_allocation_profile");
+
+/**
+ * \brief Names the code that runs while it is in scope, for the allocation profiler.  Sections can be nested.
+ *
+ * \verbatim
+   void update()
+   {
+     rosrt::RealtimeSection section("controller_update");
+     ...
+   }
+   \endverbatim
+ *
+ * \note name must stay valid while the profile is used, so it should be a string literal
+ */
+class RealtimeSection : public boost::noncopyable
+{
+public:
+  explicit RealtimeSection(const char* name);
+  ~RealtimeSection();
+
+private:
+  const char* previous_;
+};
+
+/**
+ * \brief Returns the name of the innermost RealtimeSection of this thread, 0 if there is none
+ */
+const char* getCurrentRealtimeSection();
+
+} // namespace rosrt
+
+#endif // ROSRT_ALLOCATION_PROFILER_H
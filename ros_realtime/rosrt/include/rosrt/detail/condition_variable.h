@@ -35,8 +35,13 @@
 #include <boost/thread/locks.hpp>
 #include <rosrt/detail/mutex.h>
 
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+
 #ifdef __XENO__
 #include <native/cond.h>
+#include <native/timer.h>
 #else
 #include <boost/thread/condition_variable.hpp>
 #endif
@@ -93,6 +98,30 @@ public:
 #endif
   }
 
+  /**
+   * Waits at most timeout_ns nanoseconds.  Returns false if the wait timed out.
+   */
+  bool timed_wait(boost::unique_lock<mutex>& m, uint64_t timeout_ns)
+  {
+#ifdef __XENO__
+    rosrt::mutex::native_handle_type native_mutex = m.mutex()->native_handle();
+    int const res = rt_cond_wait(&cond_, native_mutex, rt_timer_ns2ticks(timeout_ns));
+    BOOST_VERIFY(!res || res == -ETIMEDOUT);
+    return res != -ETIMEDOUT;
+#else
+    pthread_cond_t* native_cond = cond_.native_handle();
+    pthread_mutex_t* native_mutex = m.mutex()->native_handle();
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t nsec = deadline.tv_nsec + timeout_ns;
+    deadline.tv_sec += nsec / 1000000000ULL;
+    deadline.tv_nsec = nsec % 1000000000ULL;
+    int const res = pthread_cond_timedwait(native_cond, native_mutex, &deadline);
+    BOOST_VERIFY(!res || res == ETIMEDOUT);
+    return res != ETIMEDOUT;
+#endif
+  }
+
   template<typename predicate_type>
   void wait(boost::unique_lock<mutex>& m, predicate_type pred)
   {
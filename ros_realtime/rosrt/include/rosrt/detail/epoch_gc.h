@@ -0,0 +1,116 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef ROSRT_EPOCH_GC_H
+#define ROSRT_EPOCH_GC_H
+
+#include "mwsr_queue.h"
+
+#include <rosrt/epoch.h>
+#include <ros/atomic.h>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <vector>
+#include <deque>
+
+namespace rosrt
+{
+
+struct InitOptions;
+
+namespace detail
+{
+
+/**
+ * \brief Epoch based reclamation of the message pools of destroyed publishers and subscribers
+ *
+ * A retired pool first waits for its outstanding messages to be released.  Once it is empty, the global epoch
+ * is advanced, and the pool is freed as soon as every EpochGuard still in scope started in a later epoch, i.e.
+ * once no thread can still be inside the free() that released its last message.  The gc thread is woken up
+ * when a pool is retired, and only polls while pools are pending.
+ */
+class EpochGC
+{
+public:
+  typedef void(*DeleteFunc)(void* pool);
+  typedef bool(*IsDeletableFunc)(void* pool);
+
+  EpochGC(const InitOptions& ops);
+  ~EpochGC();
+
+  void add(void* pool, DeleteFunc deleter, IsDeletableFunc deletable);
+
+  GCStats getStats();
+
+private:
+  struct PoolGCItem
+  {
+    void* pool;
+    DeleteFunc deleter;
+    IsDeletableFunc is_deletable;
+    ros::WallTime retire_time;
+    uint64_t epoch;   /**< epoch in which the pool was found empty */
+  };
+
+  void gcThread();
+  void collect();
+  void deletePool(const PoolGCItem& item);
+
+  volatile bool running_;
+  bool wake_;
+  boost::mutex mutex_;
+  boost::condition_variable cond_;
+
+  boost::thread pool_gc_thread_;
+  MWSRQueue<PoolGCItem> pool_gc_queue_;
+  float period_;
+  float grace_period_poll_period_;
+
+  // only used by the gc thread
+  std::vector<PoolGCItem> pools_with_messages_;
+  std::deque<PoolGCItem> pools_in_grace_period_;
+
+  ros::atomic_uint32_t pending_count_;
+  ros::atomic_uint32_t with_messages_count_;
+  ros::atomic_uint64_t deleted_count_;
+  ros::atomic_uint64_t last_lag_ns_;
+  ros::atomic_uint64_t max_lag_ns_;
+};
+
+} // namespace detail
+} // namespace rosrt
+
+#endif // ROSRT_EPOCH_GC_H
@@ -42,11 +42,11 @@ namespace detail
 
 class PublisherManager;
 class SubscriberManager;
-class SimpleGC;
+class EpochGC;
 
 PublisherManager* getPublisherManager();
 SubscriberManager* getSubscriberManager();
-SimpleGC* getGC();
+EpochGC* getGC();
 
 } // namespace detail
 } // namespace rosrt
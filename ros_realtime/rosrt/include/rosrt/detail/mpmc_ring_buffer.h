@@ -0,0 +1,200 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef ROSRT_DETAIL_MPMC_RING_BUFFER_H
+#define ROSRT_DETAIL_MPMC_RING_BUFFER_H
+
+#include <ros/atomic.h>
+#include <boost/utility.hpp>
+#include <lockfree/free_list.h> // ROSRT_CACHELINE_SIZE
+
+namespace rosrt
+{
+namespace detail
+{
+
+/**
+ * \brief Bounded lock-free multi-producer, multi-consumer FIFO queue
+ *
+ * Each cell carries a sequence number that tells whether it is ready to be written or read in the current
+ * lap around the buffer, so producers and consumers only contend on the head and tail indices, which live
+ * on separate cache lines.  The cells are allocated up front, so push() and pop() never allocate.
+ */
+template<typename T>
+class MPMCRingBuffer : public boost::noncopyable
+{
+public:
+  /**
+   * \param size The capacity of the buffer, rounded up to a power of 2
+   */
+  MPMCRingBuffer(uint32_t size)
+  : head_(0)
+  , tail_(0)
+  {
+    uint32_t capacity = 1;
+    while (capacity < size)
+    {
+      capacity <<= 1;
+    }
+
+    mask_ = capacity - 1;
+    cells_ = new Cell[capacity];
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+      cells_[i].sequence.store(i, ros::memory_order_relaxed);
+    }
+  }
+
+  ~MPMCRingBuffer()
+  {
+    delete [] cells_;
+  }
+
+  uint32_t capacity() const { return mask_ + 1; }
+
+  /**
+   * \brief Adds an element to the back of the queue.  Returns false if the queue is full
+   */
+  bool push(const T& val)
+  {
+    Cell* cell;
+    uint32_t pos = tail_.load(ros::memory_order_relaxed);
+    while (true)
+    {
+      cell = &cells_[pos & mask_];
+      uint32_t seq = cell->sequence.load(ros::memory_order_acquire);
+      int32_t diff = (int32_t)(seq - pos);
+      if (diff == 0)
+      {
+        if (tail_.compare_exchange_weak(pos, pos + 1, ros::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = tail_.load(ros::memory_order_relaxed);
+      }
+    }
+
+    cell->val = val;
+    cell->sequence.store(pos + 1, ros::memory_order_release);
+    return true;
+  }
+
+  /**
+   * \brief Removes the element at the front of the queue.  Returns false if the queue is empty
+   */
+  bool pop(T& val)
+  {
+    return popBatch(&val, 1) == 1;
+  }
+
+  /**
+   * \brief Removes up to max_count elements from the front of the queue, in push() order, with a single
+   * update of the head index.  The cells are reset to T(), so the queue holds no references to popped elements.
+   * \return The number of elements removed
+   */
+  uint32_t popBatch(T* vals, uint32_t max_count)
+  {
+    uint32_t pos = head_.load(ros::memory_order_relaxed);
+    uint32_t count;
+    while (true)
+    {
+      // count the consecutive cells that have been written
+      count = 0;
+      while (count < max_count)
+      {
+        uint32_t seq = cells_[(pos + count) & mask_].sequence.load(ros::memory_order_acquire);
+        if ((int32_t)(seq - (pos + count + 1)) != 0)
+        {
+          break;
+        }
+        ++count;
+      }
+
+      if (count == 0)
+      {
+        uint32_t seq = cells_[pos & mask_].sequence.load(ros::memory_order_acquire);
+        if ((int32_t)(seq - (pos + 1)) < 0)
+        {
+          return 0;
+        }
+
+        // another consumer got here first
+        pos = head_.load(ros::memory_order_relaxed);
+        continue;
+      }
+
+      if (head_.compare_exchange_weak(pos, pos + count, ros::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      Cell& cell = cells_[(pos + i) & mask_];
+      vals[i] = cell.val;
+      cell.val = T();
+      cell.sequence.store(pos + i + mask_ + 1, ros::memory_order_release);
+    }
+
+    return count;
+  }
+
+private:
+  struct Cell
+  {
+    ros::atomic<uint32_t> sequence;
+    T val;
+  };
+
+  char pad0_[ROSRT_CACHELINE_SIZE];
+  ros::atomic<uint32_t> head_;
+  char pad1_[ROSRT_CACHELINE_SIZE - sizeof(ros::atomic<uint32_t>)];
+  ros::atomic<uint32_t> tail_;
+  char pad2_[ROSRT_CACHELINE_SIZE - sizeof(ros::atomic<uint32_t>)];
+  Cell* cells_;
+  uint32_t mask_;
+};
+
+} // namespace detail
+} // namespace rosrt
+
+#endif // ROSRT_DETAIL_MPMC_RING_BUFFER_H
@@ -35,10 +35,11 @@
 #ifndef ROSRT_PUBLISHER_MANAGER_H
 #define ROSRT_PUBLISHER_MANAGER_H
 
-#include "mwsr_queue.h"
+#include "mpmc_ring_buffer.h"
 
 #include <ros/atomic.h>
 #include <ros/publisher.h>
+#include <vector>
 #include <rosrt/publisher.h>
 #include <lockfree/object_pool.h>
 #include <rosrt/detail/thread.h>
@@ -60,7 +61,8 @@ public:
     ros::Publisher pub;
     VoidConstPtr msg;
     PublishFunc pub_func;
-    CloneFunc clone_func;
+    CloneFunc clone_func;   /**< NULL to publish the message itself */
+    uint64_t enqueue_time;  /**< in nanoseconds, from getTimeNs() */
   };
 
   PublishQueue(uint32_t size);
@@ -68,8 +70,18 @@ public:
   bool push(const ros::Publisher& pub, const VoidConstPtr& msg, PublishFunc pub_func, CloneFunc clone_func);
   uint32_t publishAll();
 
+  void getLatencyHistogram(PublishLatencyHistogram& histogram);
+
 private:
-  MWSRQueue<PubItem> queue_;
+  void recordLatency(uint64_t latency);
+
+  MPMCRingBuffer<PubItem> queue_;
+  std::vector<PubItem> batch_;
+
+  // only written by the publisher thread
+  ros::atomic<uint64_t> latency_counts_[PublishLatencyHistogram::NUM_BUCKETS];
+  ros::atomic<uint64_t> latency_total_count_;
+  ros::atomic<uint64_t> latency_max_;
 };
 
 class PublisherManager
@@ -78,14 +90,21 @@ public:
   PublisherManager(const InitOptions& ops);
   ~PublisherManager();
   bool publish(const ros::Publisher& pub, const VoidConstPtr& msg, PublishFunc pub_func, CloneFunc clone_func);
+  void getLatencyHistogram(PublishLatencyHistogram& histogram) { queue_.getLatencyHistogram(histogram); }
 
 private:
   void publishThread();
 
+  /**
+   * The publisher thread checks for messages at least this often, in case publish() notified it right before it waited
+   */
+  static const uint64_t PUBLISH_THREAD_WAKEUP_PERIOD_NS = 10000000ULL;
+
   PublishQueue queue_;
   rosrt::condition_variable cond_;
   rosrt::mutex cond_mutex_;
   ros::atomic<uint32_t> pub_count_;
+  ros::atomic<bool> waiting_;   /**< true while the publisher thread waits on cond_, the only time it needs a notify */
   volatile bool running_;
   rosrt::thread pub_thread_;
 };
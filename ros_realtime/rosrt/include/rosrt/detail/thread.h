@@ -41,6 +41,8 @@
 #include <native/task.h>
 #else
 #include <boost/thread.hpp>
+#include <pthread.h>
+#include <sched.h>
 #endif
 
 extern "C"
@@ -56,6 +58,7 @@ namespace rosrt
  * Thin wrapper for a "real-time" thread, implementation differs based on platform.
  * Falls back to boost::thread on generic platforms.
  *
+ * If cpu_id is not negative, the thread is pinned to that CPU.
  */
 class thread: boost::noncopyable
 {
@@ -68,18 +71,36 @@ private:
 #endif
 
 public:
-  explicit thread(boost::function<void ()> thread_fn, const char* name="", const int cpu_id=0)
+  explicit thread(boost::function<void ()> thread_fn, const char* name="", const int cpu_id=-1)
   {
 #ifdef __XENO__
     thread_fn_ = thread_fn;
+    int mode = T_FPU | T_JOINABLE;
+    if (cpu_id >= 0)
+    {
+      mode |= T_CPU(cpu_id);
+    }
     int error_code;
-    if (error_code = rt_task_spawn(&thread_, name, 0, 0, T_FPU | T_JOINABLE | T_CPU(cpu_id), thread_proxy, &thread_fn_))
+    if (error_code = rt_task_spawn(&thread_, name, 0, 0, mode, thread_proxy, &thread_fn_))
     {
       ROS_ERROR("rosrt::thread - Couldn't spawn xenomai thread %s, error code = %d", name, error_code);
     }
     //thread_proxy(&thread_fn_);
 #else
     thread_ = boost::thread(thread_fn);
+#ifdef __linux__
+    if (cpu_id >= 0)
+    {
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      CPU_SET(cpu_id, &cpu_set);
+      int error_code = pthread_setaffinity_np(thread_.native_handle(), sizeof(cpu_set), &cpu_set);
+      if (error_code)
+      {
+        ROS_ERROR("rosrt::thread - Couldn't pin thread %s to CPU %d, error code = %d", name, cpu_id, error_code);
+      }
+    }
+#endif
 #endif
   }
 
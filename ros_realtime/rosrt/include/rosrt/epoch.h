@@ -0,0 +1,95 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef ROSRT_EPOCH_H
+#define ROSRT_EPOCH_H
+
+#include <ros/types.h>
+#include <ros/time.h>
+
+#include <boost/noncopyable.hpp>
+
+namespace rosrt
+{
+
+/**
+ * \brief Marks the calling thread as possibly using the message pool of a destroyed Publisher or Subscriber
+ *
+ * The message pools of destroyed publishers and subscribers are freed once all their messages have been released,
+ * and once no thread is inside an EpochGuard that started before that.  Entering and leaving a guard only stores
+ * the current epoch number, and 0, in a slot owned by the calling thread, so it is realtime safe, except for the
+ * first guard of a thread, which registers the thread.
+ *
+ * Threads that release rosrt messages after the Publisher or Subscriber they came from is destroyed should
+ * do so inside a guard, e.g. one per iteration of a realtime loop.  Guards can be nested.
+ */
+class EpochGuard : public boost::noncopyable
+{
+public:
+  EpochGuard();
+  ~EpochGuard();
+};
+
+/**
+ * \brief Statistics of the reclamation of message pools
+ */
+struct GCStats
+{
+  GCStats()
+  : pending_pools(0)
+  , pools_with_messages(0)
+  , deleted_pools(0)
+  , epoch(0)
+  , oldest_guard_epoch_lag(0)
+  , unregistered_threads(0)
+  {}
+
+  uint32_t pending_pools;               /**< Pools of destroyed publishers and subscribers that are not freed yet */
+  uint32_t pools_with_messages;         /**< Pending pools that still have messages outstanding */
+  uint64_t deleted_pools;
+  uint64_t epoch;
+  uint64_t oldest_guard_epoch_lag;      /**< Number of epochs the oldest EpochGuard in scope is behind, 0 if none */
+  uint64_t unregistered_threads;        /**< Threads whose EpochGuards had no effect, because all the slots were used */
+  ros::WallDuration last_reclamation_lag; /**< Time between the retirement and the deletion of the last deleted pool */
+  ros::WallDuration max_reclamation_lag;
+};
+
+/**
+ * \brief Gets the pool reclamation statistics.  rosrt::init() must have been called.
+ */
+GCStats getGCStats();
+
+} // namespace rosrt
+
+#endif // ROSRT_EPOCH_H
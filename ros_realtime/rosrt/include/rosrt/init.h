@@ -46,13 +46,17 @@ struct InitOptions
 {
   InitOptions()
   : pubmanager_queue_size(10000)
+  , pubmanager_thread_cpu(-1)
   , gc_queue_size(1000)
   , gc_period(0.1)
+  , gc_grace_period_poll_period(0.001)
   {}
 
   uint32_t pubmanager_queue_size;
+  int32_t pubmanager_thread_cpu;  /**< CPU to pin the publisher thread to, -1 to leave it unpinned */
   uint32_t gc_queue_size;
-  ros::WallDuration gc_period;
+  ros::WallDuration gc_period;                    /**< How often pools whose messages are still in use are checked */
+  ros::WallDuration gc_grace_period_poll_period;  /**< How often EpochGuards are checked while pools wait for them */
 };
 
 void init(const InitOptions& ops = InitOptions());
@@ -50,6 +50,23 @@ typedef boost::shared_ptr<void const> VoidConstPtr;
 typedef void(*PublishFunc)(const ros::Publisher& pub, const VoidConstPtr& msg);
 typedef VoidConstPtr(*CloneFunc)(const VoidConstPtr& msg);
 
+/**
+ * \brief Histogram of the latency between a realtime publish() call and the actual publish from the publisher thread
+ */
+struct PublishLatencyHistogram
+{
+  enum { NUM_BUCKETS = 32 };
+
+  uint64_t counts[NUM_BUCKETS];   /**< counts[i] is the number of latencies in [2^i, 2^(i+1)) nanoseconds, counts[0] includes 0 */
+  uint64_t total_count;
+  uint64_t max_latency;           /**< in nanoseconds */
+};
+
+/**
+ * \brief Gets the publish latency histogram of all realtime publishers since rosrt::init()
+ */
+void getPublishLatencyHistogram(PublishLatencyHistogram& histogram);
+
 namespace detail
 {
 template<typename M>
@@ -74,6 +91,12 @@ bool publish(const ros::Publisher& pub, const VoidConstPtr& msg)
 {
   return publish(pub, msg, publishMessage<M>, cloneMessage<M>);
 }
+
+template<typename M>
+bool publishWithoutClone(const ros::Publisher& pub, const VoidConstPtr& msg)
+{
+  return publish(pub, msg, publishMessage<M>, 0);
+}
 } // namespace detail
 
 /**
@@ -91,6 +114,7 @@ public:
    */
   Publisher()
     : pool_(NULL)
+    , zero_clone_(false)
   {
   }
 
@@ -101,6 +125,7 @@ public:
    * \param tmpl A template object to intialize all the messages in the message pool with
    */
   Publisher(const ros::Publisher& pub, uint32_t message_pool_size, const M& tmpl)
+    : zero_clone_(false)
   {
     initialize(pub, message_pool_size, tmpl);
   }
@@ -114,6 +139,7 @@ public:
    * \param tmpl A template object to intialize all the messages in the message pool with
    */
   Publisher(ros::NodeHandle& nh, const std::string& topic, uint32_t ros_publisher_queue_size, uint32_t message_pool_size, const M& tmpl)
+    : zero_clone_(false)
   {
     initialize(nh, topic, ros_publisher_queue_size, message_pool_size, tmpl);
   }
@@ -155,9 +181,21 @@ public:
    */
   bool publish(const MConstPtr& msg)
   {
+    if (zero_clone_)
+    {
+      return detail::publishWithoutClone<M>(pub_, msg);
+    }
+
     return detail::publish<M>(pub_, msg);
   }
 
+  /**
+   * \brief Publish the messages themselves instead of copies of them.  By default every message is cloned before
+   * it is published, since an intraprocess subscriber that holds on to the messages could otherwise empty the
+   * message pool.  Only enable this if there are no such subscribers.
+   */
+  void setZeroClone(bool zero_clone) { zero_clone_ = zero_clone; }
+
   /**
    * \brief Allocate a message.  The message will have been constructed with the template provided
    * to initialize()
@@ -176,6 +214,7 @@ public:
 private:
   ros::Publisher pub_;
   lockfree::ObjectPool<M>* pool_;
+  bool zero_clone_;
 };
 
 } // namespace rosrt
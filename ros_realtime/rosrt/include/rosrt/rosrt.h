@@ -39,6 +39,8 @@
 #include "subscriber.h"
 #include "filtered_subscriber.h"
 #include "malloc_wrappers.h"
+#include "allocation_profiler.h"
+#include "epoch.h"
 #include "init.h"
 
 #endif // ROSRT_ROSRT_H
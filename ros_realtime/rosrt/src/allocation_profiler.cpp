@@ -32,54 +32,27 @@
 *  POSSIBILITY OF SUCH DAMAGE.
 *********************************************************************/
 
-#ifndef ROSRT_SIMPLE_GC_H
-#define ROSRT_SIMPLE_GC_H
+#include <rosrt/allocation_profiler.h>
 
-#include "mwsr_queue.h"
+#include <ros/ros.h>
+#include <std_srvs/Empty.h>
 
-#include <ros/atomic.h>
-#include <lockfree/object_pool.h>
-#include <boost/thread/thread.hpp>
+#include <sstream>
 
 namespace rosrt
 {
 
-struct InitOptions;
-
-namespace detail
+static bool printAllocationProfileCallback(std_srvs::Empty::Request&, std_srvs::Empty::Response&)
 {
+  std::stringstream ss;
+  printAllocationProfile(ss);
+  ROS_INFO_STREAM(ss.str());
+  return true;
+}
 
-class SimpleGC
+ros::ServiceServer advertiseAllocationProfileService(ros::NodeHandle& nh, const std::string& service)
 {
-public:
-  typedef void(*DeleteFunc)(void* pool);
-  typedef bool(*IsDeletableFunc)(void* pool);
-
-  SimpleGC(const InitOptions& ops);
-  ~SimpleGC();
-
-  void add(void* pool, DeleteFunc deleter, IsDeletableFunc deletable);
-
-private:
-  void gcThread();
-
-  volatile bool running_;
+  return nh.advertiseService(service, printAllocationProfileCallback);
+}
 
-  struct PoolGCItem
-  {
-    void* pool;
-    DeleteFunc deleter;
-    IsDeletableFunc is_deletable;
-  };
-
-  boost::thread pool_gc_thread_;
-  MWSRQueue<PoolGCItem> pool_gc_queue_;
-  float period_;
-};
-
-} // namespace detail
 } // namespace rosrt
-
-#endif // ROSRT_SIMPLE_GC_H
-
-
@@ -0,0 +1,336 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#include <rosrt/detail/epoch_gc.h>
+#include <rosrt/detail/managers.h>
+#include <rosrt/init.h>
+#include <ros/debug.h>
+
+#include <pthread.h>
+#include <limits>
+
+#define MAX_EPOCH_THREADS 256
+
+namespace rosrt
+{
+namespace detail
+{
+
+// One slot per thread that has used an EpochGuard, each on its own cache line.  epoch is the global epoch when
+// the thread's outermost guard started, 0 outside of guards.
+struct ThreadEpoch
+{
+  ros::atomic_uint64_t epoch;
+  ros::atomic_bool used;
+  char pad[64 - sizeof(ros::atomic_uint64_t) - sizeof(ros::atomic_bool)];
+};
+
+static ThreadEpoch g_thread_epochs[MAX_EPOCH_THREADS];
+static ros::atomic_uint64_t g_global_epoch(1);
+static ros::atomic_uint64_t g_unregistered_threads(0);
+
+static __thread ThreadEpoch* g_thread_epoch = 0;
+static __thread uint32_t g_epoch_nesting = 0;
+static __thread bool g_thread_registration_failed = false;
+
+static pthread_key_t g_thread_epoch_key;
+static pthread_once_t g_thread_epoch_key_once = PTHREAD_ONCE_INIT;
+
+static void releaseThreadEpoch(void* mem)
+{
+  ThreadEpoch* thread_epoch = reinterpret_cast<ThreadEpoch*>(mem);
+  thread_epoch->epoch.store(0);
+  thread_epoch->used.store(false);
+}
+
+static void createThreadEpochKey()
+{
+  pthread_key_create(&g_thread_epoch_key, releaseThreadEpoch);
+}
+
+static ThreadEpoch* registerThread()
+{
+  pthread_once(&g_thread_epoch_key_once, createThreadEpochKey);
+
+  for (uint32_t i = 0; i < MAX_EPOCH_THREADS; ++i)
+  {
+    if (!g_thread_epochs[i].used.exchange(true))
+    {
+      g_thread_epochs[i].epoch.store(0);
+      pthread_setspecific(g_thread_epoch_key, &g_thread_epochs[i]);
+      return &g_thread_epochs[i];
+    }
+  }
+
+  g_unregistered_threads.fetch_add(1);
+  return 0;
+}
+
+// Oldest epoch of the guards in scope, max uint64 if there are none
+static uint64_t getOldestGuardEpoch()
+{
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  for (uint32_t i = 0; i < MAX_EPOCH_THREADS; ++i)
+  {
+    uint64_t epoch = g_thread_epochs[i].epoch.load();
+    if (epoch != 0 && epoch < oldest)
+    {
+      oldest = epoch;
+    }
+  }
+
+  return oldest;
+}
+
+EpochGC::EpochGC(const InitOptions& ops)
+: running_(true)
+, wake_(false)
+, pool_gc_queue_(ops.gc_queue_size)
+, period_(ops.gc_period.toSec())
+, grace_period_poll_period_(std::min(ops.gc_period.toSec(), ops.gc_grace_period_poll_period.toSec()))
+{
+  pending_count_.store(0);
+  with_messages_count_.store(0);
+  deleted_count_.store(0);
+  last_lag_ns_.store(0);
+  max_lag_ns_.store(0);
+
+  pool_gc_thread_ = boost::thread(&EpochGC::gcThread, this);
+}
+
+EpochGC::~EpochGC()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    running_ = false;
+    cond_.notify_one();
+  }
+  pool_gc_thread_.join();
+}
+
+void addPoolToGC(void* pool, EpochGC::DeleteFunc deleter, EpochGC::IsDeletableFunc deletable)
+{
+  getGC()->add(pool, deleter, deletable);
+}
+
+void EpochGC::add(void* pool, DeleteFunc deleter, IsDeletableFunc deletable)
+{
+  PoolGCItem i;
+  i.pool = pool;
+  i.deleter = deleter;
+  i.is_deletable = deletable;
+  i.retire_time = ros::WallTime::now();
+  i.epoch = 0;
+
+  // counted before the push, the gc thread may delete the pool before push() returns
+  pending_count_.fetch_add(1);
+  if (!pool_gc_queue_.push(i))
+  {
+    pending_count_.fetch_sub(1);
+    ROS_WARN("rosrt gc queue is full, leaking pool %p.  Increase InitOptions::gc_queue_size.", pool);
+    return;
+  }
+
+  boost::mutex::scoped_lock lock(mutex_);
+  wake_ = true;
+  cond_.notify_one();
+}
+
+GCStats EpochGC::getStats()
+{
+  GCStats stats;
+  stats.pending_pools = pending_count_.load();
+  stats.pools_with_messages = with_messages_count_.load();
+  stats.deleted_pools = deleted_count_.load();
+  stats.epoch = g_global_epoch.load();
+  uint64_t oldest = getOldestGuardEpoch();
+  stats.oldest_guard_epoch_lag = oldest <= stats.epoch ? stats.epoch - oldest : 0;
+  stats.unregistered_threads = g_unregistered_threads.load();
+  stats.last_reclamation_lag.fromNSec(last_lag_ns_.load());
+  stats.max_reclamation_lag.fromNSec(max_lag_ns_.load());
+  return stats;
+}
+
+void EpochGC::deletePool(const PoolGCItem& item)
+{
+  item.deleter(item.pool);
+
+  uint64_t lag = (ros::WallTime::now() - item.retire_time).toNSec();
+  last_lag_ns_.store(lag);
+  if (lag > max_lag_ns_.load())
+  {
+    max_lag_ns_.store(lag);
+  }
+  deleted_count_.fetch_add(1);
+  pending_count_.fetch_sub(1);
+}
+
+void EpochGC::collect()
+{
+  {
+    MWSRQueue<PoolGCItem>::Node* it = pool_gc_queue_.popAll();
+    while (it)
+    {
+      pools_with_messages_.push_back(it->val);
+      MWSRQueue<PoolGCItem>::Node* tmp = it;
+      it = it->next;
+      pool_gc_queue_.free(tmp);
+    }
+  }
+
+  // Pools whose messages have all been released start their grace period in a new epoch.  A thread still
+  // inside the free() of the last message is in a guard that started in this epoch or before.
+  bool advanced = false;
+  uint64_t epoch = 0;
+  for (size_t i = 0; i < pools_with_messages_.size();)
+  {
+    PoolGCItem& item = pools_with_messages_[i];
+    if (item.is_deletable(item.pool))
+    {
+      if (!advanced)
+      {
+        epoch = g_global_epoch.fetch_add(1);
+        advanced = true;
+      }
+
+      item.epoch = epoch;
+      pools_in_grace_period_.push_back(item);
+      item = pools_with_messages_.back();
+      pools_with_messages_.pop_back();
+    }
+    else
+    {
+      ++i;
+    }
+  }
+  with_messages_count_.store(pools_with_messages_.size());
+
+  // pools_in_grace_period_ is sorted by epoch
+  if (!pools_in_grace_period_.empty())
+  {
+    uint64_t oldest = getOldestGuardEpoch();
+    while (!pools_in_grace_period_.empty() && pools_in_grace_period_.front().epoch < oldest)
+    {
+      deletePool(pools_in_grace_period_.front());
+      pools_in_grace_period_.pop_front();
+    }
+  }
+}
+
+void EpochGC::gcThread()
+{
+  while (running_)
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if (running_ && !wake_)
+      {
+        // Nothing to do until a pool is retired, unless some are still waiting for their messages or for guards
+        if (!pools_in_grace_period_.empty())
+        {
+          cond_.timed_wait(lock, boost::posix_time::microseconds((int64_t)(grace_period_poll_period_ * 1e6)));
+        }
+        else if (!pools_with_messages_.empty())
+        {
+          cond_.timed_wait(lock, boost::posix_time::microseconds((int64_t)(period_ * 1e6)));
+        }
+        else
+        {
+          cond_.wait(lock);
+        }
+      }
+      wake_ = false;
+    }
+
+    collect();
+  }
+
+  {
+    // Once we've stopped running, make sure everything is deleted
+    collect();
+    for (size_t i = 0; i < pools_with_messages_.size(); ++i)
+    {
+      ROS_WARN("Pool %p still has allocated blocks.  Deleting anyway.", pools_with_messages_[i].pool);
+      deletePool(pools_with_messages_[i]);
+    }
+    pools_with_messages_.clear();
+
+    for (size_t i = 0; i < pools_in_grace_period_.size(); ++i)
+    {
+      deletePool(pools_in_grace_period_[i]);
+    }
+    pools_in_grace_period_.clear();
+  }
+}
+
+} // namespace detail
+
+EpochGuard::EpochGuard()
+{
+  if (detail::g_epoch_nesting++ > 0)
+  {
+    return;
+  }
+
+  if (!detail::g_thread_epoch && !detail::g_thread_registration_failed)
+  {
+    detail::g_thread_epoch = detail::registerThread();
+    detail::g_thread_registration_failed = !detail::g_thread_epoch;
+  }
+
+  if (detail::g_thread_epoch)
+  {
+    detail::g_thread_epoch->epoch.store(detail::g_global_epoch.load());
+  }
+}
+
+EpochGuard::~EpochGuard()
+{
+  if (--detail::g_epoch_nesting > 0)
+  {
+    return;
+  }
+
+  if (detail::g_thread_epoch)
+  {
+    detail::g_thread_epoch->epoch.store(0);
+  }
+}
+
+GCStats getGCStats()
+{
+  return detail::getGC()->getStats();
+}
+
+} // namespace rosrt
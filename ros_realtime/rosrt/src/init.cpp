@@ -34,7 +34,7 @@
 
 #include <rosrt/detail/publisher_manager.h>
 #include <rosrt/detail/subscriber_manager.h>
-#include <rosrt/detail/simple_gc.h>
+#include <rosrt/detail/epoch_gc.h>
 
 #include <boost/thread.hpp>
 
@@ -52,13 +52,13 @@ public:
 
   PublisherManager* getPublisherManager() { return pub_manager_; }
   SubscriberManager* getSubscriberManager() { return sub_manager_; }
-  SimpleGC* getGC() { return gc_; }
+  EpochGC* getGC() { return gc_; }
 
 private:
 
   PublisherManager* pub_manager_;
   SubscriberManager* sub_manager_;
-  SimpleGC* gc_;
+  EpochGC* gc_;
 };
 typedef boost::shared_ptr<Managers> ManagersPtr;
 
@@ -68,7 +68,7 @@ Managers::Managers(const InitOptions& ops)
 {
   pub_manager_ = new PublisherManager(ops);
   sub_manager_ = new SubscriberManager;
-  gc_ = new SimpleGC(ops);
+  gc_ = new EpochGC(ops);
 }
 
 Managers::~Managers()
@@ -90,7 +90,7 @@ SubscriberManager* getSubscriberManager()
   return g_managers->getSubscriberManager();
 }
 
-SimpleGC* getGC()
+EpochGC* getGC()
 {
   ROS_ASSERT(g_managers);
   return g_managers->getGC();
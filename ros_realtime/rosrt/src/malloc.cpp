@@ -33,6 +33,7 @@
 *********************************************************************/
 
 #include <rosrt/malloc_wrappers.h>
+#include <rosrt/allocation_profiler.h>
 
 #include <ros/assert.h>
 #include <ros/atomic.h>
@@ -40,6 +41,9 @@
 #include <boost/thread.hpp>
 
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
 #include <dlfcn.h>
 
 #if defined(WIN32)
@@ -57,6 +61,13 @@
 #define MAX_ALLOC_INFO 1000
 #endif
 
+#if HAS_TLS_KW && defined(__GLIBC__)
+#include <execinfo.h>
+#define HAS_ALLOCATION_PROFILER 1
+#else
+#define HAS_ALLOCATION_PROFILER 0
+#endif
+
 namespace rosrt
 {
 namespace detail
@@ -137,6 +148,164 @@ AllocInfo* allocateAllocInfo()
 
 #endif // !HAS_TLS_KW
 
+#if HAS_ALLOCATION_PROFILER
+
+#define MAX_ALLOCATION_SITES 1024
+#define MAX_ALLOCATION_STACK_DEPTH 16
+// the frames of recordAllocationSample() and of the malloc wrapper itself
+#define ALLOCATION_STACK_SKIP 2
+
+STATIC_TLS_KW const char* g_realtime_section = 0;
+STATIC_TLS_KW bool g_in_profiler = false;
+STATIC_TLS_KW int64_t g_bytes_until_sample = 0;
+STATIC_TLS_KW uint32_t g_sample_seed = 0;
+
+ros::atomic_bool g_profiler_running(false);
+AllocationProfilerOptions g_profiler_options;
+ros::atomic_uint64_t g_dropped_samples(0);
+
+// The sites are kept in a fixed size open addressing hash table, keyed by a hash of the call stack and section,
+// so that sampling never allocates
+struct AllocationRecord
+{
+  ros::atomic_uint64_t key;
+  ros::atomic_bool ready;
+  const char* section;
+  uint32_t depth;
+  void* stack[MAX_ALLOCATION_STACK_DEPTH];
+  ros::atomic_uint64_t samples;
+  ros::atomic_uint64_t sampled_bytes;
+  ros::atomic_uint64_t estimated_bytes;
+};
+AllocationRecord g_allocation_records[MAX_ALLOCATION_SITES];
+
+// Keeps the allocations made by the profiler itself out of the profile
+struct ProfilerGuard
+{
+  ProfilerGuard()
+  : previous(g_in_profiler)
+  {
+    g_in_profiler = true;
+  }
+
+  ~ProfilerGuard()
+  {
+    g_in_profiler = previous;
+  }
+
+  bool previous;
+};
+
+// Bytes until the next sample, uniformly distributed in [1, 2 * sample_period] so that periodic
+// allocation patterns are not aliased
+int64_t nextSampleCountdown()
+{
+  uint64_t period = g_profiler_options.sample_period;
+  if (period == 0)
+  {
+    return 0;
+  }
+
+  if (g_sample_seed == 0)
+  {
+    g_sample_seed = reinterpret_cast<uintptr_t>(&g_sample_seed) | 1;
+  }
+
+  // xorshift
+  g_sample_seed ^= g_sample_seed << 13;
+  g_sample_seed ^= g_sample_seed >> 17;
+  g_sample_seed ^= g_sample_seed << 5;
+
+  return 1 + (g_sample_seed % (2 * period));
+}
+
+__attribute__((noinline)) void recordAllocationSample(size_t size, bool sampled_all)
+{
+  ProfilerGuard guard;
+
+  void* frames[MAX_ALLOCATION_STACK_DEPTH + ALLOCATION_STACK_SKIP];
+  int frame_count = backtrace(frames, MAX_ALLOCATION_STACK_DEPTH + ALLOCATION_STACK_SKIP);
+  void** stack = frames + std::min(frame_count, ALLOCATION_STACK_SKIP);
+  uint32_t depth = std::max(frame_count - ALLOCATION_STACK_SKIP, 0);
+  const char* section = g_realtime_section;
+
+  // FNV-1a
+  uint64_t key = 14695981039346656037ULL;
+  for (uint32_t i = 0; i < depth; ++i)
+  {
+    key = (key ^ reinterpret_cast<uintptr_t>(stack[i])) * 1099511628211ULL;
+  }
+  key = (key ^ reinterpret_cast<uintptr_t>(section)) * 1099511628211ULL;
+  key |= 1;
+
+  // Below the sample period, a sample stands for all the bytes allocated since the previous one
+  uint64_t estimated_bytes = sampled_all ? size : std::max<uint64_t>(size, g_profiler_options.sample_period);
+
+  for (uint32_t probe = 0, i = key % MAX_ALLOCATION_SITES; probe < MAX_ALLOCATION_SITES; ++probe, i = (i + 1) % MAX_ALLOCATION_SITES)
+  {
+    AllocationRecord& record = g_allocation_records[i];
+    uint64_t record_key = record.key.load();
+    if (record_key == 0)
+    {
+      uint64_t expected = 0;
+      if (record.key.compare_exchange_strong(expected, key))
+      {
+        record.section = section;
+        record.depth = depth;
+        std::copy(stack, stack + depth, record.stack);
+        record.ready.store(true);
+        record_key = key;
+      }
+      else
+      {
+        record_key = expected;
+      }
+    }
+
+    if (record_key == key)
+    {
+      record.samples.fetch_add(1);
+      record.sampled_bytes.fetch_add(size);
+      record.estimated_bytes.fetch_add(estimated_bytes);
+      return;
+    }
+  }
+
+  g_dropped_samples.fetch_add(1);
+}
+
+inline __attribute__((always_inline)) void profileAllocation(size_t size)
+{
+  if (!g_profiler_running.load(ros::memory_order_relaxed) || g_in_profiler)
+  {
+    return;
+  }
+
+  if (g_realtime_section && g_profiler_options.sample_realtime_sections)
+  {
+    recordAllocationSample(size, true);
+    return;
+  }
+
+  g_bytes_until_sample -= size;
+  if (g_bytes_until_sample <= 0)
+  {
+    bool sampled_all = g_profiler_options.sample_period == 0;
+    g_bytes_until_sample = nextSampleCountdown();
+    recordAllocationSample(size, sampled_all);
+  }
+}
+
+void printAllocationProfileAtExit()
+{
+  if (g_profiler_options.print_on_exit)
+  {
+    printAllocationProfile(std::cerr);
+  }
+}
+
+#endif // HAS_ALLOCATION_PROFILER
+
 } // namespace malloc_tls
 
 AllocInfo getThreadAllocInfo()
@@ -194,6 +363,173 @@ void setThreadBreakOnAllocOrFree(bool b)
 #endif
 }
 
+bool startAllocationProfiler(const AllocationProfilerOptions& ops)
+{
+#if HAS_ALLOCATION_PROFILER
+  detail::ProfilerGuard guard;
+
+  // The first call to backtrace() loads libgcc, which allocates.  Do that here rather than while sampling.
+  void* frames[1];
+  backtrace(frames, 1);
+
+  static bool at_exit_registered = false;
+  if (!at_exit_registered)
+  {
+    atexit(detail::printAllocationProfileAtExit);
+    at_exit_registered = true;
+  }
+
+  detail::g_profiler_options = ops;
+  detail::g_profiler_running.store(true);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void stopAllocationProfiler()
+{
+#if HAS_ALLOCATION_PROFILER
+  detail::g_profiler_running.store(false);
+#endif
+}
+
+bool isAllocationProfilerRunning()
+{
+#if HAS_ALLOCATION_PROFILER
+  return detail::g_profiler_running.load();
+#else
+  return false;
+#endif
+}
+
+void resetAllocationProfile()
+{
+#if HAS_ALLOCATION_PROFILER
+  for (uint32_t i = 0; i < MAX_ALLOCATION_SITES; ++i)
+  {
+    detail::AllocationRecord& record = detail::g_allocation_records[i];
+    record.ready.store(false);
+    record.samples.store(0);
+    record.sampled_bytes.store(0);
+    record.estimated_bytes.store(0);
+    record.key.store(0);
+  }
+
+  detail::g_dropped_samples.store(0);
+#endif
+}
+
+#if HAS_ALLOCATION_PROFILER
+static bool compareEstimatedBytes(const AllocationSite& lhs, const AllocationSite& rhs)
+{
+  return lhs.estimated_bytes > rhs.estimated_bytes;
+}
+#endif
+
+void getAllocationProfile(std::vector<AllocationSite>& sites)
+{
+  sites.clear();
+
+#if HAS_ALLOCATION_PROFILER
+  detail::ProfilerGuard guard;
+
+  for (uint32_t i = 0; i < MAX_ALLOCATION_SITES; ++i)
+  {
+    detail::AllocationRecord& record = detail::g_allocation_records[i];
+    if (!record.ready.load())
+    {
+      continue;
+    }
+
+    AllocationSite site;
+    site.section = record.section;
+    site.stack.assign(record.stack, record.stack + record.depth);
+    site.samples = record.samples.load();
+    site.sampled_bytes = record.sampled_bytes.load();
+    site.estimated_bytes = record.estimated_bytes.load();
+    sites.push_back(site);
+  }
+
+  std::sort(sites.begin(), sites.end(), compareEstimatedBytes);
+#endif
+}
+
+void printAllocationProfile(std::ostream& out, uint32_t max_sites)
+{
+#if HAS_ALLOCATION_PROFILER
+  detail::ProfilerGuard guard;
+
+  std::vector<AllocationSite> sites;
+  getAllocationProfile(sites);
+
+  uint64_t samples = 0;
+  uint64_t estimated_bytes = 0;
+  for (size_t i = 0; i < sites.size(); ++i)
+  {
+    samples += sites[i].samples;
+    estimated_bytes += sites[i].estimated_bytes;
+  }
+
+  out << "Allocation profile: " << sites.size() << " sites, " << samples << " samples, ~" << estimated_bytes << " bytes";
+  if (detail::g_dropped_samples.load() > 0)
+  {
+    out << " (" << detail::g_dropped_samples.load() << " samples dropped, too many sites)";
+  }
+  out << std::endl;
+
+  for (size_t i = 0; i < sites.size() && i < max_sites; ++i)
+  {
+    const AllocationSite& site = sites[i];
+    out << "#" << i << " " << (site.section ? site.section : "<no realtime section>") << ": " << site.samples << " samples, "
+        << site.sampled_bytes << " bytes sampled, ~" << site.estimated_bytes << " bytes" << std::endl;
+
+    if (site.stack.empty())
+    {
+      continue;
+    }
+
+    char** symbols = backtrace_symbols(&site.stack[0], site.stack.size());
+    if (symbols)
+    {
+      for (size_t j = 0; j < site.stack.size(); ++j)
+      {
+        out << "    " << symbols[j] << std::endl;
+      }
+
+      ::free(symbols);
+    }
+  }
+#else
+  out << "Allocation profile: not supported on this platform" << std::endl;
+#endif
+}
+
+RealtimeSection::RealtimeSection(const char* name)
+: previous_(0)
+{
+#if HAS_ALLOCATION_PROFILER
+  previous_ = detail::g_realtime_section;
+  detail::g_realtime_section = name;
+#endif
+}
+
+RealtimeSection::~RealtimeSection()
+{
+#if HAS_ALLOCATION_PROFILER
+  detail::g_realtime_section = previous_;
+#endif
+}
+
+const char* getCurrentRealtimeSection()
+{
+#if HAS_ALLOCATION_PROFILER
+  return detail::g_realtime_section;
+#else
+  return 0;
+#endif
+}
+
 } // namespace rosrt
 
 extern "C"
@@ -242,6 +578,16 @@ typedef void (*FreeType)(void* ptr);
   }
 #endif
 
+#if HAS_ALLOCATION_PROFILER
+#define PROFILE_ALLOCATION(result, size) \
+  if (result) \
+  { \
+    rosrt::detail::profileAllocation(size); \
+  }
+#else
+#define PROFILE_ALLOCATION(result, size)
+#endif
+
 void* malloc(size_t size)
 {
   static MallocType original_function = reinterpret_cast<MallocType>(dlsym(RTLD_NEXT, "malloc"));
@@ -249,6 +595,7 @@ void* malloc(size_t size)
   void* result = original_function(size);
 
   UPDATE_ALLOC_INFO(result, size, mallocs);
+  PROFILE_ALLOCATION(result, size);
 
   return result;
 }
@@ -265,6 +612,7 @@ void* realloc(void* ptr, size_t size)
   void* result = original_function(ptr, size);
 
   UPDATE_ALLOC_INFO(result, size, reallocs);
+  PROFILE_ALLOCATION(result, size);
 
   return result;
 }
@@ -281,6 +629,7 @@ void* memalign(size_t boundary, size_t size)
   void* result = original_function(boundary, size);
 
   UPDATE_ALLOC_INFO(result, size, memaligns);
+  PROFILE_ALLOCATION(result, size);
 
   return result;
 }
@@ -324,6 +673,7 @@ void* calloc(size_t nmemb, size_t size)
   void* result = original_function(nmemb, size);
 
   UPDATE_ALLOC_INFO(result, size * nmemb, callocs);
+  PROFILE_ALLOCATION(result, size * nmemb);
 
   return result;
 }
@@ -339,6 +689,7 @@ int posix_memalign(void** ptr, size_t alignment, size_t size) {
   int result = original_function(ptr, alignment, size);
 
   UPDATE_ALLOC_INFO(!result, size, memaligns);
+  PROFILE_ALLOCATION(!result, size);
 
   return result;
 }
@@ -36,6 +36,7 @@
 #include <rosrt/detail/publisher_manager.h>
 #include <rosrt/detail/managers.h>
 #include <rosrt/init.h>
+#include <rosrt/epoch.h>
 #include <ros/debug.h>
 
 #include <lockfree/object_pool.h>
@@ -44,6 +45,9 @@
 
 #ifdef __XENO__
 #include <native/task.h>
+#include <native/timer.h>
+#else
+#include <time.h>
 #endif
 
 namespace rosrt
@@ -51,6 +55,20 @@ namespace rosrt
 namespace detail
 {
 
+// number of messages the publisher thread takes off the queue at once
+static const uint32_t PUBLISH_BATCH_SIZE = 64;
+
+static uint64_t getTimeNs()
+{
+#ifdef __XENO__
+  return rt_timer_read();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
 bool publish(const ros::Publisher& pub, const VoidConstPtr& msg, PublishFunc pub_func, CloneFunc clone_func)
 {
   return detail::getPublisherManager()->publish(pub, msg, pub_func, clone_func);
@@ -58,7 +76,14 @@ bool publish(const ros::Publisher& pub, const VoidConstPtr& msg, PublishFunc pub
 
 PublishQueue::PublishQueue(uint32_t size)
 : queue_(size)
+, batch_(PUBLISH_BATCH_SIZE)
+, latency_total_count_(0)
+, latency_max_(0)
 {
+  for (uint32_t i = 0; i < PublishLatencyHistogram::NUM_BUCKETS; ++i)
+  {
+    latency_counts_[i].store(0);
+  }
 }
 
 bool PublishQueue::push(const ros::Publisher& pub, const VoidConstPtr& msg, PublishFunc pub_func, CloneFunc clone_func)
@@ -68,6 +93,7 @@ bool PublishQueue::push(const ros::Publisher& pub, const VoidConstPtr& msg, Publ
   i.msg = msg;
   i.pub_func = pub_func;
   i.clone_func = clone_func;
+  i.enqueue_time = getTimeNs();
   return queue_.push(i);
 }
 
@@ -75,31 +101,71 @@ uint32_t PublishQueue::publishAll()
 {
   uint32_t count = 0;
 
-  MWSRQueue<PubItem>::Node* it = queue_.popAll();
-  while (it)
+  uint32_t batch_count;
+  while ((batch_count = queue_.popBatch(&batch_[0], batch_.size())) > 0)
   {
-    // Always clone the message before publishing.  Otherwise, if there's an intraprocess non-realtime subscriber that stores off the messages
-    // it could starve the realtime publisher for messages.
-    VoidConstPtr clone = it->val.clone_func(it->val.msg);
-    it->val.pub_func(it->val.pub, clone);
-    it->val.msg.reset();
-    it->val.pub = ros::Publisher();
-    MWSRQueue<PubItem>::Node* tmp = it;
-    it = it->next;
-
-    queue_.free(tmp);
-
-    ++count;
+    // releasing a message can free the last block of the pool of a destroyed Publisher
+    EpochGuard epoch_guard;
+
+    for (uint32_t i = 0; i < batch_count; ++i)
+    {
+      PubItem& item = batch_[i];
+      recordLatency(getTimeNs() - item.enqueue_time);
+
+      // Clone the message before publishing, unless the publisher asked not to.  Otherwise, if there's an intraprocess non-realtime
+      // subscriber that stores off the messages it could starve the realtime publisher for messages.
+      if (item.clone_func)
+      {
+        VoidConstPtr clone = item.clone_func(item.msg);
+        item.pub_func(item.pub, clone);
+      }
+      else
+      {
+        item.pub_func(item.pub, item.msg);
+      }
+      item.msg.reset();
+      item.pub = ros::Publisher();
+    }
+
+    count += batch_count;
   }
 
   return count;
 }
 
+void PublishQueue::recordLatency(uint64_t latency)
+{
+  uint32_t bucket = 0;
+  for (uint64_t l = latency >> 1; l && bucket < PublishLatencyHistogram::NUM_BUCKETS - 1; l >>= 1)
+  {
+    ++bucket;
+  }
+
+  // single writer, so no read-modify-write needed
+  latency_counts_[bucket].store(latency_counts_[bucket].load(ros::memory_order_relaxed) + 1, ros::memory_order_relaxed);
+  latency_total_count_.store(latency_total_count_.load(ros::memory_order_relaxed) + 1, ros::memory_order_relaxed);
+  if (latency > latency_max_.load(ros::memory_order_relaxed))
+  {
+    latency_max_.store(latency, ros::memory_order_relaxed);
+  }
+}
+
+void PublishQueue::getLatencyHistogram(PublishLatencyHistogram& histogram)
+{
+  for (uint32_t i = 0; i < PublishLatencyHistogram::NUM_BUCKETS; ++i)
+  {
+    histogram.counts[i] = latency_counts_[i].load(ros::memory_order_relaxed);
+  }
+  histogram.total_count = latency_total_count_.load(ros::memory_order_relaxed);
+  histogram.max_latency = latency_max_.load(ros::memory_order_relaxed);
+}
+
 PublisherManager::PublisherManager(const InitOptions& ops)
 : queue_(ops.pubmanager_queue_size)
 , pub_count_(0)
+, waiting_(false)
 , running_(true)
-, pub_thread_(boost::bind(&PublisherManager::publishThread, this), "rosrt_publisher", 7) // HACK!!! Assigns to CPU 7
+, pub_thread_(boost::bind(&PublisherManager::publishThread, this), "rosrt_publisher", ops.pubmanager_thread_cpu)
 {
 }
 
@@ -118,10 +184,14 @@ void PublisherManager::publishThread()
   {
     {
       rosrt::mutex::scoped_lock lock(cond_mutex_);
+      // publish() notifies without taking cond_mutex_, so a notify can get lost between checking pub_count_
+      // and waiting.  The timed wait bounds the delay of such a message.
+      waiting_.store(true);
       while (running_ && pub_count_.load() == 0)
       {
-        cond_.wait(lock);
+        cond_.timed_wait(lock, PUBLISH_THREAD_WAKEUP_PERIOD_NS);
       }
+      waiting_.store(false);
 
       if (!running_)
       {
@@ -146,10 +216,21 @@ bool PublisherManager::publish(const ros::Publisher& pub, const VoidConstPtr& ms
   }
 
   pub_count_.fetch_add(1);
-  cond_.notify_one();
+
+  // only wake the publisher thread when it is actually waiting.  The realtime side never takes cond_mutex_,
+  // the publisher thread polls in case this notify gets lost.
+  if (waiting_.load())
+  {
+    cond_.notify_one();
+  }
 
   return true;
 }
 
 } // namespace detail
+
+void getPublishLatencyHistogram(PublishLatencyHistogram& histogram)
+{
+  detail::getPublisherManager()->getLatencyHistogram(histogram);
+}
 } // namespace rosrt
@@ -0,0 +1,185 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <gtest/gtest.h>
+
+#include "rosrt/detail/epoch_gc.h"
+#include "rosrt/init.h"
+#include "ros/atomic.h"
+#include <ros/time.h>
+
+#include <boost/thread.hpp>
+
+using namespace rosrt;
+using namespace rosrt::detail;
+using namespace ros;
+
+atomic<uint32_t> g_deleted(0);
+atomic<bool> g_deletable(true);
+
+void deleteFakePool(void* pool)
+{
+  g_deleted.fetch_add(1);
+}
+
+bool fakePoolIsDeletable(void* pool)
+{
+  return g_deletable.load();
+}
+
+bool waitForDeleted(uint32_t count)
+{
+  WallTime start = WallTime::now();
+  while (g_deleted.load() < count)
+  {
+    if (WallTime::now() - start > WallDuration(2.0))
+    {
+      return false;
+    }
+
+    WallDuration(0.001).sleep();
+  }
+
+  return true;
+}
+
+TEST(EpochGC, emptyPool)
+{
+  g_deleted.store(0);
+  g_deletable.store(true);
+
+  EpochGC gc((InitOptions()));
+  int pool;
+  gc.add(&pool, deleteFakePool, fakePoolIsDeletable);
+  ASSERT_TRUE(waitForDeleted(1));
+
+  GCStats stats = gc.getStats();
+  EXPECT_EQ(stats.pending_pools, 0U);
+  EXPECT_EQ(stats.deleted_pools, 1U);
+  EXPECT_GT(stats.max_reclamation_lag.toSec(), 0.0);
+  // woken up when the pool is retired, not after a gc period
+  EXPECT_LT(stats.max_reclamation_lag.toSec(), InitOptions().gc_period.toSec());
+}
+
+TEST(EpochGC, poolWithMessages)
+{
+  g_deleted.store(0);
+  g_deletable.store(false);
+
+  EpochGC gc((InitOptions()));
+  int pool;
+  gc.add(&pool, deleteFakePool, fakePoolIsDeletable);
+  WallDuration(0.05).sleep();
+
+  GCStats stats = gc.getStats();
+  EXPECT_EQ(g_deleted.load(), 0U);
+  EXPECT_EQ(stats.pending_pools, 1U);
+  EXPECT_EQ(stats.pools_with_messages, 1U);
+
+  g_deletable.store(true);
+  ASSERT_TRUE(waitForDeleted(1));
+
+  stats = gc.getStats();
+  EXPECT_EQ(stats.pending_pools, 0U);
+  EXPECT_EQ(stats.pools_with_messages, 0U);
+}
+
+TEST(EpochGC, guardDelaysDeletion)
+{
+  g_deleted.store(0);
+  g_deletable.store(true);
+
+  EpochGC gc((InitOptions()));
+  int pool;
+  {
+    EpochGuard outer;
+    {
+      EpochGuard inner;
+      gc.add(&pool, deleteFakePool, fakePoolIsDeletable);
+    }
+
+    WallDuration(0.05).sleep();
+    EXPECT_EQ(g_deleted.load(), 0U);
+
+    GCStats stats = gc.getStats();
+    EXPECT_EQ(stats.pending_pools, 1U);
+    EXPECT_EQ(stats.pools_with_messages, 0U);
+    EXPECT_GT(stats.oldest_guard_epoch_lag, 0U);
+  }
+
+  ASSERT_TRUE(waitForDeleted(1));
+  EXPECT_EQ(gc.getStats().oldest_guard_epoch_lag, 0U);
+}
+
+void guardThread(atomic<bool>& done)
+{
+  while (!done.load())
+  {
+    EpochGuard guard;
+    boost::this_thread::yield();
+  }
+}
+
+TEST(EpochGC, concurrentGuards)
+{
+  g_deleted.store(0);
+  g_deletable.store(true);
+
+  atomic<bool> done(false);
+  boost::thread_group tg;
+  for (uint32_t i = 0; i < 4; ++i)
+  {
+    tg.create_thread(boost::bind(guardThread, boost::ref(done)));
+  }
+
+  {
+    EpochGC gc((InitOptions()));
+    int pools[100];
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+      gc.add(&pools[i], deleteFakePool, fakePoolIsDeletable);
+    }
+
+    // guards that keep being entered and left do not stall reclamation
+    ASSERT_TRUE(waitForDeleted(100));
+  }
+
+  done.store(true);
+  tg.join_all();
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -35,12 +35,15 @@
 #include <gtest/gtest.h>
 
 #include "rosrt/malloc_wrappers.h"
+#include "rosrt/allocation_profiler.h"
 #include "ros/atomic.h"
 #include <ros/time.h>
 #include <ros/console.h>
 
 #include <boost/thread.hpp>
 
+#include <cstring>
+
 #if __unix__ && !APPLE
 #include <dlfcn.h>
 #endif
@@ -156,6 +159,99 @@ TEST(MallocWrappersDeathTest, breakOnAllocFree)
   //ASSERT_DEATH_IF_SUPPORTED(doBreakOnMalloc(), "Issuing break due to break_on_alloc_or_free being set");
 }
 
+#if __unix__ && !APPLE
+TEST(AllocationProfiler, realtimeSections)
+{
+  AllocationProfilerOptions ops;
+  ops.sample_period = 1ULL << 40;
+  ops.print_on_exit = false;
+  ASSERT_TRUE(startAllocationProfiler(ops));
+  resetAllocationProfile();
+
+  EXPECT_FALSE(getCurrentRealtimeSection());
+  {
+    RealtimeSection outer("test_outer");
+    EXPECT_STREQ(getCurrentRealtimeSection(), "test_outer");
+    {
+      RealtimeSection inner("test_inner");
+      EXPECT_STREQ(getCurrentRealtimeSection(), "test_inner");
+      for (uint32_t i = 0; i < 10; ++i)
+      {
+        void* volatile mem = malloc(100);
+        free(mem);
+      }
+    }
+    EXPECT_STREQ(getCurrentRealtimeSection(), "test_outer");
+
+    void* volatile mem = malloc(200);
+    free(mem);
+  }
+  EXPECT_FALSE(getCurrentRealtimeSection());
+
+  stopAllocationProfiler();
+
+  std::vector<AllocationSite> sites;
+  getAllocationProfile(sites);
+
+  uint64_t inner_samples = 0;
+  uint64_t inner_bytes = 0;
+  uint64_t outer_bytes = 0;
+  for (size_t i = 0; i < sites.size(); ++i)
+  {
+    ASSERT_TRUE(sites[i].section);
+    EXPECT_FALSE(sites[i].stack.empty());
+    if (strcmp(sites[i].section, "test_inner") == 0)
+    {
+      inner_samples += sites[i].samples;
+      inner_bytes += sites[i].sampled_bytes;
+      EXPECT_EQ(sites[i].estimated_bytes, sites[i].sampled_bytes);
+    }
+    else if (strcmp(sites[i].section, "test_outer") == 0)
+    {
+      outer_bytes += sites[i].sampled_bytes;
+    }
+  }
+
+  EXPECT_EQ(inner_samples, 10U);
+  EXPECT_EQ(inner_bytes, 1000U);
+  EXPECT_EQ(outer_bytes, 200U);
+}
+
+TEST(AllocationProfiler, samplePeriod)
+{
+  AllocationProfilerOptions ops;
+  ops.sample_period = 1000;
+  ops.sample_realtime_sections = false;
+  ops.print_on_exit = false;
+  ASSERT_TRUE(startAllocationProfiler(ops));
+  resetAllocationProfile();
+
+  for (uint32_t i = 0; i < 1000; ++i)
+  {
+    void* volatile mem = malloc(100);
+    free(mem);
+  }
+
+  stopAllocationProfiler();
+
+  std::vector<AllocationSite> sites;
+  getAllocationProfile(sites);
+
+  // about one sample every 1000 bytes
+  uint64_t samples = 0;
+  uint64_t estimated_bytes = 0;
+  for (size_t i = 0; i < sites.size(); ++i)
+  {
+    samples += sites[i].samples;
+    estimated_bytes += sites[i].estimated_bytes;
+  }
+
+  EXPECT_GT(samples, 50U);
+  EXPECT_LT(samples, 200U);
+  EXPECT_EQ(estimated_bytes, samples * 1000);
+}
+#endif
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,233 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "rosrt/detail/mpmc_ring_buffer.h"
+#include "ros/atomic.h"
+
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+using namespace rosrt::detail;
+using namespace ros;
+
+TEST(MPMCRingBuffer, capacity)
+{
+  MPMCRingBuffer<uint32_t> queue(10);
+  EXPECT_EQ(queue.capacity(), 16UL);
+
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    ASSERT_TRUE(queue.push(i));
+  }
+  ASSERT_FALSE(queue.push(16));
+
+  uint32_t val;
+  ASSERT_TRUE(queue.pop(val));
+  EXPECT_EQ(val, 0UL);
+  ASSERT_TRUE(queue.push(16));
+  ASSERT_FALSE(queue.push(17));
+}
+
+TEST(MPMCRingBuffer, order)
+{
+  MPMCRingBuffer<uint32_t> queue(8);
+  uint32_t val;
+  ASSERT_FALSE(queue.pop(val));
+
+  // several laps around the buffer
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    ASSERT_TRUE(queue.push(i));
+    ASSERT_TRUE(queue.push(i + 1000));
+    ASSERT_TRUE(queue.pop(val));
+    EXPECT_EQ(val, i);
+    ASSERT_TRUE(queue.pop(val));
+    EXPECT_EQ(val, i + 1000);
+  }
+  ASSERT_FALSE(queue.pop(val));
+}
+
+TEST(MPMCRingBuffer, popBatch)
+{
+  MPMCRingBuffer<uint32_t> queue(8);
+  uint32_t vals[8];
+  EXPECT_EQ(queue.popBatch(vals, 8), 0UL);
+
+  for (uint32_t i = 0; i < 5; ++i)
+  {
+    ASSERT_TRUE(queue.push(i));
+  }
+  ASSERT_EQ(queue.popBatch(vals, 3), 3UL);
+  for (uint32_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(vals[i], i);
+  }
+
+  for (uint32_t i = 5; i < 10; ++i)
+  {
+    ASSERT_TRUE(queue.push(i));
+  }
+  ASSERT_EQ(queue.popBatch(vals, 8), 7UL);
+  for (uint32_t i = 0; i < 7; ++i)
+  {
+    EXPECT_EQ(vals[i], i + 3);
+  }
+}
+
+TEST(MPMCRingBuffer, releasesPoppedElements)
+{
+  MPMCRingBuffer<boost::shared_ptr<uint32_t> > queue(4);
+  boost::shared_ptr<uint32_t> item(new uint32_t(5));
+  ASSERT_TRUE(queue.push(item));
+  EXPECT_EQ(item.use_count(), 2);
+
+  boost::shared_ptr<uint32_t> popped;
+  ASSERT_TRUE(queue.pop(popped));
+  EXPECT_EQ(popped, item);
+  popped.reset();
+  EXPECT_EQ(item.use_count(), 1);
+}
+
+void producerThread(MPMCRingBuffer<uint32_t>& queue, uint32_t id, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    while (!queue.push(id * count + i))
+    {
+      boost::this_thread::yield();
+    }
+  }
+}
+
+void consumerThread(MPMCRingBuffer<uint32_t>& queue, std::vector<uint32_t>& last, uint32_t count,
+                    atomic<uint32_t>& popped, atomic<bool>& failed)
+{
+  uint32_t vals[16];
+  while (popped.load() < count * last.size())
+  {
+    uint32_t num = queue.popBatch(vals, 16);
+    if (num == 0)
+    {
+      boost::this_thread::yield();
+    }
+    for (uint32_t i = 0; i < num; ++i)
+    {
+      // each producer's elements must come out in order
+      uint32_t producer = vals[i] / count;
+      uint32_t index = vals[i] % count;
+      if (index + 1 <= last[producer])
+      {
+        failed.store(true);
+      }
+      last[producer] = index + 1;
+    }
+    popped.fetch_add(num);
+  }
+}
+
+TEST(MPMCRingBuffer, multipleProducersSingleConsumer)
+{
+  const uint32_t num_producers = 4;
+  const uint32_t count = 20000;
+  MPMCRingBuffer<uint32_t> queue(64);
+  atomic<uint32_t> popped(0);
+  atomic<bool> failed(false);
+  std::vector<uint32_t> last(num_producers, 0);
+
+  boost::thread_group producers;
+  for (uint32_t i = 0; i < num_producers; ++i)
+  {
+    producers.create_thread(boost::bind(producerThread, boost::ref(queue), i, count));
+  }
+  consumerThread(queue, last, count, popped, failed);
+  producers.join_all();
+
+  EXPECT_FALSE(failed.load());
+  EXPECT_EQ(popped.load(), num_producers * count);
+  for (uint32_t i = 0; i < num_producers; ++i)
+  {
+    EXPECT_EQ(last[i], count);
+  }
+}
+
+void countingConsumerThread(MPMCRingBuffer<uint32_t>& queue, uint32_t total, atomic<uint32_t>& popped,
+                            atomic<uint64_t>& sum)
+{
+  uint32_t vals[8];
+  while (popped.load() < total)
+  {
+    uint32_t num = queue.popBatch(vals, 8);
+    if (num == 0)
+    {
+      boost::this_thread::yield();
+    }
+    for (uint32_t i = 0; i < num; ++i)
+    {
+      sum.fetch_add(vals[i]);
+    }
+    popped.fetch_add(num);
+  }
+}
+
+TEST(MPMCRingBuffer, multipleProducersMultipleConsumers)
+{
+  const uint32_t num_threads = 4;
+  const uint32_t count = 10000;
+  MPMCRingBuffer<uint32_t> queue(64);
+  atomic<uint32_t> popped(0);
+  atomic<uint64_t> sum(0);
+
+  boost::thread_group threads;
+  for (uint32_t i = 0; i < num_threads; ++i)
+  {
+    threads.create_thread(boost::bind(producerThread, boost::ref(queue), i, count));
+    threads.create_thread(boost::bind(countingConsumerThread, boost::ref(queue), num_threads * count,
+                                      boost::ref(popped), boost::ref(sum)));
+  }
+  threads.join_all();
+
+  // every element popped exactly once
+  uint64_t n = num_threads * count;
+  EXPECT_EQ(popped.load(), n);
+  EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
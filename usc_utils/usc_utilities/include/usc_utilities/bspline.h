@@ -79,6 +79,27 @@ bool resample(const std::vector<double>& input_vector,
               bool compute_slope,
               bool verbose = false);
 
+/*!
+ * Resamples several target vectors that are sampled at the same input vector. The nodes of the
+ * b-spline and the factorization of its (banded) system are computed once and shared by all
+ * target vectors, each of which then only requires a forward/backward substitution.
+ * @param input_vector
+ * @param target_vectors
+ * @param cutoff_wave_length
+ * @param input_querry
+ * @param output_vectors
+ * @param compute_slope
+ * @param num_threads Number of threads the target vectors are split among, 0 to use one per core
+ * @return True on success, otherwise False
+ */
+bool resample(const std::vector<double>& input_vector,
+              const std::vector<std::vector<double> >& target_vectors,
+              const double cutoff_wave_length,
+              const std::vector<double>& input_querry,
+              std::vector<std::vector<double> >& output_vectors,
+              bool compute_slope,
+              int num_threads = 0);
+
 /**
  * Given input samples of input_y = f(input_x), calculates output_y = f(output_x) using linear interpolation
  * Assumes that input_x and output_x are sorted!
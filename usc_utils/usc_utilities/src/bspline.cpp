@@ -0,0 +1,173 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks    Resamples several target vectors with a shared b-spline, split among threads.
+
+ \file   bspline.cpp
+
+ \date   Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <algorithm>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+// local includes
+#include <usc_utilities/bspline.h>
+
+namespace usc_utilities
+{
+
+/*!
+ * Solves the b-splines of the target vectors [begin, end) using the shared spline
+ * @param spline A copy of the shared spline (one per thread)
+ * @param valid_indexes Indexes of the valid input data points
+ * @param target_vectors
+ * @param input_querry
+ * @param output_vectors
+ * @param compute_slope
+ * @param begin
+ * @param end
+ * @param results Set to 1 for each target vector that could be resampled
+ */
+static void resampleChannels(BSpline<double>* spline,
+                             const std::vector<int>* valid_indexes,
+                             const std::vector<std::vector<double> >* target_vectors,
+                             const std::vector<double>* input_querry,
+                             std::vector<std::vector<double> >* output_vectors,
+                             const bool compute_slope,
+                             const int begin,
+                             const int end,
+                             std::vector<char>* results)
+{
+  const int num_rows = static_cast<int> (valid_indexes->size());
+  const int num_samples = static_cast<int> (input_querry->size());
+  std::vector<double> y_vector(num_rows);
+  for (int c = begin; c < end; ++c)
+  {
+    const std::vector<double>& target_vector = (*target_vectors)[c];
+    for (int i = 0; i < num_rows; ++i)
+    {
+      y_vector[i] = target_vector[(*valid_indexes)[i]];
+    }
+
+    std::vector<double>& output_vector = (*output_vectors)[c];
+    output_vector.resize(num_samples);
+    if (!spline->solve(&(y_vector[0])))
+    {
+      ROS_ERROR("Could not solve b-spline of target vector >%i<.", c);
+      (*results)[c] = 0;
+      continue;
+    }
+    for (int s = 0; s < num_samples; ++s)
+    {
+      if (compute_slope)
+      {
+        output_vector[s] = spline->slope((*input_querry)[s]);
+      }
+      else
+      {
+        output_vector[s] = spline->evaluate((*input_querry)[s]);
+      }
+    }
+    (*results)[c] = 1;
+  }
+}
+
+bool resample(const std::vector<double>& input_vector,
+              const std::vector<std::vector<double> >& target_vectors,
+              const double cutoff_wave_length,
+              const std::vector<double>& input_querry,
+              std::vector<std::vector<double> >& output_vectors,
+              bool compute_slope,
+              int num_threads)
+{
+  ROS_ASSERT_MSG(!input_vector.empty(), "Input vector is empty. Cannot resample trajecoty using a bspline.");
+  ROS_ASSERT_MSG(!input_querry.empty(), "Input querry is empty. Cannot resample trajecoty using a bspline.");
+  const int num_channels = static_cast<int> (target_vectors.size());
+  for (int c = 0; c < num_channels; ++c)
+  {
+    ROS_VERIFY(input_vector.size() == target_vectors[c].size());
+  }
+  output_vectors.resize(num_channels);
+  if (num_channels == 0)
+  {
+    return true;
+  }
+
+  // skip invalid data points once for all target vectors
+  std::vector<int> valid_indexes;
+  std::vector<double> x_vector;
+  valid_indexes.reserve(input_vector.size());
+  x_vector.reserve(input_vector.size());
+  for (int i = 0; i < static_cast<int> (input_vector.size()); i++)
+  {
+    if (input_vector[i] >= 1e-6)
+    {
+      valid_indexes.push_back(i);
+      x_vector.push_back(input_vector[i]);
+    }
+  }
+  const int invalid_data_counter = static_cast<int> (input_vector.size() - x_vector.size());
+  if (invalid_data_counter > static_cast<int> (x_vector.size()))
+  {
+    ROS_WARN("Found >%i< invalid data points when resampling the trajectory.", invalid_data_counter);
+  }
+  if (x_vector.empty())
+  {
+    ROS_ERROR("All >%i< data points are invalid. Cannot resample trajectory using a bspline.", invalid_data_counter);
+    return false;
+  }
+
+  // compute the nodes and factorize the system once
+  BSpline<double>::Debug(0);
+  BSplineBase<double> b_spline_base(&(x_vector[0]), static_cast<int> (x_vector.size()), cutoff_wave_length);
+  if (!b_spline_base.ok())
+  {
+    ROS_ERROR("Could not create b-spline.");
+    ROS_ERROR("Number of input values is >%i<.", (int)x_vector.size());
+    ROS_ERROR("Cuttoff is >%f<.", cutoff_wave_length);
+    return false;
+  }
+
+  if (num_threads <= 0)
+  {
+    num_threads = static_cast<int> (boost::thread::hardware_concurrency());
+  }
+  num_threads = std::max(1, std::min(num_threads, num_channels));
+
+  // each thread solves a contiguous block of target vectors with its own copy of the spline
+  std::vector<boost::shared_ptr<BSpline<double> > > splines(num_threads);
+  std::vector<double> zeros(x_vector.size(), 0.0);
+  for (int t = 0; t < num_threads; ++t)
+  {
+    splines[t].reset(new BSpline<double>(b_spline_base, &(zeros[0])));
+  }
+
+  std::vector<char> results(num_channels, 0);
+  boost::thread_group threads;
+  for (int t = 1; t < num_threads; ++t)
+  {
+    threads.create_thread(boost::bind(&resampleChannels, splines[t].get(), &valid_indexes, &target_vectors, &input_querry, &output_vectors,
+                                      compute_slope, (t * num_channels) / num_threads, ((t + 1) * num_channels) / num_threads, &results));
+  }
+  resampleChannels(splines[0].get(), &valid_indexes, &target_vectors, &input_querry, &output_vectors,
+                   compute_slope, 0, num_channels / num_threads, &results);
+  threads.join_all();
+
+  for (int c = 0; c < num_channels; ++c)
+  {
+    if (!results[c])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+}
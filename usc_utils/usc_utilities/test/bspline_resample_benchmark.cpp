@@ -0,0 +1,106 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		Compares resampling each target vector with its own
+            b-spline to resampling all target vectors with a shared one.
+
+  \file		bspline_resample_benchmark.cpp
+
+  \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <stdio.h>
+#include <math.h>
+
+// local includes
+#include <ros/ros.h>
+#include <usc_utilities/bspline.h>
+
+static const int NUM_ROWS = 3000; // 10 seconds at 300Hz
+static const int NUM_SAMPLES = 100;
+static const int NUM_REPETITIONS = 3;
+
+static void createTrajectories(const int num_channels,
+                               std::vector<double>& input_vector,
+                               std::vector<std::vector<double> >& target_vectors)
+{
+  input_vector.resize(NUM_ROWS);
+  for (int i = 0; i < NUM_ROWS; ++i)
+  {
+    input_vector[i] = 1000.0 + i / 300.0 + 1e-4 * sin(3.0 * i);
+  }
+  target_vectors.resize(num_channels);
+  for (int c = 0; c < num_channels; ++c)
+  {
+    target_vectors[c].resize(NUM_ROWS);
+    for (int i = 0; i < NUM_ROWS; ++i)
+    {
+      target_vectors[c][i] = sin((c % 10 + 1) * (input_vector[i] - 1000.0)) + 0.01 * cos(11.0 * i + c);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "bspline_resample_benchmark");
+
+  printf("%d data points resampled to %d samples, times in ms\n", NUM_ROWS, NUM_SAMPLES);
+  printf("%10s %14s %14s %14s %12s\n", "channels", "per channel", "shared", "shared/cores", "max diff");
+  const int channels[] = {10, 50, 100, 200};
+  for (unsigned int n = 0; n < sizeof(channels) / sizeof(channels[0]); ++n)
+  {
+    std::vector<double> input_vector;
+    std::vector<std::vector<double> > target_vectors;
+    createTrajectories(channels[n], input_vector, target_vectors);
+
+    std::vector<double> input_querry(NUM_SAMPLES);
+    const double interval = (input_vector.back() - input_vector.front()) / (NUM_SAMPLES - 1);
+    for (int s = 0; s < NUM_SAMPLES; ++s)
+    {
+      input_querry[s] = input_vector.front() + s * interval;
+    }
+    const double wave_length = 2.0 * interval;
+
+    std::vector<std::vector<double> > per_channel_output(channels[n]);
+    ros::WallTime start = ros::WallTime::now();
+    for (int r = 0; r < NUM_REPETITIONS; ++r)
+    {
+      for (int c = 0; c < channels[n]; ++c)
+      {
+        ROS_VERIFY(usc_utilities::resample(input_vector, target_vectors[c], wave_length, input_querry, per_channel_output[c], false));
+      }
+    }
+    double per_channel_time = (ros::WallTime::now() - start).toSec() / NUM_REPETITIONS;
+
+    std::vector<std::vector<double> > shared_output;
+    start = ros::WallTime::now();
+    for (int r = 0; r < NUM_REPETITIONS; ++r)
+    {
+      ROS_VERIFY(usc_utilities::resample(input_vector, target_vectors, wave_length, input_querry, shared_output, false, 1));
+    }
+    double shared_time = (ros::WallTime::now() - start).toSec() / NUM_REPETITIONS;
+
+    start = ros::WallTime::now();
+    for (int r = 0; r < NUM_REPETITIONS; ++r)
+    {
+      ROS_VERIFY(usc_utilities::resample(input_vector, target_vectors, wave_length, input_querry, shared_output, false));
+    }
+    double parallel_time = (ros::WallTime::now() - start).toSec() / NUM_REPETITIONS;
+
+    double max_difference = 0.0;
+    for (int c = 0; c < channels[n]; ++c)
+    {
+      for (int s = 0; s < NUM_SAMPLES; ++s)
+      {
+        max_difference = std::max(max_difference, fabs(per_channel_output[c][s] - shared_output[c][s]));
+      }
+    }
+    printf("%10d %14.3f %14.3f %14.3f %12g\n", channels[n], 1e3 * per_channel_time, 1e3 * shared_time,
+           1e3 * parallel_time, max_difference);
+  }
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		...
+
+  \file		bspline_test.cpp
+
+  \date		Oct 17, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <math.h>
+
+// local includes
+#include <gtest/gtest.h>
+#include <usc_utilities/bspline.h>
+
+using namespace usc_utilities;
+
+static void createTrajectories(const int num_channels,
+                               const int num_rows,
+                               std::vector<double>& input_vector,
+                               std::vector<std::vector<double> >& target_vectors)
+{
+  input_vector.resize(num_rows);
+  for (int i = 0; i < num_rows; ++i)
+  {
+    input_vector[i] = 100.0 + i * 0.01 + 0.001 * sin(3.0 * i);
+  }
+  target_vectors.resize(num_channels);
+  for (int c = 0; c < num_channels; ++c)
+  {
+    target_vectors[c].resize(num_rows);
+    for (int i = 0; i < num_rows; ++i)
+    {
+      target_vectors[c][i] = c + sin((c + 1) * (input_vector[i] - 100.0)) + 0.01 * cos(11.0 * i);
+    }
+  }
+}
+
+static void createQuerry(const std::vector<double>& input_vector,
+                         const int num_samples,
+                         std::vector<double>& input_querry)
+{
+  input_querry.resize(num_samples);
+  const double interval = (input_vector.back() - input_vector.front()) / (num_samples - 1);
+  for (int s = 0; s < num_samples; ++s)
+  {
+    input_querry[s] = input_vector.front() + s * interval;
+  }
+}
+
+TEST(UscUtilitiesBSpline, resampleMultipleTargetVectors)
+{
+  const int num_channels = 7;
+  const int num_samples = 100;
+  std::vector<double> input_vector;
+  std::vector<std::vector<double> > target_vectors;
+  createTrajectories(num_channels, 500, input_vector, target_vectors);
+  std::vector<double> input_querry;
+  createQuerry(input_vector, num_samples, input_querry);
+  const double wave_length = 2.0 * (input_querry[1] - input_querry[0]);
+
+  for (int compute_slope = 0; compute_slope < 2; ++compute_slope)
+  {
+    for (int num_threads = 1; num_threads <= 3; ++num_threads)
+    {
+      std::vector<std::vector<double> > output_vectors;
+      EXPECT_TRUE(resample(input_vector, target_vectors, wave_length, input_querry, output_vectors, compute_slope, num_threads));
+      ASSERT_EQ(static_cast<int>(output_vectors.size()), num_channels);
+      for (int c = 0; c < num_channels; ++c)
+      {
+        std::vector<double> output_vector;
+        EXPECT_TRUE(resample(input_vector, target_vectors[c], wave_length, input_querry, output_vector, compute_slope));
+        ASSERT_EQ(output_vectors[c].size(), output_vector.size());
+        for (int s = 0; s < num_samples; ++s)
+        {
+          EXPECT_NEAR(output_vectors[c][s], output_vector[s], 1e-9);
+        }
+      }
+    }
+  }
+}
+
+TEST(UscUtilitiesBSpline, resampleSkipsInvalidDataPoints)
+{
+  const int num_channels = 3;
+  std::vector<double> input_vector;
+  std::vector<std::vector<double> > target_vectors;
+  createTrajectories(num_channels, 200, input_vector, target_vectors);
+  std::vector<double> input_querry;
+  createQuerry(input_vector, 50, input_querry);
+  const double wave_length = 2.0 * (input_querry[1] - input_querry[0]);
+
+  std::vector<std::vector<double> > output_vectors;
+  EXPECT_TRUE(resample(input_vector, target_vectors, wave_length, input_querry, output_vectors, false));
+
+  // data points with a time stamp of zero are ignored
+  std::vector<double> invalid_input_vector = input_vector;
+  std::vector<std::vector<double> > invalid_target_vectors = target_vectors;
+  invalid_input_vector.insert(invalid_input_vector.begin(), 0.0);
+  for (int c = 0; c < num_channels; ++c)
+  {
+    invalid_target_vectors[c].insert(invalid_target_vectors[c].begin(), 1e3);
+  }
+  std::vector<std::vector<double> > invalid_output_vectors;
+  EXPECT_TRUE(resample(invalid_input_vector, invalid_target_vectors, wave_length, input_querry, invalid_output_vectors, false));
+  for (int c = 0; c < num_channels; ++c)
+  {
+    for (int s = 0; s < static_cast<int>(input_querry.size()); ++s)
+    {
+      EXPECT_DOUBLE_EQ(invalid_output_vectors[c][s], output_vectors[c][s]);
+    }
+  }
+}